@@ -7,6 +7,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "mysql.h"
 #import "MariaDBResultSet.h"
 
 #define kMariaDBKitDomain      @"MariaDBKit"
@@ -30,6 +31,22 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSError*) lastError;
 
+// Underlying connection, for callers that drive the C API directly
+// (row decoding, prepared statements). Owned by the client.
+- (nullable MYSQL*) mysqlHandle;
+
+// Server side id of this connection (mysql_thread_id), 0 when not connected.
+- (unsigned long) threadId;
+
+// Sends KILL QUERY for another connection's thread id. Meant to be called on
+// a separate side connection while the target is busy fetching.
+- (BOOL) killQuery: (unsigned long) threadId
+             error: (NSError**) pError;
+
+// Shuts the socket down (mariadb_cancel) so a blocked read on another thread
+// returns immediately. The connection must be reconnected afterwards.
+- (void) cancel;
+
 - (MariaDBResultSet*) executeQuery: (NSString*) sql
                              error: (NSError**) pError;
 // Below attribute lets it work with try rather than requiring NSError ptr
@@ -72,6 +72,12 @@
         port = 3306;
     } // End of no port
 
+    if(mysql)
+    {
+        mysql_close(mysql);
+        mysql = NULL;
+    } // End of reconnecting an existing client
+
     mysql = mysql_init(NULL);
     
     // Compress results
@@ -84,7 +90,9 @@
     // Set our encoding
     mysql_options(mysql, MYSQL_SET_CHARSET_NAME, [@"utf8" UTF8String]);
     
-    unsigned long clientFlags = CLIENT_COMPRESS;
+    // Scripts are sent in one round trip and every result set is read back,
+    // including the ones stored procedures return.
+    unsigned long clientFlags = CLIENT_COMPRESS | CLIENT_MULTI_STATEMENTS | CLIENT_MULTI_RESULTS;
     
     if(NULL == mysql_real_connect(mysql,
                                   host.UTF8String,
@@ -149,6 +157,58 @@
     return resultSet;
 } // End of executeQuery
 
+- (MYSQL*) mysqlHandle
+{
+    return mysql;
+} // End of mysqlHandle
+
+- (unsigned long) threadId
+{
+    if(NULL == mysql)
+    {
+        return 0;
+    } // End of mysql was null
+
+    return mysql_thread_id(mysql);
+} // End of threadId
+
+- (BOOL) killQuery: (unsigned long) threadId
+             error: (NSError**) pError
+{
+    if(NULL == mysql)
+    {
+        if(pError)
+        {
+            *pError = [self lastError];
+        }
+
+        return false;
+    } // End of mysql was null
+
+    char killStatement[64];
+    int killLength = snprintf(killStatement, sizeof(killStatement), "KILL QUERY %lu", threadId);
+
+    if(0 != mysql_real_query(mysql, killStatement, (unsigned long) killLength))
+    {
+        if(pError)
+        {
+            *pError = [self lastError];
+        }
+
+        return false;
+    } // End of kill query
+
+    return true;
+} // End of killQuery:error:
+
+- (void) cancel
+{
+    if(mysql)
+    {
+        mariadb_cancel(mysql);
+    } // End of we have an open socket
+} // End of cancel
+
 - (NSError*) lastError
 {
     @synchronized(self)
@@ -0,0 +1,1119 @@
+//
+//  ArrowExport.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ArrowExport.hpp"
+#include "ResultSorter.hpp"
+#include "ThreadPool.hpp"
+#include "ValueParser.hpp"
+
+#include <MariaDBKit/mysql.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string_view>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace DBCore;
+
+namespace
+{
+    enum class ArrowType : uint8_t
+    {
+        Int64,
+        UInt64,
+        Float64,
+        Date32,
+        Timestamp,      // microseconds, no time zone
+        Duration,       // microseconds
+        Decimal128,
+        Utf8,
+        Binary,
+    };
+
+    struct ArrowColumn
+    {
+        ArrowType   Type      = ArrowType::Utf8;
+        bool        FromText  = false;      // values are parsed out of text cells
+        int         Precision = 0;
+        int         Scale     = 0;
+        std::string Format;                 // C data interface format string
+
+        bool                              Dictionary = false;
+        std::vector<int32_t>              DictionaryOffsets;
+        std::string                       DictionaryData;
+        std::vector<std::vector<int32_t>> Indices;      // per block
+    };
+
+    struct ArrowPlan
+    {
+        std::shared_ptr<const ResultStore> Owner;       // set for C interface exports
+        const ResultStore*                 Store = nullptr;
+        std::vector<ArrowColumn>           Columns;
+    };
+
+    struct ArrowBuffer
+    {
+        const void* Data   = nullptr;
+        size_t      Length = 0;
+    };
+
+    struct ArrowColumnBatch
+    {
+        int64_t              NullCount   = 0;
+        ArrowBuffer          Buffers[3];
+        int                  BufferCount = 2;
+        std::vector<uint8_t> Validity;
+        std::vector<uint8_t> Values;        // converted values, when not handed out in place
+    };
+
+    struct ArrowBatch
+    {
+        std::shared_ptr<const ArrowPlan>   Plan;
+        std::shared_ptr<const ResultBlock> Block;
+        std::vector<ArrowColumnBatch>      Columns;
+
+        // C data interface structs, which point into this batch.
+        std::vector<const void*> BufferPointers;       // 3 per column
+        std::vector<const void*> DictionaryPointers;   // 3 per column
+        std::vector<ArrowArray>  Children;
+        std::vector<ArrowArray*> ChildPointers;
+        std::vector<ArrowArray>  Dictionaries;
+        const void*              StructBuffers[1] = { nullptr };
+    };
+
+    struct SchemaHolder
+    {
+        std::vector<std::string>  Formats;
+        std::vector<std::string>  Names;
+        std::vector<ArrowSchema>  Children;
+        std::vector<ArrowSchema*> ChildPointers;
+        std::vector<ArrowSchema>  Dictionaries;
+    };
+
+    struct StreamState
+    {
+        std::shared_ptr<const ArrowPlan> Plan;
+        size_t                           NextBlock = 0;
+    };
+
+    // Minimal FlatBuffers builder for the Arrow IPC metadata. Like the real
+    // one it builds back to front, so objects are referenced by their
+    // distance from the end of the buffer and must exist before whatever
+    // refers to them.
+    class FlatBuilder
+    {
+    public:
+        uint32_t Size() const { return (uint32_t)(Buffer.size() - Head); }
+
+        void Prep(size_t Align, size_t Additional) {
+            MaxAlign = std::max(MaxAlign, Align);
+            Pad((~(Size() + Additional) + 1) & (Align - 1));
+        }
+
+        template<typename T>
+        void Push(T Value) {
+            Grow(sizeof(T));
+            Head -= sizeof(T);
+            memcpy(&Buffer[Head], &Value, sizeof(T));
+        }
+
+        uint32_t String(std::string_view Text) {
+            Prep(4, Text.size() + 1);
+            Push<uint8_t>(0);
+            PushBytes(Text.data(), Text.size());
+            Push<uint32_t>((uint32_t)Text.size());
+            return Size();
+        }
+
+        uint32_t OffsetVector(const std::vector<uint32_t>& Offsets) {
+            Prep(4, Offsets.size() * 4);
+            for (size_t i = Offsets.size(); i-- > 0; )
+                Push<uint32_t>(Size() + 4 - Offsets[i]);
+            Push<uint32_t>((uint32_t)Offsets.size());
+            return Size();
+        }
+
+        uint32_t StructVector(const void* Data, size_t ElementSize, size_t Count) {
+            Prep(8, ElementSize * Count);
+            PushBytes(Data, ElementSize * Count);
+            Push<uint32_t>((uint32_t)Count);
+            return Size();
+        }
+
+        void StartTable() {
+            Fields.clear();
+            TableStart = Size();
+        }
+
+        template<typename T>
+        void AddScalar(uint16_t Slot, T Value) {
+            Prep(sizeof(T), 0);
+            Push(Value);
+            Fields.emplace_back(Slot, Size());
+        }
+
+        void AddOffset(uint16_t Slot, uint32_t Target) {
+            Prep(4, 0);
+            Push<uint32_t>(Size() + 4 - Target);
+            Fields.emplace_back(Slot, Size());
+        }
+
+        uint32_t EndTable() {
+            Prep(4, 0);
+            Push<int32_t>(0);
+            uint32_t Table = Size();
+
+            uint16_t Count = 0;
+            for (const auto& [Slot, Offset] : Fields)
+                Count = std::max<uint16_t>(Count, Slot + 1);
+            std::vector<uint16_t> Slots(Count, 0);
+            for (const auto& [Slot, Offset] : Fields)
+                Slots[Slot] = (uint16_t)(Table - Offset);
+
+            for (size_t i = Count; i-- > 0; )
+                Push<uint16_t>(Slots[i]);
+            Push<uint16_t>((uint16_t)(Table - TableStart));
+            Push<uint16_t>((uint16_t)(4 + 2 * Count));
+
+            int32_t VTable = (int32_t)(Size() - Table);
+            memcpy(&Buffer[Buffer.size() - Table], &VTable, sizeof(VTable));
+            return Table;
+        }
+
+        std::vector<uint8_t> Finish(uint32_t Root) {
+            Prep(MaxAlign, 4);
+            Push<uint32_t>(Size() + 4 - Root);
+            return std::vector<uint8_t>(Buffer.begin() + (ptrdiff_t)Head, Buffer.end());
+        }
+
+    private:
+        void Grow(size_t Length) {
+            if (Head >= Length)
+                return;
+            size_t Used = Size();
+            size_t Capacity = std::max(Buffer.size() * 2, Used + Length + 256);
+            std::vector<uint8_t> Grown(Capacity);
+            memcpy(Grown.data() + Capacity - Used, Buffer.data() + Head, Used);
+            Buffer.swap(Grown);
+            Head = Capacity - Used;
+        }
+
+        void Pad(size_t Length) {
+            Grow(Length);
+            Head -= Length;
+            memset(&Buffer[Head], 0, Length);
+        }
+
+        void PushBytes(const void* Data, size_t Length) {
+            Grow(Length);
+            Head -= Length;
+            if (Length)
+                memcpy(&Buffer[Head], Data, Length);
+        }
+
+        std::vector<uint8_t>                       Buffer;
+        size_t                                     Head       = 0;
+        size_t                                     MaxAlign   = 1;
+        uint32_t                                   TableStart = 0;
+        std::vector<std::pair<uint16_t, uint32_t>> Fields;
+    };
+
+    // Structs of the IPC metadata, laid out as in Message.fbs and File.fbs.
+    struct FieldNode
+    {
+        int64_t Length;
+        int64_t NullCount;
+    };
+
+    struct BufferSpec
+    {
+        int64_t Offset;
+        int64_t Length;
+    };
+
+    struct FileBlock
+    {
+        int64_t Offset;
+        int32_t MetadataLength;
+        int32_t Padding;
+        int64_t BodyLength;
+    };
+
+    enum : uint8_t
+    {
+        HeaderSchema          = 1,
+        HeaderDictionaryBatch = 2,
+        HeaderRecordBatch     = 3,
+    };
+
+    enum : uint8_t
+    {
+        TypeInt           = 2,
+        TypeFloatingPoint = 3,
+        TypeBinary        = 4,
+        TypeUtf8          = 5,
+        TypeDecimal       = 7,
+        TypeDate          = 8,
+        TypeTimestamp     = 10,
+        TypeDuration      = 18,
+    };
+
+    constexpr int16_t MetadataVersionV5 = 4;
+    constexpr int16_t UnitMicrosecond   = 2;
+}
+
+static const uint8_t EmptyBuffer[8] = {};
+
+static size_t Pad8(size_t Length) { return (Length + 7) & ~(size_t)7; }
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar.
+static int32_t DaysFromCivil(int Year, unsigned Month, unsigned Day)
+{
+    Year -= Month <= 2;
+    const int Era = (Year >= 0 ? Year : Year - 399) / 400;
+    const unsigned YearOfEra = (unsigned)(Year - Era * 400);
+    const unsigned DayOfYear = (153 * (Month > 2 ? Month - 3 : Month + 9) + 2) / 5 + Day - 1;
+    const unsigned DayOfEra = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+    return Era * 146097 + (int)DayOfEra - 719468;
+}
+
+static ArrowColumn PlanColumn(const ColumnInfo& Column)
+{
+    ArrowColumn Plan;
+    const bool DateOnly = Column.Type == MYSQL_TYPE_DATE || Column.Type == MYSQL_TYPE_NEWDATE;
+
+    switch (Column.Encoding)
+    {
+        case ColumnEncoding::Int64:    Plan.Type = ArrowType::Int64; break;
+        case ColumnEncoding::UInt64:   Plan.Type = ArrowType::UInt64; break;
+        case ColumnEncoding::Double:   Plan.Type = ArrowType::Float64; break;
+        case ColumnEncoding::DateTime: Plan.Type = DateOnly ? ArrowType::Date32 : ArrowType::Timestamp; break;
+        case ColumnEncoding::Time:     Plan.Type = ArrowType::Duration; break;
+        case ColumnEncoding::Text:
+        {
+            Plan.FromText = true;
+            switch (SortKeyKindForColumn(Column))
+            {
+                case SortKeyKind::Signed:   Plan.Type = ArrowType::Int64; break;
+                case SortKeyKind::Unsigned: Plan.Type = ArrowType::UInt64; break;
+                case SortKeyKind::Temporal: Plan.Type = DateOnly ? ArrowType::Date32 : ArrowType::Timestamp; break;
+                case SortKeyKind::Duration: Plan.Type = ArrowType::Duration; break;
+                case SortKeyKind::Bytes:    Plan.Type = ArrowType::Binary; break;
+                case SortKeyKind::Real:
+                {
+                    Plan.Type = ArrowType::Float64;
+                    if (Column.Type != MYSQL_TYPE_DECIMAL && Column.Type != MYSQL_TYPE_NEWDECIMAL)
+                        break;
+
+                    // The display length counts the sign and the decimal point.
+                    int Precision = (int)Column.Length - (Column.Decimals ? 1 : 0) - ((Column.Flags & UNSIGNED_FLAG) ? 0 : 1);
+                    if (Precision >= 1 && Precision <= 38 && (int)Column.Decimals <= Precision)
+                    {
+                        Plan.Type      = ArrowType::Decimal128;
+                        Plan.Precision = Precision;
+                        Plan.Scale     = (int)Column.Decimals;
+                    }
+                    else
+                    {
+                        // Too wide for decimal128; the text keeps every digit.
+                        Plan.Type = ArrowType::Utf8;
+                    }
+                    break;
+                }
+                case SortKeyKind::Text:
+                    // The text protocol sends BIT already decoded to digits.
+                    Plan.Type = Column.Type == MYSQL_TYPE_BIT ? ArrowType::UInt64 : ArrowType::Utf8;
+                    break;
+            }
+            break;
+        }
+    }
+
+    switch (Plan.Type)
+    {
+        case ArrowType::Int64:      Plan.Format = "l"; break;
+        case ArrowType::UInt64:     Plan.Format = "L"; break;
+        case ArrowType::Float64:    Plan.Format = "g"; break;
+        case ArrowType::Date32:     Plan.Format = "tdD"; break;
+        case ArrowType::Timestamp:  Plan.Format = "tsu:"; break;
+        case ArrowType::Duration:   Plan.Format = "tDu"; break;
+        case ArrowType::Decimal128: Plan.Format = "d:" + std::to_string(Plan.Precision) + "," + std::to_string(Plan.Scale); break;
+        case ArrowType::Utf8:       Plan.Format = "u"; break;
+        case ArrowType::Binary:     Plan.Format = "z"; break;
+    }
+    return Plan;
+}
+
+// Assigns ids in order of first appearance. Gives up as soon as the column
+// turns out to have too many distinct values to be worth it.
+static void BuildDictionary(const ResultStore& Store, size_t Column, uint32_t Limit, ArrowColumn& Plan)
+{
+    const auto& Blocks = Store.Blocks();
+    std::unordered_map<std::string_view, int32_t> Ids;
+    std::vector<std::vector<int32_t>> Indices(Blocks.size());
+    uint64_t Seen = 0;
+
+    for (size_t b = 0; b < Blocks.size(); b++)
+    {
+        const ColumnBlock& Values = Blocks[b]->Columns[Column];
+        std::vector<int32_t>& Out = Indices[b];
+        Out.resize(Values.RowCount());
+        for (uint32_t r = 0; r < Values.RowCount(); r++)
+        {
+            CellView Cell = Values.Cell(r);
+            if (Cell.Null)
+                continue;
+            Out[r] = Ids.try_emplace(Cell.Text(), (int32_t)Ids.size()).first->second;
+        }
+        Seen += Values.RowCount();
+        if (Ids.size() > Limit || (Seen >= Limit && Ids.size() * 2 >= Seen))
+            return;
+    }
+    if (Ids.size() * 2 >= Seen)
+        return;
+
+    std::vector<std::string_view> Values(Ids.size());
+    size_t Bytes = 0;
+    for (const auto& [Text, Id] : Ids)
+    {
+        Values[(size_t)Id] = Text;
+        Bytes += Text.size();
+    }
+
+    Plan.DictionaryData.reserve(Bytes);
+    Plan.DictionaryOffsets.reserve(Values.size() + 1);
+    Plan.DictionaryOffsets.push_back(0);
+    for (std::string_view Text : Values)
+    {
+        Plan.DictionaryData.append(Text);
+        Plan.DictionaryOffsets.push_back((int32_t)Plan.DictionaryData.size());
+    }
+    Plan.Indices    = std::move(Indices);
+    Plan.Dictionary = true;
+}
+
+static std::shared_ptr<ArrowPlan> BuildPlan(const ResultStore& Store, const ArrowOptions& Options)
+{
+    auto Plan = std::make_shared<ArrowPlan>();
+    Plan->Store = &Store;
+
+    std::vector<size_t> Candidates;
+    for (size_t c = 0; c < Store.ColumnCount(); c++)
+    {
+        Plan->Columns.push_back(PlanColumn(Store.Columns()[c]));
+        ArrowType Type = Plan->Columns.back().Type;
+        if (Options.DictionaryLimit && Store.Columns()[c].Encoding == ColumnEncoding::Text &&
+            (Type == ArrowType::Utf8 || Type == ArrowType::Binary))
+            Candidates.push_back(c);
+    }
+
+    ThreadPool::Shared().ParallelFor(Candidates.size(), 1, [&](uint64_t Begin, uint64_t End) {
+        for (uint64_t i = Begin; i < End; i++)
+            BuildDictionary(Store, Candidates[i], Options.DictionaryLimit, Plan->Columns[Candidates[i]]);
+    });
+    return Plan;
+}
+
+static void ConvertColumn(const ArrowColumn& Plan, const ColumnBlock& Values, const std::vector<int32_t>* Indices,
+                          ArrowColumnBatch& Out)
+{
+    const uint32_t Rows = Values.RowCount();
+    const size_t ValidityBytes = (Rows + 7) / 8;
+
+    // Null bits are set for NULL; Arrow's validity bits for values.
+    Out.Validity.resize(ValidityBytes);
+    const uint8_t* Nulls = Values.NullData();
+    for (size_t i = 0; i < ValidityBytes; i++)
+        Out.Validity[i] = (uint8_t)~Nulls[i];
+    if (Rows & 7)
+        Out.Validity[ValidityBytes - 1] &= (uint8_t)((1u << (Rows & 7)) - 1);
+
+    // Values that have no Arrow equivalent (zero dates, unparsable text) become NULL.
+    auto Invalidate = [&](uint32_t Row) { Out.Validity[Row >> 3] &= (uint8_t)~(1u << (Row & 7)); };
+
+    auto Convert = [&](size_t Width, auto&& Store) {
+        Out.Values.assign((size_t)Rows * Width, 0);
+        for (uint32_t r = 0; r < Rows; r++)
+        {
+            CellView Cell = Values.Cell(r);
+            if (!Cell.Null && !Store(Cell, Out.Values.data() + (size_t)r * Width))
+                Invalidate(r);
+        }
+        Out.Buffers[1] = ArrowBuffer{ Out.Values.data(), Out.Values.size() };
+    };
+
+    // Text that does not parse packs as a zero date, which converts to null.
+    auto DateTimeOf = [&](const CellView& Cell) {
+        int64_t Packed = 0;
+        if (!Plan.FromText)
+            return Cell.As<int64_t>();
+        ParseDateTime(Cell.Text(), Packed);
+        return Packed;
+    };
+
+    Out.BufferCount = 2;
+    if (Plan.Dictionary)
+    {
+        Out.Buffers[1] = ArrowBuffer{ Indices->data(), (size_t)Rows * 4 };
+    }
+    else switch (Plan.Type)
+    {
+        case ArrowType::Utf8:
+        case ArrowType::Binary:
+            Out.BufferCount = 3;
+            Out.Buffers[1]  = ArrowBuffer{ Values.OffsetData(), ((size_t)Rows + 1) * 4 };
+            Out.Buffers[2]  = ArrowBuffer{ Values.ArenaData(), Values.ArenaSize() };
+            break;
+        case ArrowType::Int64:
+        case ArrowType::UInt64:
+        case ArrowType::Float64:
+        case ArrowType::Duration:
+            if (!Plan.FromText)
+            {
+                Out.Buffers[1] = ArrowBuffer{ Values.ArenaData(), (size_t)Rows * 8 };
+                break;
+            }
+            Convert(8, [&](const CellView& Cell, uint8_t* Slot) {
+                std::string_view Text = Cell.Text();
+                switch (Plan.Type)
+                {
+                    case ArrowType::Int64:
+                    {
+                        int64_t Value = 0;
+                        bool Parsed = ParseInt64(Text, Value);
+                        memcpy(Slot, &Value, 8);
+                        return Parsed;
+                    }
+                    case ArrowType::UInt64:
+                    {
+                        uint64_t Value = 0;
+                        bool Parsed = ParseUInt64(Text, Value);
+                        memcpy(Slot, &Value, 8);
+                        return Parsed;
+                    }
+                    case ArrowType::Float64:
+                    {
+                        double Value = 0.0;
+                        bool Parsed = ParseDouble(Text, Value);
+                        memcpy(Slot, &Value, 8);
+                        return Parsed;
+                    }
+                    default:
+                    {
+                        int64_t Value = 0;
+                        bool Parsed = ParseTime(Text, Value);
+                        memcpy(Slot, &Value, 8);
+                        return Parsed;
+                    }
+                }
+            });
+            break;
+        case ArrowType::Date32:
+            Convert(4, [&](const CellView& Cell, uint8_t* Slot) {
+                unsigned Year, Month, Day, Hour, Minute, Second;
+                unsigned long Microsecond;
+                UnpackDateTime(DateTimeOf(Cell), Year, Month, Day, Hour, Minute, Second, Microsecond);
+                if (Month == 0 || Day == 0)
+                    return false;
+                int32_t Days = DaysFromCivil((int)Year, Month, Day);
+                memcpy(Slot, &Days, 4);
+                return true;
+            });
+            break;
+        case ArrowType::Timestamp:
+            Convert(8, [&](const CellView& Cell, uint8_t* Slot) {
+                unsigned Year, Month, Day, Hour, Minute, Second;
+                unsigned long Microsecond;
+                UnpackDateTime(DateTimeOf(Cell), Year, Month, Day, Hour, Minute, Second, Microsecond);
+                if (Month == 0 || Day == 0)
+                    return false;
+                int64_t Micros = (int64_t)DaysFromCivil((int)Year, Month, Day) * 86400000000ll +
+                                 (int64_t)((Hour * 60 + Minute) * 60 + Second) * 1000000 + (int64_t)Microsecond;
+                memcpy(Slot, &Micros, 8);
+                return true;
+            });
+            break;
+        case ArrowType::Decimal128:
+            Convert(16, [&](const CellView& Cell, uint8_t* Slot) {
+                __int128 Value = 0;
+                if (!ParseDecimal(Cell.Text(), Plan.Scale, Value))
+                    return false;
+                memcpy(Slot, &Value, 16);
+                return true;
+            });
+            break;
+    }
+
+    size_t Valid = 0;
+    for (uint8_t Byte : Out.Validity)
+        Valid += (size_t)std::popcount(Byte);
+    Out.NullCount  = (int64_t)(Rows - Valid);
+    Out.Buffers[0] = Out.NullCount ? ArrowBuffer{ Out.Validity.data(), ValidityBytes } : ArrowBuffer{};
+}
+
+static void ConvertBlock(const ArrowPlan& Plan, size_t BlockIndex, ArrowBatch& Batch)
+{
+    Batch.Block = Plan.Store->Blocks()[BlockIndex];
+    Batch.Columns.resize(Plan.Columns.size());
+    for (size_t c = 0; c < Plan.Columns.size(); c++)
+    {
+        const ArrowColumn& Column = Plan.Columns[c];
+        ConvertColumn(Column, Batch.Block->Columns[c], Column.Dictionary ? &Column.Indices[BlockIndex] : nullptr, Batch.Columns[c]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// IPC
+
+static uint32_t BuildSchema(FlatBuilder& Builder, const ArrowPlan& Plan)
+{
+    const std::vector<ColumnInfo>& Infos = Plan.Store->Columns();
+    std::vector<uint32_t> Fields;
+
+    for (size_t c = 0; c < Plan.Columns.size(); c++)
+    {
+        const ArrowColumn& Column = Plan.Columns[c];
+        uint32_t Name = Builder.String(Infos[c].Name);
+
+        uint8_t TypeType = 0;
+        Builder.StartTable();
+        switch (Column.Type)
+        {
+            case ArrowType::Int64:
+            case ArrowType::UInt64:
+                Builder.AddScalar<int32_t>(0, 64);
+                Builder.AddScalar<uint8_t>(1, Column.Type == ArrowType::Int64);
+                TypeType = TypeInt;
+                break;
+            case ArrowType::Float64:
+                Builder.AddScalar<int16_t>(0, 2);
+                TypeType = TypeFloatingPoint;
+                break;
+            case ArrowType::Date32:
+                Builder.AddScalar<int16_t>(0, 0);
+                TypeType = TypeDate;
+                break;
+            case ArrowType::Timestamp:
+                Builder.AddScalar<int16_t>(0, UnitMicrosecond);
+                TypeType = TypeTimestamp;
+                break;
+            case ArrowType::Duration:
+                Builder.AddScalar<int16_t>(0, UnitMicrosecond);
+                TypeType = TypeDuration;
+                break;
+            case ArrowType::Decimal128:
+                Builder.AddScalar<int32_t>(0, Column.Precision);
+                Builder.AddScalar<int32_t>(1, Column.Scale);
+                Builder.AddScalar<int32_t>(2, 128);
+                TypeType = TypeDecimal;
+                break;
+            case ArrowType::Utf8:
+                TypeType = TypeUtf8;
+                break;
+            case ArrowType::Binary:
+                TypeType = TypeBinary;
+                break;
+        }
+        uint32_t Type = Builder.EndTable();
+
+        uint32_t Dictionary = 0;
+        if (Column.Dictionary)
+        {
+            Builder.StartTable();
+            Builder.AddScalar<int32_t>(0, 32);
+            Builder.AddScalar<uint8_t>(1, 1);
+            uint32_t IndexType = Builder.EndTable();
+
+            Builder.StartTable();
+            Builder.AddScalar<int64_t>(0, (int64_t)c);
+            Builder.AddOffset(1, IndexType);
+            Dictionary = Builder.EndTable();
+        }
+
+        uint32_t Children = Builder.OffsetVector({});
+
+        Builder.StartTable();
+        Builder.AddOffset(0, Name);
+        Builder.AddScalar<uint8_t>(1, 1);
+        Builder.AddScalar<uint8_t>(2, TypeType);
+        Builder.AddOffset(3, Type);
+        if (Dictionary)
+            Builder.AddOffset(4, Dictionary);
+        Builder.AddOffset(5, Children);
+        Fields.push_back(Builder.EndTable());
+    }
+
+    uint32_t FieldVector = Builder.OffsetVector(Fields);
+    Builder.StartTable();
+    Builder.AddScalar<int16_t>(0, 0);     // little endian
+    Builder.AddOffset(1, FieldVector);
+    return Builder.EndTable();
+}
+
+static uint32_t BuildRecordBatch(FlatBuilder& Builder, int64_t Length, const std::vector<FieldNode>& Nodes,
+                                 const std::vector<BufferSpec>& Buffers)
+{
+    uint32_t NodeVector = Builder.StructVector(Nodes.data(), sizeof(FieldNode), Nodes.size());
+    uint32_t BufferVector = Builder.StructVector(Buffers.data(), sizeof(BufferSpec), Buffers.size());
+    Builder.StartTable();
+    Builder.AddScalar<int64_t>(0, Length);
+    Builder.AddOffset(1, NodeVector);
+    Builder.AddOffset(2, BufferVector);
+    return Builder.EndTable();
+}
+
+static std::vector<uint8_t> FinishMessage(FlatBuilder& Builder, uint8_t HeaderType, uint32_t Header, int64_t BodyLength)
+{
+    Builder.StartTable();
+    Builder.AddScalar<int64_t>(3, BodyLength);
+    Builder.AddOffset(2, Header);
+    Builder.AddScalar<int16_t>(0, MetadataVersionV5);
+    Builder.AddScalar<uint8_t>(1, HeaderType);
+    return Builder.Finish(Builder.EndTable());
+}
+
+// Body buffers are laid out back to back, each padded to 8 bytes.
+static int64_t LayoutBody(const std::vector<ArrowBuffer>& Body, std::vector<BufferSpec>& Specs)
+{
+    int64_t Offset = 0;
+    for (const ArrowBuffer& Buffer : Body)
+    {
+        Specs.push_back(BufferSpec{ Offset, (int64_t)Buffer.Length });
+        Offset += (int64_t)Pad8(Buffer.Length);
+    }
+    return Offset;
+}
+
+namespace
+{
+    // Encapsulated messages go through a staging buffer so metadata and
+    // small buffers do not turn into tiny writes; large buffers bypass it.
+    class IpcWriter
+    {
+    public:
+        explicit IpcWriter(ExportProgress* Progress) : Progress(Progress) { Staging.reserve(ResultExporter::WriteBufferSize); }
+        ~IpcWriter() {
+            if (Descriptor >= 0)
+                close(Descriptor);
+        }
+
+        bool Open(const std::string& Path, std::string* Error) {
+            Descriptor = open(Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (Descriptor < 0)
+                return Fail("Cannot create " + Path, Error);
+            this->Path = Path;
+            return true;
+        }
+
+        bool Append(const void* Data, size_t Length, std::string* Error) {
+            Position += Length;
+            if (Staging.size() + Length > ResultExporter::WriteBufferSize && !Flush(Error))
+                return false;
+            if (Length >= ResultExporter::WriteBufferSize)
+                return WriteAll(static_cast<const char*>(Data), Length, Error);
+            Staging.append(static_cast<const char*>(Data), Length);
+            return true;
+        }
+
+        bool Message(const std::vector<uint8_t>& Metadata, const std::vector<ArrowBuffer>& Body, int64_t BodyLength,
+                     FileBlock* Block, std::string* Error) {
+            const uint32_t Continuation = 0xFFFFFFFF;
+            const int32_t MetadataLength = (int32_t)Pad8(Metadata.size());
+            if (Block)
+                *Block = FileBlock{ (int64_t)Position, MetadataLength + 8, 0, BodyLength };
+
+            if (!Append(&Continuation, 4, Error) || !Append(&MetadataLength, 4, Error) ||
+                !Append(Metadata.data(), Metadata.size(), Error) ||
+                !Append(EmptyBuffer, (size_t)MetadataLength - Metadata.size(), Error))
+                return false;
+
+            for (const ArrowBuffer& Buffer : Body)
+            {
+                if (!Append(Buffer.Data ? Buffer.Data : EmptyBuffer, Buffer.Length, Error) ||
+                    !Append(EmptyBuffer, Pad8(Buffer.Length) - Buffer.Length, Error))
+                    return false;
+            }
+            return true;
+        }
+
+        bool Close(std::string* Error) {
+            if (!Flush(Error))
+                return false;
+            int Result = close(Descriptor);
+            Descriptor = -1;
+            if (Result != 0)
+                return Fail("Cannot write " + Path, Error);
+            return true;
+        }
+
+        uint64_t Offset() const { return Position; }
+
+    private:
+        bool Fail(const std::string& What, std::string* Error) {
+            if (Error)
+                *Error = What + ": " + strerror(errno);
+            return false;
+        }
+
+        bool Flush(std::string* Error) {
+            bool Written = WriteAll(Staging.data(), Staging.size(), Error);
+            Staging.clear();
+            return Written;
+        }
+
+        bool WriteAll(const char* Data, size_t Length, std::string* Error) {
+            while (Length > 0)
+            {
+                ssize_t Written = write(Descriptor, Data, Length);
+                if (Written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return Fail("Cannot write " + Path, Error);
+                }
+                Data   += Written;
+                Length -= (size_t)Written;
+                if (Progress)
+                    Progress->Bytes.fetch_add((uint64_t)Written, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        ExportProgress* Progress;
+        int             Descriptor = -1;
+        std::string     Path;
+        std::string     Staging;
+        uint64_t        Position = 0;
+    };
+}
+
+static bool WriteIpcMessages(IpcWriter& Writer, const ArrowPlan& Plan, bool File, ExportProgress* Progress,
+                             const CancelToken* Cancel, std::string* Error)
+{
+    static const char Magic[8] = { 'A', 'R', 'R', 'O', 'W', '1', 0, 0 };
+    if (File && !Writer.Append(Magic, sizeof(Magic), Error))
+        return false;
+
+    {
+        FlatBuilder Builder;
+        uint32_t Schema = BuildSchema(Builder, Plan);
+        if (!Writer.Message(FinishMessage(Builder, HeaderSchema, Schema, 0), {}, 0, nullptr, Error))
+            return false;
+    }
+
+    std::vector<FileBlock> Dictionaries;
+    for (size_t c = 0; c < Plan.Columns.size(); c++)
+    {
+        const ArrowColumn& Column = Plan.Columns[c];
+        if (!Column.Dictionary)
+            continue;
+
+        const int64_t Length = (int64_t)Column.DictionaryOffsets.size() - 1;
+        std::vector<ArrowBuffer> Body = {
+            ArrowBuffer{},
+            ArrowBuffer{ Column.DictionaryOffsets.data(), Column.DictionaryOffsets.size() * 4 },
+            ArrowBuffer{ Column.DictionaryData.data(), Column.DictionaryData.size() },
+        };
+        std::vector<BufferSpec> Specs;
+        int64_t BodyLength = LayoutBody(Body, Specs);
+
+        FlatBuilder Builder;
+        uint32_t Data = BuildRecordBatch(Builder, Length, { FieldNode{ Length, 0 } }, Specs);
+        Builder.StartTable();
+        Builder.AddScalar<int64_t>(0, (int64_t)c);
+        Builder.AddOffset(1, Data);
+        uint32_t Batch = Builder.EndTable();
+
+        Dictionaries.emplace_back();
+        if (!Writer.Message(FinishMessage(Builder, HeaderDictionaryBatch, Batch, BodyLength), Body, BodyLength, &Dictionaries.back(), Error))
+            return false;
+    }
+
+    std::vector<FileBlock> Batches;
+    for (size_t b = 0; b < Plan.Store->Blocks().size(); b++)
+    {
+        if (IsCancelled(Cancel))
+        {
+            if (Error)
+                *Error = "Export cancelled";
+            return false;
+        }
+
+        ArrowBatch Batch;
+        ConvertBlock(Plan, b, Batch);
+
+        std::vector<FieldNode> Nodes;
+        std::vector<ArrowBuffer> Body;
+        for (const ArrowColumnBatch& Column : Batch.Columns)
+        {
+            Nodes.push_back(FieldNode{ Batch.Block->RowCount, Column.NullCount });
+            Body.insert(Body.end(), Column.Buffers, Column.Buffers + Column.BufferCount);
+        }
+        std::vector<BufferSpec> Specs;
+        int64_t BodyLength = LayoutBody(Body, Specs);
+
+        FlatBuilder Builder;
+        uint32_t Header = BuildRecordBatch(Builder, Batch.Block->RowCount, Nodes, Specs);
+        Batches.emplace_back();
+        if (!Writer.Message(FinishMessage(Builder, HeaderRecordBatch, Header, BodyLength), Body, BodyLength, &Batches.back(), Error))
+            return false;
+        if (Progress)
+            Progress->Rows.fetch_add(Batch.Block->RowCount, std::memory_order_relaxed);
+    }
+
+    const uint32_t EndOfStream[2] = { 0xFFFFFFFF, 0 };
+    if (!Writer.Append(EndOfStream, sizeof(EndOfStream), Error))
+        return false;
+    if (!File)
+        return true;
+
+    FlatBuilder Builder;
+    uint32_t Schema = BuildSchema(Builder, Plan);
+    uint32_t DictionaryVector = Builder.StructVector(Dictionaries.data(), sizeof(FileBlock), Dictionaries.size());
+    uint32_t BatchVector = Builder.StructVector(Batches.data(), sizeof(FileBlock), Batches.size());
+    Builder.StartTable();
+    Builder.AddOffset(1, Schema);
+    Builder.AddOffset(2, DictionaryVector);
+    Builder.AddOffset(3, BatchVector);
+    Builder.AddScalar<int16_t>(0, MetadataVersionV5);
+    std::vector<uint8_t> Footer = Builder.Finish(Builder.EndTable());
+
+    int32_t FooterLength = (int32_t)Footer.size();
+    return Writer.Append(Footer.data(), Footer.size(), Error) &&
+           Writer.Append(&FooterLength, 4, Error) &&
+           Writer.Append(Magic, 6, Error);
+}
+
+bool ArrowExporter::WriteIpc(const ResultStore& Store, const std::string& Path, const ArrowOptions& Options,
+                             ExportProgress* Progress, const CancelToken* Cancel, std::string* Error)
+{
+    if (Store.PartialCells())
+    {
+        if (Error)
+            *Error = "The result holds BLOB/TEXT values that were only partly fetched; export the query instead";
+        return false;
+    }
+
+    std::shared_ptr<ArrowPlan> Plan = BuildPlan(Store, Options);
+
+    IpcWriter Writer(Progress);
+    if (!Writer.Open(Path, Error))
+        return false;
+    if (!WriteIpcMessages(Writer, *Plan, Options.Layout == ArrowLayout::File, Progress, Cancel, Error) || !Writer.Close(Error))
+    {
+        unlink(Path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string ArrowExporter::FileExtension(const ArrowOptions& Options)
+{
+    return Options.Layout == ArrowLayout::File ? ".arrow" : ".arrows";
+}
+
+// ---------------------------------------------------------------------------
+// C data interface. Every struct handed out owns a reference to the holder
+// it points into, so a consumer may move children out and release them in
+// any order, as the spec allows.
+
+static void ReleaseSchema(ArrowSchema* Schema)
+{
+    for (int64_t i = 0; i < Schema->n_children; i++)
+    {
+        if (Schema->children[i]->release)
+            Schema->children[i]->release(Schema->children[i]);
+    }
+    if (Schema->dictionary && Schema->dictionary->release)
+        Schema->dictionary->release(Schema->dictionary);
+    delete static_cast<std::shared_ptr<SchemaHolder>*>(Schema->private_data);
+    Schema->release = nullptr;
+}
+
+static void ReleaseArray(ArrowArray* Array)
+{
+    for (int64_t i = 0; i < Array->n_children; i++)
+    {
+        if (Array->children[i]->release)
+            Array->children[i]->release(Array->children[i]);
+    }
+    if (Array->dictionary && Array->dictionary->release)
+        Array->dictionary->release(Array->dictionary);
+    delete static_cast<std::shared_ptr<ArrowBatch>*>(Array->private_data);
+    Array->release = nullptr;
+}
+
+static void ExportSchema(const ArrowPlan& Plan, ArrowSchema* Out)
+{
+    const size_t Count = Plan.Columns.size();
+    auto Holder = std::make_shared<SchemaHolder>();
+    Holder->Formats.resize(Count);
+    Holder->Names.resize(Count);
+    Holder->Children.resize(Count);
+    Holder->ChildPointers.resize(Count);
+    Holder->Dictionaries.resize(Count);
+
+    for (size_t c = 0; c < Count; c++)
+    {
+        const ArrowColumn& Column = Plan.Columns[c];
+        Holder->Formats[c] = Column.Dictionary ? "i" : Column.Format;
+        Holder->Names[c]   = Plan.Store->Columns()[c].Name;
+
+        ArrowSchema& Child = Holder->Children[c];
+        Child = ArrowSchema{};
+        Child.format       = Holder->Formats[c].c_str();
+        Child.name         = Holder->Names[c].c_str();
+        Child.flags        = ARROW_FLAG_NULLABLE;
+        Child.release      = ReleaseSchema;
+        Child.private_data = new std::shared_ptr<SchemaHolder>(Holder);
+        if (Column.Dictionary)
+        {
+            ArrowSchema& Values = Holder->Dictionaries[c];
+            Values = ArrowSchema{};
+            Values.format       = Column.Format.c_str();
+            Values.release      = ReleaseSchema;
+            Values.private_data = new std::shared_ptr<SchemaHolder>(Holder);
+            Child.dictionary    = &Values;
+        }
+        Holder->ChildPointers[c] = &Child;
+    }
+
+    *Out = ArrowSchema{};
+    Out->format       = "+s";
+    Out->name         = "";
+    Out->n_children   = (int64_t)Count;
+    Out->children     = Holder->ChildPointers.data();
+    Out->release      = ReleaseSchema;
+    Out->private_data = new std::shared_ptr<SchemaHolder>(std::move(Holder));
+}
+
+static void ExportBatch(const std::shared_ptr<const ArrowPlan>& Plan, size_t BlockIndex, ArrowArray* Out)
+{
+    const size_t Count = Plan->Columns.size();
+    auto Batch = std::make_shared<ArrowBatch>();
+    Batch->Plan = Plan;
+    ConvertBlock(*Plan, BlockIndex, *Batch);
+
+    const int64_t Rows = Batch->Block->RowCount;
+    Batch->BufferPointers.resize(Count * 3);
+    Batch->DictionaryPointers.resize(Count * 3);
+    Batch->Children.resize(Count);
+    Batch->ChildPointers.resize(Count);
+    Batch->Dictionaries.resize(Count);
+
+    for (size_t c = 0; c < Count; c++)
+    {
+        const ArrowColumn& Column = Plan->Columns[c];
+        const ArrowColumnBatch& Values = Batch->Columns[c];
+
+        // Only the validity bitmap may be missing; empty buffers still need an address.
+        const void** Buffers = &Batch->BufferPointers[c * 3];
+        Buffers[0] = Values.Buffers[0].Data;
+        for (int i = 1; i < Values.BufferCount; i++)
+            Buffers[i] = Values.Buffers[i].Data ? Values.Buffers[i].Data : EmptyBuffer;
+
+        ArrowArray& Child = Batch->Children[c];
+        Child = ArrowArray{};
+        Child.length       = Rows;
+        Child.null_count   = Values.NullCount;
+        Child.n_buffers    = Values.BufferCount;
+        Child.buffers      = Buffers;
+        Child.release      = ReleaseArray;
+        Child.private_data = new std::shared_ptr<ArrowBatch>(Batch);
+
+        if (Column.Dictionary)
+        {
+            const void** DictionaryBuffers = &Batch->DictionaryPointers[c * 3];
+            DictionaryBuffers[1] = Column.DictionaryOffsets.data();
+            DictionaryBuffers[2] = Column.DictionaryData.empty() ? EmptyBuffer : (const void*)Column.DictionaryData.data();
+
+            ArrowArray& Dictionary = Batch->Dictionaries[c];
+            Dictionary = ArrowArray{};
+            Dictionary.length       = (int64_t)Column.DictionaryOffsets.size() - 1;
+            Dictionary.n_buffers    = 3;
+            Dictionary.buffers      = DictionaryBuffers;
+            Dictionary.release      = ReleaseArray;
+            Dictionary.private_data = new std::shared_ptr<ArrowBatch>(Batch);
+            Child.dictionary        = &Dictionary;
+        }
+        Batch->ChildPointers[c] = &Child;
+    }
+
+    *Out = ArrowArray{};
+    Out->length       = Rows;
+    Out->n_buffers    = 1;
+    Out->buffers      = Batch->StructBuffers;
+    Out->n_children   = (int64_t)Count;
+    Out->children     = Batch->ChildPointers.data();
+    Out->release      = ReleaseArray;
+    Out->private_data = new std::shared_ptr<ArrowBatch>(std::move(Batch));
+}
+
+static int StreamGetSchema(ArrowArrayStream* Stream, ArrowSchema* Out)
+{
+    ExportSchema(*static_cast<StreamState*>(Stream->private_data)->Plan, Out);
+    return 0;
+}
+
+static int StreamGetNext(ArrowArrayStream* Stream, ArrowArray* Out)
+{
+    StreamState* State = static_cast<StreamState*>(Stream->private_data);
+    if (State->NextBlock >= State->Plan->Store->Blocks().size())
+    {
+        // End of stream is a released array.
+        *Out = ArrowArray{};
+        return 0;
+    }
+    ExportBatch(State->Plan, State->NextBlock++, Out);
+    return 0;
+}
+
+static const char* StreamGetLastError(ArrowArrayStream*)
+{
+    return nullptr;
+}
+
+static void StreamRelease(ArrowArrayStream* Stream)
+{
+    delete static_cast<StreamState*>(Stream->private_data);
+    Stream->release = nullptr;
+}
+
+bool ArrowExporter::ExportStream(std::shared_ptr<const ResultStore> Store, const ArrowOptions& Options,
+                                 ArrowArrayStream* Out, std::string* Error)
+{
+    if (!Store || !Out)
+    {
+        if (Error)
+            *Error = "Nothing to export";
+        return false;
+    }
+    if (Store->PartialCells())
+    {
+        if (Error)
+            *Error = "The result holds BLOB/TEXT values that were only partly fetched; export the query instead";
+        return false;
+    }
+
+    std::shared_ptr<ArrowPlan> Plan = BuildPlan(*Store, Options);
+    Plan->Owner = std::move(Store);
+
+    auto State = new StreamState;
+    State->Plan = std::move(Plan);
+
+    *Out = ArrowArrayStream{};
+    Out->get_schema     = StreamGetSchema;
+    Out->get_next       = StreamGetNext;
+    Out->get_last_error = StreamGetLastError;
+    Out->release        = StreamRelease;
+    Out->private_data   = State;
+    return true;
+}
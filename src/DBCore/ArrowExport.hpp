@@ -0,0 +1,112 @@
+//
+//  ArrowExport.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+#include "ResultExport.hpp"
+#include "CancelToken.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Arrow C data and C stream interfaces, ABI as published by the Arrow
+// project. The guards let an embedding application include Arrow's own
+// abi.h first.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C"
+{
+    struct ArrowSchema
+    {
+        const char*          format;
+        const char*          name;
+        const char*          metadata;
+        int64_t              flags;
+        int64_t              n_children;
+        struct ArrowSchema** children;
+        struct ArrowSchema*  dictionary;
+        void (*release)(struct ArrowSchema*);
+        void*                private_data;
+    };
+
+    struct ArrowArray
+    {
+        int64_t             length;
+        int64_t             null_count;
+        int64_t             offset;
+        int64_t             n_buffers;
+        int64_t             n_children;
+        const void**        buffers;
+        struct ArrowArray** children;
+        struct ArrowArray*  dictionary;
+        void (*release)(struct ArrowArray*);
+        void*               private_data;
+    };
+}
+
+#endif
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+extern "C"
+{
+    struct ArrowArrayStream
+    {
+        int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+        int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+        const char* (*get_last_error)(struct ArrowArrayStream*);
+        void (*release)(struct ArrowArrayStream*);
+        void* private_data;
+    };
+}
+
+#endif
+
+namespace DBCore
+{
+    enum class ArrowLayout : uint8_t
+    {
+        Stream,     // IPC streaming format (.arrows)
+        File,       // IPC file format with footer (.arrow)
+    };
+
+    struct ArrowOptions
+    {
+        ArrowLayout Layout = ArrowLayout::Stream;
+        // Text columns with at most this many distinct values, and fewer than
+        // half as many as rows, are dictionary-encoded. 0 turns it off.
+        uint32_t    DictionaryLimit = 1u << 16;
+    };
+
+    // Result stores as Arrow record batches, one per result block. Integer,
+    // floating point, TIME and text columns are handed out in place: Arrow's
+    // layouts match the block arenas, so only validity bitmaps (which have
+    // the opposite polarity of the null bits), dates, decimals and columns
+    // fetched over the text protocol are converted. Types come from the
+    // MYSQL_FIELD data kept in ColumnInfo.
+    class ArrowExporter
+    {
+    public:
+        static bool WriteIpc(const ResultStore& Store, const std::string& Path, const ArrowOptions& Options,
+                             ExportProgress* Progress, const CancelToken* Cancel, std::string* Error);
+
+        // Zero-copy handoff through the C stream interface. The stream and
+        // every array it yields keep the store alive until released.
+        static bool ExportStream(std::shared_ptr<const ResultStore> Store, const ArrowOptions& Options,
+                                 ArrowArrayStream* Out, std::string* Error);
+
+        static std::string FileExtension(const ArrowOptions& Options);
+    };
+}
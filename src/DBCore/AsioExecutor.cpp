@@ -0,0 +1,109 @@
+//
+//  AsioExecutor.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "AsioExecutor.hpp"
+
+#include <boost/asio/post.hpp>
+
+using namespace DBCore;
+
+AsioExecutor::~AsioExecutor()
+{
+    // Completions still queued on the context see Finished and do nothing.
+    for (auto& [Socket, Entry] : Waits)
+        Release(*Entry);
+}
+
+void AsioExecutor::Post(Task Work)
+{
+    boost::asio::post(Context, std::move(Work));
+}
+
+void AsioExecutor::Wait(my_socket Socket, int Status, unsigned TimeoutMs, WaitHandler Handler)
+{
+    Forget(Socket);
+
+    auto Entry = std::make_shared<SocketWait>(Context);
+    Entry->Handler = std::move(Handler);
+    const int Events = Status & (MYSQL_WAIT_READ | MYSQL_WAIT_WRITE | MYSQL_WAIT_EXCEPT);
+
+    boost::system::error_code Failed;
+    if (Events)
+        Entry->Descriptor.assign(Socket, Failed);
+    if (Failed)
+    {
+        // Let the _cont call run into the socket's error itself.
+        Post([Work = std::move(Entry->Handler), Events]() { Work(Events); });
+        return;
+    }
+    Waits[Socket] = Entry;
+
+    using Descriptor = boost::asio::posix::stream_descriptor;
+    auto Arm = [this, &Entry, Socket, Events](Descriptor::wait_type Type, int Event) {
+        Entry->Descriptor.async_wait(Type, [this, Entry, Socket, Events, Event](const boost::system::error_code& Error) {
+            // An error on the socket wakes whatever was waited for; the _cont call reports it.
+            if (Error != boost::asio::error::operation_aborted)
+                Fire(Entry, Socket, Error ? Events : Event);
+        });
+    };
+    if (Events & MYSQL_WAIT_READ)
+        Arm(Descriptor::wait_read, MYSQL_WAIT_READ);
+    if (Events & MYSQL_WAIT_WRITE)
+        Arm(Descriptor::wait_write, MYSQL_WAIT_WRITE);
+    if (Events & MYSQL_WAIT_EXCEPT)
+        Arm(Descriptor::wait_error, MYSQL_WAIT_EXCEPT);
+
+    if (Status & MYSQL_WAIT_TIMEOUT)
+    {
+        Entry->Deadline.expires_after(std::chrono::milliseconds(TimeoutMs));
+        Entry->Deadline.async_wait([this, Entry, Socket](const boost::system::error_code& Error) {
+            if (!Error)
+                Fire(Entry, Socket, MYSQL_WAIT_TIMEOUT);
+        });
+    }
+}
+
+void AsioExecutor::Forget(my_socket Socket)
+{
+    auto It = Waits.find(Socket);
+    if (It == Waits.end())
+        return;
+    Release(*It->second);
+    Waits.erase(It);
+}
+
+void AsioExecutor::After(std::chrono::milliseconds Delay, Task Work)
+{
+    auto Timer = std::make_shared<boost::asio::steady_timer>(Context, Delay);
+    Timer->async_wait([Timer, Work = std::move(Work)](const boost::system::error_code& Error) {
+        if (!Error)
+            Work();
+    });
+}
+
+void AsioExecutor::Fire(const std::shared_ptr<SocketWait>& Entry, my_socket Socket, int Ready)
+{
+    // Both directions and the deadline can complete in the same turn.
+    if (Entry->Finished)
+        return;
+    WaitHandler Handler = std::move(Entry->Handler);
+    Release(*Entry);
+    Waits.erase(Socket);
+    Handler(Ready);
+}
+
+void AsioExecutor::Release(SocketWait& Entry)
+{
+    Entry.Finished = true;
+    Entry.Deadline.cancel();
+    if (!Entry.Descriptor.is_open())
+        return;
+    // Deregisters and aborts the other waits, but leaves the socket open.
+    boost::system::error_code Ignored;
+    Entry.Descriptor.cancel(Ignored);
+    Entry.Descriptor.release();
+}
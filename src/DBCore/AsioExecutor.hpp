@@ -0,0 +1,59 @@
+//
+//  AsioExecutor.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "AsyncExecutor.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <memory>
+#include <unordered_map>
+
+namespace DBCore
+{
+    // AsyncExecutor on a Boost.Asio io_context, for code that already runs
+    // one; the thread calling Context.run() is the executor's thread. A wait
+    // borrows the socket as a stream_descriptor and hands it back without
+    // closing it, since libmariadb owns the socket and may replace it while
+    // it connects.
+    class AsioExecutor final : public AsyncExecutor
+    {
+    public:
+        explicit AsioExecutor(boost::asio::io_context& Context) : Context(Context) {}
+        ~AsioExecutor() override;
+
+        AsioExecutor(const AsioExecutor&) = delete;
+        AsioExecutor& operator=(const AsioExecutor&) = delete;
+
+        boost::asio::io_context& IoContext() { return Context; }
+
+        void Post(Task Work) override;
+        void Wait(my_socket Socket, int Status, unsigned TimeoutMs, WaitHandler Handler) override;
+        void Forget(my_socket Socket) override;
+        void After(std::chrono::milliseconds Delay, Task Work) override;
+
+    private:
+        struct SocketWait
+        {
+            explicit SocketWait(boost::asio::io_context& Context) : Descriptor(Context), Deadline(Context) {}
+
+            boost::asio::posix::stream_descriptor Descriptor;
+            boost::asio::steady_timer             Deadline;
+            WaitHandler                           Handler;
+            bool                                  Finished = false;   // the first completion wins
+        };
+
+        void Fire(const std::shared_ptr<SocketWait>& Entry, my_socket Socket, int Ready);
+        static void Release(SocketWait& Entry);
+
+        boost::asio::io_context& Context;
+        std::unordered_map<my_socket, std::shared_ptr<SocketWait>> Waits;
+    };
+}
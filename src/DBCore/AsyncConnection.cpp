@@ -0,0 +1,447 @@
+//
+//  AsyncConnection.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "AsyncConnection.hpp"
+
+#include <algorithm>
+
+using namespace DBCore;
+
+using Clock = std::chrono::steady_clock;
+
+// How often a suspended call looks at its CancelToken.
+static constexpr std::chrono::milliseconds CancelPollInterval(100);
+
+static std::string LastError(MYSQL* Mysql)
+{
+    const char* Message = mysql_error(Mysql);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_errno(Mysql)) + ")";
+}
+
+AsyncConnection::AsyncConnection(AsyncExecutor& Executor, AsyncClientOptions Options)
+    : Executor(Executor), Options(Options)
+{
+}
+
+AsyncConnection::~AsyncConnection()
+{
+    CloseNow();
+}
+
+AsyncOperation AsyncConnection::NewOperation(AsyncOperation::Kind Type, std::string* Error)
+{
+    AsyncOperation Op;
+    Op.Owner = this;
+    Op.Type  = Type;
+    Op.Error = Error;
+    return Op;
+}
+
+AsyncCall<bool> AsyncConnection::Connect(const ConnectionEndpoint& Endpoint, std::string* Error)
+{
+    AsyncOperation Op = NewOperation(AsyncOperation::Kind::Connect, Error);
+    Op.Endpoint = &Endpoint;
+    return AsyncCall<bool>(Op);
+}
+
+AsyncCall<bool> AsyncConnection::Query(std::string_view Sql, std::string* Error)
+{
+    AsyncOperation Op = NewOperation(AsyncOperation::Kind::Query, Error);
+    Op.Sql = Sql;
+    return AsyncCall<bool>(Op);
+}
+
+AsyncCall<bool> AsyncConnection::FetchBatch(ResultStoreBuilder& Into, uint32_t MaxRows, std::string* Error)
+{
+    AsyncOperation Op = NewOperation(AsyncOperation::Kind::Fetch, Error);
+    Op.Into    = &Into;
+    Op.MaxRows = MaxRows;
+    return AsyncCall<bool>(Op);
+}
+
+AsyncCall<bool> AsyncConnection::NextResult(std::string* Error)
+{
+    return AsyncCall<bool>(NewOperation(AsyncOperation::Kind::NextResult, Error));
+}
+
+AsyncCall<void> AsyncConnection::Close()
+{
+    return AsyncCall<void>(NewOperation(AsyncOperation::Kind::Close, nullptr));
+}
+
+bool AsyncConnection::Start(AsyncOperation& Op)
+{
+    Op.Serial = ++Serial;
+    if (Options.OperationTimeout.count() > 0)
+        Op.Deadline = Clock::now() + Options.OperationTimeout;
+
+    if (Op.Type != AsyncOperation::Kind::Close && IsCancelled(Cancel.get()))
+        Op.Status = Fail(Op, "Cancelled");
+    else
+        Op.Status = Begin(Op);
+    return Op.Status == 0;
+}
+
+int AsyncConnection::Begin(AsyncOperation& Op)
+{
+    using Kind = AsyncOperation::Kind;
+
+    if (Op.Type == Kind::Connect)
+    {
+        if (Mysql)
+            return Fail(Op, "Already connected");
+        Mysql = mysql_init(nullptr);
+        if (!Mysql)
+            return Fail(Op, "Out of memory");
+
+        ApplyConnectionOptions(Mysql);
+        unsigned ConnectTimeout = Options.ConnectTimeout;
+        unsigned ReadTimeout = Options.ReadTimeout;
+        mysql_options(Mysql, MYSQL_OPT_NONBLOCK, nullptr);
+        mysql_options(Mysql, MYSQL_OPT_CONNECT_TIMEOUT, &ConnectTimeout);
+        mysql_options(Mysql, MYSQL_OPT_READ_TIMEOUT, &ReadTimeout);
+        mysql_options(Mysql, MYSQL_OPT_WRITE_TIMEOUT, &ReadTimeout);
+        Opening = true;
+
+        const ConnectionEndpoint& Target = *Op.Endpoint;
+        MYSQL* Connected = nullptr;
+        return EndConnect(Op, mysql_real_connect_start(&Connected, Mysql, Target.Host.c_str(), Target.User.c_str(),
+                                                       Target.Password.c_str(), Target.Database.empty() ? nullptr : Target.Database.c_str(),
+                                                       Target.Port ? Target.Port : 3306, nullptr, ConnectionFlags));
+    }
+
+    if (Op.Type == Kind::Close)
+    {
+        Op.Succeeded = true;
+        if (!Mysql)
+            return 0;
+        // Nothing worth a goodbye: shut the socket and let go.
+        if (Opening || BrokenFlag || Rows)
+        {
+            CloseNow();
+            return 0;
+        }
+        Executor.Forget(mysql_get_socket(Mysql));
+        int Status = mysql_close_start(Mysql);
+        if (Status == 0)
+            Mysql = nullptr;
+        return Status;
+    }
+
+    if (!Connected())
+        return Fail(Op, "Not connected");
+    if (BrokenFlag)
+        return Fail(Op, "The connection was cancelled or lost; close it");
+
+    switch (Op.Type)
+    {
+        case Kind::Query:
+        {
+            if (Rows)
+                return Fail(Op, "The current result still has rows to fetch");
+            ResultStarted = Clock::now();
+            int Failed = 0;
+            int Status = mysql_real_query_start(&Failed, Mysql, Op.Sql.data(), (unsigned long)Op.Sql.size());
+            return Status ? Status : EndQuery(Op, Failed);
+        }
+
+        case Kind::Fetch:
+        {
+            Op.Succeeded = true;
+            if (!Rows)
+                return 0;
+            MYSQL_ROW Row = nullptr;
+            int Status = mysql_fetch_row_start(&Row, Rows);
+            return FetchRows(Op, Row, Status);
+        }
+
+        case Kind::NextResult:
+            if (Rows)
+            {
+                // Reads the unfetched rows off the wire.
+                Op.Step = AsyncOperation::Stage::Freeing;
+                return FreeResult(Op, mysql_free_result_start(Rows));
+            }
+            return StartNext(Op);
+
+        case Kind::Connect:
+        case Kind::Close:
+            break;
+    }
+    return 0;
+}
+
+int AsyncConnection::Continue(AsyncOperation& Op, int Ready)
+{
+    using Kind = AsyncOperation::Kind;
+
+    if (Op.Step == AsyncOperation::Stage::Freeing)
+        return FreeResult(Op, mysql_free_result_cont(Rows, Ready));
+
+    switch (Op.Type)
+    {
+        case Kind::Connect:
+        {
+            MYSQL* Connected = nullptr;
+            return EndConnect(Op, mysql_real_connect_cont(&Connected, Mysql, Ready));
+        }
+
+        case Kind::Query:
+        {
+            int Failed = 0;
+            int Status = mysql_real_query_cont(&Failed, Mysql, Ready);
+            return Status ? Status : EndQuery(Op, Failed);
+        }
+
+        case Kind::Fetch:
+        {
+            MYSQL_ROW Row = nullptr;
+            int Status = mysql_fetch_row_cont(&Row, Rows, Ready);
+            return FetchRows(Op, Row, Status);
+        }
+
+        case Kind::NextResult:
+        {
+            int More = 0;
+            int Status = mysql_next_result_cont(&More, Mysql, Ready);
+            return Status ? Status : EndNext(Op, More);
+        }
+
+        case Kind::Close:
+        {
+            int Status = mysql_close_cont(Mysql, Ready);
+            if (Status == 0)
+                Mysql = nullptr;
+            return Status;
+        }
+    }
+    return 0;
+}
+
+int AsyncConnection::EndConnect(AsyncOperation& Op, int Status)
+{
+    if (Status != 0)
+        return Status;
+
+    Opening = false;
+    if (mysql_errno(Mysql))
+    {
+        std::string Error = "Connect error: " + LastError(Mysql);
+        CloseNow();
+        return Fail(Op, std::move(Error));
+    }
+    Op.Succeeded = true;
+    return 0;
+}
+
+int AsyncConnection::EndQuery(AsyncOperation& Op, int Failed)
+{
+    if (Failed)
+    {
+        // A statement the server rejected leaves the connection usable.
+        BrokenFlag = IsConnectionLost(Mysql);
+        return Fail(Op, LastError(Mysql));
+    }
+    return OpenResult(Op);
+}
+
+// Decodes rows while they are already buffered, up to the batch size.
+int AsyncConnection::FetchRows(AsyncOperation& Op, MYSQL_ROW Row, int Status)
+{
+    while (Status == 0 && Row)
+    {
+        QueryFetcher::DecodeRow(ResultPlan, Row, mysql_fetch_lengths(Rows), *Op.Into);
+        if (++Op.Fetched == Op.MaxRows)
+            return 0;
+        Status = mysql_fetch_row_start(&Row, Rows);
+    }
+    if (Status != 0)
+        return Status;
+
+    if (mysql_errno(Mysql))
+    {
+        // The error ended the result, so this reads nothing more; the link
+        // is out of step with the server though.
+        mysql_free_result(Rows);
+        Rows = nullptr;
+        BrokenFlag = true;
+        return Fail(Op, LastError(Mysql));
+    }
+
+    ResultInfo.Warnings = mysql_warning_count(Mysql);
+    ResultInfo.Seconds  = std::chrono::duration<double>(Clock::now() - ResultStarted).count();
+    ResultStarted = Clock::now();
+    Op.Step = AsyncOperation::Stage::Freeing;
+    return FreeResult(Op, mysql_free_result_start(Rows));
+}
+
+int AsyncConnection::FreeResult(AsyncOperation& Op, int Status)
+{
+    if (Status != 0)
+        return Status;
+
+    Rows = nullptr;
+    if (Op.Type == AsyncOperation::Kind::NextResult)
+        return StartNext(Op);
+    return 0;
+}
+
+int AsyncConnection::StartNext(AsyncOperation& Op)
+{
+    Op.Step = AsyncOperation::Stage::Next;
+    if (!mysql_more_results(Mysql))
+        return 0;
+    int More = 0;
+    int Status = mysql_next_result_start(&More, Mysql);
+    return Status ? Status : EndNext(Op, More);
+}
+
+// More is what mysql_next_result returned: 0 when another result follows,
+// -1 when the query is done, > 0 when the next statement of a script failed.
+int AsyncConnection::EndNext(AsyncOperation& Op, int More)
+{
+    if (More > 0)
+    {
+        BrokenFlag = IsConnectionLost(Mysql);
+        return Fail(Op, LastError(Mysql));
+    }
+    if (More < 0)
+        return 0;
+    return OpenResult(Op);
+}
+
+int AsyncConnection::OpenResult(AsyncOperation& Op)
+{
+    ResultInfo = ResultSummary();
+    ResultPlan = DecoderPlan();
+
+    Rows = mysql_use_result(Mysql);
+    if (Rows)
+    {
+        ResultInfo.HasRows = true;
+        ResultPlan = DecoderPlan::FromFields(mysql_fetch_fields(Rows), mysql_num_fields(Rows), Options.CellPrefixBytes);
+    }
+    else
+    {
+        if (mysql_field_count(Mysql) != 0)
+        {
+            BrokenFlag = IsConnectionLost(Mysql);
+            return Fail(Op, LastError(Mysql));
+        }
+        ResultInfo.AffectedRows = mysql_affected_rows(Mysql);
+        ResultInfo.InsertId     = mysql_insert_id(Mysql);
+        ResultInfo.Warnings     = mysql_warning_count(Mysql);
+        ResultInfo.Seconds      = std::chrono::duration<double>(Clock::now() - ResultStarted).count();
+        ResultStarted = Clock::now();
+    }
+    Op.Succeeded = true;
+    return 0;
+}
+
+int AsyncConnection::Fail(AsyncOperation& Op, std::string Error)
+{
+    Op.Succeeded = false;
+    if (Op.Error)
+        *Op.Error = std::move(Error);
+    return 0;
+}
+
+void AsyncConnection::Suspend(AsyncOperation& Op, std::coroutine_handle<> Caller)
+{
+    Op.Caller = Caller;
+    Active = &Op;
+    Wait(Op, Op.Status);
+    if (Op.Type != AsyncOperation::Kind::Close && (Cancel || Options.OperationTimeout.count() > 0))
+        Schedule(Op);
+}
+
+void AsyncConnection::Wait(AsyncOperation& Op, int Status)
+{
+    unsigned TimeoutMs = Status & MYSQL_WAIT_TIMEOUT ? mysql_get_timeout_value_ms(Mysql) : 0;
+    AsyncOperation* Pending = &Op;
+    Executor.Wait(mysql_get_socket(Mysql), Status, TimeoutMs, [this, Pending](int Ready) {
+        int Next = Continue(*Pending, Ready);
+        if (Next != 0)
+        {
+            Wait(*Pending, Next);
+            return;
+        }
+        Active = nullptr;
+        Pending->Caller.resume();
+    });
+}
+
+void AsyncConnection::Schedule(const AsyncOperation& Op)
+{
+    auto Delay = CancelPollInterval;
+    if (Options.OperationTimeout.count() > 0)
+    {
+        auto Left = std::chrono::ceil<std::chrono::milliseconds>(Op.Deadline - Clock::now());
+        Delay = Cancel ? std::min(Delay, Left) : Left;
+        Delay = std::max(Delay, std::chrono::milliseconds(1));
+    }
+    Executor.After(Delay, [this, Alive = std::weak_ptr<char>(Lifetime), Serial = Op.Serial]() {
+        if (!Alive.expired())
+            Watch(Serial);
+    });
+}
+
+// Ends the suspended call when its token tripped or its time ran out.
+void AsyncConnection::Watch(uint64_t Serial)
+{
+    if (!Active || Active->Serial != Serial)
+        return;
+
+    AsyncOperation& Op = *Active;
+    const char* Reason = nullptr;
+    if (IsCancelled(Cancel.get()))
+        Reason = "Cancelled";
+    else if (Options.OperationTimeout.count() > 0 && Clock::now() >= Op.Deadline)
+        Reason = "Timed out";
+    if (!Reason)
+    {
+        Schedule(Op);
+        return;
+    }
+
+    // The libmariadb call stays suspended for good, so the handle can only
+    // be closed now. A handshake has nothing worth keeping; otherwise the
+    // socket is shut down and Close() finishes the job.
+    Active = nullptr;
+    if (Op.Type == AsyncOperation::Kind::Connect)
+        CloseNow();
+    else
+    {
+        Executor.Forget(mysql_get_socket(Mysql));
+        mariadb_cancel(Mysql);
+        BrokenFlag = true;
+    }
+    Fail(Op, Reason);
+    Op.Caller.resume();
+}
+
+void AsyncConnection::CloseNow()
+{
+    if (!Mysql)
+        return;
+
+    Executor.Forget(mysql_get_socket(Mysql));
+    // Makes the closes below quick when a call or a result was cut off.
+    if (!Opening && (Active || Rows || BrokenFlag))
+        mariadb_cancel(Mysql);
+    if (Rows)
+        mysql_free_result(Rows);
+    mysql_close(Mysql);
+
+    Mysql      = nullptr;
+    Rows       = nullptr;
+    Opening    = false;
+    BrokenFlag = false;
+    Active     = nullptr;
+}
@@ -0,0 +1,188 @@
+//
+//  AsyncConnection.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "AsyncExecutor.hpp"
+#include "AsyncTask.hpp"
+#include "ConnectionPool.hpp"
+#include "QueryFetcher.hpp"
+#include "ResultSetList.hpp"
+#include "CancelToken.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace DBCore
+{
+    struct AsyncClientOptions
+    {
+        unsigned ConnectTimeout  = 10;   // seconds, MYSQL_OPT_CONNECT_TIMEOUT
+        unsigned ReadTimeout     = 30;   // seconds, MYSQL_OPT_READ_TIMEOUT and _WRITE_TIMEOUT
+        uint32_t CellPrefixBytes = 0;    // as StreamOptions::CellPrefixBytes
+        // Limit on each Connect, Query, FetchBatch or NextResult; 0 for none.
+        std::chrono::milliseconds OperationTimeout{0};
+    };
+
+    class AsyncConnection;
+
+    // One call of an AsyncConnection, kept in the awaiting coroutine's frame
+    // while the call is suspended.
+    struct AsyncOperation
+    {
+        enum class Kind : uint8_t { Connect, Query, Fetch, NextResult, Close };
+        enum class Stage : uint8_t { Call, Freeing, Next };
+
+        AsyncConnection*          Owner     = nullptr;
+        Kind                      Type      = Kind::Close;
+        Stage                     Step      = Stage::Call;
+        const ConnectionEndpoint* Endpoint  = nullptr;
+        std::string_view          Sql;
+        ResultStoreBuilder*       Into      = nullptr;
+        uint32_t                  MaxRows   = 0;
+        uint32_t                  Fetched   = 0;
+        std::string*              Error     = nullptr;
+        bool                      Succeeded = false;
+        int                       Status    = 0;        // the MYSQL_WAIT_* events waited for
+        uint64_t                  Serial    = 0;
+        std::chrono::steady_clock::time_point Deadline;
+        std::coroutine_handle<>   Caller;
+    };
+
+    // What the calls of AsyncConnection return: co_await it right away, once.
+    // A call that needs no waiting completes without suspending.
+    template<typename T>
+    class AsyncCall
+    {
+    public:
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> Caller);
+        T    await_resume();
+
+    private:
+        friend class AsyncConnection;
+        explicit AsyncCall(const AsyncOperation& Op) : Op(Op) {}
+
+        AsyncOperation Op;
+    };
+
+    // libmariadb's non-blocking client as C++20 coroutines: each call runs
+    // its _start/_cont pair on an AsyncExecutor and resumes the awaiting
+    // coroutine once it is done, so feature code reads linearly while one
+    // thread serves every connection. Rows go from the network buffer
+    // straight into the caller's ResultStoreBuilder.
+    //
+    // Everything, the destructor included, belongs on the executor's thread,
+    // and a connection runs one call at a time. Calls fail as the rest of
+    // DBCore does: false, with Error set.
+    class AsyncConnection
+    {
+    public:
+        explicit AsyncConnection(AsyncExecutor& Executor, AsyncClientOptions Options = AsyncClientOptions());
+        // Closes without waiting when Close() was not awaited.
+        ~AsyncConnection();
+
+        AsyncConnection(const AsyncConnection&) = delete;
+        AsyncConnection& operator=(const AsyncConnection&) = delete;
+
+        // A tripped Cancel ends the pending call with "Cancelled" and, like
+        // OperationTimeout, leaves the connection broken: later calls fail
+        // until Close(). Share one token between the connections of a task to
+        // cancel them together.
+        void SetCancel(std::shared_ptr<const CancelToken> Cancel) { this->Cancel = std::move(Cancel); }
+
+        AsyncCall<bool> Connect(const ConnectionEndpoint& Endpoint, std::string* Error = nullptr);
+        // Sends Sql and reads the header of its first result; the rows, if
+        // any, come from FetchBatch().
+        AsyncCall<bool> Query(std::string_view Sql, std::string* Error = nullptr);
+        // Decodes up to MaxRows rows of the current result into Into, which
+        // is built on Plan().Columns; 0 for all of them. HasRows() turns
+        // false at the end.
+        AsyncCall<bool> FetchBatch(ResultStoreBuilder& Into, uint32_t MaxRows, std::string* Error = nullptr);
+        // Skips what is left of the current result and reads the header of
+        // the next one. False, without Error, when there is none.
+        AsyncCall<bool> NextResult(std::string* Error = nullptr);
+        AsyncCall<void> Close();
+
+        bool Connected() const { return Mysql && !Opening; }
+        bool Broken() const { return BrokenFlag; }
+        // The current result is a row set with rows left to fetch.
+        bool HasRows() const { return Rows != nullptr; }
+
+        // Of the current result.
+        const DecoderPlan&   Plan() const { return ResultPlan; }
+        const ResultSummary& Summary() const { return ResultInfo; }
+
+        MYSQL* Handle() const { return Mysql; }
+
+    private:
+        template<typename T>
+        friend class AsyncCall;
+
+        AsyncOperation NewOperation(AsyncOperation::Kind Type, std::string* Error);
+
+        // Each returns the events to wait for, or 0 once the call is done.
+        bool Start(AsyncOperation& Op);
+        int  Begin(AsyncOperation& Op);
+        int  Continue(AsyncOperation& Op, int Ready);
+        int  EndConnect(AsyncOperation& Op, int Status);
+        int  EndQuery(AsyncOperation& Op, int Failed);
+        int  FetchRows(AsyncOperation& Op, MYSQL_ROW Row, int Status);
+        int  FreeResult(AsyncOperation& Op, int Status);
+        int  StartNext(AsyncOperation& Op);
+        int  EndNext(AsyncOperation& Op, int More);
+        int  OpenResult(AsyncOperation& Op);
+        int  Fail(AsyncOperation& Op, std::string Error);
+
+        void Suspend(AsyncOperation& Op, std::coroutine_handle<> Caller);
+        void Wait(AsyncOperation& Op, int Status);
+        void Schedule(const AsyncOperation& Op);
+        void Watch(uint64_t Serial);
+        void CloseNow();
+
+        AsyncExecutor&           Executor;
+        const AsyncClientOptions Options;
+
+        MYSQL*                   Mysql      = nullptr;
+        MYSQL_RES*               Rows       = nullptr;
+        bool                     Opening    = false;   // connect in progress
+        bool                     BrokenFlag = false;
+        DecoderPlan              ResultPlan;
+        ResultSummary            ResultInfo;
+        std::chrono::steady_clock::time_point ResultStarted;
+
+        std::shared_ptr<const CancelToken> Cancel;
+        AsyncOperation*          Active     = nullptr;  // the suspended call
+        uint64_t                 Serial     = 0;
+        // Watchdog timers check it, as they can outlive the connection.
+        std::shared_ptr<char>    Lifetime   = std::make_shared<char>();
+    };
+
+    template<typename T>
+    bool AsyncCall<T>::await_ready()
+    {
+        return Op.Owner->Start(Op);
+    }
+
+    template<typename T>
+    void AsyncCall<T>::await_suspend(std::coroutine_handle<> Caller)
+    {
+        Op.Owner->Suspend(Op, Caller);
+    }
+
+    template<typename T>
+    T AsyncCall<T>::await_resume()
+    {
+        if constexpr (!std::is_void_v<T>)
+            return Op.Succeeded;
+    }
+}
@@ -0,0 +1,43 @@
+//
+//  AsyncExecutor.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include <chrono>
+#include <functional>
+
+namespace DBCore
+{
+    // What AsyncConnection needs from an event loop: socket readiness for the
+    // MYSQL_WAIT_* status of libmariadb's _start/_cont calls, timers, and work
+    // posted from other threads. EventLoop is one; AsioExecutor puts the same
+    // on a Boost.Asio io_context.
+    class AsyncExecutor
+    {
+    public:
+        using Task        = std::function<void()>;
+        // The MYSQL_WAIT_* events that happened, for the next _cont call.
+        using WaitHandler = std::function<void(int Ready)>;
+
+        virtual ~AsyncExecutor() = default;
+
+        // Thread safe. Work runs on the executor's thread, in the order posted.
+        virtual void Post(Task Work) = 0;
+
+        // The rest are for the executor's thread only.
+
+        // Calls Handler once for Status, the value a _start/_cont call returned.
+        // A socket has one wait at a time; TimeoutMs only counts when Status
+        // has MYSQL_WAIT_TIMEOUT.
+        virtual void Wait(my_socket Socket, int Status, unsigned TimeoutMs, WaitHandler Handler) = 0;
+        // Drops the socket's wait without calling it; before the socket closes.
+        virtual void Forget(my_socket Socket) = 0;
+        virtual void After(std::chrono::milliseconds Delay, Task Work) = 0;
+    };
+}
@@ -0,0 +1,540 @@
+//
+//  AsyncQueryEngine.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "AsyncQueryEngine.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace DBCore;
+
+// How often running and queued queries look at their CancelToken.
+static constexpr std::chrono::milliseconds CancelPollInterval(100);
+// Wait before the next handshake after one failed, doubled per failure.
+static constexpr std::chrono::milliseconds MinReconnectDelay(100);
+static constexpr std::chrono::milliseconds MaxReconnectDelay(5000);
+
+static std::string LastError(MYSQL* Mysql)
+{
+    const char* Message = mysql_error(Mysql);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_errno(Mysql)) + ")";
+}
+
+AsyncQueryEngine::AsyncQueryEngine(ConnectionEndpoint Endpoint, AsyncEngineOptions Options)
+    : Target(std::move(Endpoint)), Options(Options)
+{
+    if (Loop.Valid())
+        Thread = std::thread([this]() { Loop.Run(); });
+}
+
+AsyncQueryEngine::~AsyncQueryEngine()
+{
+    Loop.Stop();
+    if (Thread.joinable())
+        Thread.join();
+
+    // The loop is gone, so nothing resumes the suspended operations; their
+    // sockets are shut down to make the closes below quick.
+    for (std::unique_ptr<Connection>& Conn : Pool)
+    {
+        // Already closed, waiting to be erased.
+        if (!Conn->Mysql)
+            continue;
+        if (Conn->Current)
+        {
+            AsyncQueryResult Result;
+            Result.Cancelled = true;
+            Result.Error = "Cancelled";
+            Conn->Current->Done(std::move(Result));
+        }
+        if (Conn->Step != Phase::Connecting)
+            mariadb_cancel(Conn->Mysql);
+        if (Conn->Rows)
+            mysql_free_result(Conn->Rows);
+        mysql_close(Conn->Mysql);
+    }
+    // Then the queries submitted after the loop last took them, in order.
+    {
+        std::lock_guard<std::mutex> Lock(SubmittedMutex);
+        std::move(Submitted.begin(), Submitted.end(), std::back_inserter(Pending));
+        Submitted.clear();
+    }
+    for (std::unique_ptr<Query>& Work : Pending)
+    {
+        AsyncQueryResult Result;
+        Result.Cancelled = true;
+        Result.Error = "Cancelled";
+        Work->Done(std::move(Result));
+    }
+}
+
+void AsyncQueryEngine::Submit(std::string Sql, Completion Done, std::shared_ptr<const CancelToken> Cancel)
+{
+    auto Work = std::make_unique<Query>();
+    Work->Sql    = std::move(Sql);
+    Work->Done   = std::move(Done);
+    Work->Cancel = std::move(Cancel);
+
+    if (!Loop.Valid())
+    {
+        AsyncQueryResult Result;
+        Result.Error = Loop.Error();
+        Work->Done(std::move(Result));
+        return;
+    }
+
+    QueuedCount.fetch_add(1);
+    // Queued here rather than in the posted task, so the destructor still
+    // finds it when the loop stops first.
+    {
+        std::lock_guard<std::mutex> Lock(SubmittedMutex);
+        Submitted.push_back(std::move(Work));
+    }
+    Loop.Post([this]() { TakeSubmitted(); });
+}
+
+void AsyncQueryEngine::TakeSubmitted()
+{
+    {
+        std::lock_guard<std::mutex> Lock(SubmittedMutex);
+        if (Submitted.empty())
+            return;
+        std::move(Submitted.begin(), Submitted.end(), std::back_inserter(Pending));
+        Submitted.clear();
+    }
+    Dispatch();
+}
+
+void AsyncQueryEngine::Dispatch()
+{
+    for (size_t i = 0; i < Pool.size() && !Pending.empty(); i++)
+    {
+        if (Pool[i]->Step != Phase::Idle)
+            continue;
+        std::unique_ptr<Query> Work;
+        while (!Work && !Pending.empty())
+        {
+            Work = std::move(Pending.front());
+            Pending.pop_front();
+            QueuedCount.fetch_sub(1);
+            if (IsCancelled(Work->Cancel.get()))
+            {
+                AsyncQueryResult Result;
+                Result.Cancelled = true;
+                Result.Error = "Cancelled";
+                Work->Done(std::move(Result));
+                Work.reset();
+            }
+        }
+        if (!Work)
+            break;
+        Pool[i]->Current = std::move(Work);
+        Begin(Pool[i].get());
+    }
+
+    // One handshake per query left over, up to the connection cap; none
+    // while waiting out a failed one, or a refusing server is hammered.
+    size_t Connecting = (size_t)std::count_if(Pool.begin(), Pool.end(), [](const std::unique_ptr<Connection>& Conn) {
+        return Conn->Step == Phase::Connecting;
+    });
+    while (!ReconnectWaiting && Pending.size() > Connecting && Pool.size() < Options.MaxConnections)
+    {
+        Connect();
+        Connecting++;
+    }
+
+    if (!CancelPolling && (RunningCount.load() || !Pending.empty()))
+    {
+        CancelPolling = true;
+        Loop.After(CancelPollInterval, [this]() { PollCancels(); });
+    }
+}
+
+void AsyncQueryEngine::Connect()
+{
+    auto Owned = std::make_unique<Connection>();
+    Connection* Conn = Owned.get();
+    Conn->Mysql = mysql_init(nullptr);
+    if (!Conn->Mysql)
+    {
+        FailQueued("Out of memory");
+        return;
+    }
+
+    ApplyConnectionOptions(Conn->Mysql);
+    unsigned ConnectTimeout = Options.ConnectTimeout;
+    unsigned ReadTimeout = Options.ReadTimeout;
+    mysql_options(Conn->Mysql, MYSQL_OPT_NONBLOCK, nullptr);
+    mysql_options(Conn->Mysql, MYSQL_OPT_CONNECT_TIMEOUT, &ConnectTimeout);
+    mysql_options(Conn->Mysql, MYSQL_OPT_READ_TIMEOUT, &ReadTimeout);
+    mysql_options(Conn->Mysql, MYSQL_OPT_WRITE_TIMEOUT, &ReadTimeout);
+
+    Pool.push_back(std::move(Owned));
+    OpenCount.fetch_add(1);
+
+    Conn->Step = Phase::Connecting;
+    MYSQL* Connected = nullptr;
+    int Status = mysql_real_connect_start(&Connected, Conn->Mysql, Target.Host.c_str(), Target.User.c_str(),
+                                          Target.Password.c_str(), Target.Database.empty() ? nullptr : Target.Database.c_str(),
+                                          Target.Port ? Target.Port : 3306, nullptr, ConnectionFlags);
+    Resume(Conn, Status);
+}
+
+void AsyncQueryEngine::Begin(Connection* Conn)
+{
+    Conn->Result  = AsyncQueryResult();
+    Conn->Started = std::chrono::steady_clock::now();
+    Conn->Step    = Phase::Querying;
+    RunningCount.fetch_add(1);
+
+    int Failed = 0;
+    const std::string& Sql = Conn->Current->Sql;
+    int Status = mysql_real_query_start(&Failed, Conn->Mysql, Sql.data(), (unsigned long)Sql.size());
+    if (Status == 0 && Failed)
+    {
+        Fail(Conn, LastError(Conn->Mysql));
+        return;
+    }
+    Resume(Conn, Status);
+}
+
+void AsyncQueryEngine::Suspend(Connection* Conn, int Status)
+{
+    unsigned TimeoutMs = Status & MYSQL_WAIT_TIMEOUT ? mysql_get_timeout_value_ms(Conn->Mysql) : 0;
+    Loop.Wait(mysql_get_socket(Conn->Mysql), Status, TimeoutMs, [this, Conn](int Ready) { Advance(Conn, Ready); });
+}
+
+// Status is what the phase's last _start or _cont call returned: 0 when it
+// finished, else the events it waits for.
+void AsyncQueryEngine::Resume(Connection* Conn, int Status)
+{
+    if (Status != 0)
+    {
+        Suspend(Conn, Status);
+        return;
+    }
+
+    switch (Conn->Step)
+    {
+        case Phase::Connecting:
+            if (mysql_errno(Conn->Mysql))
+            {
+                std::string Error = "Connect error: " + LastError(Conn->Mysql);
+                const bool Alone = std::none_of(Pool.begin(), Pool.end(), [Conn](const std::unique_ptr<Connection>& Other) {
+                    return Other.get() != Conn && Other->Mysql && Other->Step != Phase::Closing;
+                });
+                Conn->Broken = true;
+                Close(Conn);
+                // With no other connection the server is down or refusing us;
+                // otherwise the queue waits for the ones that work, and more
+                // are tried only after a delay ("Too many connections").
+                if (Alone)
+                {
+                    FailQueued(Error);
+                    break;
+                }
+                ReconnectDelay = std::clamp(ReconnectDelay * 2, MinReconnectDelay, MaxReconnectDelay);
+                if (!ReconnectWaiting)
+                {
+                    ReconnectWaiting = true;
+                    Loop.After(ReconnectDelay, [this]() {
+                        ReconnectWaiting = false;
+                        Dispatch();
+                    });
+                }
+                break;
+            }
+            ReconnectDelay = std::chrono::milliseconds(0);
+            Conn->Step = Phase::Idle;
+            Dispatch();
+            break;
+
+        case Phase::Querying:
+            StartResult(Conn);
+            break;
+
+        case Phase::Freeing:
+            Conn->Rows = nullptr;
+            Conn->Step = Phase::NextResult;
+            if (!mysql_more_results(Conn->Mysql))
+            {
+                Complete(Conn);
+                break;
+            }
+            {
+                int More = 0;
+                int Next = mysql_next_result_start(&More, Conn->Mysql);
+                if (Next == 0)
+                    NextResult(Conn, More);
+                else
+                    Suspend(Conn, Next);
+            }
+            break;
+
+        case Phase::Closing:
+            Remove(Conn);
+            break;
+
+        case Phase::Idle:
+        case Phase::Fetching:
+        case Phase::NextResult:
+            break;
+    }
+}
+
+void AsyncQueryEngine::Advance(Connection* Conn, int Ready)
+{
+    int Status = 0;
+    switch (Conn->Step)
+    {
+        case Phase::Connecting:
+        {
+            MYSQL* Connected = nullptr;
+            Status = mysql_real_connect_cont(&Connected, Conn->Mysql, Ready);
+            break;
+        }
+        case Phase::Querying:
+        {
+            int Failed = 0;
+            Status = mysql_real_query_cont(&Failed, Conn->Mysql, Ready);
+            if (Status == 0 && Failed)
+            {
+                Fail(Conn, LastError(Conn->Mysql));
+                return;
+            }
+            break;
+        }
+        case Phase::Fetching:
+        {
+            MYSQL_ROW Row = nullptr;
+            Status = mysql_fetch_row_cont(&Row, Conn->Rows, Ready);
+            FetchRows(Conn, Row, Status);
+            return;
+        }
+        case Phase::Freeing:
+            Status = mysql_free_result_cont(Conn->Rows, Ready);
+            break;
+        case Phase::NextResult:
+        {
+            int More = 0;
+            Status = mysql_next_result_cont(&More, Conn->Mysql, Ready);
+            if (Status == 0)
+            {
+                NextResult(Conn, More);
+                return;
+            }
+            break;
+        }
+        case Phase::Closing:
+            Status = mysql_close_cont(Conn->Mysql, Ready);
+            break;
+        case Phase::Idle:
+            return;
+    }
+    Resume(Conn, Status);
+}
+
+void AsyncQueryEngine::StartResult(Connection* Conn)
+{
+    MYSQL* Mysql = Conn->Mysql;
+    Conn->Rows = mysql_use_result(Mysql);
+    if (!Conn->Rows)
+    {
+        if (mysql_field_count(Mysql) != 0)
+        {
+            Fail(Conn, LastError(Mysql));
+            return;
+        }
+
+        ResultSummary& Summary = Conn->Result.Summary;
+        Summary = ResultSummary();
+        Summary.AffectedRows = mysql_affected_rows(Mysql);
+        Summary.InsertId     = mysql_insert_id(Mysql);
+        Summary.Warnings     = mysql_warning_count(Mysql);
+        Conn->Result.Store = ResultStore::FromMessage("Result", std::to_string((unsigned long long)Summary.AffectedRows) + " row(s) affected");
+
+        // Nothing to free; go straight to the next result.
+        Conn->Step = Phase::Freeing;
+        Resume(Conn, 0);
+        return;
+    }
+
+    Conn->Result.Summary = ResultSummary();
+    Conn->Result.Summary.HasRows = true;
+    Conn->Plan = DecoderPlan::FromFields(mysql_fetch_fields(Conn->Rows), mysql_num_fields(Conn->Rows), Options.CellPrefixBytes);
+    Conn->Builder = std::make_unique<ResultStoreBuilder>(Conn->Plan.Columns);
+    Conn->Step = Phase::Fetching;
+
+    MYSQL_ROW Row = nullptr;
+    int Status = mysql_fetch_row_start(&Row, Conn->Rows);
+    FetchRows(Conn, Row, Status);
+}
+
+// Decodes rows while they are already buffered, up to TurnRows per turn so a
+// large result does not hold up the other connections.
+void AsyncQueryEngine::FetchRows(Connection* Conn, MYSQL_ROW Row, int Status)
+{
+    for (uint32_t Decoded = 0; Status == 0 && Row; )
+    {
+        QueryFetcher::DecodeRow(Conn->Plan, Row, mysql_fetch_lengths(Conn->Rows), *Conn->Builder);
+        if (++Decoded == Options.TurnRows)
+        {
+            Loop.Post([this, Conn]() {
+                MYSQL_ROW Next = nullptr;
+                int NextStatus = mysql_fetch_row_start(&Next, Conn->Rows);
+                FetchRows(Conn, Next, NextStatus);
+            });
+            return;
+        }
+        Status = mysql_fetch_row_start(&Row, Conn->Rows);
+    }
+    if (Status != 0)
+    {
+        Suspend(Conn, Status);
+        return;
+    }
+
+    if (mysql_errno(Conn->Mysql))
+    {
+        Fail(Conn, LastError(Conn->Mysql));
+        return;
+    }
+    EndResult(Conn);
+}
+
+void AsyncQueryEngine::EndResult(Connection* Conn)
+{
+    Conn->Result.Store = Conn->Builder->Finish();
+    Conn->Result.Summary.Warnings = mysql_warning_count(Conn->Mysql);
+    Conn->Builder.reset();
+
+    Conn->Step = Phase::Freeing;
+    Resume(Conn, mysql_free_result_start(Conn->Rows));
+}
+
+// More is what mysql_next_result returned: 0 when another result follows,
+// -1 when the query is done, > 0 when the next statement of a script failed.
+void AsyncQueryEngine::NextResult(Connection* Conn, int More)
+{
+    if (More > 0)
+        Fail(Conn, LastError(Conn->Mysql));
+    else if (More < 0)
+        Complete(Conn);
+    else
+        StartResult(Conn);
+}
+
+void AsyncQueryEngine::Fail(Connection* Conn, std::string Error)
+{
+    // A statement the server rejected leaves the connection usable; anything
+    // that broke off a result or the link does not.
+    if (Conn->Rows || IsConnectionLost(Conn->Mysql) || IsCancelled(Conn->Current->Cancel.get()))
+        Conn->Broken = true;
+    if (Conn->Rows)
+    {
+        // The error ended the result, so this reads nothing more.
+        mysql_free_result(Conn->Rows);
+        Conn->Rows = nullptr;
+    }
+    Conn->Builder.reset();
+    Conn->Result.Error = std::move(Error);
+    Complete(Conn);
+}
+
+void AsyncQueryEngine::Complete(Connection* Conn)
+{
+    std::unique_ptr<Query> Work = std::move(Conn->Current);
+    AsyncQueryResult Result = std::move(Conn->Result);
+    Conn->Result = AsyncQueryResult();
+    RunningCount.fetch_sub(1);
+
+    Result.Summary.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Conn->Started).count();
+    if (IsCancelled(Work->Cancel.get()))
+    {
+        Result.Cancelled = true;
+        Result.Error = "Cancelled";
+        Result.Store.reset();
+    }
+    Result.Succeeded = Result.Error.empty();
+
+    if (Conn->Broken)
+        Close(Conn);
+    else
+        Conn->Step = Phase::Idle;
+
+    Work->Done(std::move(Result));
+    // Not inline: a query may complete from inside Dispatch().
+    Loop.Post([this]() { Dispatch(); });
+}
+
+void AsyncQueryEngine::Close(Connection* Conn)
+{
+    Conn->Step = Phase::Closing;
+    Loop.Forget(mysql_get_socket(Conn->Mysql));
+    Resume(Conn, mysql_close_start(Conn->Mysql));
+}
+
+void AsyncQueryEngine::Remove(Connection* Conn)
+{
+    // mysql_close freed the handle. Erased later, as the caller may be iterating the pool.
+    Conn->Mysql = nullptr;
+    OpenCount.fetch_sub(1);
+    Loop.Post([this, Conn]() {
+        Pool.erase(std::find_if(Pool.begin(), Pool.end(), [Conn](const std::unique_ptr<Connection>& Entry) {
+            return Entry.get() == Conn;
+        }));
+        Dispatch();
+    });
+}
+
+void AsyncQueryEngine::FailQueued(const std::string& Error)
+{
+    std::deque<std::unique_ptr<Query>> Failed;
+    Failed.swap(Pending);
+    QueuedCount.fetch_sub(Failed.size());
+    for (std::unique_ptr<Query>& Work : Failed)
+    {
+        AsyncQueryResult Result;
+        Result.Cancelled = IsCancelled(Work->Cancel.get());
+        Result.Error = Result.Cancelled ? "Cancelled" : Error;
+        Work->Done(std::move(Result));
+    }
+}
+
+void AsyncQueryEngine::PollCancels()
+{
+    CancelPolling = false;
+
+    // Shutting the socket down wakes the suspended operation with an error,
+    // which ends the query and closes the connection.
+    for (std::unique_ptr<Connection>& Conn : Pool)
+    {
+        if (Conn->Current && !Conn->Broken && IsCancelled(Conn->Current->Cancel.get()))
+        {
+            Conn->Broken = true;
+            mariadb_cancel(Conn->Mysql);
+        }
+    }
+
+    auto Cancelled = std::stable_partition(Pending.begin(), Pending.end(), [](const std::unique_ptr<Query>& Work) {
+        return !IsCancelled(Work->Cancel.get());
+    });
+    std::vector<std::unique_ptr<Query>> Dropped(std::make_move_iterator(Cancelled), std::make_move_iterator(Pending.end()));
+    Pending.erase(Cancelled, Pending.end());
+    QueuedCount.fetch_sub(Dropped.size());
+    for (std::unique_ptr<Query>& Work : Dropped)
+    {
+        AsyncQueryResult Result;
+        Result.Cancelled = true;
+        Result.Error = "Cancelled";
+        Work->Done(std::move(Result));
+    }
+
+    Dispatch();
+}
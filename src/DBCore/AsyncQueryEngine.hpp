@@ -0,0 +1,140 @@
+//
+//  AsyncQueryEngine.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "EventLoop.hpp"
+#include "ConnectionPool.hpp"
+#include "QueryFetcher.hpp"
+#include "ResultSetList.hpp"
+#include "CancelToken.hpp"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DBCore
+{
+    struct AsyncEngineOptions
+    {
+        size_t   MaxConnections  = 32;   // queries beyond this many wait for a free connection
+        unsigned ConnectTimeout  = 10;   // seconds, MYSQL_OPT_CONNECT_TIMEOUT
+        unsigned ReadTimeout     = 30;   // seconds, MYSQL_OPT_READ_TIMEOUT and _WRITE_TIMEOUT
+        uint32_t CellPrefixBytes = 0;    // as StreamOptions::CellPrefixBytes
+        // Rows decoded per turn before the loop serves the other connections.
+        uint32_t TurnRows        = 1024;
+    };
+
+    struct AsyncQueryResult
+    {
+        bool                         Succeeded = false;
+        bool                         Cancelled = false;
+        std::string                  Error;
+        // The last result of the query: its rows, or the affected rows message.
+        std::shared_ptr<ResultStore> Store;
+        ResultSummary                Summary;
+    };
+
+    // Runs queries over many connections from a single thread, with
+    // libmariadb's non-blocking API (the _start/_cont calls in
+    // mariadb_async.c) on an EventLoop. Connections are opened on demand up to
+    // MaxConnections and kept for the next query; a connection runs one query
+    // at a time and the rest queue. Meant for many small concurrent queries
+    // (monitoring, metadata) where a thread each would be the bigger cost.
+    class AsyncQueryEngine
+    {
+    public:
+        using Completion = std::function<void(AsyncQueryResult&& Result)>;
+
+        // False from Valid() when the event queue could not be created;
+        // every query then completes with that error.
+        explicit AsyncQueryEngine(ConnectionEndpoint Endpoint, AsyncEngineOptions Options = AsyncEngineOptions());
+        // Completes what is still queued or running as cancelled.
+        ~AsyncQueryEngine();
+
+        AsyncQueryEngine(const AsyncQueryEngine&) = delete;
+        AsyncQueryEngine& operator=(const AsyncQueryEngine&) = delete;
+
+        bool Valid() const { return Loop.Valid(); }
+
+        // Thread safe. Done runs on the engine's thread, so it should hand the
+        // result off rather than work on it. A tripped Cancel ends the query
+        // and closes its connection.
+        void Submit(std::string Sql, Completion Done, std::shared_ptr<const CancelToken> Cancel = nullptr);
+
+        size_t Connections() const { return OpenCount.load(); }
+        size_t Running() const { return RunningCount.load(); }
+        size_t Queued() const { return QueuedCount.load(); }
+
+    private:
+        struct Query
+        {
+            std::string                        Sql;
+            Completion                         Done;
+            std::shared_ptr<const CancelToken> Cancel;
+        };
+
+        enum class Phase : uint8_t { Connecting, Idle, Querying, Fetching, Freeing, NextResult, Closing };
+
+        struct Connection
+        {
+            MYSQL*                 Mysql  = nullptr;
+            Phase                  Step   = Phase::Connecting;
+            bool                   Broken = false;      // closed once the query completes
+            std::unique_ptr<Query> Current;
+            AsyncQueryResult       Result;
+            MYSQL_RES*             Rows   = nullptr;
+            DecoderPlan            Plan;
+            std::unique_ptr<ResultStoreBuilder> Builder;
+            std::chrono::steady_clock::time_point Started;
+        };
+
+        // Everything below runs on the loop thread.
+        void TakeSubmitted();
+        void Dispatch();
+        void Connect();
+        void Begin(Connection* Conn);
+        void Resume(Connection* Conn, int Status);
+        void Suspend(Connection* Conn, int Status);
+        void Advance(Connection* Conn, int Ready);
+        void StartResult(Connection* Conn);
+        void FetchRows(Connection* Conn, MYSQL_ROW Row, int Status);
+        void EndResult(Connection* Conn);
+        void NextResult(Connection* Conn, int More);
+        void Fail(Connection* Conn, std::string Error);
+        void Complete(Connection* Conn);
+        void Close(Connection* Conn);
+        void Remove(Connection* Conn);
+        void FailQueued(const std::string& Error);
+        void PollCancels();
+
+        const ConnectionEndpoint  Target;
+        const AsyncEngineOptions  Options;
+
+        EventLoop                 Loop;
+        std::deque<std::unique_ptr<Query>>      Pending;
+        std::vector<std::unique_ptr<Connection>> Pool;
+        bool                      CancelPolling = false;
+        bool                      ReconnectWaiting = false;    // a handshake failed; Dispatch opens none until the timer
+        std::chrono::milliseconds ReconnectDelay{0};
+
+        std::mutex                SubmittedMutex;
+        std::deque<std::unique_ptr<Query>>      Submitted;     // by Submit, not yet moved to Pending
+
+        std::atomic<size_t>       OpenCount{0};
+        std::atomic<size_t>       RunningCount{0};
+        std::atomic<size_t>       QueuedCount{0};
+
+        std::thread               Thread;
+    };
+}
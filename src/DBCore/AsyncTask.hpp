@@ -0,0 +1,144 @@
+//
+//  AsyncTask.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "AsyncExecutor.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace DBCore
+{
+    template<typename T = void>
+    class AsyncTask;
+
+    namespace Detail
+    {
+        struct TaskPromiseBase
+        {
+            std::coroutine_handle<> Continuation;
+
+            // Returns straight to whoever awaited the task, without growing the stack.
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept { return false; }
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> Done) noexcept
+                {
+                    std::coroutine_handle<> Next = Done.promise().Continuation;
+                    return Next ? Next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            // Errors travel as return values here, as everywhere in DBCore.
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        template<typename T>
+        struct TaskPromise : TaskPromiseBase
+        {
+            std::optional<T> Value;
+            void return_value(T Result) { Value.emplace(std::move(Result)); }
+        };
+
+        template<>
+        struct TaskPromise<void> : TaskPromiseBase
+        {
+            void return_void() noexcept {}
+        };
+    }
+
+    // A coroutine that starts when it is awaited and resumes its awaiter when
+    // it returns. Awaiting AsyncConnection calls inside one gives linear code
+    // for what the _start/_cont calls do with callbacks.
+    template<typename T>
+    class AsyncTask
+    {
+    public:
+        struct promise_type : Detail::TaskPromise<T>
+        {
+            AsyncTask get_return_object() { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        };
+
+        AsyncTask(AsyncTask&& Other) noexcept : Coroutine(std::exchange(Other.Coroutine, nullptr)) {}
+        AsyncTask& operator=(AsyncTask&& Other) noexcept
+        {
+            if (this != &Other)
+            {
+                if (Coroutine)
+                    Coroutine.destroy();
+                Coroutine = std::exchange(Other.Coroutine, nullptr);
+            }
+            return *this;
+        }
+        ~AsyncTask()
+        {
+            if (Coroutine)
+                Coroutine.destroy();
+        }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> Caller) noexcept
+        {
+            Coroutine.promise().Continuation = Caller;
+            return Coroutine;
+        }
+        T await_resume()
+        {
+            if constexpr (!std::is_void_v<T>)
+                return std::move(*Coroutine.promise().Value);
+        }
+
+    private:
+        explicit AsyncTask(std::coroutine_handle<promise_type> Coroutine) : Coroutine(Coroutine) {}
+
+        std::coroutine_handle<promise_type> Coroutine;
+    };
+
+    namespace Detail
+    {
+        // Frees its frame when it returns; nobody awaits it.
+        struct DetachedTask
+        {
+            struct promise_type
+            {
+                DetachedTask get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+        };
+
+        inline DetachedTask RunDetached(AsyncTask<> Work, std::function<void()> Done)
+        {
+            co_await Work;
+            if (Done)
+                Done();
+        }
+    }
+
+    // Thread safe. Starts Work on the executor's thread and lets it run on its
+    // own; Done, if set, runs there once it returned.
+    inline void Spawn(AsyncExecutor& Executor, AsyncTask<> Work, std::function<void()> Done = nullptr)
+    {
+        // std::function needs a copyable callable.
+        auto Shared = std::make_shared<AsyncTask<>>(std::move(Work));
+        Executor.Post([Shared, Done = std::move(Done)]() mutable {
+            Detail::RunDetached(std::move(*Shared), std::move(Done));
+        });
+    }
+}
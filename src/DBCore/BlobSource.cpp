@@ -0,0 +1,245 @@
+//
+//  BlobSource.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "BlobSource.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace DBCore;
+
+static std::string QuoteIdentifier(const std::string& Name)
+{
+    std::string Quoted = "`";
+    for (char c : Name)
+    {
+        if (c == '`')
+            Quoted.push_back('`');
+        Quoted.push_back(c);
+    }
+    Quoted.push_back('`');
+    return Quoted;
+}
+
+// Key values go into the query as hex literals, so no escaping depends on the
+// connection's character set; text is tagged so it compares as text.
+static std::string KeyLiteral(const ColumnInfo& Column, const CellView& Cell)
+{
+    static const char Digits[] = "0123456789ABCDEF";
+
+    char Buffer[64];
+    std::string_view Value = FormatCell(Column, Cell, Buffer, sizeof(Buffer));
+    if (Column.Encoding == ColumnEncoding::Int64 || Column.Encoding == ColumnEncoding::UInt64 || Column.Encoding == ColumnEncoding::Double)
+        return std::string(Value);
+
+    std::string Literal = Column.Charset == 63 ? "X'" : "_utf8mb4 X'";
+    Literal.reserve(Literal.size() + Value.size() * 2 + 1);
+    for (unsigned char c : Value)
+    {
+        Literal.push_back(Digits[c >> 4]);
+        Literal.push_back(Digits[c & 15]);
+    }
+    Literal.push_back('\'');
+    return Literal;
+}
+
+bool BlobSource::WriteToFile(const std::string& Path, std::atomic<uint64_t>* Written, const CancelToken* Cancel, std::string* Error)
+{
+    int Descriptor = open(Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (Descriptor < 0)
+    {
+        if (Error)
+            *Error = "Cannot create " + Path + ": " + strerror(errno);
+        return false;
+    }
+
+    bool Succeeded = true;
+    std::string Chunk;
+    for (uint64_t Offset = 0; Succeeded && Offset < Length(); Offset += Chunk.size())
+    {
+        if (IsCancelled(Cancel))
+        {
+            if (Error)
+                *Error = "Cancelled";
+            Succeeded = false;
+            break;
+        }
+        uint32_t Wanted = (uint32_t)std::min<uint64_t>(ChunkSize, Length() - Offset);
+        if (!Read(Offset, Wanted, Chunk, Error))
+        {
+            Succeeded = false;
+            break;
+        }
+        if (Chunk.empty())
+            break;
+
+        for (size_t Done = 0; Done < Chunk.size(); )
+        {
+            ssize_t Count = write(Descriptor, Chunk.data() + Done, Chunk.size() - Done);
+            if (Count < 0 && errno == EINTR)
+                continue;
+            if (Count < 0)
+            {
+                if (Error)
+                    *Error = "Cannot write " + Path + ": " + strerror(errno);
+                Succeeded = false;
+                break;
+            }
+            Done += (size_t)Count;
+        }
+        if (Written)
+            Written->fetch_add(Chunk.size(), std::memory_order_relaxed);
+    }
+
+    if (close(Descriptor) != 0 && Succeeded)
+    {
+        if (Error)
+            *Error = "Cannot write " + Path + ": " + strerror(errno);
+        Succeeded = false;
+    }
+    if (!Succeeded)
+        unlink(Path.c_str());
+    return Succeeded;
+}
+
+StoredBlob::StoredBlob(std::shared_ptr<const ResultStore> Store, uint64_t Row, size_t Column)
+    : Store(std::move(Store))
+{
+    const ColumnInfo& Info = this->Store->Columns()[Column];
+    CellView Cell = this->Store->Cell(Row, Column);
+    if (Info.Encoding == ColumnEncoding::Text)
+    {
+        Value = Cell.Text();
+        return;
+    }
+
+    char Buffer[64];
+    Formatted = std::string(FormatCell(Info, Cell, Buffer, sizeof(Buffer)));
+    Value = Formatted;
+}
+
+bool StoredBlob::Read(uint64_t Offset, uint32_t Length, std::string& Out, std::string*)
+{
+    Out.clear();
+    if (Offset < Value.size())
+        Out.assign(Value.substr((size_t)Offset, Length));
+    return true;
+}
+
+std::shared_ptr<KeyedBlob> KeyedBlob::Locate(const ResultStore& Store, uint64_t Row, size_t Column,
+                                             ConnectionProvider Connection, std::string* Error)
+{
+    const std::vector<ColumnInfo>& Columns = Store.Columns();
+    const ColumnInfo& Target = Columns[Column];
+    if (Target.Table.empty() || Target.OriginalName.empty())
+    {
+        if (Error)
+            *Error = "The value is not read from a table column, so it cannot be fetched again";
+        return nullptr;
+    }
+
+    std::string Condition;
+    for (size_t c = 0; c < Columns.size(); c++)
+    {
+        const ColumnInfo& Key = Columns[c];
+        if (!(Key.Flags & PRI_KEY_FLAG) || Key.Table != Target.Table || Key.Database != Target.Database)
+            continue;
+        CellView Cell = Store.Cell(Row, c);
+        if (Cell.Null)
+            continue;
+
+        if (!Condition.empty())
+            Condition += " AND ";
+        Condition += QuoteIdentifier(Key.OriginalName) + " = " + KeyLiteral(Key, Cell);
+    }
+    if (Condition.empty())
+    {
+        if (Error)
+            *Error = "Add the primary key of " + Target.Table + " to the query to fetch the whole value";
+        return nullptr;
+    }
+
+    auto Blob = std::make_shared<KeyedBlob>();
+    Blob->Connection = std::move(Connection);
+    Blob->Source     = (Target.Database.empty() ? std::string() : QuoteIdentifier(Target.Database) + ".") + QuoteIdentifier(Target.Table);
+    Blob->Column     = QuoteIdentifier(Target.OriginalName);
+    Blob->Condition  = std::move(Condition);
+    Blob->Text       = Target.Charset != 63;
+    Blob->FullLength = Store.FullLength(Row, Column);
+    return Blob;
+}
+
+bool KeyedBlob::Read(uint64_t Offset, uint32_t Length, std::string& Out, std::string* Error)
+{
+    Out.clear();
+    std::shared_ptr<PooledConnection> Lease = Connection ? Connection(Error) : nullptr;
+    MYSQL* Handle = Lease ? Lease->Handle() : nullptr;
+    if (!Handle)
+        return false;
+
+    // SUBSTRING counts characters on text, while offsets count the bytes the
+    // client received; text is sliced as its bytes in the connection's
+    // character set, which is what the result prefix and FullLength hold.
+    std::string Value = Column;
+    if (Text)
+        Value = std::string("CAST(CONVERT(") + Column + " USING " + mysql_character_set_name(Handle) + ") AS BINARY)";
+
+    // LIMIT 2 tells a key that does not identify the row (part of a composite
+    // key missing from the result) apart from a unique one.
+    std::string Sql = "SELECT SUBSTRING(" + Value + ", " + std::to_string(Offset + 1) + ", " + std::to_string(Length) +
+                      ") FROM " + Source + " WHERE " + Condition + " LIMIT 2";
+    if (mysql_real_query(Handle, Sql.data(), (unsigned long)Sql.size()) != 0)
+    {
+        if (Error)
+            *Error = mysql_error(Handle);
+        if (IsConnectionLost(Handle))
+            Lease->Discard();
+        return false;
+    }
+
+    MYSQL_RES* Result = mysql_store_result(Handle);
+    if (!Result)
+    {
+        if (Error)
+            *Error = mysql_error(Handle);
+        return false;
+    }
+
+    bool Succeeded = false;
+    uint64_t Rows = mysql_num_rows(Result);
+    MYSQL_ROW Row = mysql_fetch_row(Result);
+    if (Rows == 1 && Row && Row[0])
+    {
+        Out.assign(Row[0], mysql_fetch_lengths(Result)[0]);
+        Succeeded = true;
+    }
+    else if (Error)
+    {
+        *Error = Rows == 0 ? "The row is no longer in the table"
+               : Rows > 1  ? "The key columns in the result match more than one row"
+                           : "The value is now NULL";
+    }
+    mysql_free_result(Result);
+    return Succeeded;
+}
+
+std::shared_ptr<BlobSource> DBCore::OpenBlob(std::shared_ptr<const ResultStore> Store, uint64_t Row, size_t Column,
+                                             KeyedBlob::ConnectionProvider Connection, std::string* Error)
+{
+    if (!Store || Row >= Store->RowCount() || Column >= Store->ColumnCount())
+    {
+        if (Error)
+            *Error = "No such cell";
+        return nullptr;
+    }
+    if (Store->FullLength(Row, Column) == 0)
+        return std::make_shared<StoredBlob>(std::move(Store), Row, Column);
+    return KeyedBlob::Locate(*Store, Row, Column, std::move(Connection), Error);
+}
@@ -0,0 +1,86 @@
+//
+//  BlobSource.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "ResultStore.hpp"
+#include "CancelToken.hpp"
+#include "ConnectionPool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace DBCore
+{
+    // One cell value, read a piece at a time so values larger than memory can
+    // be paged through or saved. Not thread safe; readers use one thread.
+    class BlobSource
+    {
+    public:
+        static constexpr uint32_t ChunkSize = 1u << 20;
+
+        virtual ~BlobSource() = default;
+
+        virtual uint64_t Length() const = 0;
+        // Reads up to Length bytes at Offset into Out; less at the end of the value.
+        virtual bool Read(uint64_t Offset, uint32_t Length, std::string& Out, std::string* Error) = 0;
+
+        // Streams the whole value into Path, ChunkSize bytes at a time.
+        bool WriteToFile(const std::string& Path, std::atomic<uint64_t>* Written, const CancelToken* Cancel, std::string* Error);
+    };
+
+    // A value kept whole in a result store. Typed cells read as their display text.
+    class StoredBlob : public BlobSource
+    {
+    public:
+        StoredBlob(std::shared_ptr<const ResultStore> Store, uint64_t Row, size_t Column);
+
+        uint64_t Length() const override { return Value.size(); }
+        bool     Read(uint64_t Offset, uint32_t Length, std::string& Out, std::string* Error) override;
+
+    private:
+        std::shared_ptr<const ResultStore> Store;   // keeps Value alive
+        std::string_view                   Value;
+        std::string                        Formatted;
+    };
+
+    // A value the result only holds a prefix of. Each read runs
+    // SELECT SUBSTRING(column, offset, length) against the column's table,
+    // finding the row by the primary key columns the result carries.
+    class KeyedBlob : public BlobSource
+    {
+    public:
+        // Lends a connection for one read; called on the reading thread.
+        using ConnectionProvider = std::function<std::shared_ptr<PooledConnection>(std::string* Error)>;
+
+        // Null, with Error set, when the result does not carry the primary key
+        // of the column's table.
+        static std::shared_ptr<KeyedBlob> Locate(const ResultStore& Store, uint64_t Row, size_t Column,
+                                                 ConnectionProvider Connection, std::string* Error);
+
+        uint64_t Length() const override { return FullLength; }
+        bool     Read(uint64_t Offset, uint32_t Length, std::string& Out, std::string* Error) override;
+
+    private:
+        ConnectionProvider Connection;
+        std::string        Source;      // `db`.`table`
+        std::string        Column;      // `column`
+        std::string        Condition;   // WHERE clause matching the row's key
+        uint64_t           FullLength = 0;
+        bool               Text       = false;   // not a binary string
+    };
+
+    // StoredBlob for cells held whole, KeyedBlob for partly fetched ones.
+    std::shared_ptr<BlobSource> OpenBlob(std::shared_ptr<const ResultStore> Store, uint64_t Row, size_t Column,
+                                         KeyedBlob::ConnectionProvider Connection, std::string* Error);
+}
@@ -0,0 +1,724 @@
+//
+//  BulkLoader.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "BulkLoader.hpp"
+#include "ValueParser.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace DBCore;
+
+static std::string LastError(MYSQL* Connection)
+{
+    const char* Message = mysql_error(Connection);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_errno(Connection)) + ")";
+}
+
+static std::string StatementError(MYSQL_STMT* Statement)
+{
+    const char* Message = mysql_stmt_error(Statement);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_stmt_errno(Statement)) + ")";
+}
+
+static std::string QuoteIdentifier(const std::string& Name)
+{
+    std::string Quoted = "`";
+    for (char c : Name)
+    {
+        if (c == '`')
+            Quoted.push_back('`');
+        Quoted.push_back(c);
+    }
+    Quoted.push_back('`');
+    return Quoted;
+}
+
+// Bytes a value takes in a bulk request: its indicator, then a length-encoded string.
+static size_t EncodedSize(std::string_view Value)
+{
+    if (!Value.data())
+        return 1;
+    const size_t Length = Value.size();
+    const size_t Prefix = Length < 251 ? 1 : Length < (1u << 16) ? 3 : Length < (1u << 24) ? 4 : 9;
+    return 1 + Prefix + Length;
+}
+
+DelimitedSource::~DelimitedSource()
+{
+    if (Descriptor >= 0)
+        close(Descriptor);
+}
+
+std::unique_ptr<DelimitedSource> DelimitedSource::Open(const std::string& Path, ExportFormat Format, std::string* Error)
+{
+    if (Format != ExportFormat::Csv && Format != ExportFormat::Tsv)
+    {
+        if (Error)
+            *Error = "Only CSV and TSV files can be loaded.";
+        return nullptr;
+    }
+
+    std::unique_ptr<DelimitedSource> Source(new DelimitedSource());
+    Source->Format = Format;
+    Source->Descriptor = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (Source->Descriptor < 0)
+    {
+        if (Error)
+            *Error = "Cannot open " + Path + ": " + strerror(errno);
+        return nullptr;
+    }
+
+    std::string ReadError;
+    std::vector<std::string_view> Header;
+    if (!Source->Fill(&ReadError))
+    {
+        if (Error)
+            *Error = ReadError;
+        return nullptr;
+    }
+    // Spreadsheets like to start UTF-8 files with a byte order mark.
+    if (Source->Buffer.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        Source->Consumed = 3;
+
+    if (!Source->Next(Header, &ReadError))
+    {
+        if (Error)
+            *Error = ReadError.empty() ? Path + " is empty." : ReadError;
+        return nullptr;
+    }
+    for (std::string_view Name : Header)
+    {
+        if (Name.empty())
+        {
+            if (Error)
+                *Error = "The header of " + Path + " has an empty column name.";
+            return nullptr;
+        }
+        Source->Names.emplace_back(Name);
+    }
+    return Source;
+}
+
+bool DelimitedSource::Next(std::vector<std::string_view>& Cells, std::string* Error)
+{
+    for (;;)
+    {
+        // With one column an empty line is a record: NULL in CSV, '' in TSV.
+        // Otherwise it cannot be one, and is skipped as a blank line.
+        while (Names.size() != 1 && Consumed < Buffer.size() && (Buffer[Consumed] == '\n' || Buffer[Consumed] == '\r'))
+            Consumed++;
+        if (Consumed == Buffer.size())
+        {
+            if (AtEnd)
+                return false;
+            if (!Fill(Error))
+                return false;
+            continue;
+        }
+
+        size_t Position = Consumed;
+        std::string Malformed;
+        if (ParseRecord(Position, &Malformed))
+        {
+            Consumed = Position;
+            break;
+        }
+        if (!Malformed.empty())
+        {
+            if (Error)
+                *Error = Malformed;
+            return false;
+        }
+        if (!Fill(Error))
+            return false;
+    }
+
+    Record++;
+    // The header itself sets the width.
+    if (!Names.empty() && Ends.size() != Names.size())
+    {
+        if (Error)
+            *Error = "Record " + std::to_string(Record - 1) + " has " + std::to_string(Ends.size()) + " values; the header has " +
+                     std::to_string(Names.size()) + " columns.";
+        return false;
+    }
+
+    Cells.resize(Ends.size());
+    size_t Start = 0;
+    for (size_t i = 0; i < Ends.size(); i++)
+    {
+        Cells[i] = Nulls[i] ? std::string_view() : std::string_view(Values.data() + Start, Ends[i] - Start);
+        Start = Ends[i];
+    }
+    return true;
+}
+
+bool DelimitedSource::ParseRecord(size_t& Position, std::string* Error)
+{
+    Values.clear();
+    Ends.clear();
+    Nulls.clear();
+
+    const size_t Size = Buffer.size();
+    size_t p = Position;
+    for (;;)
+    {
+        const size_t FieldStart = p;
+        bool Null = false;
+
+        if (Format == ExportFormat::Csv)
+        {
+            if (p < Size && Buffer[p] == '"')
+            {
+                p++;
+                for (;;)
+                {
+                    const size_t Quote = Buffer.find('"', p);
+                    if (Quote == std::string::npos)
+                    {
+                        if (AtEnd && Error)
+                            *Error = "Record " + std::to_string(Record) + " has an unterminated quoted value.";
+                        return false;
+                    }
+                    Values.append(Buffer, p, Quote - p);
+                    if (Quote + 1 == Size && !AtEnd)
+                        return false;
+                    p = Quote + 1;
+                    if (p < Size && Buffer[p] == '"')
+                    {
+                        Values.push_back('"');
+                        p++;
+                        continue;
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                while (p < Size && Buffer[p] != ',' && Buffer[p] != '\n' && Buffer[p] != '\r')
+                    p++;
+                Values.append(Buffer, FieldStart, p - FieldStart);
+                // An empty field is NULL; '' is written quoted.
+                Null = p == FieldStart;
+            }
+        }
+        else
+        {
+            while (p < Size && Buffer[p] != '\t' && Buffer[p] != '\n')
+            {
+                if (Buffer[p] != '\\')
+                {
+                    Values.push_back(Buffer[p++]);
+                    continue;
+                }
+                if (p + 1 == Size)
+                {
+                    if (!AtEnd)
+                        return false;
+                    Values.push_back('\\');
+                    p++;
+                    break;
+                }
+                char Escaped = Buffer[p + 1];
+                switch (Escaped)
+                {
+                    case '0': Escaped = '\0'; break;
+                    case 'b': Escaped = '\b'; break;
+                    case 'n': Escaped = '\n'; break;
+                    case 'r': Escaped = '\r'; break;
+                    case 't': Escaped = '\t'; break;
+                    case 'Z': Escaped = '\x1A'; break;
+                    default: break;
+                }
+                Values.push_back(Escaped);
+                p += 2;
+            }
+            Null = p - FieldStart == 2 && Buffer[FieldStart] == '\\' && Buffer[FieldStart + 1] == 'N';
+            if (Null)
+                Values.resize(Values.size() - 1);
+        }
+
+        Ends.push_back(Values.size());
+        Nulls.push_back(Null);
+
+        if (p == Size)
+        {
+            if (!AtEnd)
+                return false;
+            Position = p;
+            return true;
+        }
+
+        const char Delimiter = Buffer[p];
+        if (Delimiter == (Format == ExportFormat::Csv ? ',' : '\t'))
+        {
+            p++;
+            continue;
+        }
+        if (Delimiter == '\n')
+        {
+            Position = p + 1;
+            return true;
+        }
+        if (Delimiter == '\r')
+        {
+            if (p + 1 == Size && !AtEnd)
+                return false;
+            p++;
+            if (p < Size && Buffer[p] == '\n')
+                p++;
+            Position = p;
+            return true;
+        }
+        if (Error)
+            *Error = "Record " + std::to_string(Record) + " has text after a quoted value.";
+        return false;
+    }
+}
+
+bool DelimitedSource::Fill(std::string* Error)
+{
+    if (AtEnd)
+        return true;
+
+    // Whatever is left of the buffer is the start of a record that did not fit.
+    Buffer.erase(0, Consumed);
+    Consumed = 0;
+
+    const size_t Kept = Buffer.size();
+    Buffer.resize(Kept + ReadBufferSize);
+    ssize_t Read;
+    do
+        Read = read(Descriptor, Buffer.data() + Kept, ReadBufferSize);
+    while (Read < 0 && errno == EINTR);
+
+    if (Read < 0)
+    {
+        Buffer.resize(Kept);
+        if (Error)
+            *Error = std::string("Read failed: ") + strerror(errno);
+        return false;
+    }
+    Buffer.resize(Kept + (size_t)Read);
+    AtEnd = Read == 0;
+    return true;
+}
+
+void BulkLoader::Batch::Reset(size_t Columns)
+{
+    Data.clear();
+    Offsets.resize(Columns);
+    Lengths.resize(Columns);
+    Indicators.resize(Columns);
+    Pointers.resize(Columns);
+    for (size_t c = 0; c < Columns; c++)
+    {
+        Offsets[c].clear();
+        Lengths[c].clear();
+        Indicators[c].clear();
+    }
+    Rows = 0;
+    Bytes = 0;
+}
+
+BulkLoader::BulkLoader(BulkOptions Options, BulkProgress* Progress)
+    : Options(std::move(Options)), Progress(Progress)
+{
+}
+
+BulkLoader::~BulkLoader()
+{
+    Stop();
+}
+
+bool BulkLoader::BulkSupported(MYSQL* Connection)
+{
+    unsigned long Capabilities = 0, Extended = 0;
+    if (mariadb_get_infov(Connection, MARIADB_CONNECTION_SERVER_CAPABILITIES, &Capabilities) ||
+        mariadb_get_infov(Connection, MARIADB_CONNECTION_EXTENDED_SERVER_CAPABILITIES, &Extended))
+        return false;
+    // MySQL servers announce themselves with CLIENT_MYSQL; the extended flags are MariaDB's.
+    return !(Capabilities & CLIENT_MYSQL) && (Extended & (MARIADB_CLIENT_STMT_BULK_OPERATIONS >> 32));
+}
+
+size_t BulkLoader::BatchBytes(MYSQL* Connection)
+{
+    static const char Query[] = "SELECT @@max_allowed_packet";
+
+    uint64_t Packet = 0;
+    if (mysql_real_query(Connection, Query, sizeof(Query) - 1) == 0)
+    {
+        if (MYSQL_RES* Result = mysql_store_result(Connection))
+        {
+            MYSQL_ROW Row = mysql_fetch_row(Result);
+            if (Row && Row[0])
+                ParseUInt64(Row[0], Packet);
+            mysql_free_result(Result);
+        }
+    }
+    if (Packet == 0)
+        return DefaultBatchBytes;
+    return (size_t)std::min<uint64_t>(Packet / 4 * 3, MaxBatchBytes);
+}
+
+bool BulkLoader::Run(MYSQL* Connection, BulkSource& Source, std::string* Error)
+{
+    if (!Connection)
+    {
+        if (Error)
+            *Error = "Unknown error. (No connection to the server).";
+        return false;
+    }
+
+    const std::vector<std::string>& Columns = Source.Columns();
+    if (Options.Table.empty() || Columns.empty())
+    {
+        if (Error)
+            *Error = Options.Table.empty() ? "No table to insert into." : "The source has no columns.";
+        return false;
+    }
+
+    Insert = "INSERT INTO ";
+    if (!Options.Database.empty())
+        Insert += QuoteIdentifier(Options.Database) + ".";
+    Insert += QuoteIdentifier(Options.Table) + " (";
+    for (size_t c = 0; c < Columns.size(); c++)
+        Insert += (c ? ", " : "") + QuoteIdentifier(Columns[c]);
+    Insert += ")";
+
+    const bool Bulk = BulkSupported(Connection);
+    const size_t Budget = Options.MaxBatchBytes ? Options.MaxBatchBytes : BatchBytes(Connection);
+
+    MYSQL_STMT* Statement = nullptr;
+    if (Bulk)
+    {
+        std::string Sql = Insert + " VALUES (";
+        for (size_t c = 0; c < Columns.size(); c++)
+            Sql += c ? ", ?" : "?";
+        Sql += ")";
+
+        Statement = mysql_stmt_init(Connection);
+        if (!Statement)
+        {
+            if (Error)
+                *Error = "Out of memory";
+            return false;
+        }
+        if (mysql_stmt_prepare(Statement, Sql.data(), (unsigned long)Sql.size()) != 0)
+        {
+            if (Error)
+                *Error = StatementError(Statement);
+            mysql_stmt_close(Statement);
+            return false;
+        }
+    }
+
+    if (Options.CommitEvery && mysql_autocommit(Connection, 0))
+    {
+        if (Error)
+            *Error = LastError(Connection);
+        if (Statement)
+            mysql_stmt_close(Statement);
+        return false;
+    }
+
+    Free = { &Slots[0], &Slots[1] };
+    Full.clear();
+    ReaderDone = false;
+    Stopping = false;
+    ReadError.clear();
+    // The statement id, flags and parameter types lead every bulk request.
+    const size_t RowBudget = Budget > 7 + 2 * Columns.size() ? Budget - 7 - 2 * Columns.size() : 1;
+    Reader = std::thread(&BulkLoader::RunReader, this, std::ref(Source), Columns.size(), RowBudget);
+
+    bool Succeeded = true;
+    std::string Failure;
+    unsigned Uncommitted = 0;
+    uint64_t UncommittedRows = 0;
+
+    while (Batch* Rows = TakeFull())
+    {
+        if (IsCancelled(Options.Cancel))
+        {
+            Succeeded = false;
+            Failure = "Cancelled";
+            break;
+        }
+
+        Succeeded = Bulk ? ExecuteBulk(Statement, *Rows, &Failure) : ExecuteText(Connection, *Rows, Budget, &Failure);
+        const size_t Count = Rows->Rows, Bytes = Rows->Bytes;
+        // The reader fills it again while this batch commits.
+        GiveBack(Rows);
+        if (!Succeeded)
+            break;
+
+        if (Progress)
+        {
+            Progress->Rows.fetch_add(Count, std::memory_order_relaxed);
+            Progress->Bytes.fetch_add(Bytes, std::memory_order_relaxed);
+            Progress->Batches.fetch_add(1, std::memory_order_relaxed);
+        }
+        UncommittedRows += Count;
+        if (!Options.CommitEvery || ++Uncommitted == Options.CommitEvery)
+        {
+            if (Options.CommitEvery && mysql_commit(Connection))
+            {
+                Succeeded = false;
+                Failure = LastError(Connection);
+                break;
+            }
+            if (Progress)
+                Progress->Committed.fetch_add(UncommittedRows, std::memory_order_relaxed);
+            Uncommitted = 0;
+            UncommittedRows = 0;
+        }
+    }
+
+    Stop();
+    if (Succeeded && !ReadError.empty())
+    {
+        Succeeded = false;
+        Failure = ReadError;
+    }
+    if (Succeeded && IsCancelled(Options.Cancel))
+    {
+        Succeeded = false;
+        Failure = "Cancelled";
+    }
+
+    if (Options.CommitEvery)
+    {
+        if (Succeeded && Uncommitted)
+        {
+            if (mysql_commit(Connection))
+            {
+                Succeeded = false;
+                Failure = LastError(Connection);
+            }
+            else if (Progress)
+            {
+                Progress->Committed.fetch_add(UncommittedRows, std::memory_order_relaxed);
+            }
+        }
+        if (!Succeeded)
+            mysql_rollback(Connection);
+        mysql_autocommit(Connection, 1);
+    }
+
+    if (Statement)
+        mysql_stmt_close(Statement);
+    if (!Succeeded && Error)
+        *Error = Failure;
+    return Succeeded;
+}
+
+void BulkLoader::RunReader(BulkSource& Source, size_t Columns, size_t BudgetBytes)
+{
+    std::vector<std::string_view> Cells;
+    std::string Malformed;
+    bool Pending = false;   // Cells holds a row that did not fit the last batch
+    const size_t MaxRows = std::max<size_t>(1, Options.MaxBatchRows);
+
+    while (Batch* Rows = TakeFree())
+    {
+        Rows->Reset(Columns);
+        bool End = false;
+
+        while (Rows->Rows < MaxRows)
+        {
+            if (!Pending)
+            {
+                if (!Source.Next(Cells, &Malformed))
+                {
+                    End = true;
+                    break;
+                }
+                if (Cells.size() != Columns)
+                {
+                    Malformed = "A row has " + std::to_string(Cells.size()) + " values for " + std::to_string(Columns) + " columns.";
+                    End = true;
+                    break;
+                }
+            }
+
+            size_t RowBytes = 0;
+            for (std::string_view Cell : Cells)
+                RowBytes += EncodedSize(Cell);
+            // A row larger than the budget still goes, alone.
+            if (Rows->Rows && Rows->Bytes + RowBytes > BudgetBytes)
+            {
+                Pending = true;
+                break;
+            }
+            Pending = false;
+
+            for (size_t c = 0; c < Columns; c++)
+            {
+                Rows->Offsets[c].push_back(Rows->Data.size());
+                Rows->Lengths[c].push_back((unsigned long)Cells[c].size());
+                Rows->Indicators[c].push_back(Cells[c].data() ? STMT_INDICATOR_NONE : STMT_INDICATOR_NULL);
+                Rows->Data.append(Cells[c]);
+            }
+            Rows->Rows++;
+            Rows->Bytes += RowBytes;
+
+            if ((Rows->Rows & 1023) == 0 && IsCancelled(Options.Cancel))
+            {
+                End = true;
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (Rows->Rows)
+            Full.push_back(Rows);
+        else
+            Free.push_back(Rows);
+        if (End)
+        {
+            ReaderDone = true;
+            ReadError = Malformed;
+        }
+        Changed.notify_all();
+        if (End)
+            return;
+    }
+}
+
+BulkLoader::Batch* BulkLoader::TakeFree()
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Changed.wait(Lock, [this] { return Stopping || !Free.empty(); });
+    if (Stopping)
+        return nullptr;
+    Batch* Rows = Free.back();
+    Free.pop_back();
+    return Rows;
+}
+
+BulkLoader::Batch* BulkLoader::TakeFull()
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Changed.wait(Lock, [this] { return Stopping || ReaderDone || !Full.empty(); });
+    if (Stopping || Full.empty())
+        return nullptr;
+    Batch* Rows = Full.front();
+    Full.pop_front();
+    return Rows;
+}
+
+void BulkLoader::GiveBack(Batch* Done)
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Free.push_back(Done);
+    Changed.notify_all();
+}
+
+void BulkLoader::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+        Changed.notify_all();
+    }
+    if (Reader.joinable())
+        Reader.join();
+}
+
+bool BulkLoader::ExecuteBulk(MYSQL_STMT* Statement, Batch& Rows, std::string* Error)
+{
+    const size_t Columns = Rows.Offsets.size();
+    std::vector<MYSQL_BIND> Binds(Columns);
+    for (size_t c = 0; c < Columns; c++)
+    {
+        // Variable-length values are bound column-wise as an array of pointers.
+        std::vector<char*>& Pointers = Rows.Pointers[c];
+        Pointers.resize(Rows.Rows);
+        for (size_t r = 0; r < Rows.Rows; r++)
+            Pointers[r] = Rows.Data.data() + Rows.Offsets[c][r];
+
+        MYSQL_BIND& Bind = Binds[c];
+        memset(&Bind, 0, sizeof(Bind));
+        Bind.buffer_type = MYSQL_TYPE_STRING;
+        Bind.buffer      = Pointers.data();
+        Bind.length      = Rows.Lengths[c].data();
+        Bind.u.indicator = Rows.Indicators[c].data();
+    }
+
+    unsigned int Size = (unsigned int)Rows.Rows;
+    if (mysql_stmt_attr_set(Statement, STMT_ATTR_ARRAY_SIZE, &Size) ||
+        mysql_stmt_bind_param(Statement, Binds.data()) ||
+        mysql_stmt_execute(Statement))
+    {
+        if (Error)
+            *Error = StatementError(Statement);
+        return false;
+    }
+    return true;
+}
+
+bool BulkLoader::ExecuteText(MYSQL* Connection, Batch& Rows, size_t BudgetBytes, std::string* Error)
+{
+    const size_t Columns = Rows.Offsets.size();
+    std::string Sql;
+    std::string Row;
+    std::string Escaped;
+
+    auto Send = [&]() {
+        if (mysql_real_query(Connection, Sql.data(), (unsigned long)Sql.size()) != 0)
+        {
+            if (Error)
+                *Error = LastError(Connection);
+            return false;
+        }
+        Sql.clear();
+        return true;
+    };
+
+    for (size_t r = 0; r < Rows.Rows; r++)
+    {
+        Row = "(";
+        for (size_t c = 0; c < Columns; c++)
+        {
+            if (c)
+                Row.push_back(',');
+            if (Rows.Indicators[c][r] == STMT_INDICATOR_NULL)
+            {
+                Row.append("NULL");
+                continue;
+            }
+            const unsigned long Length = Rows.Lengths[c][r];
+            Escaped.resize(2 * (size_t)Length + 1);
+            unsigned long Written = mysql_real_escape_string(Connection, Escaped.data(), Rows.Data.data() + Rows.Offsets[c][r], Length);
+            if (Written == (unsigned long)-1)
+            {
+                if (Error)
+                    *Error = "Cannot escape a value in the connection's character set.";
+                return false;
+            }
+            Row.push_back('\'');
+            Row.append(Escaped.data(), Written);
+            Row.push_back('\'');
+        }
+        Row.push_back(')');
+
+        // Escaping can grow a batch past its estimate; the overflow goes in another INSERT.
+        if (!Sql.empty() && Sql.size() + 1 + Row.size() > BudgetBytes && !Send())
+            return false;
+        Sql.append(Sql.empty() ? Insert + " VALUES " : ",");
+        Sql.append(Row);
+    }
+    return Sql.empty() || Send();
+}
@@ -0,0 +1,169 @@
+//
+//  BulkLoader.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "ResultExport.hpp"
+#include "CancelToken.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace DBCore
+{
+    struct BulkOptions
+    {
+        std::string        Database;                  // empty for the session's database
+        std::string        Table;
+        size_t             MaxBatchRows  = 100000;    // rows per execute
+        size_t             MaxBatchBytes = 0;         // per request; 0 = from the server's max_allowed_packet
+        unsigned           CommitEvery   = 4;         // batches per transaction; 0 leaves autocommit alone
+        const CancelToken* Cancel        = nullptr;
+    };
+
+    struct BulkProgress
+    {
+        std::atomic<uint64_t> Rows{0};        // sent to the server
+        std::atomic<uint64_t> Committed{0};   // in committed transactions (or sent, under autocommit)
+        std::atomic<uint64_t> Bytes{0};       // of values sent
+        std::atomic<uint64_t> Batches{0};
+    };
+
+    // Rows to insert, read one at a time on the loader's reader thread.
+    class BulkSource
+    {
+    public:
+        virtual ~BulkSource() = default;
+
+        // Target column of each value, in order.
+        virtual const std::vector<std::string>& Columns() const = 0;
+        // Fills Cells with the next row, one value per column and a null data()
+        // for NULL; they stay valid until the next call. False at the end, or
+        // with Error set when the input is malformed.
+        virtual bool Next(std::vector<std::string_view>& Cells, std::string* Error) = 0;
+    };
+
+    // CSV or TSV as ResultExporter writes them: a header row with the column
+    // names, then one row per line. CSV is RFC 4180 with an empty field for
+    // NULL; TSV uses the LOAD DATA escapes and \N.
+    class DelimitedSource : public BulkSource
+    {
+    public:
+        static constexpr size_t ReadBufferSize = 4u << 20;
+
+        ~DelimitedSource() override;
+
+        // Null, with Error set, when the file cannot be read or has no header.
+        static std::unique_ptr<DelimitedSource> Open(const std::string& Path, ExportFormat Format, std::string* Error);
+
+        const std::vector<std::string>& Columns() const override { return Names; }
+        bool Next(std::vector<std::string_view>& Cells, std::string* Error) override;
+
+    private:
+        DelimitedSource() = default;
+
+        // Parses one record at Position into Values/Nulls. False when the
+        // buffer ends inside it; Error is set for malformed input.
+        bool ParseRecord(size_t& Position, std::string* Error);
+        bool Fill(std::string* Error);
+
+        ExportFormat Format     = ExportFormat::Csv;
+        int          Descriptor = -1;
+        bool         AtEnd      = false;      // nothing left to read from the file
+        uint64_t     Record     = 0;          // records read, the header included
+        std::string  Buffer;
+        size_t       Consumed   = 0;
+
+        std::vector<std::string> Names;
+        std::string              Values;      // unescaped values of the current record
+        std::vector<size_t>      Ends;        // of each value in Values
+        std::vector<char>        Nulls;
+    };
+
+    // Inserts a source's rows through MariaDB's bulk execute: one prepared
+    // INSERT, bound column-wise with STMT_ATTR_ARRAY_SIZE and indicator
+    // arrays, so each COM_STMT_BULK_EXECUTE carries a whole batch. Batches
+    // are sized to fit max_allowed_packet. A reader thread parses the next
+    // batch while the current one executes and commits, and a transaction
+    // is committed every CommitEvery batches. Servers without bulk
+    // operations (MySQL, MariaDB before 10.2) get multi-row INSERTs instead.
+    //
+    // A failed load rolls back the open transaction; rows already committed
+    // stay, as Progress->Committed tells.
+    class BulkLoader
+    {
+    public:
+        // Request size used when max_allowed_packet cannot be read, and the
+        // most a batch takes however much the server allows.
+        static constexpr size_t DefaultBatchBytes = 4u << 20;
+        static constexpr size_t MaxBatchBytes     = 64u << 20;
+
+        explicit BulkLoader(BulkOptions Options, BulkProgress* Progress = nullptr);
+        ~BulkLoader();
+
+        BulkLoader(const BulkLoader&) = delete;
+        BulkLoader& operator=(const BulkLoader&) = delete;
+
+        bool Run(MYSQL* Connection, BulkSource& Source, std::string* Error);
+
+        // The server takes COM_STMT_BULK_EXECUTE.
+        static bool BulkSupported(MYSQL* Connection);
+        // Bytes a batch request may take on Connection: three quarters of
+        // max_allowed_packet, at most MaxBatchBytes.
+        static size_t BatchBytes(MYSQL* Connection);
+
+    private:
+        // One batch, stored column-wise as the array binding reads it.
+        struct Batch
+        {
+            std::string                             Data;
+            std::vector<std::vector<size_t>>        Offsets;
+            std::vector<std::vector<unsigned long>> Lengths;
+            std::vector<std::vector<char>>          Indicators;
+            std::vector<std::vector<char*>>         Pointers;
+            size_t                                  Rows  = 0;
+            size_t                                  Bytes = 0;
+
+            void Reset(size_t Columns);
+        };
+
+        void RunReader(BulkSource& Source, size_t Columns, size_t BudgetBytes);
+        Batch* TakeFree();
+        Batch* TakeFull();
+        void   GiveBack(Batch* Done);
+        void   Stop();
+
+        bool ExecuteBulk(MYSQL_STMT* Statement, Batch& Rows, std::string* Error);
+        bool ExecuteText(MYSQL* Connection, Batch& Rows, size_t BudgetBytes, std::string* Error);
+
+        BulkOptions   Options;
+        BulkProgress* Progress;
+
+        std::string   Insert;           // INSERT INTO `table` (`a`, `b`)
+
+        std::mutex              Mutex;
+        std::condition_variable Changed;
+        Batch                   Slots[2];
+        std::vector<Batch*>     Free;
+        std::deque<Batch*>      Full;   // in fill order
+        bool                    ReaderDone = false;
+        bool                    Stopping   = false;
+        std::string             ReadError;
+
+        std::thread Reader;
+    };
+}
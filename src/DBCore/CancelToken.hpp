@@ -0,0 +1,26 @@
+//
+//  CancelToken.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <atomic>
+
+namespace DBCore
+{
+    // Shared between whoever requests the cancel and the loop that polls it.
+    class CancelToken
+    {
+    public:
+        void Cancel() { Flag.store(true, std::memory_order_release); }
+        bool Cancelled() const { return Flag.load(std::memory_order_acquire); }
+
+    private:
+        std::atomic_bool Flag{false};
+    };
+
+    inline bool IsCancelled(const CancelToken* Token) { return Token && Token->Cancelled(); }
+}
@@ -0,0 +1,567 @@
+//
+//  ColumnStats.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ColumnStats.hpp"
+#include "ResultSorter.hpp"
+#include "ThreadPool.hpp"
+#include "ValueParser.hpp"
+
+#include <boost/histogram.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <mutex>
+#include <string_view>
+
+using namespace DBCore;
+
+// Blocks reduced per wave, per pool thread.
+static constexpr size_t WaveBlocksPerThread = 2;
+
+bool DBCore::NumericValue(const ColumnInfo& Column, const CellView& Cell, double& Value)
+{
+    if (Cell.Null)
+        return false;
+
+    switch (Column.Encoding)
+    {
+        case ColumnEncoding::Int64:  Value = (double)Cell.As<int64_t>(); return true;
+        case ColumnEncoding::UInt64: Value = (double)Cell.As<uint64_t>(); return true;
+        case ColumnEncoding::Double: Value = Cell.As<double>(); return true;
+        case ColumnEncoding::DateTime:
+        case ColumnEncoding::Time:   return false;
+        case ColumnEncoding::Text:   break;
+    }
+
+    SortKeyKind Kind = SortKeyKindForColumn(Column);
+    if (Kind != SortKeyKind::Signed && Kind != SortKeyKind::Unsigned && Kind != SortKeyKind::Real)
+        return false;
+
+    return ParseDouble(Cell.Text(), Value);
+}
+
+double ColumnStats::StandardDeviation() const
+{
+    return Numeric && Count ? std::sqrt(M2 / (double)Count) : 0.0;
+}
+
+// Reductions over the native arrays of typed columns. Four independent lanes
+// keep the loops free of cross-iteration dependencies, so they compile to
+// packed min/max/add on SSE/AVX and NEON.
+template<typename T>
+static void Extremes(const T* Values, size_t Count, T& Min, T& Max)
+{
+    T Low[4]  = { Values[0], Values[0], Values[0], Values[0] };
+    T High[4] = { Values[0], Values[0], Values[0], Values[0] };
+    size_t i = 0;
+    for (; i + 4 <= Count; i += 4)
+    {
+        for (int l = 0; l < 4; l++)
+        {
+            T Value = Values[i + l];
+            Low[l]  = Value < Low[l] ? Value : Low[l];
+            High[l] = Value > High[l] ? Value : High[l];
+        }
+    }
+    for (; i < Count; i++)
+    {
+        Low[0]  = Values[i] < Low[0] ? Values[i] : Low[0];
+        High[0] = Values[i] > High[0] ? Values[i] : High[0];
+    }
+    Min = std::min(std::min(Low[0], Low[1]), std::min(Low[2], Low[3]));
+    Max = std::max(std::max(High[0], High[1]), std::max(High[2], High[3]));
+}
+
+static double Sum(const double* Values, size_t Count)
+{
+    double Lanes[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= Count; i += 4)
+        for (int l = 0; l < 4; l++)
+            Lanes[l] += Values[i + l];
+    for (; i < Count; i++)
+        Lanes[0] += Values[i];
+    return (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+}
+
+static double SquaredDeviations(const double* Values, size_t Count, double Mean)
+{
+    double Lanes[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= Count; i += 4)
+    {
+        for (int l = 0; l < 4; l++)
+        {
+            double Delta = Values[i + l] - Mean;
+            Lanes[l] += Delta * Delta;
+        }
+    }
+    for (; i < Count; i++)
+        Lanes[0] += (Values[i] - Mean) * (Values[i] - Mean);
+    return (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+}
+
+static uint64_t Mix(uint64_t Hash)
+{
+    Hash ^= Hash >> 30;
+    Hash *= 0xbf58476d1ce4e5b9ull;
+    Hash ^= Hash >> 27;
+    Hash *= 0x94d049bb133111ebull;
+    return Hash ^ (Hash >> 31);
+}
+
+template<size_t Size>
+static void AddToSketch(std::array<uint8_t, Size>& Registers, uint64_t Hash)
+{
+    constexpr uint32_t Precision = std::countr_zero(Size);
+    uint64_t Rest = Hash << Precision;
+    uint8_t Rank = Rest ? (uint8_t)(std::countl_zero(Rest) + 1) : (uint8_t)(64 - Precision + 1);
+    uint8_t& Register = Registers[Hash >> (64 - Precision)];
+    Register = std::max(Register, Rank);
+}
+
+template<size_t Size>
+static uint64_t EstimateDistinct(const std::array<uint8_t, Size>& Registers)
+{
+    const double m = (double)Size;
+    double Harmonic = 0.0;
+    size_t Zeros = 0;
+    for (uint8_t Register : Registers)
+    {
+        Harmonic += std::ldexp(1.0, -Register);
+        Zeros += Register == 0;
+    }
+    double Estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / Harmonic;
+    // Linear counting is more accurate while many registers are still empty.
+    if (Estimate <= 2.5 * m && Zeros)
+        Estimate = m * std::log(m / (double)Zeros);
+    return (uint64_t)std::llround(Estimate);
+}
+
+// Misra-Gries reduction: drops everything at or below the count of the
+// (Capacity + 1)th most frequent entry and lowers the rest by that much,
+// so summaries of disjoint row ranges can be merged. True when it dropped.
+template<typename Key>
+static bool ReduceFrequent(std::vector<std::pair<Key, uint64_t>>& Entries, size_t Capacity)
+{
+    if (Entries.size() <= Capacity)
+        return false;
+
+    auto ByCount = [](const auto& a, const auto& b) { return a.second > b.second; };
+    std::nth_element(Entries.begin(), Entries.begin() + Capacity, Entries.end(), ByCount);
+    const uint64_t Cut = Entries[Capacity].second;
+
+    size_t Kept = 0;
+    for (auto& Entry : Entries)
+    {
+        if (Entry.second > Cut)
+            Entries[Kept++] = { std::move(Entry.first), Entry.second - Cut };
+    }
+    Entries.resize(Kept);
+    return true;
+}
+
+namespace
+{
+    struct ColumnPart
+    {
+        uint64_t    Count = 0;
+        uint64_t    Nulls = 0;
+        bool        HasRange = false;
+        std::string Min;
+        std::string Max;
+        double      NumericMin = 0.0;
+        double      NumericMax = 0.0;
+        double      Mean = 0.0;
+        double      M2 = 0.0;
+        std::array<uint8_t, 1u << ColumnStatsCollector::HllPrecision> Registers{};
+        std::vector<std::pair<std::string_view, uint64_t>> Frequent;
+        bool        FrequentExact = true;
+    };
+
+    enum class RangeOrder : uint8_t { Signed, Unsigned, Real, Number, Bytes };
+
+    RangeOrder RangeOrderFor(const ColumnInfo& Column, bool Numeric)
+    {
+        switch (Column.Encoding)
+        {
+            case ColumnEncoding::Int64:
+            case ColumnEncoding::DateTime:
+            case ColumnEncoding::Time:   return RangeOrder::Signed;
+            case ColumnEncoding::UInt64: return RangeOrder::Unsigned;
+            case ColumnEncoding::Double: return RangeOrder::Real;
+            case ColumnEncoding::Text:   break;
+        }
+        return Numeric ? RangeOrder::Number : RangeOrder::Bytes;
+    }
+
+    bool IsNumericColumn(const ColumnInfo& Column)
+    {
+        SortKeyKind Kind = SortKeyKindForColumn(Column);
+        return Kind == SortKeyKind::Signed || Kind == SortKeyKind::Unsigned || Kind == SortKeyKind::Real;
+    }
+
+    template<typename T>
+    T Native(std::string_view Raw)
+    {
+        T Value{};
+        memcpy(&Value, Raw.data(), std::min(Raw.size(), sizeof(T)));
+        return Value;
+    }
+
+    // Negative when a orders before b.
+    int CompareRaw(RangeOrder Order, std::string_view a, double NumberA, std::string_view b, double NumberB)
+    {
+        switch (Order)
+        {
+            case RangeOrder::Signed:   { auto x = Native<int64_t>(a), y = Native<int64_t>(b); return (x > y) - (x < y); }
+            case RangeOrder::Unsigned: { auto x = Native<uint64_t>(a), y = Native<uint64_t>(b); return (x > y) - (x < y); }
+            case RangeOrder::Real:     { auto x = Native<double>(a), y = Native<double>(b); return (x > y) - (x < y); }
+            case RangeOrder::Number:   return (NumberA > NumberB) - (NumberA < NumberB);
+            case RangeOrder::Bytes:    return a.compare(b);
+        }
+        return 0;
+    }
+
+    template<typename T>
+    void TypedExtremes(const ColumnBlock& Values, uint32_t Rows, bool AnyNull, ColumnPart& Part)
+    {
+        const T* Data = Values.Values<T>();
+        T Min{}, Max{};
+        bool Found = false;
+        if (!AnyNull)
+        {
+            Extremes(Data, Rows, Min, Max);
+            Found = true;
+        }
+        else
+        {
+            for (uint32_t r = 0; r < Rows; r++)
+            {
+                if (Values.IsNull(r))
+                    continue;
+                if (!Found || Data[r] < Min)
+                    Min = Data[r];
+                if (!Found || Data[r] > Max)
+                    Max = Data[r];
+                Found = true;
+            }
+        }
+        if (!Found)
+            return;
+        Part.HasRange = true;
+        Part.Min.assign(reinterpret_cast<const char*>(&Min), sizeof(T));
+        Part.Max.assign(reinterpret_cast<const char*>(&Max), sizeof(T));
+        Part.NumericMin = (double)Min;
+        Part.NumericMax = (double)Max;
+    }
+
+    void SummarizeColumn(const ColumnInfo& Column, const ColumnBlock& Values, uint32_t Rows, ColumnPart& Part)
+    {
+        const uint8_t* NullBits = Values.NullData();
+        for (uint32_t i = 0; i < (Rows + 7) / 8; i++)
+            Part.Nulls += (uint64_t)std::popcount(NullBits[i]);
+        Part.Count = Rows - Part.Nulls;
+        if (!Part.Count)
+            return;
+
+        const bool AnyNull = Part.Nulls != 0;
+        const bool Numeric = IsNumericColumn(Column);
+
+        // Range
+        switch (Column.Encoding)
+        {
+            case ColumnEncoding::Int64:
+            case ColumnEncoding::DateTime:
+            case ColumnEncoding::Time:   TypedExtremes<int64_t>(Values, Rows, AnyNull, Part); break;
+            case ColumnEncoding::UInt64: TypedExtremes<uint64_t>(Values, Rows, AnyNull, Part); break;
+            case ColumnEncoding::Double: TypedExtremes<double>(Values, Rows, AnyNull, Part); break;
+            case ColumnEncoding::Text:   break;
+        }
+
+        // Mean and squared deviations, two passes over the block's values.
+        std::vector<double> Numbers;
+        if (Numeric)
+        {
+            Numbers.reserve(Part.Count);
+            if (Column.Encoding == ColumnEncoding::Double && !AnyNull)
+            {
+                Numbers.assign(Values.Values<double>(), Values.Values<double>() + Rows);
+            }
+            else if (Column.Encoding == ColumnEncoding::Int64 && !AnyNull)
+            {
+                const int64_t* Data = Values.Values<int64_t>();
+                Numbers.resize(Rows);
+                for (uint32_t r = 0; r < Rows; r++)
+                    Numbers[r] = (double)Data[r];
+            }
+            else
+            {
+                double Value;
+                for (uint32_t r = 0; r < Rows; r++)
+                {
+                    CellView Cell = Values.Cell(r);
+                    if (!NumericValue(Column, Cell, Value))
+                        continue;
+                    // Decimal text has no native array; its range is found here.
+                    if (Column.Encoding == ColumnEncoding::Text && (!Part.HasRange || Value < Part.NumericMin))
+                    {
+                        Part.NumericMin = Value;
+                        Part.Min.assign(Cell.Data, Cell.Length);
+                    }
+                    if (Column.Encoding == ColumnEncoding::Text && (!Part.HasRange || Value > Part.NumericMax))
+                    {
+                        Part.NumericMax = Value;
+                        Part.Max.assign(Cell.Data, Cell.Length);
+                    }
+                    Part.HasRange = true;
+                    Numbers.push_back(Value);
+                }
+            }
+            if (!Numbers.empty())
+            {
+                Part.Mean = Sum(Numbers.data(), Numbers.size()) / (double)Numbers.size();
+                Part.M2 = SquaredDeviations(Numbers.data(), Numbers.size(), Part.Mean);
+            }
+        }
+
+        // Bytewise range of text, distinct sketch and value counts.
+        std::unordered_map<std::string_view, uint64_t> Counts;
+        Counts.reserve(std::min<uint64_t>(Part.Count, 4096));
+        std::string_view Min, Max;
+        for (uint32_t r = 0; r < Rows; r++)
+        {
+            CellView Cell = Values.Cell(r);
+            if (Cell.Null)
+                continue;
+            std::string_view Raw(Cell.Data, Cell.Length);
+            if (Column.Encoding == ColumnEncoding::Text && !Numeric)
+            {
+                if (Min.data() == nullptr || Raw < Min)
+                    Min = Raw;
+                if (Max.data() == nullptr || Raw > Max)
+                    Max = Raw;
+            }
+            uint64_t Hash = Values.ValueWidth() ? Mix(Native<uint64_t>(Raw)) : Mix(std::hash<std::string_view>()(Raw));
+            AddToSketch(Part.Registers, Hash);
+            Counts[Raw]++;
+        }
+        if (Min.data())
+        {
+            Part.HasRange = true;
+            Part.Min = Min;
+            Part.Max = Max;
+        }
+
+        Part.Frequent.assign(Counts.begin(), Counts.end());
+        Part.FrequentExact = !ReduceFrequent(Part.Frequent, ColumnStatsCollector::TopCapacity);
+    }
+}
+
+struct ColumnStatsCollector::BlockSummary
+{
+    uint32_t                Rows = 0;
+    std::vector<ColumnPart> Columns;
+};
+
+void ColumnStatsCollector::Reset()
+{
+    Accumulators.clear();
+    BlocksSeen = 0;
+    RowsSeen = 0;
+}
+
+void ColumnStatsCollector::Merge(const std::vector<ColumnInfo>& Columns, BlockSummary& Block)
+{
+    for (size_t c = 0; c < Columns.size(); c++)
+    {
+        Accumulator& Into = Accumulators[c];
+        ColumnStats& Stats = Into.Stats;
+        ColumnPart& Part = Block.Columns[c];
+
+        Stats.Nulls += Part.Nulls;
+        if (Part.Count)
+        {
+            // Chan et al.'s pairwise update of mean and squared deviations.
+            const double Total = (double)(Stats.Count + Part.Count);
+            const double Delta = Part.Mean - Stats.Mean;
+            Stats.M2 += Part.M2 + Delta * Delta * (double)Stats.Count * (double)Part.Count / Total;
+            Stats.Mean += Delta * (double)Part.Count / Total;
+            Stats.Count += Part.Count;
+        }
+        Stats.Numeric = IsNumericColumn(Columns[c]);
+
+        if (Part.HasRange)
+        {
+            RangeOrder Order = RangeOrderFor(Columns[c], Stats.Numeric);
+            if (!Stats.HasRange || CompareRaw(Order, Part.Min, Part.NumericMin, Stats.Min, Into.NumericMin) < 0)
+            {
+                Stats.Min = std::move(Part.Min);
+                Into.NumericMin = Part.NumericMin;
+            }
+            if (!Stats.HasRange || CompareRaw(Order, Part.Max, Part.NumericMax, Stats.Max, Into.NumericMax) > 0)
+            {
+                Stats.Max = std::move(Part.Max);
+                Into.NumericMax = Part.NumericMax;
+            }
+            Stats.HasRange = true;
+        }
+
+        for (size_t i = 0; i < Into.Registers.size(); i++)
+            Into.Registers[i] = std::max(Into.Registers[i], Part.Registers[i]);
+
+        for (const auto& [Value, Count] : Part.Frequent)
+            Into.Frequent[std::string(Value)] += Count;
+        Stats.TopExact = Stats.TopExact && Part.FrequentExact;
+        if (Into.Frequent.size() > TopCapacity)
+        {
+            std::vector<std::pair<std::string, uint64_t>> Entries(std::make_move_iterator(Into.Frequent.begin()),
+                                                                  std::make_move_iterator(Into.Frequent.end()));
+            Stats.TopExact = !ReduceFrequent(Entries, TopCapacity) && Stats.TopExact;
+            Into.Frequent.clear();
+            for (auto& Entry : Entries)
+                Into.Frequent.emplace(std::move(Entry.first), Entry.second);
+        }
+    }
+}
+
+bool ColumnStatsCollector::BuildHistograms(const ResultStore& Store, const CancelToken* Cancel)
+{
+    using namespace boost::histogram;
+    using Histogram = decltype(make_histogram(axis::regular<>(1, 0.0, 1.0)));
+
+    const auto& Columns = Store.Columns();
+    const auto& Blocks = Store.Blocks();
+
+    std::vector<size_t> Numeric;
+    std::vector<Histogram> Totals;
+    for (size_t c = 0; c < Columns.size(); c++)
+    {
+        const Accumulator& Into = Accumulators[c];
+        if (!Into.Stats.Numeric || !Into.Stats.Count)
+            continue;
+        double Low = Into.NumericMin;
+        double High = Into.NumericMax > Low ? Into.NumericMax : Low + 1.0;
+        // The upper edge is exclusive, so nudge it past the maximum.
+        Numeric.push_back(c);
+        Totals.push_back(make_histogram(axis::regular<>(HistogramBins, Low, std::nextafter(High, INFINITY))));
+    }
+    if (Numeric.empty())
+        return true;
+
+    std::mutex TotalsMutex;
+    ThreadPool::Shared().ParallelFor(Blocks.size(), 1, [&](uint64_t Begin, uint64_t End) {
+        std::vector<Histogram> Local;
+        for (const Histogram& Total : Totals)
+            Local.push_back(make_histogram(Total.axis()));
+
+        double Value;
+        for (uint64_t b = Begin; b < End && !IsCancelled(Cancel); b++)
+        {
+            const ResultBlock& Block = *Blocks[b];
+            for (size_t i = 0; i < Numeric.size(); i++)
+            {
+                const ColumnBlock& Values = Block.Columns[Numeric[i]];
+                for (uint32_t r = 0; r < Block.RowCount; r++)
+                {
+                    if (NumericValue(Columns[Numeric[i]], Values.Cell(r), Value))
+                        Local[i](Value);
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> Lock(TotalsMutex);
+        for (size_t i = 0; i < Numeric.size(); i++)
+            Totals[i] += Local[i];
+    });
+    if (IsCancelled(Cancel))
+        return false;
+
+    for (size_t i = 0; i < Numeric.size(); i++)
+    {
+        ColumnStats& Stats = Accumulators[Numeric[i]].Stats;
+        Stats.Histogram.clear();
+        for (auto&& Bin : indexed(Totals[i]))
+            Stats.Histogram.push_back((uint64_t)*Bin);
+        Stats.HistogramLow = Totals[i].axis().value(0);
+        Stats.HistogramHigh = Totals[i].axis().value(HistogramBins);
+    }
+    return true;
+}
+
+std::shared_ptr<const ResultStats> ColumnStatsCollector::Snapshot(uint64_t Rows, bool Complete) const
+{
+    auto Stats = std::make_shared<ResultStats>();
+    Stats->Rows = Rows;
+    Stats->Complete = Complete;
+    Stats->Columns.reserve(Accumulators.size());
+    for (const Accumulator& Into : Accumulators)
+    {
+        ColumnStats Column = Into.Stats;
+        Column.DistinctEstimate = std::min<uint64_t>(EstimateDistinct(Into.Registers), Column.Count);
+
+        Column.TopValues.assign(Into.Frequent.begin(), Into.Frequent.end());
+        size_t Shown = std::min(Column.TopValues.size(), TopValues);
+        std::partial_sort(Column.TopValues.begin(), Column.TopValues.begin() + Shown, Column.TopValues.end(),
+                          [](const auto& a, const auto& b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+        Column.TopValues.resize(Shown);
+        Stats->Columns.push_back(std::move(Column));
+    }
+    return Stats;
+}
+
+bool ColumnStatsCollector::Update(const ResultStore& Store, bool Complete, const Progress& Publish, const CancelToken* Cancel)
+{
+    const auto& Columns = Store.Columns();
+    const auto& Blocks = Store.Blocks();
+    if (Accumulators.size() != Columns.size())
+    {
+        Accumulators.clear();
+        Accumulators.resize(Columns.size());
+        BlocksSeen = 0;
+        RowsSeen = 0;
+    }
+
+    ThreadPool& Pool = ThreadPool::Shared();
+    const size_t Wave = std::max<size_t>(Pool.ThreadCount() * WaveBlocksPerThread, 1);
+    while (BlocksSeen < Blocks.size())
+    {
+        const size_t First = BlocksSeen;
+        const size_t Last = std::min(First + Wave, Blocks.size());
+        std::vector<BlockSummary> Summaries(Last - First);
+
+        Pool.ParallelFor(Last - First, 1, [&](uint64_t Begin, uint64_t End) {
+            for (uint64_t i = Begin; i < End && !IsCancelled(Cancel); i++)
+            {
+                const ResultBlock& Block = *Blocks[First + i];
+                BlockSummary& Summary = Summaries[i];
+                Summary.Rows = Block.RowCount;
+                Summary.Columns.resize(Columns.size());
+                for (size_t c = 0; c < Columns.size(); c++)
+                    SummarizeColumn(Columns[c], Block.Columns[c], Block.RowCount, Summary.Columns[c]);
+            }
+        });
+        if (IsCancelled(Cancel))
+            return false;
+
+        // Merged in block order, so ties in the range keep the first value fetched.
+        for (BlockSummary& Summary : Summaries)
+        {
+            Merge(Columns, Summary);
+            RowsSeen += Summary.Rows;
+        }
+        BlocksSeen = Last;
+        if (BlocksSeen < Blocks.size())
+            Publish(Snapshot(RowsSeen, false));
+    }
+
+    if (Complete && !BuildHistograms(Store, Cancel))
+        return false;
+    Publish(Snapshot(RowsSeen, Complete));
+    return true;
+}
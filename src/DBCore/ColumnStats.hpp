@@ -0,0 +1,109 @@
+//
+//  ColumnStats.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+#include "CancelToken.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DBCore
+{
+    // Numeric value of a cell of an integer, decimal or floating point column.
+    // False for NULLs and for columns of any other type.
+    bool NumericValue(const ColumnInfo& Column, const CellView& Cell, double& Value);
+
+    struct ColumnStats
+    {
+        uint64_t Count = 0;             // non-NULL values
+        uint64_t Nulls = 0;
+
+        // Smallest and largest value as raw cells in the column's encoding; show
+        // them with FormatCell(). Numbers compare by value, text bytewise.
+        bool        HasRange = false;
+        std::string Min;
+        std::string Max;
+
+        // Integer, decimal and floating point columns only.
+        bool   Numeric = false;
+        double Mean    = 0.0;
+        double M2      = 0.0;           // sum of squared deviations from Mean
+
+        uint64_t DistinctEstimate = 0;  // HyperLogLog, about 1.6% standard error
+
+        // Most frequent values (raw cells) with lower bounds on their counts;
+        // the bounds are exact while TopExact is set.
+        std::vector<std::pair<std::string, uint64_t>> TopValues;
+        bool TopExact = true;
+
+        // Equal-width bins over [Min, Max] of numeric columns, built once the
+        // result is complete since the range is only known then.
+        std::vector<uint64_t> Histogram;
+        double HistogramLow  = 0.0;
+        double HistogramHigh = 0.0;
+
+        // Population standard deviation, like STDDEV().
+        double StandardDeviation() const;
+        double NullFraction() const { return Count + Nulls ? (double)Nulls / (double)(Count + Nulls) : 0.0; }
+    };
+
+    struct ResultStats
+    {
+        uint64_t                 Rows = 0;
+        std::vector<ColumnStats> Columns;
+        bool                     Complete = false;
+    };
+
+    // Folds the blocks of a growing result into per-column statistics. Blocks
+    // are only ever appended to a result, so each update looks at the blocks
+    // it has not seen yet; they are reduced in parallel and merged in waves.
+    // Only one thread may use a collector at a time.
+    class ColumnStatsCollector
+    {
+    public:
+        static constexpr uint32_t HllPrecision   = 12;
+        static constexpr size_t   TopCapacity    = 64;
+        static constexpr size_t   TopValues      = 10;
+        static constexpr size_t   HistogramBins  = 32;
+
+        using Progress = std::function<void(std::shared_ptr<const ResultStats>)>;
+
+        void Reset();
+
+        // Complete marks the last update of the result, which also builds the
+        // histograms. Returns false when cancelled; what was merged is kept.
+        bool Update(const ResultStore& Store, bool Complete, const Progress& Publish, const CancelToken* Cancel);
+
+    private:
+        struct Accumulator
+        {
+            ColumnStats                               Stats;
+            double                                    NumericMin = 0.0;
+            double                                    NumericMax = 0.0;
+            std::array<uint8_t, 1u << HllPrecision>   Registers{};
+            std::unordered_map<std::string, uint64_t> Frequent;
+        };
+
+        struct BlockSummary;
+
+        void Merge(const std::vector<ColumnInfo>& Columns, BlockSummary& Block);
+        bool BuildHistograms(const ResultStore& Store, const CancelToken* Cancel);
+        std::shared_ptr<const ResultStats> Snapshot(uint64_t Rows, bool Complete) const;
+
+        std::vector<Accumulator> Accumulators;
+        size_t                   BlocksSeen = 0;
+        uint64_t                 RowsSeen   = 0;
+    };
+}
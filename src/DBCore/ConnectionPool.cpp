@@ -0,0 +1,312 @@
+//
+//  ConnectionPool.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ConnectionPool.hpp"
+
+#include <algorithm>
+
+using namespace DBCore;
+
+// How often a blocked Acquire() looks at its CancelToken.
+static constexpr std::chrono::milliseconds CancelPollInterval(100);
+
+void DBCore::ApplyConnectionOptions(MYSQL* Mysql)
+{
+    int Protocol = MYSQL_PROTOCOL_TCP;
+    mysql_options(Mysql, MYSQL_OPT_COMPRESS, nullptr);
+    mysql_options(Mysql, MYSQL_OPT_PROTOCOL, &Protocol);
+    mysql_options(Mysql, MYSQL_SET_CHARSET_NAME, "utf8");
+}
+
+MYSQL* DBCore::OpenConnection(const ConnectionEndpoint& Endpoint, std::string* Error)
+{
+    MYSQL* Mysql = mysql_init(nullptr);
+    if (!Mysql)
+    {
+        if (Error)
+            *Error = "Out of memory";
+        return nullptr;
+    }
+
+    ApplyConnectionOptions(Mysql);
+    if (!mysql_real_connect(Mysql, Endpoint.Host.c_str(), Endpoint.User.c_str(), Endpoint.Password.c_str(),
+                            Endpoint.Database.empty() ? nullptr : Endpoint.Database.c_str(),
+                            Endpoint.Port ? Endpoint.Port : 3306, nullptr, ConnectionFlags))
+    {
+        if (Error)
+            *Error = mysql_error(Mysql);
+        mysql_close(Mysql);
+        return nullptr;
+    }
+    return Mysql;
+}
+
+bool DBCore::IsConnectionLost(MYSQL* Mysql)
+{
+    // CR_SERVER_GONE_ERROR and CR_SERVER_LOST; errmsg.h is not among MariaDBKit's public headers.
+    const unsigned int Code = mysql_errno(Mysql);
+    return Code == 2006 || Code == 2013;
+}
+
+PooledConnection::~PooledConnection()
+{
+    // Before the handle goes back and someone else's session starts on it.
+    Cache.reset();
+    if (Pool && Mysql)
+        Pool->Release(Mysql, Broken.load());
+}
+
+const ConnectionEndpoint& PooledConnection::Endpoint() const
+{
+    return Pool->Endpoint();
+}
+
+StatementCache& PooledConnection::Statements()
+{
+    if (!Cache)
+        Cache = std::make_unique<StatementCache>(Pool->Options.StatementCacheSize, &Pool->Stats.Statements);
+    return *Cache;
+}
+
+std::shared_ptr<ConnectionPool> ConnectionPool::Create(ConnectionEndpoint Endpoint, PoolOptions Options)
+{
+    return std::shared_ptr<ConnectionPool>(new ConnectionPool(std::move(Endpoint), Options));
+}
+
+ConnectionPool::ConnectionPool(ConnectionEndpoint Endpoint, PoolOptions Options)
+    : Target(std::move(Endpoint)), Options(Options)
+{
+    NextCheck = std::chrono::steady_clock::now() + Options.HealthCheckInterval;
+    Maintainer = std::thread(&ConnectionPool::Maintain, this);
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+    Wake.notify_all();
+    if (Maintainer.joinable())
+        Maintainer.join();
+
+    // Every lease holds the pool, so nothing is leased any more.
+    for (MYSQL* Mysql : Idle)
+        Close(Mysql);
+    for (MYSQL* Mysql : Returned)
+        Close(Mysql);
+}
+
+std::shared_ptr<PooledConnection> ConnectionPool::Acquire(std::string* Error, const CancelToken* Cancel)
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true)
+    {
+        if (IsCancelled(Cancel))
+        {
+            if (Error)
+                *Error = "Cancelled";
+            return nullptr;
+        }
+
+        if (!Idle.empty())
+        {
+            MYSQL* Mysql = Idle.back();
+            Idle.pop_back();
+            Stats.Reused.fetch_add(1, std::memory_order_relaxed);
+            // Lets the maintainer open a replacement.
+            Wake.notify_one();
+            return std::shared_ptr<PooledConnection>(new PooledConnection(shared_from_this(), Mysql));
+        }
+
+        // Nothing clean yet; resetting one here beats a handshake.
+        if (!Returned.empty())
+        {
+            MYSQL* Mysql = Returned.back();
+            Returned.pop_back();
+            Lock.unlock();
+            const bool Usable = Clean(Mysql);
+            if (!Usable)
+                Close(Mysql);
+            Lock.lock();
+            if (Usable)
+            {
+                Stats.Reused.fetch_add(1, std::memory_order_relaxed);
+                return std::shared_ptr<PooledConnection>(new PooledConnection(shared_from_this(), Mysql));
+            }
+            Open--;
+            Stats.Dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (Open < Options.MaxConnections)
+        {
+            Open++;
+            Lock.unlock();
+            MYSQL* Mysql = OpenConnection(Target, Error);
+            Lock.lock();
+            if (!Mysql)
+            {
+                Open--;
+                Available.notify_one();
+                return nullptr;
+            }
+            Stats.Opened.fetch_add(1, std::memory_order_relaxed);
+            Wake.notify_one();
+            return std::shared_ptr<PooledConnection>(new PooledConnection(shared_from_this(), Mysql));
+        }
+
+        Available.wait_for(Lock, CancelPollInterval);
+    }
+}
+
+size_t ConnectionPool::IdleCount() const
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Idle.size();
+}
+
+size_t ConnectionPool::OpenCount() const
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Open;
+}
+
+void ConnectionPool::Release(MYSQL* Mysql, bool Broken)
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (!Broken)
+        {
+            Returned.push_back(Mysql);
+            Wake.notify_one();
+            Available.notify_one();
+            return;
+        }
+        Open--;
+        Stats.Dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    Close(Mysql);
+    Available.notify_one();
+}
+
+void ConnectionPool::Maintain()
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (!Stopping)
+    {
+        const auto Now = std::chrono::steady_clock::now();
+
+        // Returned connections first, as someone may be waiting for one.
+        if (!Returned.empty())
+        {
+            MYSQL* Mysql = Returned.back();
+            Returned.pop_back();
+            Lock.unlock();
+            const bool Usable = Clean(Mysql);
+            if (!Usable)
+                Close(Mysql);
+            Lock.lock();
+            if (Usable)
+            {
+                Idle.push_back(Mysql);
+            }
+            else
+            {
+                Open--;
+                Stats.Dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            Available.notify_one();
+            continue;
+        }
+
+        const bool Warming = Idle.size() < Options.WarmConnections && Open < Options.MaxConnections;
+        if (Warming && Now >= NextWarm)
+        {
+            Open++;
+            Lock.unlock();
+            MYSQL* Mysql = OpenConnection(Target, nullptr);
+            Lock.lock();
+            if (Mysql)
+            {
+                Stats.Opened.fetch_add(1, std::memory_order_relaxed);
+                Idle.insert(Idle.begin(), Mysql);
+                Available.notify_one();
+            }
+            else
+            {
+                // Wrong credentials or the server is down; Acquire() reports it,
+                // warming tries again with the next health check.
+                Open--;
+                NextWarm = Now + Options.HealthCheckInterval;
+            }
+            continue;
+        }
+
+        if (Now >= NextCheck)
+        {
+            // Idle past the warm count are closed rather than pinged.
+            std::vector<MYSQL*> Checking;
+            Checking.swap(Idle);
+            Lock.unlock();
+
+            std::vector<MYSQL*> Alive;
+            size_t Failed = 0;
+            for (auto It = Checking.rbegin(); It != Checking.rend(); ++It)
+            {
+                MYSQL* Mysql = *It;
+                if (Alive.size() < Options.WarmConnections && (mysql_ping(Mysql) == 0 || Recover(Mysql)))
+                {
+                    Alive.push_back(Mysql);
+                    continue;
+                }
+                Failed += Alive.size() < Options.WarmConnections;
+                Close(Mysql);
+            }
+            std::reverse(Alive.begin(), Alive.end());
+
+            Lock.lock();
+            Idle.insert(Idle.begin(), Alive.begin(), Alive.end());
+            Open -= Checking.size() - Alive.size();
+            Stats.Dropped.fetch_add(Failed, std::memory_order_relaxed);
+            NextCheck = std::chrono::steady_clock::now() + Options.HealthCheckInterval;
+            if (!Alive.empty())
+                Available.notify_all();
+            continue;
+        }
+
+        Wake.wait_until(Lock, Warming ? std::min(NextCheck, NextWarm) : NextCheck);
+    }
+}
+
+// Clears what the last borrower left behind: transactions, temporary tables,
+// user variables, prepared statements and a changed default database.
+bool ConnectionPool::Clean(MYSQL* Mysql)
+{
+    if (mysql_reset_connection(Mysql) != 0 && !Recover(Mysql))
+        return false;
+    return Target.Database.empty() || mysql_select_db(Mysql, Target.Database.c_str()) == 0;
+}
+
+// Reconnects in place. Automatic reconnects stay off otherwise, so a
+// connection never silently loses its session while it is leased.
+bool ConnectionPool::Recover(MYSQL* Mysql)
+{
+    my_bool Reconnect = 1;
+    mysql_options(Mysql, MYSQL_OPT_RECONNECT, &Reconnect);
+    const bool Recovered = mariadb_reconnect(Mysql) == 0;
+    Reconnect = 0;
+    mysql_options(Mysql, MYSQL_OPT_RECONNECT, &Reconnect);
+    if (Recovered)
+        Stats.Recovered.fetch_add(1, std::memory_order_relaxed);
+    return Recovered;
+}
+
+void ConnectionPool::Close(MYSQL* Mysql)
+{
+    mysql_close(Mysql);
+}
@@ -0,0 +1,158 @@
+//
+//  ConnectionPool.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "CancelToken.hpp"
+#include "StatementCache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DBCore
+{
+    struct ConnectionEndpoint
+    {
+        std::string Host;
+        std::string User;
+        std::string Password;
+        std::string Database;
+        unsigned    Port = 3306;
+
+        bool operator==(const ConnectionEndpoint& Other) const = default;
+    };
+
+    struct PoolOptions
+    {
+        size_t               WarmConnections     = 2;     // idle connections kept ready
+        size_t               MaxConnections      = 8;     // open at once, leased or idle
+        std::chrono::seconds HealthCheckInterval = std::chrono::seconds(30);
+        size_t               StatementCacheSize  = 32;    // prepared statements kept per lease
+    };
+
+    struct PoolCounters
+    {
+        std::atomic<uint64_t> Opened{0};      // full handshakes
+        std::atomic<uint64_t> Reused{0};      // leases served by an open connection
+        std::atomic<uint64_t> Recovered{0};   // dead connections brought back by mariadb_reconnect
+        std::atomic<uint64_t> Dropped{0};     // closed after a failed ping, reset or recovery
+        StatementCounters     Statements;     // of every lease's StatementCache
+    };
+
+    // Client flags for mysql_real_connect: compression, multi-statements and multi-results.
+    constexpr unsigned long ConnectionFlags = CLIENT_COMPRESS | CLIENT_MULTI_STATEMENTS | CLIENT_MULTI_RESULTS;
+
+    // The options MariaDBClient sets before connecting: TCP, compression and utf8.
+    void ApplyConnectionOptions(MYSQL* Mysql);
+
+    // Opens a connection with ApplyConnectionOptions() and ConnectionFlags,
+    // selecting Database in the handshake.
+    MYSQL* OpenConnection(const ConnectionEndpoint& Endpoint, std::string* Error);
+
+    // The last error on Mysql means the server went away or the link dropped.
+    bool IsConnectionLost(MYSQL* Mysql);
+
+    class ConnectionPool;
+
+    // A connection borrowed from a pool; handed back when the last reference
+    // goes away. Session state left behind is cleared before anyone else gets it.
+    class PooledConnection
+    {
+    public:
+        ~PooledConnection();
+
+        PooledConnection(const PooledConnection&) = delete;
+        PooledConnection& operator=(const PooledConnection&) = delete;
+
+        MYSQL*        Handle() const { return Mysql; }
+        unsigned long ThreadId() const { return Mysql ? mysql_thread_id(Mysql) : 0; }
+        // Where the connection goes: its pool's endpoint, not the login form.
+        const ConnectionEndpoint& Endpoint() const;
+
+        // Prepared statements of this lease. The reset that cleans the
+        // connection on its way back drops them on the server, so they are
+        // closed with the lease; hold one lease (the editor's session) to
+        // keep them across runs.
+        StatementCache& Statements();
+
+        // The connection cannot be used again (its socket was shut down, or a
+        // fetch was abandoned mid-result); it is closed instead of returned.
+        void Discard() { Broken.store(true); }
+        bool Discarded() const { return Broken.load(); }
+
+    private:
+        friend class ConnectionPool;
+        PooledConnection(std::shared_ptr<ConnectionPool> Pool, MYSQL* Mysql) : Pool(std::move(Pool)), Mysql(Mysql) {}
+
+        std::shared_ptr<ConnectionPool> Pool;
+        MYSQL*                          Mysql = nullptr;
+        std::atomic_bool                Broken{false};
+        std::unique_ptr<StatementCache> Cache;
+    };
+
+    // Connections to one endpoint. A background thread keeps WarmConnections
+    // idle ones ready, pings them every HealthCheckInterval (reconnecting those
+    // that died with mariadb_reconnect) and cleans returned ones with
+    // mysql_reset_connection, so Acquire() rarely waits on a handshake.
+    // Leases keep the pool alive; dropping it closes the idle connections and
+    // the leased ones as they come back.
+    class ConnectionPool : public std::enable_shared_from_this<ConnectionPool>
+    {
+    public:
+        static std::shared_ptr<ConnectionPool> Create(ConnectionEndpoint Endpoint, PoolOptions Options = PoolOptions());
+        ~ConnectionPool();
+
+        ConnectionPool(const ConnectionPool&) = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        const ConnectionEndpoint& Endpoint() const { return Target; }
+        const PoolCounters&       Counters() const { return Stats; }
+
+        // An idle connection, else a new one while under MaxConnections, else
+        // the next one handed back. Null, with Error set, when connecting fails
+        // or Cancel trips first.
+        std::shared_ptr<PooledConnection> Acquire(std::string* Error, const CancelToken* Cancel = nullptr);
+
+        size_t IdleCount() const;
+        size_t OpenCount() const;
+
+    private:
+        friend class PooledConnection;
+
+        ConnectionPool(ConnectionEndpoint Endpoint, PoolOptions Options);
+
+        void Release(MYSQL* Mysql, bool Broken);
+        void Maintain();
+        bool Clean(MYSQL* Mysql);
+        bool Recover(MYSQL* Mysql);
+        void Close(MYSQL* Mysql);
+
+        const ConnectionEndpoint Target;
+        const PoolOptions        Options;
+        PoolCounters             Stats;
+
+        mutable std::mutex       Mutex;
+        std::condition_variable  Available;   // acquirers wait for a connection
+        std::condition_variable  Wake;        // the maintainer waits for work
+        std::vector<MYSQL*>      Idle;        // clean, most recently used last
+        std::vector<MYSQL*>      Returned;    // waiting for a reset
+        size_t                   Open = 0;    // leased, idle, returned or being opened
+        bool                     Stopping = false;
+        std::chrono::steady_clock::time_point NextCheck;
+        std::chrono::steady_clock::time_point NextWarm;
+        std::thread              Maintainer;
+    };
+}
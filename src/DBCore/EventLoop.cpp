@@ -0,0 +1,309 @@
+//
+//  EventLoop.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "EventLoop.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+using namespace DBCore;
+
+// Kernel events read per poll.
+static constexpr int PollBatch = 64;
+
+EventLoop::EventLoop()
+{
+#if defined(__linux__)
+    Queue = epoll_create1(EPOLL_CLOEXEC);
+    Waker = Queue >= 0 ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+    epoll_event Event{};
+    Event.events = EPOLLIN;
+    Event.data.fd = Waker;
+    if (Waker < 0 || epoll_ctl(Queue, EPOLL_CTL_ADD, Waker, &Event) != 0)
+#else
+    Queue = kqueue();
+    struct kevent Event;
+    EV_SET(&Event, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    if (Queue < 0 || kevent(Queue, &Event, 1, nullptr, 0, nullptr) != 0)
+#endif
+    {
+        LastError = std::string("Could not create the event queue: ") + strerror(errno);
+        if (Waker >= 0)
+            close(Waker);
+        if (Queue >= 0)
+            close(Queue);
+        Waker = Queue = -1;
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    if (Waker >= 0)
+        close(Waker);
+    if (Queue >= 0)
+        close(Queue);
+}
+
+void EventLoop::Post(Task Work)
+{
+    {
+        std::lock_guard<std::mutex> Lock(PostedMutex);
+        Posted.push_back(std::move(Work));
+    }
+    Wakeup();
+}
+
+void EventLoop::Wait(my_socket Socket, int Status, unsigned TimeoutMs, WaitHandler Handler)
+{
+    SocketWait Entry;
+    Entry.Events = Status & (MYSQL_WAIT_READ | MYSQL_WAIT_WRITE | MYSQL_WAIT_EXCEPT);
+    Entry.Handler = std::move(Handler);
+
+    if (Entry.Events && !Arm(Socket, Entry.Events))
+    {
+        // Let the _cont call run into the socket's error itself.
+        Post([Work = std::move(Entry.Handler), Ready = Entry.Events]() { Work(Ready); });
+        return;
+    }
+    if (Status & MYSQL_WAIT_TIMEOUT)
+    {
+        Timer Deadline;
+        Deadline.Socket = Socket;
+        Entry.Deadline = Timers.emplace(Clock::now() + std::chrono::milliseconds(TimeoutMs), std::move(Deadline));
+        Entry.HasDeadline = true;
+    }
+    Waits[Socket] = std::move(Entry);
+}
+
+void EventLoop::Forget(my_socket Socket)
+{
+    auto It = Waits.find(Socket);
+    if (It != Waits.end())
+    {
+        Disarm(Socket, It->second.Events);
+        if (It->second.HasDeadline)
+            Timers.erase(It->second.Deadline);
+        Waits.erase(It);
+    }
+#if defined(__linux__)
+    if (Registered.erase(Socket))
+        epoll_ctl(Queue, EPOLL_CTL_DEL, Socket, nullptr);
+#endif
+}
+
+void EventLoop::After(std::chrono::milliseconds Delay, Task Work)
+{
+    Timer Entry;
+    Entry.Work = std::move(Work);
+    Timers.emplace(Clock::now() + Delay, std::move(Entry));
+}
+
+void EventLoop::Run()
+{
+    Owner.store(std::this_thread::get_id());
+    while (!Stopping.load())
+    {
+        RunPosted();
+        if (Stopping.load())
+            break;
+
+        int TimeoutMs = -1;
+        if (!Timers.empty())
+        {
+            auto Left = std::chrono::ceil<std::chrono::milliseconds>(Timers.begin()->first - Clock::now());
+            TimeoutMs = (int)std::max<int64_t>(0, Left.count());
+        }
+        Poll(TimeoutMs);
+
+        const auto Now = Clock::now();
+        while (!Timers.empty() && Timers.begin()->first <= Now)
+        {
+            Timer Expired = std::move(Timers.begin()->second);
+            Timers.erase(Timers.begin());
+            if (Expired.Socket < 0)
+            {
+                Expired.Work();
+                continue;
+            }
+
+            auto It = Waits.find(Expired.Socket);
+            if (It == Waits.end())
+                continue;
+            WaitHandler Handler = std::move(It->second.Handler);
+            Disarm(Expired.Socket, It->second.Events);
+            Waits.erase(It);
+            Handler(MYSQL_WAIT_TIMEOUT);
+        }
+    }
+    Owner.store(std::thread::id());
+}
+
+void EventLoop::Stop()
+{
+    Stopping.store(true);
+    Wakeup();
+}
+
+void EventLoop::RunPosted()
+{
+    std::vector<Task> Batch;
+    {
+        std::lock_guard<std::mutex> Lock(PostedMutex);
+        Batch.swap(Posted);
+    }
+    for (Task& Work : Batch)
+        Work();
+}
+
+void EventLoop::Fire(my_socket Socket, int Ready)
+{
+    auto It = Waits.find(Socket);
+    if (It == Waits.end())
+        return;
+    WaitHandler Handler = std::move(It->second.Handler);
+    if (It->second.HasDeadline)
+        Timers.erase(It->second.Deadline);
+    // kqueue removes only the filter that fired.
+    Disarm(Socket, It->second.Events & ~Ready);
+    Waits.erase(It);
+    Handler(Ready);
+}
+
+#if defined(__linux__)
+
+bool EventLoop::Arm(my_socket Socket, int Events)
+{
+    epoll_event Event{};
+    Event.events = EPOLLONESHOT | (Events & MYSQL_WAIT_READ ? EPOLLIN : 0u) |
+                   (Events & MYSQL_WAIT_WRITE ? EPOLLOUT : 0u) | (Events & MYSQL_WAIT_EXCEPT ? EPOLLPRI : 0u);
+    Event.data.fd = Socket;
+
+    // The set may still hold a socket number that was closed and reused.
+    const bool Known = Registered.count(Socket) != 0;
+    if (epoll_ctl(Queue, Known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, Socket, &Event) != 0)
+    {
+        if (errno != (Known ? ENOENT : EEXIST) ||
+            epoll_ctl(Queue, Known ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, Socket, &Event) != 0)
+            return false;
+    }
+    Registered.insert(Socket);
+    return true;
+}
+
+void EventLoop::Disarm(my_socket Socket, int Events)
+{
+    // A one-shot registration stays disabled once it fired.
+    if (!Events || !Registered.count(Socket))
+        return;
+    epoll_event Event{};
+    Event.events = EPOLLONESHOT;
+    Event.data.fd = Socket;
+    epoll_ctl(Queue, EPOLL_CTL_MOD, Socket, &Event);
+}
+
+void EventLoop::Wakeup()
+{
+    uint64_t One = 1;
+    (void)!write(Waker, &One, sizeof(One));
+}
+
+void EventLoop::Poll(int TimeoutMs)
+{
+    epoll_event Events[PollBatch];
+    int Count = epoll_wait(Queue, Events, PollBatch, TimeoutMs);
+    for (int i = 0; i < Count; i++)
+    {
+        if (Events[i].data.fd == Waker)
+        {
+            uint64_t Value;
+            (void)!read(Waker, &Value, sizeof(Value));
+            continue;
+        }
+
+        auto It = Waits.find(Events[i].data.fd);
+        if (It == Waits.end())
+            continue;
+        // Errors and hang-ups wake whatever was waited for; the _cont call reports them.
+        const uint32_t Flags = Events[i].events;
+        int Ready = It->second.Events & (Flags & (EPOLLERR | EPOLLHUP) ? ~0 : 0);
+        Ready |= Flags & EPOLLIN ? MYSQL_WAIT_READ : 0;
+        Ready |= Flags & EPOLLOUT ? MYSQL_WAIT_WRITE : 0;
+        Ready |= Flags & EPOLLPRI ? MYSQL_WAIT_EXCEPT : 0;
+        Fire(Events[i].data.fd, Ready & It->second.Events);
+    }
+}
+
+#else
+
+bool EventLoop::Arm(my_socket Socket, int Events)
+{
+    struct kevent Changes[2];
+    int Count = 0;
+    if (Events & (MYSQL_WAIT_READ | MYSQL_WAIT_EXCEPT))
+        EV_SET(&Changes[Count++], Socket, EVFILT_READ, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+    if (Events & MYSQL_WAIT_WRITE)
+        EV_SET(&Changes[Count++], Socket, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+    return kevent(Queue, Changes, Count, nullptr, 0, nullptr) == 0;
+}
+
+void EventLoop::Disarm(my_socket Socket, int Events)
+{
+    // Filters that already fired are gone, and deleting them again only fails.
+    struct kevent Changes[2];
+    int Count = 0;
+    if (Events & (MYSQL_WAIT_READ | MYSQL_WAIT_EXCEPT))
+        EV_SET(&Changes[Count++], Socket, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    if (Events & MYSQL_WAIT_WRITE)
+        EV_SET(&Changes[Count++], Socket, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    for (int i = 0; i < Count; i++)
+        kevent(Queue, &Changes[i], 1, nullptr, 0, nullptr);
+}
+
+void EventLoop::Wakeup()
+{
+    struct kevent Event;
+    EV_SET(&Event, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    kevent(Queue, &Event, 1, nullptr, 0, nullptr);
+}
+
+void EventLoop::Poll(int TimeoutMs)
+{
+    struct kevent Events[PollBatch];
+    struct timespec Timeout;
+    Timeout.tv_sec  = TimeoutMs / 1000;
+    Timeout.tv_nsec = (long)(TimeoutMs % 1000) * 1000000;
+    int Count = kevent(Queue, nullptr, 0, Events, PollBatch, TimeoutMs < 0 ? nullptr : &Timeout);
+
+    // A socket waiting on both directions can come back twice in one batch.
+    std::unordered_map<my_socket, int> Ready;
+    for (int i = 0; i < Count; i++)
+    {
+        if (Events[i].filter == EVFILT_USER)
+            continue;
+        auto It = Waits.find((my_socket)Events[i].ident);
+        if (It == Waits.end())
+            continue;
+        int& Flags = Ready[(my_socket)Events[i].ident];
+        if (Events[i].flags & (EV_EOF | EV_ERROR))
+            Flags |= It->second.Events;
+        Flags |= Events[i].filter == EVFILT_READ ? It->second.Events & (MYSQL_WAIT_READ | MYSQL_WAIT_EXCEPT) : MYSQL_WAIT_WRITE;
+    }
+    for (const auto& [Socket, Flags] : Ready)
+        Fire(Socket, Flags);
+}
+
+#endif
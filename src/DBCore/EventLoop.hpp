@@ -0,0 +1,103 @@
+//
+//  EventLoop.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "AsyncExecutor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace DBCore
+{
+    // Readiness loop for libmariadb's non-blocking API: a _start or _cont call
+    // returns the MYSQL_WAIT_* events it is suspended on, and Wait() calls back
+    // on the loop thread once the socket has one of them or the timeout from
+    // mysql_get_timeout_value_ms() passes. epoll on Linux, kqueue on macOS.
+    class EventLoop final : public AsyncExecutor
+    {
+    public:
+        EventLoop();
+        ~EventLoop() override;
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        // False, with Error() set, when the kernel queue could not be created.
+        bool               Valid() const { return Queue >= 0; }
+        const std::string& Error() const { return LastError; }
+
+        // Thread safe. Work runs on the loop thread, in the order posted.
+        void Post(Task Work) override;
+
+        // The rest are for the loop thread only.
+
+        // Calls Handler once for Status, the value a _start/_cont call returned.
+        // A socket has one wait at a time; TimeoutMs only counts when Status
+        // has MYSQL_WAIT_TIMEOUT.
+        void Wait(my_socket Socket, int Status, unsigned TimeoutMs, WaitHandler Handler) override;
+        // Drops the socket's wait without calling it; before the socket closes.
+        void Forget(my_socket Socket) override;
+        void After(std::chrono::milliseconds Delay, Task Work) override;
+
+        size_t Waiting() const { return Waits.size(); }
+        bool   InLoopThread() const { return std::this_thread::get_id() == Owner.load(); }
+
+        // Dispatches until Stop(); the calling thread becomes the loop thread.
+        void Run();
+        // Thread safe.
+        void Stop();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Timer
+        {
+            my_socket Socket = -1;   // a wait's timeout, or -1 for After()
+            Task      Work;
+        };
+        using TimerQueue = std::multimap<Clock::time_point, Timer>;
+
+        struct SocketWait
+        {
+            int                  Events = 0;      // MYSQL_WAIT_READ/WRITE/EXCEPT
+            WaitHandler          Handler;
+            TimerQueue::iterator Deadline;
+            bool                 HasDeadline = false;
+        };
+
+        bool Arm(my_socket Socket, int Events);
+        void Disarm(my_socket Socket, int Events);
+        void Wakeup();
+        void RunPosted();
+        void Poll(int TimeoutMs);
+        void Fire(my_socket Socket, int Ready);
+
+        int                                   Queue  = -1;   // epoll or kqueue descriptor
+        int                                   Waker  = -1;   // eventfd on Linux
+        std::string                           LastError;
+        std::atomic<std::thread::id>          Owner{};
+        std::atomic_bool                      Stopping{false};
+
+        std::mutex                            PostedMutex;
+        std::vector<Task>                     Posted;
+
+        std::unordered_map<my_socket, SocketWait> Waits;
+        std::unordered_set<my_socket>             Registered;   // in the epoll set
+        TimerQueue                                Timers;
+    };
+}
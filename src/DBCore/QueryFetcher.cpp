@@ -0,0 +1,322 @@
+//
+//  QueryFetcher.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "QueryFetcher.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+
+using namespace DBCore;
+
+static constexpr unsigned int BinaryCharset = 63;
+
+ColumnInfo DBCore::ColumnInfoFromField(const MYSQL_FIELD& Field)
+{
+    ColumnInfo Info;
+    Info.Name         = std::string(Field.name, Field.name_length);
+    Info.Database     = std::string(Field.db ? Field.db : "", Field.db ? Field.db_length : 0);
+    Info.Table        = std::string(Field.org_table ? Field.org_table : "", Field.org_table ? Field.org_table_length : 0);
+    Info.OriginalName = std::string(Field.org_name ? Field.org_name : "", Field.org_name ? Field.org_name_length : 0);
+    Info.Type         = Field.type;
+    Info.Charset      = Field.charsetnr;
+    Info.Flags        = Field.flags;
+    Info.Length       = Field.length;
+    Info.MaxLength    = Field.max_length;
+    Info.Decimals     = Field.decimals;
+    return Info;
+}
+
+bool DBCore::IsLargeObjectField(const MYSQL_FIELD& Field)
+{
+    switch (Field.type)
+    {
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        case MYSQL_TYPE_GEOMETRY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+DecoderPlan DecoderPlan::FromFields(const MYSQL_FIELD* Fields, unsigned int Count, uint32_t PrefixBytes)
+{
+    DecoderPlan Plan;
+    Plan.PrefixBytes = PrefixBytes;
+    Plan.Columns.reserve(Count);
+    Plan.Decoders.reserve(Count);
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        Plan.Columns.push_back(ColumnInfoFromField(Fields[i]));
+
+        CellDecoder Decoder = CellDecoder::Copy;
+        if (Fields[i].type == MYSQL_TYPE_BIT)
+            Decoder = CellDecoder::Bit;
+        else if (PrefixBytes && IsLargeObjectField(Fields[i]))
+            Decoder = CellDecoder::Prefix;
+
+        Plan.Decoders.push_back(Decoder);
+        Plan.AllCopy = Plan.AllCopy && Decoder == CellDecoder::Copy;
+    }
+    return Plan;
+}
+
+static void AppendBit(const char* Data, unsigned long Length, ResultStoreBuilder& Builder)
+{
+    uint64_t Value = 0;
+    for (unsigned long i = 0; i < Length && i < 8; i++)
+        Value = (Value << 8) | (uint8_t)Data[i];
+
+    char Buffer[24];
+    auto Result = std::to_chars(Buffer, Buffer + sizeof(Buffer), Value);
+    Builder.AppendCell(Buffer, (size_t)(Result.ptr - Buffer));
+}
+
+void DBCore::AppendPrefix(const ColumnInfo& Column, const char* Data, uint64_t Length, uint32_t PrefixBytes, ResultStoreBuilder& Builder)
+{
+    if (Length <= PrefixBytes)
+    {
+        Builder.AppendCell(Data, (size_t)Length);
+        return;
+    }
+    size_t Kept = Column.Charset == BinaryCharset ? PrefixBytes : Utf8Prefix(Data, (size_t)Length, PrefixBytes);
+    Builder.AppendPartialCell(Data, Kept, Length);
+}
+
+void QueryFetcher::DecodeRow(const DecoderPlan& Plan, MYSQL_ROW Row, const unsigned long* Lengths, ResultStoreBuilder& Builder)
+{
+    if (Plan.AllCopy)
+    {
+        Builder.AppendRow(Row, Lengths);
+        return;
+    }
+
+    for (size_t c = 0; c < Plan.Decoders.size(); c++)
+    {
+        if (!Row[c])
+        {
+            Builder.AppendNull();
+            continue;
+        }
+
+        switch (Plan.Decoders[c])
+        {
+            case CellDecoder::Copy:
+                Builder.AppendCell(Row[c], Lengths[c]);
+                break;
+            case CellDecoder::Bit:
+                AppendBit(Row[c], Lengths[c], Builder);
+                break;
+            case CellDecoder::Prefix:
+                AppendPrefix(Plan.Columns[c], Row[c], Lengths[c], Plan.PrefixBytes, Builder);
+                break;
+        }
+    }
+    Builder.EndRow();
+}
+
+static std::string LastError(MYSQL* Connection)
+{
+    const char* Message = mysql_error(Connection);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_errno(Connection)) + ")";
+}
+
+// Reads and drops what is left of a script so the connection can take the next query.
+static void DrainResults(MYSQL* Connection)
+{
+    while (mysql_more_results(Connection) && mysql_next_result(Connection) == 0)
+    {
+        if (MYSQL_RES* Result = mysql_use_result(Connection))
+            mysql_free_result(Result);
+    }
+}
+
+// Streams the current result into Publisher, or publishes the affected rows
+// message when Result is null (an OK packet).
+static bool FetchResult(MYSQL* Connection, MYSQL_RES* Result, ResultPublisher& Publisher, ResultSummary& Summary,
+                        std::string* Error, const StreamOptions& Options)
+{
+    if (!Result)
+    {
+        Summary.AffectedRows = mysql_affected_rows(Connection);
+        Summary.InsertId     = mysql_insert_id(Connection);
+        Summary.Warnings     = mysql_warning_count(Connection);
+
+        std::string Message = std::to_string((unsigned long long)Summary.AffectedRows) + " row(s) affected";
+        Publisher.Publish(ResultStore::FromMessage("Result", Message));
+        return true;
+    }
+
+    Summary.HasRows = true;
+    DecoderPlan Plan = DecoderPlan::FromFields(mysql_fetch_fields(Result), mysql_num_fields(Result), Options.CellPrefixBytes);
+    ResultStream Stream(Publisher, Plan.Columns, Options);
+    ResultStoreBuilder& Builder = Stream.Builder();
+
+    MYSQL_ROW Row;
+    while (!Stream.Cancelled() && (Row = mysql_fetch_row(Result)))
+    {
+        QueryFetcher::DecodeRow(Plan, Row, mysql_fetch_lengths(Result), Builder);
+        Stream.RowCommitted();
+    }
+
+    // A cancelled fetch usually ends with the server's "interrupted" error from KILL QUERY.
+    if (Stream.Cancelled())
+    {
+        Stream.Abandon();
+        mysql_free_result(Result);
+        return true;
+    }
+
+    bool Failed = mysql_errno(Connection) != 0;
+    if (Failed && Error)
+        *Error = LastError(Connection);
+
+    mysql_free_result(Result);
+    Summary.Warnings = mysql_warning_count(Connection);
+    Stream.Finish();
+    return !Failed;
+}
+
+bool QueryFetcher::Execute(MYSQL* Connection, const std::string& Sql, ResultPublisher& Publisher,
+                           std::string* Error, const StreamOptions& Options)
+{
+    if (!Connection)
+    {
+        if (Error)
+            *Error = "Unknown error. (No connection to the server).";
+        return false;
+    }
+
+    if (mysql_real_query(Connection, Sql.data(), (unsigned long)Sql.size()) != 0)
+    {
+        if (Error)
+            *Error = LastError(Connection);
+        return false;
+    }
+
+    MYSQL_RES* Result = mysql_use_result(Connection);
+    if (!Result && mysql_field_count(Connection) != 0)
+    {
+        if (Error)
+            *Error = LastError(Connection);
+        DrainResults(Connection);
+        return false;
+    }
+
+    ResultSummary Summary;
+    bool Succeeded = FetchResult(Connection, Result, Publisher, Summary, Error, Options);
+    DrainResults(Connection);
+    return Succeeded;
+}
+
+bool QueryFetcher::ExecuteScript(MYSQL* Connection, const std::string& Sql, ResultSetList& Results,
+                                 std::string* Error, const StreamOptions& Options)
+{
+    if (!Connection)
+    {
+        if (Error)
+            *Error = "Unknown error. (No connection to the server).";
+        return false;
+    }
+
+    auto Started = std::chrono::steady_clock::now();
+    if (mysql_real_query(Connection, Sql.data(), (unsigned long)Sql.size()) != 0)
+    {
+        if (Error)
+            *Error = LastError(Connection);
+        return false;
+    }
+
+    for (;;)
+    {
+        MYSQL_RES* Result = mysql_use_result(Connection);
+        if (!Result && mysql_field_count(Connection) != 0)
+        {
+            if (Error)
+                *Error = LastError(Connection);
+            DrainResults(Connection);
+            return false;
+        }
+
+        ResultSummary Summary;
+        bool Fetched = FetchResult(Connection, Result, *Results.Add(), Summary, Error, Options);
+
+        auto Now = std::chrono::steady_clock::now();
+        Summary.Seconds = std::chrono::duration<double>(Now - Started).count();
+        Summary.Failed  = !Fetched;
+        Started = Now;
+        Results.Summarize(Summary);
+
+        if (!Fetched || IsCancelled(Options.Cancel))
+        {
+            DrainResults(Connection);
+            return Fetched;
+        }
+
+        // 0: another result follows, -1: done, > 0: the next statement failed.
+        int Status = mysql_next_result(Connection);
+        if (Status < 0)
+            return true;
+        if (Status > 0)
+        {
+            if (Error)
+                *Error = LastError(Connection);
+            return false;
+        }
+    }
+}
+
+size_t QueryFetcher::CountStatements(const std::string& Sql)
+{
+    size_t Count = 0;
+    bool   Content = false;
+    size_t i = 0;
+    const size_t Size = Sql.size();
+
+    while (i < Size)
+    {
+        char c = Sql[i];
+        if (c == '\'' || c == '"' || c == '`')
+        {
+            for (i++; i < Size && Sql[i] != c; i++)
+            {
+                if (Sql[i] == '\\' && c != '`')
+                    i++;
+            }
+            i++;
+            Content = true;
+        }
+        else if (c == '#' || (c == '-' && i + 1 < Size && Sql[i + 1] == '-' && (i + 2 == Size || isspace((unsigned char)Sql[i + 2]))))
+        {
+            while (i < Size && Sql[i] != '\n')
+                i++;
+        }
+        else if (c == '/' && i + 1 < Size && Sql[i + 1] == '*' && !(i + 2 < Size && Sql[i + 2] == '!'))
+        {
+            size_t End = Sql.find("*/", i + 2);
+            i = End == std::string::npos ? Size : End + 2;
+        }
+        else if (c == ';')
+        {
+            Count += Content;
+            Content = false;
+            i++;
+        }
+        else
+        {
+            Content = Content || !isspace((unsigned char)c);
+            i++;
+        }
+    }
+    return Count + Content;
+}
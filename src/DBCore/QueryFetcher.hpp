@@ -0,0 +1,73 @@
+//
+//  QueryFetcher.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "ResultStream.hpp"
+#include "ResultSetList.hpp"
+
+#include <string>
+#include <vector>
+
+namespace DBCore
+{
+    enum class CellDecoder : uint8_t
+    {
+        Copy,       // text protocol bytes are stored as received
+        Bit,        // BIT(n) arrives as big-endian bytes, stored as its integer text
+        Prefix,     // BLOB/TEXT, cut to DecoderPlan::PrefixBytes
+    };
+
+    // Built once per result from MYSQL_FIELD metadata so the fetch loop only
+    // looks up a precomputed decoder per column instead of switching on types.
+    struct DecoderPlan
+    {
+        std::vector<ColumnInfo>  Columns;
+        std::vector<CellDecoder> Decoders;
+        uint32_t                 PrefixBytes = 0;
+        bool                     AllCopy = true;
+
+        static DecoderPlan FromFields(const MYSQL_FIELD* Fields, unsigned int Count, uint32_t PrefixBytes = 0);
+    };
+
+    ColumnInfo ColumnInfoFromField(const MYSQL_FIELD& Field);
+
+    // BLOB, TEXT and GEOMETRY columns, whose values can run to gigabytes.
+    bool IsLargeObjectField(const MYSQL_FIELD& Field);
+
+    // Appends a value of Length bytes, or only its first PrefixBytes when it is
+    // longer; text is cut on a UTF-8 boundary.
+    void AppendPrefix(const ColumnInfo& Column, const char* Data, uint64_t Length, uint32_t PrefixBytes, ResultStoreBuilder& Builder);
+
+    class QueryFetcher
+    {
+    public:
+        // Runs Sql with mysql_real_query/mysql_use_result and streams the rows,
+        // read as (pointer, length) pairs from mysql_fetch_row/mysql_fetch_lengths,
+        // into Publisher. Statements without a result set publish an affected
+        // rows message. Any further results of a script are read and dropped.
+        // Returns false and fills Error on failure.
+        static bool Execute(MYSQL* Connection, const std::string& Sql, ResultPublisher& Publisher,
+                            std::string* Error, const StreamOptions& Options = StreamOptions());
+
+        // Sends a script of one or more statements in a single round trip (the
+        // connection needs CLIENT_MULTI_STATEMENTS) and reads every result,
+        // including each one a stored procedure returns, into its own entry of
+        // Results. Stops at the first statement that fails, keeping the results
+        // before it. The connection is ready for the next query either way.
+        static bool ExecuteScript(MYSQL* Connection, const std::string& Sql, ResultSetList& Results,
+                                  std::string* Error, const StreamOptions& Options = StreamOptions());
+
+        // Statements in Sql, split on semicolons outside of literals, quoted
+        // identifiers and comments; empty statements are not counted.
+        static size_t CountStatements(const std::string& Sql);
+
+        static void DecodeRow(const DecoderPlan& Plan, MYSQL_ROW Row, const unsigned long* Lengths, ResultStoreBuilder& Builder);
+    };
+}
@@ -0,0 +1,85 @@
+//
+//  QueryWorker.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "QueryWorker.hpp"
+
+using namespace DBCore;
+
+QueryWorker::QueryWorker()
+{
+    Thread = std::thread(&QueryWorker::Run, this);
+}
+
+QueryWorker::~QueryWorker()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+        Queue.clear();
+        if (CurrentToken)
+            CurrentToken->Cancel();
+    }
+    Condition.notify_all();
+    if (Thread.joinable())
+        Thread.join();
+}
+
+uint64_t QueryWorker::Submit(Job Work)
+{
+    uint64_t Id;
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Id = NextId++;
+        Queue.push_back(Entry{ Id, std::move(Work), std::make_shared<CancelToken>() });
+    }
+    Condition.notify_one();
+    return Id;
+}
+
+void QueryWorker::Cancel()
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Queue.clear();
+    if (CurrentToken)
+        CurrentToken->Cancel();
+}
+
+bool QueryWorker::Busy() const
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return CurrentId != 0 || !Queue.empty();
+}
+
+bool QueryWorker::Running(uint64_t JobId) const
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return CurrentId == JobId;
+}
+
+void QueryWorker::Run()
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true)
+    {
+        Condition.wait(Lock, [this] { return Stopping || !Queue.empty(); });
+        if (Stopping)
+            break;
+
+        Entry Next = std::move(Queue.front());
+        Queue.pop_front();
+        CurrentId    = Next.Id;
+        CurrentToken = Next.Token;
+
+        Lock.unlock();
+        Next.Work(*Next.Token);
+        Next.Work = nullptr;
+        Lock.lock();
+
+        CurrentId = 0;
+        CurrentToken.reset();
+    }
+}
@@ -0,0 +1,61 @@
+//
+//  QueryWorker.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "CancelToken.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace DBCore
+{
+    // One long-lived thread that runs queued jobs in order. Every job gets its
+    // own CancelToken; Cancel() trips the running one and drops the queue.
+    class QueryWorker
+    {
+    public:
+        using Job = std::function<void(const CancelToken&)>;
+
+        QueryWorker();
+        ~QueryWorker();
+
+        QueryWorker(const QueryWorker&) = delete;
+        QueryWorker& operator=(const QueryWorker&) = delete;
+
+        // Returns an id that identifies the job in Running().
+        uint64_t Submit(Job Work);
+        void     Cancel();
+
+        bool     Busy() const;
+        // True while the job with this id is still executing.
+        bool     Running(uint64_t JobId) const;
+
+    private:
+        struct Entry
+        {
+            uint64_t                     Id = 0;
+            Job                          Work;
+            std::shared_ptr<CancelToken> Token;
+        };
+
+        void Run();
+
+        mutable std::mutex           Mutex;
+        std::condition_variable      Condition;
+        std::deque<Entry>            Queue;
+        std::shared_ptr<CancelToken> CurrentToken;
+        uint64_t                     CurrentId = 0;
+        uint64_t                     NextId    = 1;
+        bool                         Stopping  = false;
+        std::thread                  Thread;
+    };
+}
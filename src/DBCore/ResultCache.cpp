@@ -0,0 +1,654 @@
+//
+//  ResultCache.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultCache.hpp"
+#include "SpillFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace DBCore;
+
+namespace
+{
+    constexpr char     CacheMagic[8] = { 'D', 'B', 'G', 'C', 'A', 'C', 'H', 'E' };
+    constexpr uint32_t CacheVersion  = 2;
+    constexpr char     CacheSuffix[] = ".dbgcache";
+
+    // All offsets are from the start of the file and 8-byte aligned.
+    struct FileHeader
+    {
+        char     Magic[8];
+        uint32_t Version;
+        uint32_t ColumnCount;
+        uint64_t RowCount;
+        uint64_t BlockCount;
+        int64_t  Created;           // seconds since the epoch
+        uint64_t KeyOffset;
+        uint64_t KeyLength;
+        uint64_t ColumnsOffset;
+        uint64_t ColumnsLength;
+        uint64_t DirectoryOffset;   // BlockCount x (BlockEntry, ColumnCount x ColumnEntry)
+        uint64_t FileLength;        // written last, so a torn file never matches
+    };
+
+    struct BlockEntry
+    {
+        uint64_t FirstRow;
+        uint32_t RowCount;
+        uint32_t Reserved;
+    };
+
+    struct ColumnEntry
+    {
+        uint64_t Nulls;
+        uint64_t Offsets;       // 0 for fixed-width columns
+        uint64_t Arena;
+        uint64_t ArenaLength;
+    };
+
+    // Sequential writes through a staging buffer; large arenas bypass it.
+    class CacheWriter
+    {
+    public:
+        static constexpr size_t StagingSize = 1u << 20;
+
+        explicit CacheWriter(int Descriptor) : Descriptor(Descriptor) { Staging.reserve(StagingSize); }
+
+        uint64_t Offset() const { return Position; }
+
+        bool Append(const void* Data, size_t Length) {
+            Position += Length;
+            if (Staging.size() + Length > StagingSize && !Flush())
+                return false;
+            if (Length >= StagingSize)
+                return WriteAll(static_cast<const char*>(Data), Length);
+            Staging.append(static_cast<const char*>(Data), Length);
+            return true;
+        }
+
+        bool Align() {
+            static const char Zeros[8] = {};
+            return Append(Zeros, (size_t)(((Position + 7) & ~(uint64_t)7) - Position));
+        }
+
+        bool Flush() {
+            bool Written = WriteAll(Staging.data(), Staging.size());
+            Staging.clear();
+            return Written;
+        }
+
+    private:
+        bool WriteAll(const char* Data, size_t Length) {
+            while (Length > 0)
+            {
+                ssize_t Written = write(Descriptor, Data, Length);
+                if (Written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                Data   += Written;
+                Length -= (size_t)Written;
+            }
+            return true;
+        }
+
+        int         Descriptor;
+        std::string Staging;
+        uint64_t    Position = 0;
+    };
+
+    template<typename T>
+    void Put(std::string& Out, T Value)
+    {
+        Out.append(reinterpret_cast<const char*>(&Value), sizeof(T));
+    }
+
+    template<typename T>
+    bool Get(const char*& Cursor, const char* End, T& Value)
+    {
+        if ((size_t)(End - Cursor) < sizeof(T))
+            return false;
+        memcpy(&Value, Cursor, sizeof(T));
+        Cursor += sizeof(T);
+        return true;
+    }
+
+    void PutString(std::string& Out, const std::string& Value)
+    {
+        Put<uint32_t>(Out, (uint32_t)Value.size());
+        Out.append(Value);
+    }
+
+    bool GetString(const char*& Cursor, const char* End, std::string& Value)
+    {
+        uint32_t Length = 0;
+        if (!Get(Cursor, End, Length) || (size_t)(End - Cursor) < Length)
+            return false;
+        Value.assign(Cursor, Length);
+        Cursor += Length;
+        return true;
+    }
+
+    // Cells are read straight out of the mapping, so a text column's offsets
+    // must stay inside its own arena.
+    bool OffsetsValid(const uint32_t* Offsets, uint32_t Rows, uint64_t ArenaLength)
+    {
+        for (uint32_t Row = 0; Row < Rows; Row++)
+        {
+            if (Offsets[Row + 1] < Offsets[Row])
+                return false;
+        }
+        return Offsets[Rows] <= ArenaLength;
+    }
+}
+
+static bool SystemError(const std::string& What, std::string* Error)
+{
+    if (Error)
+        *Error = What + ": " + strerror(errno);
+    return false;
+}
+
+static bool MakeDirectories(const std::string& Path)
+{
+    for (size_t Slash = Path.find('/', 1); ; Slash = Path.find('/', Slash + 1))
+    {
+        std::string Part = Path.substr(0, Slash);
+        if (mkdir(Part.c_str(), 0700) != 0 && errno != EEXIST)
+            return false;
+        if (Slash == std::string::npos)
+            return true;
+    }
+}
+
+static bool HasSuffix(const std::string& Name, const char* Suffix)
+{
+    size_t Length = strlen(Suffix);
+    return Name.size() >= Length && Name.compare(Name.size() - Length, Length, Suffix) == 0;
+}
+
+static bool ReadHeader(const std::string& Path, FileHeader& Header, uint64_t& FileSize)
+{
+    int Descriptor = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (Descriptor < 0)
+        return false;
+
+    struct stat Info;
+    bool Valid = fstat(Descriptor, &Info) == 0 && (uint64_t)Info.st_size >= sizeof(FileHeader) &&
+                 pread(Descriptor, &Header, sizeof(Header), 0) == (ssize_t)sizeof(Header) &&
+                 memcmp(Header.Magic, CacheMagic, sizeof(CacheMagic)) == 0 && Header.Version == CacheVersion &&
+                 Header.FileLength == (uint64_t)Info.st_size;
+    FileSize = (uint64_t)Info.st_size;
+    close(Descriptor);
+    return Valid;
+}
+
+static bool Expired(const FileHeader& Header, const CacheOptions& Options)
+{
+    if (Options.TimeToLive.count() <= 0)
+        return false;
+    auto Created = std::chrono::system_clock::time_point(std::chrono::seconds(Header.Created));
+    return std::chrono::system_clock::now() - Created > Options.TimeToLive;
+}
+
+std::string DBCore::NormalizeQuery(const std::string& Sql)
+{
+    std::string Out;
+    Out.reserve(Sql.size());
+    bool PendingSpace = false;
+
+    auto Emit = [&](char c) {
+        if (PendingSpace && !Out.empty())
+            Out.push_back(' ');
+        PendingSpace = false;
+        Out.push_back(c);
+    };
+
+    const size_t Size = Sql.size();
+    size_t i = 0;
+    while (i < Size)
+    {
+        char c = Sql[i];
+        if (c == '\'' || c == '"' || c == '`')
+        {
+            // Literals and quoted identifiers are copied byte for byte.
+            Emit(c);
+            for (i++; i < Size; i++)
+            {
+                Out.push_back(Sql[i]);
+                if (Sql[i] == '\\' && c != '`' && i + 1 < Size)
+                    Out.push_back(Sql[++i]);
+                else if (Sql[i] == c)
+                    break;
+            }
+            i++;
+        }
+        else if (c == '#' || (c == '-' && i + 1 < Size && Sql[i + 1] == '-' && (i + 2 == Size || isspace((unsigned char)Sql[i + 2]))))
+        {
+            while (i < Size && Sql[i] != '\n')
+                i++;
+            PendingSpace = true;
+        }
+        else if (c == '/' && i + 1 < Size && Sql[i + 1] == '*')
+        {
+            size_t End = Sql.find("*/", i + 2);
+            End = End == std::string::npos ? Size : End + 2;
+            bool Executable = i + 2 < Size && (Sql[i + 2] == '!' || (Sql[i + 2] == 'M' && i + 3 < Size && Sql[i + 3] == '!'));
+            if (Executable)
+            {
+                Emit(c);
+                Out.append(Sql, i + 1, End - i - 1);
+            }
+            else
+            {
+                PendingSpace = true;
+            }
+            i = End;
+        }
+        else if (isspace((unsigned char)c))
+        {
+            PendingSpace = true;
+            i++;
+        }
+        else
+        {
+            Emit(c);
+            i++;
+        }
+    }
+
+    while (!Out.empty() && (Out.back() == ';' || Out.back() == ' '))
+        Out.pop_back();
+    return Out;
+}
+
+std::string CacheKey::Serialize() const
+{
+    std::string Key;
+    Key.reserve(Host.size() + Database.size() + User.size() + Fingerprint.size() + 3);
+    Key.append(Host).push_back('\0');
+    Key.append(Database).push_back('\0');
+    Key.append(User).push_back('\0');
+    Key.append(Fingerprint);
+    return Key;
+}
+
+void ResultCache::SetOptions(CacheOptions Options)
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Settings = std::move(Options);
+}
+
+CacheOptions ResultCache::Options() const
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Settings;
+}
+
+std::string ResultCache::PathFor(const std::string& Key) const
+{
+    // FNV-1a only picks the file name; the full key is checked on lookup.
+    uint64_t Hash = 0xcbf29ce484222325ull;
+    for (char c : Key)
+        Hash = (Hash ^ (uint8_t)c) * 0x100000001b3ull;
+
+    char Name[32];
+    snprintf(Name, sizeof(Name), "%016llx", (unsigned long long)Hash);
+    return Settings.Directory + "/" + Name + CacheSuffix;
+}
+
+std::shared_ptr<ResultStore> ResultCache::Lookup(const CacheKey& Key, std::chrono::system_clock::time_point* Created, std::string* Error)
+{
+    CacheOptions Options = this->Options();
+    if (Options.Directory.empty())
+        return nullptr;
+
+    const std::string KeyText = Key.Serialize();
+    std::string Path;
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Path = PathFor(KeyText);
+    }
+
+    int Descriptor = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (Descriptor < 0)
+        return nullptr;
+
+    struct stat Info;
+    if (fstat(Descriptor, &Info) != 0 || (uint64_t)Info.st_size < sizeof(FileHeader))
+    {
+        close(Descriptor);
+        unlink(Path.c_str());
+        return nullptr;
+    }
+
+    const size_t FileSize = (size_t)Info.st_size;
+    void* Base = mmap(nullptr, FileSize, PROT_READ, MAP_SHARED, Descriptor, 0);
+    close(Descriptor);
+    if (Base == MAP_FAILED)
+    {
+        SystemError("Cannot map cache file", Error);
+        return nullptr;
+    }
+    auto Mapping = std::make_shared<SpillMapping>(Base, FileSize);
+    const char* Data = Mapping->Data();
+    const char* End  = Data + FileSize;
+
+    auto InFile = [&](uint64_t Offset, uint64_t Length) { return Offset <= FileSize && Length <= FileSize - Offset; };
+    // A file that does not hold together is removed, whatever part is wrong.
+    auto Reject = [&]() -> std::shared_ptr<ResultStore> {
+        unlink(Path.c_str());
+        return nullptr;
+    };
+
+    FileHeader Header;
+    memcpy(&Header, Data, sizeof(Header));
+    bool Valid = memcmp(Header.Magic, CacheMagic, sizeof(CacheMagic)) == 0 && Header.Version == CacheVersion &&
+                 Header.FileLength == FileSize && InFile(Header.KeyOffset, Header.KeyLength) &&
+                 InFile(Header.ColumnsOffset, Header.ColumnsLength) && InFile(Header.DirectoryOffset, 0);
+    if (!Valid)
+        return Reject();
+
+    // Another key with the same file name.
+    if (std::string_view(Data + Header.KeyOffset, Header.KeyLength) != KeyText)
+        return nullptr;
+
+    if (Expired(Header, Options))
+        return Reject();
+
+    std::vector<ColumnInfo> Columns(Header.ColumnCount);
+    const char* Cursor = Data + Header.ColumnsOffset;
+    const char* ColumnsEnd = Cursor + Header.ColumnsLength;
+    for (ColumnInfo& Column : Columns)
+    {
+        uint64_t Length = 0, MaxLength = 0;
+        uint8_t Encoding = 0;
+        if (!GetString(Cursor, ColumnsEnd, Column.Name) || !GetString(Cursor, ColumnsEnd, Column.Database) ||
+            !GetString(Cursor, ColumnsEnd, Column.Table) || !GetString(Cursor, ColumnsEnd, Column.OriginalName) ||
+            !Get(Cursor, ColumnsEnd, Column.Type) || !Get(Cursor, ColumnsEnd, Column.Charset) ||
+            !Get(Cursor, ColumnsEnd, Column.Flags) || !Get(Cursor, ColumnsEnd, Length) ||
+            !Get(Cursor, ColumnsEnd, MaxLength) || !Get(Cursor, ColumnsEnd, Column.Decimals) ||
+            !Get(Cursor, ColumnsEnd, Encoding) || Encoding > (uint8_t)ColumnEncoding::Time)
+            return Reject();
+        Column.Length    = (unsigned long)Length;
+        Column.MaxLength = (unsigned long)MaxLength;
+        Column.Encoding  = (ColumnEncoding)Encoding;
+    }
+
+    std::vector<std::shared_ptr<const ResultBlock>> Blocks;
+    Blocks.reserve(Header.BlockCount);
+    Cursor = Data + Header.DirectoryOffset;
+    uint64_t NextRow = 0;
+    for (uint64_t b = 0; b < Header.BlockCount; b++)
+    {
+        BlockEntry Entry;
+        if (!Get(Cursor, End, Entry) || Entry.FirstRow != NextRow)
+            return Reject();
+        NextRow += Entry.RowCount;
+
+        auto Block = std::make_shared<ResultBlock>();
+        Block->FirstRow = Entry.FirstRow;
+        Block->RowCount = Entry.RowCount;
+        Block->Columns.resize(Columns.size());
+        Block->Spill = Mapping;
+
+        for (size_t c = 0; c < Columns.size(); c++)
+        {
+            ColumnEntry Place;
+            if (!Get(Cursor, End, Place))
+                return Reject();
+
+            ColumnBlock& Column = Block->Columns[c];
+            const uint32_t Width = EncodingWidth(Columns[c].Encoding);
+            const uint64_t NullSize = (Entry.RowCount + 7) / 8;
+            const uint64_t OffsetSize = Width ? 0 : ((uint64_t)Entry.RowCount + 1) * sizeof(uint32_t);
+            if (!InFile(Place.Nulls, NullSize) || !InFile(Place.Offsets, OffsetSize) || !InFile(Place.Arena, Place.ArenaLength) ||
+                (Width && Place.ArenaLength != (uint64_t)Entry.RowCount * Width))
+                return Reject();
+            if (!Width && (Place.Offsets % alignof(uint32_t) != 0 ||
+                           !OffsetsValid(reinterpret_cast<const uint32_t*>(Data + Place.Offsets), Entry.RowCount, Place.ArenaLength)))
+                return Reject();
+
+            Column.Rows        = Entry.RowCount;
+            Column.Width       = Width;
+            Column.NullView    = reinterpret_cast<const uint8_t*>(Data + Place.Nulls);
+            Column.OffsetView  = Width ? nullptr : reinterpret_cast<const uint32_t*>(Data + Place.Offsets);
+            Column.ArenaView   = Data + Place.Arena;
+            Column.ArenaLength = (size_t)Place.ArenaLength;
+            Block->SpillBytes += NullSize + OffsetSize + Place.ArenaLength;
+        }
+        Blocks.push_back(std::move(Block));
+    }
+    if (NextRow != Header.RowCount)
+        return Reject();
+
+    // The modification time doubles as the last use for eviction.
+    utimes(Path.c_str(), nullptr);
+    if (Created)
+        *Created = std::chrono::system_clock::time_point(std::chrono::seconds(Header.Created));
+    return std::make_shared<ResultStore>(std::move(Columns), std::move(Blocks));
+}
+
+bool ResultCache::Insert(const CacheKey& Key, const ResultStore& Store, std::string* Error)
+{
+    static std::atomic<uint64_t> TemporaryId{0};
+
+    CacheOptions Options = this->Options();
+    if (Options.Directory.empty())
+        return true;
+    if (Store.PartialCells())
+    {
+        if (Error)
+            *Error = "Results with partly fetched values are not cached";
+        return false;
+    }
+    if (!MakeDirectories(Options.Directory))
+        return SystemError("Cannot create " + Options.Directory, Error);
+
+    const std::string KeyText = Key.Serialize();
+    std::string Path;
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Path = PathFor(KeyText);
+    }
+    std::string Temporary = Path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(TemporaryId++);
+
+    int Descriptor = open(Temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (Descriptor < 0)
+        return SystemError("Cannot create cache file", Error);
+
+    FileHeader Header{};
+    memcpy(Header.Magic, CacheMagic, sizeof(CacheMagic));
+    Header.Version     = CacheVersion;
+    Header.ColumnCount = (uint32_t)Store.ColumnCount();
+    Header.RowCount    = Store.RowCount();
+    Header.BlockCount  = Store.Blocks().size();
+    Header.Created     = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::string Columns;
+    for (const ColumnInfo& Column : Store.Columns())
+    {
+        PutString(Columns, Column.Name);
+        PutString(Columns, Column.Database);
+        PutString(Columns, Column.Table);
+        PutString(Columns, Column.OriginalName);
+        Put(Columns, Column.Type);
+        Put(Columns, Column.Charset);
+        Put(Columns, Column.Flags);
+        Put<uint64_t>(Columns, Column.Length);
+        Put<uint64_t>(Columns, Column.MaxLength);
+        Put(Columns, Column.Decimals);
+        Put<uint8_t>(Columns, (uint8_t)Column.Encoding);
+    }
+
+    CacheWriter Writer(Descriptor);
+    bool Written = Writer.Append(&Header, sizeof(Header)) && Writer.Align();
+
+    Header.KeyOffset = Writer.Offset();
+    Header.KeyLength = KeyText.size();
+    Written = Written && Writer.Append(KeyText.data(), KeyText.size()) && Writer.Align();
+
+    Header.ColumnsOffset = Writer.Offset();
+    Header.ColumnsLength = Columns.size();
+    Written = Written && Writer.Append(Columns.data(), Columns.size()) && Writer.Align();
+
+    std::string Directory;
+    for (const auto& Block : Store.Blocks())
+    {
+        if (!Written)
+            break;
+
+        Put(Directory, BlockEntry{ Block->FirstRow, Block->RowCount, 0 });
+        for (const ColumnBlock& Column : Block->Columns)
+        {
+            const size_t NullSize = (Block->RowCount + 7) / 8;
+            const size_t OffsetSize = Column.ValueWidth() ? 0 : ((size_t)Block->RowCount + 1) * sizeof(uint32_t);
+
+            ColumnEntry Place{};
+            Place.Nulls = Writer.Offset();
+            Written = Written && Writer.Append(Column.NullData(), NullSize) && Writer.Align();
+            if (OffsetSize)
+            {
+                Place.Offsets = Writer.Offset();
+                Written = Written && Writer.Append(Column.OffsetData(), OffsetSize) && Writer.Align();
+            }
+            Place.Arena       = Writer.Offset();
+            Place.ArenaLength = Column.ArenaSize();
+            Written = Written && (Place.ArenaLength == 0 || Writer.Append(Column.ArenaData(), Column.ArenaSize())) && Writer.Align();
+            Put(Directory, Place);
+        }
+    }
+
+    Header.DirectoryOffset = Writer.Offset();
+    Written = Written && Writer.Append(Directory.data(), Directory.size());
+    Header.FileLength = Writer.Offset();
+    Written = Written && Writer.Flush() && pwrite(Descriptor, &Header, sizeof(Header), 0) == (ssize_t)sizeof(Header);
+
+    if (!Written)
+    {
+        SystemError("Cannot write cache file", Error);
+        close(Descriptor);
+        unlink(Temporary.c_str());
+        return false;
+    }
+    if (close(Descriptor) != 0 || rename(Temporary.c_str(), Path.c_str()) != 0)
+    {
+        SystemError("Cannot write cache file", Error);
+        unlink(Temporary.c_str());
+        return false;
+    }
+
+    Evict();
+    return true;
+}
+
+void ResultCache::Evict()
+{
+    struct Entry
+    {
+        std::string Path;
+        uint64_t    Size;
+        time_t      LastUse;
+    };
+
+    CacheOptions Options = this->Options();
+    DIR* Directory = Options.Directory.empty() ? nullptr : opendir(Options.Directory.c_str());
+    if (!Directory)
+        return;
+
+    std::vector<Entry> Entries;
+    uint64_t Total = 0;
+    const time_t Now = time(nullptr);
+    while (dirent* Item = readdir(Directory))
+    {
+        std::string Name = Item->d_name;
+        std::string Path = Options.Directory + "/" + Name;
+        struct stat Info;
+        if (stat(Path.c_str(), &Info) != 0 || !S_ISREG(Info.st_mode))
+            continue;
+
+        // Leftovers of writers that did not get to rename their file.
+        if (Name.find(".tmp.") != std::string::npos)
+        {
+            if (Now - Info.st_mtime > 24 * 3600)
+                unlink(Path.c_str());
+            continue;
+        }
+        if (!HasSuffix(Name, CacheSuffix))
+            continue;
+
+        FileHeader Header;
+        uint64_t Size = 0;
+        if (!ReadHeader(Path, Header, Size) || Expired(Header, Options))
+        {
+            unlink(Path.c_str());
+            continue;
+        }
+        Entries.push_back(Entry{ Path, Size, Info.st_mtime });
+        Total += Size;
+    }
+    closedir(Directory);
+
+    std::sort(Entries.begin(), Entries.end(), [](const Entry& a, const Entry& b) { return a.LastUse < b.LastUse; });
+    for (const Entry& Oldest : Entries)
+    {
+        if (Total <= Options.MaxBytes)
+            break;
+        // Open mappings stay valid; the space goes once they are released.
+        unlink(Oldest.Path.c_str());
+        Total -= Oldest.Size;
+    }
+}
+
+void ResultCache::Clear()
+{
+    CacheOptions Options = this->Options();
+    DIR* Directory = Options.Directory.empty() ? nullptr : opendir(Options.Directory.c_str());
+    if (!Directory)
+        return;
+    while (dirent* Item = readdir(Directory))
+    {
+        std::string Name = Item->d_name;
+        if (HasSuffix(Name, CacheSuffix))
+            unlink((Options.Directory + "/" + Name).c_str());
+    }
+    closedir(Directory);
+}
+
+uint64_t ResultCache::DiskBytes() const
+{
+    CacheOptions Options = this->Options();
+    DIR* Directory = Options.Directory.empty() ? nullptr : opendir(Options.Directory.c_str());
+    if (!Directory)
+        return 0;
+
+    uint64_t Total = 0;
+    while (dirent* Item = readdir(Directory))
+    {
+        std::string Name = Item->d_name;
+        struct stat Info;
+        if (HasSuffix(Name, CacheSuffix) && stat((Options.Directory + "/" + Name).c_str(), &Info) == 0)
+            Total += (uint64_t)Info.st_size;
+    }
+    closedir(Directory);
+    return Total;
+}
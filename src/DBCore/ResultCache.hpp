@@ -0,0 +1,71 @@
+//
+//  ResultCache.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace DBCore
+{
+    // Query text with comments dropped and whitespace outside of literals and
+    // quoted identifiers collapsed, so reformatting a query still hits the
+    // cache. Executable comments (/*! ... */) are kept, and case is left
+    // alone since table names can be case sensitive.
+    std::string NormalizeQuery(const std::string& Sql);
+
+    struct CacheKey
+    {
+        std::string Host;       // host:port
+        std::string Database;
+        std::string User;
+        std::string Fingerprint;    // NormalizeQuery()
+
+        std::string Serialize() const;
+    };
+
+    struct CacheOptions
+    {
+        std::string          Directory;
+        std::chrono::seconds TimeToLive { 3600 };
+        uint64_t             MaxBytes = 4ull << 30;
+    };
+
+    // Results of SELECTs kept on disk across runs, one file per key. The
+    // files hold the result blocks in the same layout as in memory, so a hit
+    // maps the file and points the blocks into the mapping, like spilled
+    // blocks; nothing is read until the grid touches it. Entries past their
+    // time to live are dropped, and the least recently used ones go once
+    // the directory grows over MaxBytes. Safe to use from several threads.
+    class ResultCache
+    {
+    public:
+        void SetOptions(CacheOptions Options);
+        CacheOptions Options() const;
+
+        // Null on a miss. Created is when the entry was written.
+        std::shared_ptr<ResultStore> Lookup(const CacheKey& Key, std::chrono::system_clock::time_point* Created, std::string* Error);
+
+        // Writes to a temporary file and renames it into place, then evicts.
+        bool Insert(const CacheKey& Key, const ResultStore& Store, std::string* Error);
+
+        void Evict();
+        void Clear();
+        uint64_t DiskBytes() const;
+
+    private:
+        std::string PathFor(const std::string& Key) const;
+
+        mutable std::mutex Mutex;
+        CacheOptions       Settings;
+    };
+}
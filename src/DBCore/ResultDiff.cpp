@@ -0,0 +1,393 @@
+//
+//  ResultDiff.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultDiff.hpp"
+#include "ThreadPool.hpp"
+
+#include <MariaDBKit/mysql.h>
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+using namespace DBCore;
+
+static constexpr uint32_t PartitionBits = 10;
+static constexpr size_t   Partitions = size_t(1) << PartitionBits;
+// Rows per task when partitioning row ids.
+static constexpr uint64_t PartitionChunkRows = 65536;
+
+namespace
+{
+    struct ColumnPair
+    {
+        size_t Old       = 0;
+        size_t New       = 0;
+        size_t Index     = 0;       // into ResultDiff::Columns
+        // The two sides encode the column differently (say, text and binary
+        // protocol runs), so cells are compared by their display text.
+        bool   Formatted = false;
+    };
+
+    struct PartitionOutput
+    {
+        std::vector<DiffEntry> Entries;
+        std::vector<uint32_t>  ChangedColumns;
+        uint64_t               Unchanged = 0;
+    };
+
+    uint64_t Mix(uint64_t Hash)
+    {
+        Hash ^= Hash >> 30;
+        Hash *= 0xbf58476d1ce4e5b9ull;
+        Hash ^= Hash >> 27;
+        Hash *= 0x94d049bb133111ebull;
+        return Hash ^ (Hash >> 31);
+    }
+
+    uint64_t Combine(uint64_t Hash, uint64_t Value)
+    {
+        return Mix(Hash ^ (Value + 0x9e3779b97f4a7c15ull + (Hash << 6) + (Hash >> 2)));
+    }
+
+    uint64_t CellHash(const ColumnInfo& Column, const CellView& Cell, bool Formatted)
+    {
+        if (Cell.Null)
+            return 0x6e756c6c6e756c6cull;
+        if (Formatted)
+        {
+            char Buffer[64];
+            return std::hash<std::string_view>()(FormatCell(Column, Cell, Buffer, sizeof(Buffer)));
+        }
+        if (Column.Encoding != ColumnEncoding::Text)
+            return Mix(Cell.As<uint64_t>());
+        return std::hash<std::string_view>()(Cell.Text());
+    }
+
+    bool CellsEqual(const ColumnInfo& OldColumn, const CellView& OldCell, const ColumnInfo& NewColumn, const CellView& NewCell, bool Formatted)
+    {
+        if (OldCell.Null || NewCell.Null)
+            return OldCell.Null == NewCell.Null;
+        if (!Formatted)
+            return OldCell.Text() == NewCell.Text();
+
+        char OldBuffer[64], NewBuffer[64];
+        return FormatCell(OldColumn, OldCell, OldBuffer, sizeof(OldBuffer)) == FormatCell(NewColumn, NewCell, NewBuffer, sizeof(NewBuffer));
+    }
+
+    // Key and value hashes of every row, one block per task. Columns are
+    // hashed one at a time so each pass walks a single arena.
+    void HashRows(const ResultStore& Store, bool OldSide, const std::vector<ColumnPair>& Key, const std::vector<ColumnPair>& Values,
+                  std::vector<uint64_t>& KeyHashes, std::vector<uint64_t>& ValueHashes, const CancelToken* Cancel)
+    {
+        KeyHashes.assign(Store.RowCount(), 0);
+        ValueHashes.assign(Values.empty() ? 0 : Store.RowCount(), 0);
+
+        const auto& Blocks = Store.Blocks();
+        const auto& Columns = Store.Columns();
+        auto HashColumns = [&](const ResultBlock& Block, const std::vector<ColumnPair>& Pairs, uint64_t* Hashes) {
+            for (const ColumnPair& Pair : Pairs)
+            {
+                const size_t Column = OldSide ? Pair.Old : Pair.New;
+                const ColumnBlock& Cells = Block.Columns[Column];
+                for (uint32_t r = 0; r < Block.RowCount; r++)
+                    Hashes[r] = Combine(Hashes[r], CellHash(Columns[Column], Cells.Cell(r), Pair.Formatted));
+            }
+        };
+
+        ThreadPool::Shared().ParallelFor(Blocks.size(), 1, [&](uint64_t Begin, uint64_t End) {
+            for (uint64_t b = Begin; b < End && !IsCancelled(Cancel); b++)
+            {
+                const ResultBlock& Block = *Blocks[b];
+                HashColumns(Block, Key, KeyHashes.data() + Block.FirstRow);
+                if (!Values.empty())
+                    HashColumns(Block, Values, ValueHashes.data() + Block.FirstRow);
+            }
+        });
+    }
+
+    // Row ids grouped by the top bits of their hash, each group in row order.
+    // Starts holds one more entry than there are partitions.
+    void Partition(const std::vector<uint64_t>& Hashes, std::vector<uint64_t>& Rows, std::vector<uint64_t>& Starts)
+    {
+        const uint64_t Count = Hashes.size();
+        const uint64_t Chunks = (Count + PartitionChunkRows - 1) / PartitionChunkRows;
+        std::vector<uint64_t> Cursors(Chunks * Partitions, 0);
+        ThreadPool& Pool = ThreadPool::Shared();
+
+        Pool.ParallelFor(Chunks, 1, [&](uint64_t Begin, uint64_t End) {
+            for (uint64_t Chunk = Begin; Chunk < End; Chunk++)
+            {
+                uint64_t* Counts = Cursors.data() + Chunk * Partitions;
+                for (uint64_t r = Chunk * PartitionChunkRows; r < std::min(Count, (Chunk + 1) * PartitionChunkRows); r++)
+                    Counts[Hashes[r] >> (64 - PartitionBits)]++;
+            }
+        });
+
+        // Partition-major prefix sums turn the counts into per-chunk write cursors.
+        Starts.assign(Partitions + 1, 0);
+        uint64_t Offset = 0;
+        for (size_t p = 0; p < Partitions; p++)
+        {
+            Starts[p] = Offset;
+            for (uint64_t Chunk = 0; Chunk < Chunks; Chunk++)
+            {
+                uint64_t Rows = Cursors[Chunk * Partitions + p];
+                Cursors[Chunk * Partitions + p] = Offset;
+                Offset += Rows;
+            }
+        }
+        Starts[Partitions] = Offset;
+
+        Rows.resize(Count);
+        Pool.ParallelFor(Chunks, 1, [&](uint64_t Begin, uint64_t End) {
+            for (uint64_t Chunk = Begin; Chunk < End; Chunk++)
+            {
+                uint64_t* Next = Cursors.data() + Chunk * Partitions;
+                for (uint64_t r = Chunk * PartitionChunkRows; r < std::min(Count, (Chunk + 1) * PartitionChunkRows); r++)
+                    Rows[Next[Hashes[r] >> (64 - PartitionBits)]++] = r;
+            }
+        });
+    }
+
+    bool ResolveKey(const std::vector<ColumnInfo>& Columns, const std::vector<ColumnPair>& Shared, const DiffOptions& Options,
+                    std::vector<ColumnPair>& Key, std::vector<ColumnPair>& Values, std::string* Error)
+    {
+        for (const ColumnPair& Pair : Shared)
+        {
+            bool IsKey = false;
+            switch (Options.Key)
+            {
+                case DiffKey::PrimaryKey:
+                    IsKey = (Columns[Pair.New].Flags & PRI_KEY_FLAG) != 0;
+                    break;
+                case DiffKey::Columns:
+                    IsKey = std::find(Options.KeyColumns.begin(), Options.KeyColumns.end(), Columns[Pair.New].Name) != Options.KeyColumns.end();
+                    break;
+                case DiffKey::RowHash:
+                    IsKey = true;
+                    break;
+            }
+            (IsKey ? Key : Values).push_back(Pair);
+        }
+
+        if (!Key.empty())
+            return true;
+        if (Error)
+        {
+            if (Options.Key == DiffKey::PrimaryKey)
+                *Error = "The result has no primary key columns; choose key columns or compare whole rows";
+            else if (Options.Key == DiffKey::Columns)
+                *Error = "None of the key columns are in both results";
+            else
+                *Error = "The results have no columns in common";
+        }
+        return false;
+    }
+}
+
+bool ResultDiffer::Diff(const ResultStore& Old, const ResultStore& New, const DiffOptions& Options,
+                        ResultDiff& Out, const CancelToken* Cancel, std::string* Error)
+{
+    Out = ResultDiff();
+
+    // Columns are matched by name; the first column of a name wins.
+    std::vector<ColumnPair> Shared;
+    std::vector<bool> OldMatched(Old.ColumnCount(), false);
+    for (size_t n = 0; n < New.ColumnCount(); n++)
+    {
+        const ColumnInfo& Column = New.Columns()[n];
+        size_t o = 0;
+        while (o < Old.ColumnCount() && (OldMatched[o] || Old.Columns()[o].Name != Column.Name))
+            o++;
+        if (o == Old.ColumnCount())
+        {
+            Out.AddedColumns.push_back(Column.Name);
+            continue;
+        }
+        OldMatched[o] = true;
+        Shared.push_back(ColumnPair{ o, n, Out.Columns.size(), Old.Columns()[o].Encoding != Column.Encoding });
+        Out.Columns.emplace_back(o, n);
+    }
+    for (size_t o = 0; o < Old.ColumnCount(); o++)
+    {
+        if (!OldMatched[o])
+            Out.RemovedColumns.push_back(Old.Columns()[o].Name);
+    }
+
+    std::vector<ColumnPair> Key, Values;
+    if (!ResolveKey(New.Columns(), Shared, Options, Key, Values, Error))
+        return false;
+
+    std::vector<uint64_t> OldKeys, OldValues, NewKeys, NewValues;
+    HashRows(Old, true, Key, Values, OldKeys, OldValues, Cancel);
+    HashRows(New, false, Key, Values, NewKeys, NewValues, Cancel);
+    if (IsCancelled(Cancel))
+        return false;
+
+    std::vector<uint64_t> OldRows, OldStarts, NewRows, NewStarts;
+    Partition(OldKeys, OldRows, OldStarts);
+    Partition(NewKeys, NewRows, NewStarts);
+
+    auto KeysEqual = [&](uint64_t OldRow, uint64_t NewRow) {
+        RowView OldCells = Old.Row(OldRow), NewCells = New.Row(NewRow);
+        for (const ColumnPair& Pair : Key)
+        {
+            if (!CellsEqual(Old.Columns()[Pair.Old], OldCells[Pair.Old], New.Columns()[Pair.New], NewCells[Pair.New], Pair.Formatted))
+                return false;
+        }
+        return true;
+    };
+
+    // Two rows of the old result: same columns, so no cross-type formatting.
+    auto OldKeysEqual = [&](uint64_t Row, uint64_t Other) {
+        RowView Cells = Old.Row(Row), OtherCells = Old.Row(Other);
+        for (const ColumnPair& Pair : Key)
+        {
+            const ColumnInfo& Info = Old.Columns()[Pair.Old];
+            if (!CellsEqual(Info, Cells[Pair.Old], Info, OtherCells[Pair.Old], false))
+                return false;
+        }
+        return true;
+    };
+
+    // Pairs rows with equal keys and diffs their values. Equal value hashes
+    // are taken as equal rows; otherwise the cells are compared one by one.
+    auto Match = [&](uint64_t OldRow, uint64_t NewRow, PartitionOutput& Output) {
+        if (Values.empty() || OldValues[OldRow] == NewValues[NewRow])
+        {
+            Output.Unchanged++;
+            return;
+        }
+        RowView OldCells = Old.Row(OldRow), NewCells = New.Row(NewRow);
+        const uint32_t First = (uint32_t)Output.ChangedColumns.size();
+        for (const ColumnPair& Pair : Values)
+        {
+            if (!CellsEqual(Old.Columns()[Pair.Old], OldCells[Pair.Old], New.Columns()[Pair.New], NewCells[Pair.New], Pair.Formatted))
+                Output.ChangedColumns.push_back((uint32_t)Pair.Index);
+        }
+        const uint32_t Count = (uint32_t)Output.ChangedColumns.size() - First;
+        if (Count)
+            Output.Entries.push_back(DiffEntry{ RowChange::Changed, OldRow, NewRow, First, Count });
+        else
+            Output.Unchanged++;
+    };
+
+    std::vector<PartitionOutput> Outputs(Partitions);
+    ThreadPool::Shared().ParallelFor(Partitions, 1, [&](uint64_t Begin, uint64_t End) {
+        // Old rows of an equal-hash run that share one key.
+        struct KeyGroup
+        {
+            std::vector<size_t> Members;   // indices into OldSide, in fetch order
+            size_t              Next = 0;  // first one not paired yet
+        };
+        std::vector<std::pair<uint64_t, uint64_t>> OldSide, NewSide;
+        std::vector<KeyGroup> Groups;
+        for (uint64_t p = Begin; p < End && !IsCancelled(Cancel); p++)
+        {
+            PartitionOutput& Output = Outputs[p];
+            OldSide.clear();
+            NewSide.clear();
+            for (uint64_t i = OldStarts[p]; i < OldStarts[p + 1]; i++)
+                OldSide.emplace_back(OldKeys[OldRows[i]], OldRows[i]);
+            for (uint64_t i = NewStarts[p]; i < NewStarts[p + 1]; i++)
+                NewSide.emplace_back(NewKeys[NewRows[i]], NewRows[i]);
+            std::sort(OldSide.begin(), OldSide.end());
+            std::sort(NewSide.begin(), NewSide.end());
+
+            size_t i = 0, j = 0;
+            while (i < OldSide.size() || j < NewSide.size())
+            {
+                if (j == NewSide.size() || (i < OldSide.size() && OldSide[i].first < NewSide[j].first))
+                {
+                    Output.Entries.push_back(DiffEntry{ RowChange::Removed, OldSide[i++].second, 0, 0, 0 });
+                    continue;
+                }
+                if (i == OldSide.size() || NewSide[j].first < OldSide[i].first)
+                {
+                    Output.Entries.push_back(DiffEntry{ RowChange::Added, 0, NewSide[j++].second, 0, 0 });
+                    continue;
+                }
+
+                // A run of equal hashes: duplicate keys pair up in fetch
+                // order, and the key check sorts out hash collisions.
+                const uint64_t Hash = OldSide[i].first;
+                size_t OldEnd = i, NewEnd = j;
+                while (OldEnd < OldSide.size() && OldSide[OldEnd].first == Hash)
+                    OldEnd++;
+                while (NewEnd < NewSide.size() && NewSide[NewEnd].first == Hash)
+                    NewEnd++;
+
+                // Old rows are grouped by key first, comparing only against
+                // one row per group: runs are nearly always a single key
+                // (duplicates), so pairing is linear instead of rescanning
+                // the run for every new row. Each group hands out its rows
+                // in fetch order through a cursor.
+                Groups.clear();
+                for (size_t o = i; o < OldEnd; o++)
+                {
+                    size_t g = 0;
+                    while (g < Groups.size() && !OldKeysEqual(OldSide[Groups[g].Members.front()].second, OldSide[o].second))
+                        g++;
+                    if (g == Groups.size())
+                        Groups.emplace_back();
+                    Groups[g].Members.push_back(o);
+                }
+                for (size_t n = j; n < NewEnd; n++)
+                {
+                    size_t g = 0;
+                    while (g < Groups.size() && !KeysEqual(OldSide[Groups[g].Members.front()].second, NewSide[n].second))
+                        g++;
+                    if (g == Groups.size() || Groups[g].Next == Groups[g].Members.size())
+                    {
+                        Output.Entries.push_back(DiffEntry{ RowChange::Added, 0, NewSide[n].second, 0, 0 });
+                        continue;
+                    }
+                    Match(OldSide[Groups[g].Members[Groups[g].Next++]].second, NewSide[n].second, Output);
+                }
+                for (const KeyGroup& Group : Groups)
+                {
+                    for (size_t m = Group.Next; m < Group.Members.size(); m++)
+                        Output.Entries.push_back(DiffEntry{ RowChange::Removed, OldSide[Group.Members[m]].second, 0, 0, 0 });
+                }
+                i = OldEnd;
+                j = NewEnd;
+            }
+        }
+    });
+    if (IsCancelled(Cancel))
+        return false;
+
+    for (PartitionOutput& Output : Outputs)
+    {
+        const uint32_t Base = (uint32_t)Out.ChangedColumns.size();
+        for (DiffEntry& Entry : Output.Entries)
+        {
+            Entry.FirstChanged += Base;
+            Out.Entries.push_back(Entry);
+        }
+        Out.ChangedColumns.insert(Out.ChangedColumns.end(), Output.ChangedColumns.begin(), Output.ChangedColumns.end());
+        Out.Unchanged += Output.Unchanged;
+        Output = PartitionOutput();
+    }
+
+    std::sort(Out.Entries.begin(), Out.Entries.end(), [](const DiffEntry& a, const DiffEntry& b) {
+        if (a.Change != b.Change)
+            return a.Change < b.Change;
+        return a.Change == RowChange::Removed ? a.OldRow < b.OldRow : a.NewRow < b.NewRow;
+    });
+    for (const DiffEntry& Entry : Out.Entries)
+    {
+        switch (Entry.Change)
+        {
+            case RowChange::Changed: Out.Changed++; break;
+            case RowChange::Added:   Out.Added++; break;
+            case RowChange::Removed: Out.Removed++; break;
+        }
+    }
+    return true;
+}
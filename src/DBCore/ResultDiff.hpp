@@ -0,0 +1,79 @@
+//
+//  ResultDiff.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+#include "CancelToken.hpp"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace DBCore
+{
+    // How rows of the two results are paired up.
+    enum class DiffKey : uint8_t
+    {
+        PrimaryKey,     // columns flagged PRI_KEY_FLAG
+        Columns,        // DiffOptions::KeyColumns
+        RowHash,        // every shared column; rows are equal or unmatched
+    };
+
+    struct DiffOptions
+    {
+        DiffKey                  Key = DiffKey::PrimaryKey;
+        std::vector<std::string> KeyColumns;    // by name, so they resolve in both results
+    };
+
+    enum class RowChange : uint8_t
+    {
+        Changed,
+        Added,
+        Removed,
+    };
+
+    struct DiffEntry
+    {
+        RowChange Change       = RowChange::Changed;
+        uint64_t  OldRow       = 0;     // unused for Added
+        uint64_t  NewRow       = 0;     // unused for Removed
+        uint32_t  FirstChanged = 0;     // into ResultDiff::ChangedColumns
+        uint32_t  ChangedCount = 0;
+    };
+
+    struct ResultDiff
+    {
+        // Columns present in both results as (old, new) indices, in new order.
+        std::vector<std::pair<size_t, size_t>> Columns;
+        std::vector<std::string>               AddedColumns;
+        std::vector<std::string>               RemovedColumns;
+
+        // Changed rows by new row, then added rows by new row, then removed rows by old row.
+        std::vector<DiffEntry> Entries;
+        // Indices into Columns of the cells that differ, per changed entry.
+        std::vector<uint32_t>  ChangedColumns;
+
+        uint64_t Changed   = 0;
+        uint64_t Added     = 0;
+        uint64_t Removed   = 0;
+        uint64_t Unchanged = 0;
+    };
+
+    // Row-level diff of two results of the same query. Both sides are hashed
+    // block by block on the thread pool, the row hashes are radix-partitioned
+    // and the partitions are joined in parallel, so only the key and value
+    // hashes of all rows are held at once. Spilled blocks are read through
+    // their mappings like resident ones.
+    class ResultDiffer
+    {
+    public:
+        static bool Diff(const ResultStore& Old, const ResultStore& New, const DiffOptions& Options,
+                         ResultDiff& Out, const CancelToken* Cancel, std::string* Error);
+    };
+}
@@ -0,0 +1,529 @@
+//
+//  ResultExport.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultExport.hpp"
+#include "ResultSorter.hpp"
+#include "ThreadPool.hpp"
+
+// The zlib that MariaDBKit builds for compressed protocol, not the system one.
+#include <MariaDBKit/zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace DBCore;
+
+static void AppendCsvField(std::string& Out, std::string_view Value)
+{
+    // An empty field is NULL, so empty strings are quoted to stay distinguishable.
+    bool Quote = Value.empty();
+    for (char Byte : Value)
+    {
+        if (Byte == ',' || Byte == '"' || Byte == '\n' || Byte == '\r')
+        {
+            Quote = true;
+            break;
+        }
+    }
+    if (!Quote)
+    {
+        Out.append(Value);
+        return;
+    }
+
+    Out.push_back('"');
+    size_t Start = 0;
+    for (size_t i = 0; i < Value.size(); i++)
+    {
+        if (Value[i] == '"')
+        {
+            Out.append(Value.data() + Start, i + 1 - Start);
+            Out.push_back('"');
+            Start = i + 1;
+        }
+    }
+    Out.append(Value.data() + Start, Value.size() - Start);
+    Out.push_back('"');
+}
+
+// Same escapes as SELECT ... INTO OUTFILE, so LOAD DATA reads the file back.
+static void AppendTsvField(std::string& Out, std::string_view Value)
+{
+    size_t Start = 0;
+    for (size_t i = 0; i < Value.size(); i++)
+    {
+        char Escape;
+        switch (Value[i])
+        {
+            case '\0':   Escape = '0'; break;
+            case '\b':   Escape = 'b'; break;
+            case '\n':   Escape = 'n'; break;
+            case '\r':   Escape = 'r'; break;
+            case '\t':   Escape = 't'; break;
+            case '\x1A': Escape = 'Z'; break;
+            case '\\':   Escape = '\\'; break;
+            default:     continue;
+        }
+        Out.append(Value.data() + Start, i - Start);
+        Out.push_back('\\');
+        Out.push_back(Escape);
+        Start = i + 1;
+    }
+    Out.append(Value.data() + Start, Value.size() - Start);
+}
+
+static void AppendJsonString(std::string& Out, std::string_view Value)
+{
+    static const char Hex[] = "0123456789abcdef";
+
+    Out.push_back('"');
+    size_t Start = 0;
+    for (size_t i = 0; i < Value.size(); i++)
+    {
+        unsigned char Byte = (unsigned char)Value[i];
+        if (Byte >= 0x20 && Byte != '"' && Byte != '\\')
+            continue;
+
+        Out.append(Value.data() + Start, i - Start);
+        Start = i + 1;
+        switch (Byte)
+        {
+            case '"':  Out.append("\\\""); break;
+            case '\\': Out.append("\\\\"); break;
+            case '\n': Out.append("\\n"); break;
+            case '\r': Out.append("\\r"); break;
+            case '\t': Out.append("\\t"); break;
+            default:
+            {
+                char Escape[6] = { '\\', 'u', '0', '0', Hex[Byte >> 4], Hex[Byte & 15] };
+                Out.append(Escape, sizeof(Escape));
+                break;
+            }
+        }
+    }
+    Out.append(Value.data() + Start, Value.size() - Start);
+    Out.push_back('"');
+}
+
+static bool IsNumberColumn(const ColumnInfo& Column)
+{
+    SortKeyKind Kind = SortKeyKindForColumn(Column);
+    return Kind == SortKeyKind::Signed || Kind == SortKeyKind::Unsigned || Kind == SortKeyKind::Real;
+}
+
+ResultExporter::ResultExporter(ExportOptions Options, ExportProgress* Progress)
+    : Options(Options), Progress(Progress)
+{
+    if (this->Options.MaxInFlightBlocks == 0)
+        this->Options.MaxInFlightBlocks = std::max(ThreadPool::Shared().ThreadCount(), 1u) * 2;
+}
+
+ResultExporter::~ResultExporter()
+{
+    if (Descriptor >= 0)
+        Abort();
+}
+
+std::string ResultExporter::FileExtension(const ExportOptions& Options)
+{
+    std::string Extension;
+    switch (Options.Format)
+    {
+        case ExportFormat::Csv:       Extension = ".csv"; break;
+        case ExportFormat::Tsv:       Extension = ".tsv"; break;
+        case ExportFormat::JsonLines: Extension = ".jsonl"; break;
+    }
+    if (Options.Compression == ExportCompression::Gzip)
+        Extension += ".gz";
+    return Extension;
+}
+
+bool ResultExporter::Open(const std::string& Path, std::string* Error)
+{
+    Descriptor = open(Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (Descriptor < 0)
+    {
+        if (Error)
+            *Error = "Cannot create " + Path + ": " + strerror(errno);
+        return false;
+    }
+
+    this->Path = Path;
+    Writer = std::thread(&ResultExporter::RunWriter, this);
+    return true;
+}
+
+void ResultExporter::Begin(const std::vector<ColumnInfo>& Columns)
+{
+    ColumnInfos = Columns;
+
+    Chunk Header;
+    switch (Options.Format)
+    {
+        case ExportFormat::Csv:
+        case ExportFormat::Tsv:
+            if (!Options.Header)
+                break;
+            for (size_t c = 0; c < Columns.size(); c++)
+            {
+                if (Options.Format == ExportFormat::Csv)
+                {
+                    if (c)
+                        Header.Bytes.push_back(',');
+                    AppendCsvField(Header.Bytes, Columns[c].Name);
+                }
+                else
+                {
+                    if (c)
+                        Header.Bytes.push_back('\t');
+                    AppendTsvField(Header.Bytes, Columns[c].Name);
+                }
+            }
+            Header.Bytes.append(Options.Format == ExportFormat::Csv ? "\r\n" : "\n");
+            break;
+        case ExportFormat::JsonLines:
+            JsonKeys.clear();
+            for (const ColumnInfo& Column : Columns)
+            {
+                std::string Key;
+                AppendJsonString(Key, Column.Name);
+                Key.push_back(':');
+                JsonKeys.push_back(std::move(Key));
+            }
+            break;
+    }
+
+    if (Header.Bytes.empty())
+        return;
+    if (!Compress(Header.Bytes))
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Failed    = true;
+        FailError = "Cannot compress export data";
+        return;
+    }
+    Submit(std::move(Header));
+}
+
+void ResultExporter::Format(const ResultBlock& Block, std::string& Out) const
+{
+    const size_t Columns = ColumnInfos.size();
+    size_t Estimate = 0;
+    for (const ColumnBlock& Column : Block.Columns)
+        Estimate += Column.ValueWidth() ? (size_t)Block.RowCount * 12 : Column.ArenaSize() + Block.RowCount * 3;
+    if (Options.Format == ExportFormat::JsonLines)
+        for (const std::string& Key : JsonKeys)
+            Estimate += (Key.size() + 1) * Block.RowCount;
+    Out.reserve(Estimate + Block.RowCount * 2);
+
+    std::vector<bool> Numbers(Columns);
+    for (size_t c = 0; c < Columns; c++)
+        Numbers[c] = IsNumberColumn(ColumnInfos[c]);
+
+    char Buffer[64];
+    for (uint32_t r = 0; r < Block.RowCount; r++)
+    {
+        if (Options.Format == ExportFormat::JsonLines)
+            Out.push_back('{');
+
+        for (size_t c = 0; c < Columns; c++)
+        {
+            const ColumnInfo& Column = ColumnInfos[c];
+            CellView Cell = Block.Columns[c].Cell(r);
+
+            switch (Options.Format)
+            {
+                case ExportFormat::Csv:
+                    if (c)
+                        Out.push_back(',');
+                    if (!Cell.Null)
+                        AppendCsvField(Out, FormatCell(Column, Cell, Buffer, sizeof(Buffer)));
+                    break;
+                case ExportFormat::Tsv:
+                    if (c)
+                        Out.push_back('\t');
+                    if (Cell.Null)
+                        Out.append("\\N");
+                    else
+                        AppendTsvField(Out, FormatCell(Column, Cell, Buffer, sizeof(Buffer)));
+                    break;
+                case ExportFormat::JsonLines:
+                    if (c)
+                        Out.push_back(',');
+                    Out.append(JsonKeys[c]);
+                    if (Cell.Null || (Column.Encoding == ColumnEncoding::Double && !std::isfinite(Cell.As<double>())))
+                        Out.append("null");
+                    else if (Numbers[c])
+                        Out.append(FormatCell(Column, Cell, Buffer, sizeof(Buffer)));
+                    else
+                        AppendJsonString(Out, FormatCell(Column, Cell, Buffer, sizeof(Buffer)));
+                    break;
+            }
+        }
+
+        switch (Options.Format)
+        {
+            case ExportFormat::Csv:       Out.append("\r\n"); break;
+            case ExportFormat::Tsv:       Out.push_back('\n'); break;
+            case ExportFormat::JsonLines: Out.append("}\n"); break;
+        }
+    }
+}
+
+// Every chunk becomes a complete gzip member. Concatenated members are one
+// valid .gz file (RFC 1952), and this way compression runs on the pool
+// alongside the formatting instead of serially on the writer.
+bool ResultExporter::Compress(std::string& Bytes) const
+{
+    if (Options.Compression == ExportCompression::None)
+        return true;
+
+    z_stream Stream{};
+    if (deflateInit2(&Stream, Options.CompressionLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    std::string Compressed(deflateBound(&Stream, (uLong)Bytes.size()), '\0');
+    Stream.next_in   = reinterpret_cast<Bytef*>(Bytes.data());
+    Stream.avail_in  = (uInt)Bytes.size();
+    Stream.next_out  = reinterpret_cast<Bytef*>(Compressed.data());
+    Stream.avail_out = (uInt)Compressed.size();
+    int Status = deflate(&Stream, Z_FINISH);
+    Compressed.resize(Stream.total_out);
+    deflateEnd(&Stream);
+    if (Status != Z_STREAM_END)
+        return false;
+
+    Bytes.swap(Compressed);
+    return true;
+}
+
+void ResultExporter::Submit(Chunk Formatted)
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        InFlight++;
+        Ready.emplace(NextSequence++, std::move(Formatted));
+    }
+    ChunkReady.notify_one();
+}
+
+bool ResultExporter::Write(std::shared_ptr<const ResultBlock> Block)
+{
+    if (!Block || Block->RowCount == 0)
+        return true;
+
+    uint64_t Sequence;
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        SlotFree.wait(Lock, [&] { return Failed || InFlight < Options.MaxInFlightBlocks; });
+        if (Failed)
+            return false;
+        Sequence = NextSequence++;
+        InFlight++;
+        Formatting++;
+    }
+
+    ThreadPool::Shared().Submit([this, Block = std::move(Block), Sequence] {
+        Chunk Formatted;
+        Formatted.Rows = Block->RowCount;
+        Format(*Block, Formatted.Bytes);
+        bool Compressed = Compress(Formatted.Bytes);
+
+        // Notified under the lock: once it is released the exporter may be gone.
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (!Compressed && !Failed)
+        {
+            Failed    = true;
+            FailError = "Cannot compress export data";
+        }
+        Ready.emplace(Sequence, std::move(Formatted));
+        Formatting--;
+        ChunkReady.notify_all();
+        SlotFree.notify_all();
+    });
+    return true;
+}
+
+bool ResultExporter::WriteAll(const char* Data, size_t Length)
+{
+    while (Length > 0)
+    {
+        ssize_t Written = write(Descriptor, Data, Length);
+        if (Written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Failed    = true;
+            FailError = "Cannot write " + Path + ": " + strerror(errno);
+            return false;
+        }
+        Data   += Written;
+        Length -= (size_t)Written;
+        if (Progress)
+            Progress->Bytes.fetch_add((uint64_t)Written, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ResultExporter::RunWriter()
+{
+    std::string Buffer;
+    Buffer.reserve(WriteBufferSize);
+    bool Writing = true;
+
+    for (;;)
+    {
+        Chunk Next;
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            ChunkReady.wait(Lock, [&] {
+                return Stopping || Ready.count(NextWrite) || (Finishing && NextWrite == NextSequence);
+            });
+            if (Stopping)
+                return;
+            auto It = Ready.find(NextWrite);
+            if (It == Ready.end())
+                break;
+            Next = std::move(It->second);
+            Ready.erase(It);
+            NextWrite++;
+            Writing = Writing && !Failed;
+        }
+
+        // Once writing has failed the chunks are still drained, so producers
+        // waiting for a free slot wake up and see the failure.
+        if (Writing)
+        {
+            if (Buffer.size() + Next.Bytes.size() > WriteBufferSize)
+            {
+                Writing = WriteAll(Buffer.data(), Buffer.size());
+                Buffer.clear();
+            }
+            if (Writing && Next.Bytes.size() >= WriteBufferSize)
+                Writing = WriteAll(Next.Bytes.data(), Next.Bytes.size());
+            else
+                Buffer.append(Next.Bytes);
+            if (Writing && Progress)
+                Progress->Rows.fetch_add(Next.Rows, std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            InFlight--;
+        }
+        SlotFree.notify_all();
+    }
+
+    if (Writing && !Buffer.empty())
+        WriteAll(Buffer.data(), Buffer.size());
+}
+
+void ResultExporter::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+        Failed   = true;
+    }
+    ChunkReady.notify_all();
+    SlotFree.notify_all();
+    if (Writer.joinable())
+        Writer.join();
+
+    // Pool tasks still formatting hold a pointer to this exporter.
+    std::unique_lock<std::mutex> Lock(Mutex);
+    SlotFree.wait(Lock, [&] { return Formatting == 0; });
+}
+
+bool ResultExporter::Finish(std::string* Error)
+{
+    if (Descriptor < 0)
+    {
+        if (Error)
+            *Error = "Export file is not open";
+        return false;
+    }
+
+    // A .gz file needs at least one member, even with nothing in it.
+    if (Options.Compression == ExportCompression::Gzip && NextSequence == 0)
+    {
+        Chunk Empty;
+        if (Compress(Empty.Bytes))
+            Submit(std::move(Empty));
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Finishing = true;
+    }
+    ChunkReady.notify_all();
+    if (Writer.joinable())
+        Writer.join();
+
+    bool Succeeded = !Failed;
+    std::string Message = FailError;
+    if (close(Descriptor) != 0 && Succeeded)
+    {
+        Succeeded = false;
+        Message   = "Cannot write " + Path + ": " + strerror(errno);
+    }
+    Descriptor = -1;
+
+    if (!Succeeded)
+    {
+        unlink(Path.c_str());
+        if (Error)
+            *Error = Message;
+    }
+    return Succeeded;
+}
+
+void ResultExporter::Abort()
+{
+    Stop();
+    if (Descriptor >= 0)
+    {
+        close(Descriptor);
+        unlink(Path.c_str());
+        Descriptor = -1;
+    }
+}
+
+bool ResultExporter::ExportStore(const ResultStore& Store, const std::string& Path, const ExportOptions& Options,
+                                 ExportProgress* Progress, const CancelToken* Cancel, std::string* Error)
+{
+    if (Store.PartialCells())
+    {
+        if (Error)
+            *Error = "The result holds BLOB/TEXT values that were only partly fetched; export the query instead";
+        return false;
+    }
+
+    ResultExporter Exporter(Options, Progress);
+    if (!Exporter.Open(Path, Error))
+        return false;
+
+    Exporter.Begin(Store.Columns());
+    for (const std::shared_ptr<const ResultBlock>& Block : Store.Blocks())
+    {
+        if (IsCancelled(Cancel))
+        {
+            Exporter.Abort();
+            if (Error)
+                *Error = "Export cancelled";
+            return false;
+        }
+        if (!Exporter.Write(Block))
+            break;
+    }
+    return Exporter.Finish(Error);
+}
@@ -0,0 +1,124 @@
+//
+//  ResultExport.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+#include "CancelToken.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DBCore
+{
+    enum class ExportFormat : uint8_t
+    {
+        Csv,            // RFC 4180; NULL is an empty field, '' is ""
+        Tsv,            // LOAD DATA escapes; NULL is \N
+        JsonLines,      // one object per row
+    };
+
+    enum class ExportCompression : uint8_t
+    {
+        None,
+        Gzip,
+    };
+
+    struct ExportOptions
+    {
+        ExportFormat      Format            = ExportFormat::Csv;
+        ExportCompression Compression       = ExportCompression::None;
+        int               CompressionLevel  = 6;
+        bool              Header            = true;     // CSV and TSV only
+        size_t            MaxInFlightBlocks = 0;        // 0 = two per pool thread
+    };
+
+    struct ExportProgress
+    {
+        std::atomic<uint64_t> Rows{0};
+        std::atomic<uint64_t> Bytes{0};     // written to the file, after compression
+    };
+
+    // Writes result blocks to a file as they arrive. Each block is formatted
+    // (and compressed, as its own gzip member) on the thread pool; a writer
+    // thread puts the finished chunks back in order and issues large
+    // sequential writes. Write() blocks once MaxInFlightBlocks chunks are
+    // queued, so memory stays bounded however fast the rows come in.
+    // Open, Begin, Write and Finish are called from one thread.
+    class ResultExporter
+    {
+    public:
+        static constexpr size_t WriteBufferSize = 4u << 20;
+
+        explicit ResultExporter(ExportOptions Options, ExportProgress* Progress = nullptr);
+        // Aborts an export that was not finished.
+        ~ResultExporter();
+
+        ResultExporter(const ResultExporter&) = delete;
+        ResultExporter& operator=(const ResultExporter&) = delete;
+
+        bool Open(const std::string& Path, std::string* Error);
+        void Begin(const std::vector<ColumnInfo>& Columns);
+        // False once writing has failed; Finish() reports why.
+        bool Write(std::shared_ptr<const ResultBlock> Block);
+        bool Finish(std::string* Error);
+        // Stops the writer and removes the partial file.
+        void Abort();
+
+        // Streams every block of a complete result.
+        static bool ExportStore(const ResultStore& Store, const std::string& Path, const ExportOptions& Options,
+                                ExportProgress* Progress, const CancelToken* Cancel, std::string* Error);
+
+        // ".csv", ".tsv.gz", ...
+        static std::string FileExtension(const ExportOptions& Options);
+
+    private:
+        struct Chunk
+        {
+            std::string Bytes;
+            uint32_t    Rows = 0;
+        };
+
+        void Format(const ResultBlock& Block, std::string& Out) const;
+        bool Compress(std::string& Bytes) const;
+        void Submit(Chunk Formatted);
+        void RunWriter();
+        bool WriteAll(const char* Data, size_t Length);
+        void Stop();
+
+        ExportOptions   Options;
+        ExportProgress* Progress;
+
+        std::vector<ColumnInfo>  ColumnInfos;
+        std::vector<std::string> JsonKeys;      // "name": per column
+
+        int         Descriptor = -1;
+        std::string Path;
+
+        std::mutex                Mutex;
+        std::condition_variable   ChunkReady;
+        std::condition_variable   SlotFree;
+        std::map<uint64_t, Chunk> Ready;
+        uint64_t                  NextSequence = 0;
+        uint64_t                  NextWrite    = 0;
+        size_t                    InFlight     = 0;     // submitted and not yet written
+        size_t                    Formatting   = 0;     // pool tasks still holding this
+        bool                      Finishing    = false;
+        bool                      Stopping     = false;
+        bool                      Failed       = false;
+        std::string               FailError;
+
+        std::thread Writer;
+    };
+}
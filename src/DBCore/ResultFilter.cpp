@@ -0,0 +1,223 @@
+//
+//  ResultFilter.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultFilter.hpp"
+#include "SubstringSearch.hpp"
+#include "ThreadPool.hpp"
+
+#include <boost/regex.hpp>
+
+#include <algorithm>
+#include <optional>
+
+using namespace DBCore;
+
+// Blocks per published wave, per pool thread.
+static constexpr uint64_t WaveBlocksPerThread = 4;
+// Candidate rows per task when refining.
+static constexpr uint64_t CandidateGrain = 16384;
+
+static bool HasRegexSyntax(const std::string& Pattern)
+{
+    return Pattern.find_first_of(".^$|()[]{}*+?\\") != std::string::npos;
+}
+
+static std::string FoldAscii(std::string Text)
+{
+    for (char& c : Text)
+    {
+        if (c >= 'A' && c <= 'Z')
+            c = (char)(c + 32);
+    }
+    return Text;
+}
+
+bool ResultFilter::Refines(const FilterQuery& Previous, const FilterQuery& Next)
+{
+    if (Previous.CaseSensitive != Next.CaseSensitive)
+        return false;
+
+    // Regexes only refine when they are plain text in disguise.
+    bool PreviousPlain = !Previous.Regex || !HasRegexSyntax(Previous.Pattern);
+    bool NextPlain = !Next.Regex || !HasRegexSyntax(Next.Pattern);
+    if (!PreviousPlain || !NextPlain)
+        return false;
+
+    if (Next.CaseSensitive)
+        return Next.Pattern.find(Previous.Pattern) != std::string::npos;
+    return FoldAscii(Next.Pattern).find(FoldAscii(Previous.Pattern)) != std::string::npos;
+}
+
+namespace
+{
+    // Tests cells against either the substring kernel or a compiled regex.
+    class CellMatcher
+    {
+    public:
+        CellMatcher(const FilterQuery& Query) : Searcher(Query.Pattern, Query.CaseSensitive)
+        {
+            if (Query.Regex && HasRegexSyntax(Query.Pattern))
+            {
+                auto Flags = boost::regex::perl | boost::regex::optimize;
+                if (!Query.CaseSensitive)
+                    Flags |= boost::regex::icase;
+                Expression.emplace(Query.Pattern, Flags);
+            }
+        }
+
+        bool Matches(const ColumnInfo& Column, const CellView& Cell) const
+        {
+            if (Cell.Null)
+                return false;
+
+            char Buffer[64];
+            std::string_view Text = FormatCell(Column, Cell, Buffer, sizeof(Buffer));
+            if (Expression)
+                return boost::regex_search(Text.data(), Text.data() + Text.size(), *Expression);
+            return Searcher.Contains(Text.data(), Text.size());
+        }
+
+        // Marks every row of a text column block that contains a match, by
+        // running the kernel over the whole arena and mapping hits to rows.
+        void ScanArena(const ColumnBlock& Values, std::vector<uint8_t>& Hit) const
+        {
+            const char* Arena = Values.ArenaData();
+            const uint32_t* Offsets = Values.OffsetData();
+            const uint32_t Rows = Values.RowCount();
+            const size_t Length = Values.ArenaSize();
+
+            size_t Position = 0;
+            uint32_t Row = 0;
+            size_t At;
+            while (Row < Rows && (At = Searcher.Find(Arena, Length, Position)) != SubstringSearcher::NotFound)
+            {
+                Row = (uint32_t)(std::upper_bound(Offsets + Row, Offsets + Rows + 1, (uint32_t)At) - Offsets) - 1;
+                if (Row >= Rows)
+                    break;
+                if (At + Searcher.Size() <= Offsets[Row + 1])
+                {
+                    // NULL cells have empty ranges and cannot contain a match.
+                    Hit[Row] = 1;
+                    Position = Offsets[Row + 1];
+                    Row++;
+                }
+                else
+                {
+                    Position = At + 1;
+                }
+            }
+        }
+
+        bool UsesRegex() const { return Expression.has_value(); }
+
+    private:
+        SubstringSearcher           Searcher;
+        std::optional<boost::regex> Expression;
+    };
+}
+
+static void ScanBlock(const ResultStore& Store, const ResultBlock& Block, const CellMatcher& Matcher, std::vector<uint64_t>& Out)
+{
+    std::vector<uint8_t> Hit(Block.RowCount, 0);
+    const auto& Columns = Store.Columns();
+
+    for (size_t c = 0; c < Columns.size(); c++)
+    {
+        const ColumnBlock& Values = Block.Columns[c];
+        if (Columns[c].Encoding == ColumnEncoding::Text && !Matcher.UsesRegex())
+        {
+            Matcher.ScanArena(Values, Hit);
+            continue;
+        }
+        for (uint32_t r = 0; r < Block.RowCount; r++)
+        {
+            if (!Hit[r] && Matcher.Matches(Columns[c], Values.Cell(r)))
+                Hit[r] = 1;
+        }
+    }
+
+    for (uint32_t r = 0; r < Block.RowCount; r++)
+    {
+        if (Hit[r])
+            Out.push_back(Block.FirstRow + r);
+    }
+}
+
+static bool RowMatches(const ResultStore& Store, uint64_t Row, const CellMatcher& Matcher)
+{
+    RowView View = Store.Row(Row);
+    const auto& Columns = Store.Columns();
+    for (size_t c = 0; c < Columns.size(); c++)
+    {
+        if (Matcher.Matches(Columns[c], View[c]))
+            return true;
+    }
+    return false;
+}
+
+bool ResultFilter::Run(const ResultStore& Store, const FilterQuery& Query, const std::vector<uint64_t>* Candidates,
+                       const Progress& Publish, const CancelToken* Cancel, std::string* Error)
+{
+    std::optional<CellMatcher> Matcher;
+    try
+    {
+        Matcher.emplace(Query);
+    }
+    catch (const boost::regex_error& Exception)
+    {
+        if (Error)
+            *Error = Exception.what();
+        return false;
+    }
+
+    ThreadPool& Pool = ThreadPool::Shared();
+    const uint64_t Units = Candidates ? (Candidates->size() + CandidateGrain - 1) / CandidateGrain : Store.Blocks().size();
+    const uint64_t Wave = std::max<uint64_t>(Pool.ThreadCount() * WaveBlocksPerThread, 1);
+
+    std::vector<uint64_t> Matched;
+    for (uint64_t WaveBegin = 0; WaveBegin < Units || WaveBegin == 0; WaveBegin += Wave)
+    {
+        const uint64_t WaveEnd = std::min(WaveBegin + Wave, Units);
+        std::vector<std::vector<uint64_t>> Parts(WaveEnd - WaveBegin);
+
+        Pool.ParallelFor(WaveEnd - WaveBegin, 1, [&](uint64_t Begin, uint64_t End) {
+            for (uint64_t u = Begin; u < End && !IsCancelled(Cancel); u++)
+            {
+                std::vector<uint64_t>& Out = Parts[u];
+                if (!Candidates)
+                {
+                    ScanBlock(Store, *Store.Blocks()[WaveBegin + u], *Matcher, Out);
+                    continue;
+                }
+                uint64_t First = (WaveBegin + u) * CandidateGrain;
+                uint64_t Last = std::min(First + CandidateGrain, (uint64_t)Candidates->size());
+                for (uint64_t i = First; i < Last; i++)
+                {
+                    if (RowMatches(Store, (*Candidates)[i], *Matcher))
+                        Out.push_back((*Candidates)[i]);
+                }
+            }
+        });
+        if (IsCancelled(Cancel))
+            return false;
+
+        // Parts are in block / candidate order, so the set stays sorted.
+        for (const auto& Part : Parts)
+            Matched.insert(Matched.end(), Part.begin(), Part.end());
+
+        auto Snapshot = std::make_shared<FilterMatches>();
+        Snapshot->Query = Query;
+        Snapshot->Rows = Matched;
+        Snapshot->TotalRows = Store.RowCount();
+        Snapshot->Complete = WaveEnd >= Units;
+        Publish(std::move(Snapshot));
+
+        if (Units == 0)
+            break;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+//
+//  ResultFilter.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+#include "CancelToken.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace DBCore
+{
+    struct FilterQuery
+    {
+        std::string Pattern;
+        bool        Regex         = false;
+        bool        CaseSensitive = false;
+
+        bool operator==(const FilterQuery&) const = default;
+    };
+
+    // Rows (ascending) that contain the pattern in any column. Partial sets
+    // cover the first ScannedRows rows, or a prefix of the candidates.
+    struct FilterMatches
+    {
+        FilterQuery           Query;
+        std::vector<uint64_t> Rows;
+        uint64_t              TotalRows = 0;
+        bool                  Complete  = false;
+    };
+
+    // Search-as-you-type over a fetched result. Text columns are scanned
+    // arena by arena with the SIMD substring kernel; typed columns are
+    // formatted first; boost::regex is only used for regex queries that
+    // actually contain metacharacters. Blocks are scanned on the thread
+    // pool in waves and every wave is published through Progress.
+    class ResultFilter
+    {
+    public:
+        using Progress = std::function<void(std::shared_ptr<const FilterMatches>)>;
+
+        // True when every match of Next is also a match of Previous, so Next
+        // only needs to look at Previous's rows.
+        static bool Refines(const FilterQuery& Previous, const FilterQuery& Next);
+
+        // Candidates, when given, are the complete matches of a query that
+        // Query refines; only those rows are checked.
+        static bool Run(const ResultStore& Store, const FilterQuery& Query, const std::vector<uint64_t>* Candidates,
+                        const Progress& Publish, const CancelToken* Cancel, std::string* Error);
+    };
+}
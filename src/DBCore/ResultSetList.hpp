@@ -0,0 +1,91 @@
+//
+//  ResultSetList.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultSnapshot.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace DBCore
+{
+    // What the server reported for one result of a script besides its rows.
+    struct ResultSummary
+    {
+        bool     HasRows      = false;  // a result set rather than an OK packet
+        bool     Failed       = false;  // the error that ended the script
+        uint64_t AffectedRows = 0;
+        uint64_t InsertId     = 0;
+        unsigned Warnings     = 0;
+        double   Seconds      = 0.0;    // since the previous result was read
+    };
+
+    // Results of one run of the editor, one publisher per result set or
+    // status message, in the order the server sent them. Publishers are
+    // reused by position across runs, so a widget bound to a position keeps
+    // seeing increasing generations and result ids. The query thread adds
+    // results, the UI reads them.
+    class ResultSetList
+    {
+    public:
+        // Bumped by Clear(); lets the UI notice a new run.
+        uint64_t Run() const { return CurrentRun.load(std::memory_order_acquire); }
+
+        // Starts a new run. The results of the previous one are released.
+        void Clear() {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            for (size_t i = 0; i < Used; i++)
+                Publishers[i]->Publish(nullptr);
+            Used = 0;
+            Summaries.clear();
+            CurrentRun.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        // Appends a result and returns the publisher its rows go to.
+        std::shared_ptr<ResultPublisher> Add() {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            if (Used == Publishers.size())
+                Publishers.push_back(std::make_shared<ResultPublisher>());
+            Summaries.emplace_back();
+            return Publishers[Used++];
+        }
+
+        // Sets the summary of the last result added.
+        void Summarize(const ResultSummary& Summary) {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            if (Used)
+                Summaries[Used - 1] = Summary;
+        }
+
+        size_t Count() const {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return Used;
+        }
+
+        // Null past Count().
+        std::shared_ptr<ResultPublisher> Publisher(size_t Index) const {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return Index < Used ? Publishers[Index] : nullptr;
+        }
+
+        ResultSummary Summary(size_t Index) const {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return Index < Used ? Summaries[Index] : ResultSummary();
+        }
+
+    private:
+        mutable std::mutex                            Mutex;
+        std::vector<std::shared_ptr<ResultPublisher>> Publishers;
+        std::vector<ResultSummary>                    Summaries;
+        size_t                                        Used = 0;
+        std::atomic<uint64_t>                         CurrentRun{0};
+    };
+}
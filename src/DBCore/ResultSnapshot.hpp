@@ -0,0 +1,111 @@
+//
+//  ResultSnapshot.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace DBCore
+{
+    struct StreamStats
+    {
+        uint64_t Rows     = 0;
+        uint64_t Bytes    = 0;
+        double   Seconds  = 0.0;
+        bool     Complete = true;
+        bool     Streamed = false;      // rows of a result set rather than a status message
+
+        double RowsPerSecond() const { return Seconds > 0.0 ? Rows / Seconds : 0.0; }
+        double MegabytesPerSecond() const { return Seconds > 0.0 ? Bytes / Seconds / (1024.0 * 1024.0) : 0.0; }
+    };
+
+    // Immutable view of a result as published by the query thread. Widgets that
+    // derive data from it (sort orders, filters, layout caches) key their caches
+    // on Generation and recompute only when it changes. ResultId stays the same
+    // while a streamed result grows, so row-indexed state can be kept.
+    struct ResultSnapshot
+    {
+        uint64_t                           Generation = 0;
+        uint64_t                           ResultId   = 0;
+        std::shared_ptr<const ResultStore> Store;
+        StreamStats                        Stats;
+
+        uint64_t RowCount() const { return Store ? Store->RowCount() : 0; }
+        bool     Complete() const { return Stats.Complete; }
+    };
+
+    class ResultPublisher
+    {
+    public:
+        uint64_t Generation() const { return CurrentGeneration.load(std::memory_order_acquire); }
+
+        // ContinuesResult marks a snapshot that only appends rows to the previous one.
+        std::shared_ptr<const ResultSnapshot> Publish(std::shared_ptr<const ResultStore> Store, StreamStats Stats = StreamStats(), bool ContinuesResult = false) {
+            auto Snapshot = std::make_shared<ResultSnapshot>();
+            Snapshot->Store = std::move(Store);
+            Snapshot->Stats = Stats;
+            if (Snapshot->Stats.Rows == 0 && Snapshot->Store)
+                Snapshot->Stats.Rows = Snapshot->Store->RowCount();
+
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Snapshot->Generation = CurrentGeneration.load(std::memory_order_relaxed) + 1;
+            Snapshot->ResultId   = ContinuesResult ? CurrentResult : ++CurrentResult;
+            Current = Snapshot;
+            CurrentGeneration.store(Snapshot->Generation, std::memory_order_release);
+            return Snapshot;
+        }
+
+        std::shared_ptr<const ResultSnapshot> Acquire() const {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return Current;
+        }
+
+        // Cheap per-frame refresh: only takes the lock when a newer snapshot exists.
+        bool Refresh(std::shared_ptr<const ResultSnapshot>& Held) const {
+            uint64_t Latest = Generation();
+            if (Held && Held->Generation == Latest)
+                return false;
+            if (!Held && Latest == 0)
+                return false;
+            Held = Acquire();
+            Acknowledge(Held ? Held->Generation : 0);
+            return true;
+        }
+
+        // Backpressure for streaming producers: the consumer acknowledges what it
+        // picked up, the producer waits (bounded) while it is too far ahead.
+        void Acknowledge(uint64_t Generation) const {
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                if (Generation > ConsumedGeneration)
+                    ConsumedGeneration = Generation;
+            }
+            ConsumerCondition.notify_all();
+        }
+
+        bool WaitForConsumer(uint64_t MaxPending, std::chrono::milliseconds Timeout) const {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            return ConsumerCondition.wait_for(Lock, Timeout, [&] {
+                return CurrentGeneration.load(std::memory_order_relaxed) <= ConsumedGeneration + MaxPending;
+            });
+        }
+
+    private:
+        mutable std::mutex                    Mutex;
+        mutable std::condition_variable       ConsumerCondition;
+        std::shared_ptr<const ResultSnapshot> Current;
+        std::atomic<uint64_t>                 CurrentGeneration{0};
+        mutable uint64_t                      ConsumedGeneration = 0;
+        uint64_t                              CurrentResult      = 0;
+    };
+}
@@ -0,0 +1,329 @@
+//
+//  ResultSorter.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultSorter.hpp"
+#include "ThreadPool.hpp"
+#include "ValueParser.hpp"
+
+#include <MariaDBKit/mysql.h>
+
+#include <boost/sort/block_indirect_sort/block_indirect_sort.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+using namespace DBCore;
+
+// Binary collation id; columns in it compare bytewise like BINARY_FLAG ones.
+static constexpr unsigned int BinaryCharset = 63;
+// Most fraction digits a DECIMAL key can scale by; ParseDecimal holds 38 digits.
+static constexpr unsigned int MaxDecimalScale = 38;
+
+SortKeyKind DBCore::SortKeyKindForColumn(const ColumnInfo& Column)
+{
+    switch (Column.Encoding)
+    {
+        case ColumnEncoding::Int64:    return SortKeyKind::Signed;
+        case ColumnEncoding::UInt64:   return SortKeyKind::Unsigned;
+        case ColumnEncoding::Double:   return SortKeyKind::Real;
+        case ColumnEncoding::DateTime: return SortKeyKind::Temporal;
+        case ColumnEncoding::Time:     return SortKeyKind::Duration;
+        case ColumnEncoding::Text:     break;
+    }
+
+    switch (Column.Type)
+    {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR:
+            return (Column.Flags & UNSIGNED_FLAG) ? SortKeyKind::Unsigned : SortKeyKind::Signed;
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            return SortKeyKind::Real;
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_DATETIME2:
+        case MYSQL_TYPE_TIMESTAMP:
+        case MYSQL_TYPE_TIMESTAMP2:
+            return SortKeyKind::Temporal;
+        case MYSQL_TYPE_TIME:
+        case MYSQL_TYPE_TIME2:
+            return SortKeyKind::Duration;
+        default:
+            break;
+    }
+
+    if ((Column.Flags & BINARY_FLAG) || Column.Charset == BinaryCharset)
+        return SortKeyKind::Bytes;
+    return SortKeyKind::Text;
+}
+
+// Order-preserving maps into unsigned 64-bit keys.
+static uint64_t SignedKey(int64_t Value) { return (uint64_t)Value ^ (1ull << 63); }
+
+static uint64_t RealKey(double Value)
+{
+    uint64_t Bits;
+    memcpy(&Bits, &Value, sizeof(Bits));
+    return (Bits & (1ull << 63)) ? ~Bits : Bits | (1ull << 63);
+}
+
+static uint64_t NumericKey(SortKeyKind Kind, const ColumnInfo& Column, const CellView& Cell)
+{
+    if (Column.Encoding != ColumnEncoding::Text)
+    {
+        switch (Kind)
+        {
+            case SortKeyKind::Unsigned: return Cell.As<uint64_t>();
+            case SortKeyKind::Real:     return RealKey(Cell.As<double>());
+            default:                    return SignedKey(Cell.As<int64_t>());
+        }
+    }
+
+    std::string_view Text = Cell.Text();
+    switch (Kind)
+    {
+        case SortKeyKind::Signed:
+        {
+            int64_t Value = 0;
+            ParseInt64(Text, Value);
+            return SignedKey(Value);
+        }
+        case SortKeyKind::Unsigned:
+        {
+            uint64_t Value = 0;
+            ParseUInt64(Text, Value);
+            return Value;
+        }
+        case SortKeyKind::Real:
+        {
+            double Value = 0.0;
+            ParseDouble(Text, Value);
+            return RealKey(Value);
+        }
+        case SortKeyKind::Temporal:
+        {
+            int64_t Packed = 0;
+            ParseDateTime(Text, Packed);
+            return SignedKey(Packed);
+        }
+        case SortKeyKind::Duration:
+        {
+            int64_t Micros = 0;
+            ParseTime(Text, Micros);
+            return SignedKey(Micros);
+        }
+        default:
+            return 0;
+    }
+}
+
+namespace
+{
+    struct NumericEntry
+    {
+        uint64_t Key;
+        uint64_t Row;
+    };
+
+    // DECIMAL scaled to an integer by the column's decimals, so values that
+    // differ past a double's 17 digits keep their order.
+    struct DecimalEntry
+    {
+        __int128 Key;
+        uint64_t Row;
+    };
+
+    struct TextEntry
+    {
+        uint64_t    Prefix;     // first 8 (folded) bytes, big-endian
+        const char* Data;
+        uint32_t    Length;
+        uint64_t    Row;
+    };
+
+    inline unsigned char Fold(unsigned char c) { return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c; }
+
+    uint64_t TextPrefix(std::string_view Text, bool FoldCase)
+    {
+        uint64_t Prefix = 0;
+        for (size_t i = 0; i < 8; i++)
+        {
+            unsigned char c = i < Text.size() ? (unsigned char)Text[i] : 0;
+            Prefix = (Prefix << 8) | (FoldCase ? Fold(c) : c);
+        }
+        return Prefix;
+    }
+
+    // Full comparison past the shared prefix; Length breaks ties between
+    // "ab" and "ab\0", Row keeps equal values in fetch order.
+    int CompareText(const TextEntry& a, const TextEntry& b, bool FoldCase)
+    {
+        uint32_t Common = std::min(a.Length, b.Length);
+        if (!FoldCase)
+        {
+            int Order = Common > 8 ? memcmp(a.Data + 8, b.Data + 8, Common - 8) : 0;
+            if (Order != 0)
+                return Order;
+        }
+        else
+        {
+            for (uint32_t i = 8; i < Common; i++)
+            {
+                unsigned char x = Fold((unsigned char)a.Data[i]), y = Fold((unsigned char)b.Data[i]);
+                if (x != y)
+                    return x < y ? -1 : 1;
+            }
+        }
+        if (a.Length != b.Length)
+            return a.Length < b.Length ? -1 : 1;
+        return 0;
+    }
+}
+
+template<typename Entry, typename MakeEntry>
+static bool CollectEntries(const ResultStore& Store, size_t Column, std::vector<Entry>& Entries,
+                           std::vector<uint64_t>& NullRows, const CancelToken* Cancel, MakeEntry Make)
+{
+    const auto& Blocks = Store.Blocks();
+
+    // Pass 1: non-NULL counts per block give every block its output range.
+    std::vector<uint64_t> Starts(Blocks.size() + 1, 0);
+    std::vector<uint64_t> NullStarts(Blocks.size() + 1, 0);
+    for (size_t b = 0; b < Blocks.size(); b++)
+    {
+        const ColumnBlock& Values = Blocks[b]->Columns[Column];
+        uint64_t Nulls = 0;
+        for (uint32_t r = 0; r < Values.RowCount(); r++)
+            Nulls += Values.IsNull(r);
+        Starts[b + 1] = Starts[b] + (Values.RowCount() - Nulls);
+        NullStarts[b + 1] = NullStarts[b] + Nulls;
+    }
+    Entries.resize(Starts.back());
+    NullRows.resize(NullStarts.back());
+
+    // Pass 2: keys, one block per task.
+    ThreadPool::Shared().ParallelFor(Blocks.size(), 1, [&](uint64_t Begin, uint64_t End) {
+        for (uint64_t b = Begin; b < End && !IsCancelled(Cancel); b++)
+        {
+            const ResultBlock& Block = *Blocks[b];
+            const ColumnBlock& Values = Block.Columns[Column];
+            Entry* Out = Entries.data() + Starts[b];
+            uint64_t* NullOut = NullRows.data() + NullStarts[b];
+            for (uint32_t r = 0; r < Values.RowCount(); r++)
+            {
+                if (Values.IsNull(r))
+                    *NullOut++ = Block.FirstRow + r;
+                else
+                    *Out++ = Make(Values.Cell(r), Block.FirstRow + r);
+            }
+        }
+    });
+    return !IsCancelled(Cancel);
+}
+
+template<typename Entry>
+static void AppendPermutation(const std::vector<Entry>& Entries, const std::vector<uint64_t>& NullRows,
+                              bool Descending, std::vector<uint64_t>& Permutation)
+{
+    Permutation.clear();
+    Permutation.reserve(Entries.size() + NullRows.size());
+    if (!Descending)
+        Permutation.insert(Permutation.end(), NullRows.begin(), NullRows.end());
+    for (const Entry& Item : Entries)
+        Permutation.push_back(Item.Row);
+    if (Descending)
+        Permutation.insert(Permutation.end(), NullRows.begin(), NullRows.end());
+}
+
+bool ResultSorter::Sort(const ResultStore& Store, size_t Column, bool Descending,
+                        std::vector<uint64_t>& Permutation, const CancelToken* Cancel)
+{
+    if (Column >= Store.ColumnCount())
+        return false;
+
+    const ColumnInfo& Info = Store.Columns()[Column];
+    const SortKeyKind Kind = SortKeyKindForColumn(Info);
+    const uint32_t Threads = std::max(ThreadPool::Shared().ThreadCount(), 1u);
+    std::vector<uint64_t> NullRows;
+
+    if (Kind == SortKeyKind::Bytes || Kind == SortKeyKind::Text)
+    {
+        const bool FoldCase = Kind == SortKeyKind::Text;
+        std::vector<TextEntry> Entries;
+        bool Collected = CollectEntries(Store, Column, Entries, NullRows, Cancel, [FoldCase](const CellView& Cell, uint64_t Row) {
+            return TextEntry{ TextPrefix(Cell.Text(), FoldCase), Cell.Data, Cell.Length, Row };
+        });
+        if (!Collected)
+            return false;
+
+        boost::sort::block_indirect_sort(Entries.begin(), Entries.end(), [FoldCase, Descending](const TextEntry& a, const TextEntry& b) {
+            int Order = a.Prefix != b.Prefix ? (a.Prefix < b.Prefix ? -1 : 1) : CompareText(a, b, FoldCase);
+            if (Order != 0)
+                return Descending ? Order > 0 : Order < 0;
+            return a.Row < b.Row;
+        }, Threads);
+        if (IsCancelled(Cancel))
+            return false;
+
+        AppendPermutation(Entries, NullRows, Descending, Permutation);
+        return true;
+    }
+
+    auto ByKey = [Descending](const auto& a, const auto& b) {
+        if (a.Key != b.Key)
+            return Descending ? a.Key > b.Key : a.Key < b.Key;
+        return a.Row < b.Row;
+    };
+
+    if (Info.Encoding == ColumnEncoding::Text && (Info.Type == MYSQL_TYPE_DECIMAL || Info.Type == MYSQL_TYPE_NEWDECIMAL) &&
+        Info.Decimals <= MaxDecimalScale)
+    {
+        std::atomic_bool Overflow{false};
+        std::vector<DecimalEntry> Decimals;
+        bool Collected = CollectEntries(Store, Column, Decimals, NullRows, Cancel, [&Info, &Overflow](const CellView& Cell, uint64_t Row) {
+            DecimalEntry Item{ 0, Row };
+            if (!ParseDecimal(Cell.Text(), (int)Info.Decimals, Item.Key))
+                Overflow.store(true, std::memory_order_relaxed);
+            return Item;
+        });
+        if (!Collected)
+            return false;
+
+        // A value past 38 digits (DECIMAL(65)) sorts the column by its double keys below.
+        if (!Overflow.load())
+        {
+            boost::sort::block_indirect_sort(Decimals.begin(), Decimals.end(), ByKey, Threads);
+            if (IsCancelled(Cancel))
+                return false;
+
+            AppendPermutation(Decimals, NullRows, Descending, Permutation);
+            return true;
+        }
+    }
+
+    std::vector<NumericEntry> Entries;
+    bool Collected = CollectEntries(Store, Column, Entries, NullRows, Cancel, [Kind, &Info](const CellView& Cell, uint64_t Row) {
+        return NumericEntry{ NumericKey(Kind, Info, Cell), Row };
+    });
+    if (!Collected)
+        return false;
+
+    boost::sort::block_indirect_sort(Entries.begin(), Entries.end(), ByKey, Threads);
+    if (IsCancelled(Cancel))
+        return false;
+
+    AppendPermutation(Entries, NullRows, Descending, Permutation);
+    return true;
+}
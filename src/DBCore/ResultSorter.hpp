@@ -0,0 +1,44 @@
+//
+//  ResultSorter.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultStore.hpp"
+#include "CancelToken.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace DBCore
+{
+    // How a column's values compare, derived from its MYSQL_FIELD type. Text
+    // protocol columns of numeric or temporal type are parsed, so 10 sorts
+    // after 9 and dates sort chronologically.
+    enum class SortKeyKind : uint8_t
+    {
+        Signed,
+        Unsigned,
+        Real,
+        Temporal,       // packed DATE/DATETIME/TIMESTAMP
+        Duration,       // TIME as signed microseconds
+        Bytes,          // binary strings, byte order
+        Text,           // ASCII case-insensitive, like the usual _ci collations
+    };
+
+    SortKeyKind SortKeyKindForColumn(const ColumnInfo& Column);
+
+    // Client-side ORDER BY over one column of a fetched result. The result
+    // stays in place; the output is a row permutation. Keys are built in
+    // parallel per block, then sorted with Boost's block_indirect_sort.
+    // NULLs come first ascending and last descending, ties keep fetch order.
+    class ResultSorter
+    {
+    public:
+        static bool Sort(const ResultStore& Store, size_t Column, bool Descending,
+                         std::vector<uint64_t>& Permutation, const CancelToken* Cancel = nullptr);
+    };
+}
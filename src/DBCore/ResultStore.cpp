@@ -0,0 +1,410 @@
+//
+//  ResultStore.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultStore.hpp"
+#include "SpillFile.hpp"
+
+#include <MariaDBKit/mysql.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+using namespace DBCore;
+
+static size_t AlignUp(size_t Value) { return (Value + 7) & ~(size_t)7; }
+
+size_t ColumnBlock::SpillSize() const
+{
+    return AlignUp(NullBits.size()) + AlignUp(Offsets.size() * sizeof(uint32_t)) + AlignUp(Arena.size());
+}
+
+void ColumnBlock::BindOwned()
+{
+    ArenaView   = Arena.data();
+    OffsetView  = Offsets.data();
+    NullView    = NullBits.data();
+    ArenaLength = Arena.size();
+}
+
+size_t ResultBlock::ByteSize() const
+{
+    size_t Size = 0;
+    for (const ColumnBlock& Column : Columns)
+        Size += Column.ByteSize();
+    return Size;
+}
+
+uint64_t ResultBlock::FullLength(uint32_t Row, size_t Column) const
+{
+    if (Partial.empty())
+        return 0;
+    auto It = std::lower_bound(Partial.begin(), Partial.end(), std::make_pair(Row, (uint32_t)Column),
+                               [](const PartialCell& Cell, const std::pair<uint32_t, uint32_t>& Key) {
+                                   return Cell.Row != Key.first ? Cell.Row < Key.first : Cell.Column < Key.second;
+                               });
+    return It != Partial.end() && It->Row == Row && It->Column == Column ? It->FullLength : 0;
+}
+
+ResultStore::ResultStore(std::vector<ColumnInfo> Columns, std::vector<std::shared_ptr<const ResultBlock>> Blocks)
+    : ColumnInfos(std::move(Columns)), BlockList(std::move(Blocks))
+{
+    for (const auto& Block : BlockList)
+    {
+        TotalRows    += Block->RowCount;
+        TotalBytes   += Block->ByteSize();
+        TotalSpilled += Block->SpillBytes;
+        TotalPartial += Block->Partial.size();
+    }
+}
+
+uint64_t ResultStore::FullLength(uint64_t Row, size_t Column) const
+{
+    if (TotalPartial == 0 || Row >= TotalRows)
+        return 0;
+    const ResultBlock* Block = BlockList[FindBlock(Row)].get();
+    return Block->FullLength((uint32_t)(Row - Block->FirstRow), Column);
+}
+
+size_t ResultStore::FindBlock(uint64_t Row) const
+{
+    auto It = std::upper_bound(BlockList.begin(), BlockList.end(), Row,
+                               [](uint64_t Value, const std::shared_ptr<const ResultBlock>& Block) {
+                                   return Value < Block->FirstRow;
+                               });
+    return (size_t)(It - BlockList.begin()) - 1;
+}
+
+RowView ResultStore::Row(uint64_t Index) const
+{
+    if (Index >= TotalRows)
+        return RowView();
+
+    const ResultBlock* Block = BlockList[FindBlock(Index)].get();
+    return RowView(Block, (uint32_t)(Index - Block->FirstRow));
+}
+
+std::shared_ptr<ResultStore> ResultStore::FromMessage(const std::string& Column, const std::string& Message)
+{
+    ColumnInfo Info;
+    Info.Name = Column;
+
+    ResultStoreBuilder Builder({ Info });
+    Builder.AppendCell(Message.data(), Message.size());
+    Builder.EndRow();
+    return Builder.Finish();
+}
+
+ResultStoreBuilder::ResultStoreBuilder(std::vector<ColumnInfo> Columns, uint32_t BlockRows)
+    : ColumnInfos(std::move(Columns)), BlockRows(std::max<uint32_t>(BlockRows, 1))
+{
+}
+
+ResultStoreBuilder::~ResultStoreBuilder() = default;
+ResultStoreBuilder::ResultStoreBuilder(ResultStoreBuilder&&) noexcept = default;
+ResultStoreBuilder& ResultStoreBuilder::operator=(ResultStoreBuilder&&) noexcept = default;
+
+void ResultStoreBuilder::SetMemoryBudget(size_t Bytes, std::string Directory)
+{
+    MemoryBudget   = Bytes;
+    SpillDirectory = std::move(Directory);
+}
+
+void ResultStoreBuilder::OpenBlock()
+{
+    Open = std::make_unique<ResultBlock>();
+    Open->FirstRow = SealedRows;
+    Open->Columns.resize(ColumnInfos.size());
+
+    for (size_t i = 0; i < ColumnInfos.size(); i++)
+    {
+        ColumnBlock& Column = Open->Columns[i];
+        Column.Width = EncodingWidth(ColumnInfos[i].Encoding);
+        if (Column.Width)
+        {
+            Column.Arena.reserve((size_t)BlockRows * Column.Width);
+        }
+        else
+        {
+            Column.Offsets.reserve(BlockRows + 1);
+            Column.Offsets.push_back(0);
+        }
+        Column.NullBits.reserve((BlockRows + 7) / 8);
+    }
+
+    OpenRows   = 0;
+    OpenColumn = 0;
+    OpenBytes  = 0;
+}
+
+void ResultStoreBuilder::SetNull(ColumnBlock& Column, uint32_t Row, bool Null)
+{
+    if ((Row & 7) == 0)
+        Column.NullBits.push_back(0);
+    if (Null)
+        Column.NullBits.back() |= (uint8_t)(1u << (Row & 7));
+}
+
+void ResultStoreBuilder::AppendCell(const char* Data, size_t Length)
+{
+    if (!Open)
+        OpenBlock();
+
+    ColumnBlock& Column = Open->Columns[OpenColumn++];
+    if (Column.Width)
+    {
+        Length = Column.Width;
+        Column.Arena.insert(Column.Arena.end(), Data, Data + Length);
+    }
+    else
+    {
+        Column.Arena.insert(Column.Arena.end(), Data, Data + Length);
+        Column.Offsets.push_back((uint32_t)Column.Arena.size());
+    }
+    SetNull(Column, OpenRows, false);
+    Column.Rows++;
+    OpenBytes  += Length;
+    TotalBytes += Length;
+}
+
+void ResultStoreBuilder::AppendPartialCell(const char* Data, size_t Length, uint64_t FullLength)
+{
+    if (!Open)
+        OpenBlock();
+    Open->Partial.push_back(PartialCell{ OpenRows, (uint32_t)OpenColumn, FullLength });
+    AppendCell(Data, Length);
+}
+
+void ResultStoreBuilder::AppendNull()
+{
+    if (!Open)
+        OpenBlock();
+
+    ColumnBlock& Column = Open->Columns[OpenColumn++];
+    if (Column.Width)
+        Column.Arena.resize(Column.Arena.size() + Column.Width);
+    else
+        Column.Offsets.push_back((uint32_t)Column.Arena.size());
+    SetNull(Column, OpenRows, true);
+    Column.Rows++;
+}
+
+void ResultStoreBuilder::EndRow()
+{
+    if (!Open)
+        OpenBlock();
+
+    // Short rows are padded with NULLs so every column stays aligned.
+    while (OpenColumn < ColumnInfos.size())
+        AppendNull();
+
+    OpenColumn = 0;
+    OpenRows++;
+
+    // Offsets are 32-bit, so a block is also sealed well before its arena gets near 4 GB.
+    if (OpenRows >= BlockRows || OpenBytes >= MaxBlockArenaSize)
+        Seal();
+}
+
+void ResultStoreBuilder::AppendRow(const char* const* Cells, const unsigned long* Lengths)
+{
+    for (size_t i = 0; i < ColumnInfos.size(); i++)
+    {
+        if (Cells[i])
+            AppendCell(Cells[i], Lengths ? Lengths[i] : strlen(Cells[i]));
+        else
+            AppendNull();
+    }
+    EndRow();
+}
+
+void ResultStoreBuilder::Seal()
+{
+    if (!Open || OpenRows == 0)
+        return;
+
+    Open->RowCount = OpenRows;
+    // OpenBlock reserved room for a full block; a streamed flush seals far
+    // fewer rows, and ByteSize() counts what is still reserved.
+    for (ColumnBlock& Column : Open->Columns)
+    {
+        Column.Arena.shrink_to_fit();
+        Column.Offsets.shrink_to_fit();
+        Column.NullBits.shrink_to_fit();
+        Column.BindOwned();
+    }
+
+    if (SealedSink)
+    {
+        SealedRows += OpenRows;
+        OpenRows = 0;
+        SealedSink(ColumnInfos, std::shared_ptr<const ResultBlock>(Open.release()));
+        return;
+    }
+
+    size_t BlockBytes = Open->ByteSize();
+    if (MemoryBudget && Resident + BlockBytes > MemoryBudget && SpillOpen())
+        Spilled += Open->SpillBytes;
+    else
+        Resident += BlockBytes;
+
+    SealedRows += OpenRows;
+    SealedBlocks.push_back(std::shared_ptr<const ResultBlock>(Open.release()));
+    OpenRows = 0;
+}
+
+// Writes the open block's columns into the spill file and repoints the
+// views at the mapping. On failure the block simply stays in memory.
+bool ResultStoreBuilder::SpillOpen()
+{
+    if (!Spill)
+    {
+        Spill = SpillFile::Create(SpillDirectory, &LastSpillError);
+        if (!Spill)
+        {
+            // Do not retry on every block once the file could not be created.
+            MemoryBudget = 0;
+            return false;
+        }
+    }
+
+    size_t Total = 0;
+    for (const ColumnBlock& Column : Open->Columns)
+        Total += Column.SpillSize();
+
+    uint64_t Offset;
+    std::shared_ptr<const SpillMapping> Mapping;
+    const char* Data;
+    if (!Spill->Allocate(Total, Offset, Mapping, Data, &LastSpillError))
+        return false;
+
+    size_t Position = 0;
+    for (const ColumnBlock& Column : Open->Columns)
+    {
+        const size_t NullSize   = Column.NullBits.size();
+        const size_t OffsetSize = Column.Offsets.size() * sizeof(uint32_t);
+        const size_t ArenaSize  = Column.Arena.size();
+
+        if (!Spill->Write(Offset + Position, Column.NullBits.data(), NullSize, &LastSpillError))
+            return false;
+        Position += AlignUp(NullSize);
+        if (OffsetSize && !Spill->Write(Offset + Position, Column.Offsets.data(), OffsetSize, &LastSpillError))
+            return false;
+        Position += AlignUp(OffsetSize);
+        if (ArenaSize && !Spill->Write(Offset + Position, Column.Arena.data(), ArenaSize, &LastSpillError))
+            return false;
+        Position += AlignUp(ArenaSize);
+    }
+
+    // Everything is on disk; switch the views over and release the heap copies.
+    Position = 0;
+    for (ColumnBlock& Column : Open->Columns)
+    {
+        const size_t NullSize   = Column.NullBits.size();
+        const size_t OffsetSize = Column.Offsets.size() * sizeof(uint32_t);
+        const size_t ArenaSize  = Column.Arena.size();
+
+        Column.NullView = reinterpret_cast<const uint8_t*>(Data + Position);
+        Position += AlignUp(NullSize);
+        Column.OffsetView = OffsetSize ? reinterpret_cast<const uint32_t*>(Data + Position) : nullptr;
+        Position += AlignUp(OffsetSize);
+        Column.ArenaView = Data + Position;
+        Column.ArenaLength = ArenaSize;
+        Position += AlignUp(ArenaSize);
+
+        std::vector<char>().swap(Column.Arena);
+        std::vector<uint32_t>().swap(Column.Offsets);
+        std::vector<uint8_t>().swap(Column.NullBits);
+    }
+
+    Open->Spill      = std::move(Mapping);
+    Open->SpillBytes = Total;
+    return true;
+}
+
+std::shared_ptr<ResultStore> ResultStoreBuilder::Sealed() const
+{
+    return std::make_shared<ResultStore>(ColumnInfos, SealedBlocks);
+}
+
+std::shared_ptr<ResultStore> ResultStoreBuilder::Finish()
+{
+    Seal();
+    return Sealed();
+}
+
+// NOT_FIXED_DEC from the server headers: floating columns without a fixed scale.
+static constexpr unsigned int NotFixedDecimals = 31;
+
+static size_t FormatFraction(char* Out, unsigned long Microsecond, unsigned int Decimals)
+{
+    if (Decimals == 0 || Decimals > 6)
+        return 0;
+
+    char Digits[8];
+    snprintf(Digits, sizeof(Digits), "%06lu", Microsecond);
+    Out[0] = '.';
+    memcpy(Out + 1, Digits, Decimals);
+    return Decimals + 1;
+}
+
+std::string_view DBCore::FormatCell(const ColumnInfo& Column, const CellView& Cell, char* Buffer, size_t BufferSize)
+{
+    if (Cell.Null)
+        return std::string_view("NULL", 4);
+
+    char* End = Buffer + BufferSize;
+    switch (Column.Encoding)
+    {
+        case ColumnEncoding::Text:
+            return Cell.Text();
+        case ColumnEncoding::Int64:
+            return std::string_view(Buffer, std::to_chars(Buffer, End, Cell.As<int64_t>()).ptr - Buffer);
+        case ColumnEncoding::UInt64:
+            return std::string_view(Buffer, std::to_chars(Buffer, End, Cell.As<uint64_t>()).ptr - Buffer);
+        case ColumnEncoding::Double:
+        {
+            double Value = Cell.As<double>();
+            std::to_chars_result Result;
+            if (Column.Decimals < NotFixedDecimals)
+                Result = std::to_chars(Buffer, End, Value, std::chars_format::fixed, (int)Column.Decimals);
+            else if (Column.Type == MYSQL_TYPE_FLOAT)
+                Result = std::to_chars(Buffer, End, (float)Value);
+            else
+                Result = std::to_chars(Buffer, End, Value);
+            return std::string_view(Buffer, Result.ptr - Buffer);
+        }
+        case ColumnEncoding::DateTime:
+        {
+            unsigned Year, Month, Day, Hour, Minute, Second;
+            unsigned long Microsecond;
+            UnpackDateTime(Cell.As<int64_t>(), Year, Month, Day, Hour, Minute, Second, Microsecond);
+
+            int Length;
+            if (Column.Type == MYSQL_TYPE_DATE || Column.Type == MYSQL_TYPE_NEWDATE)
+                Length = snprintf(Buffer, BufferSize, "%04u-%02u-%02u", Year, Month, Day);
+            else
+                Length = snprintf(Buffer, BufferSize, "%04u-%02u-%02u %02u:%02u:%02u", Year, Month, Day, Hour, Minute, Second);
+            Length += (int)FormatFraction(Buffer + Length, Microsecond, Column.Decimals);
+            return std::string_view(Buffer, (size_t)Length);
+        }
+        case ColumnEncoding::Time:
+        {
+            int64_t Value = Cell.As<int64_t>();
+            bool Negative = Value < 0;
+            uint64_t Micros = Negative ? (uint64_t)-Value : (uint64_t)Value;
+            uint64_t Seconds = Micros / 1000000;
+
+            int Length = snprintf(Buffer, BufferSize, "%s%02llu:%02u:%02u", Negative ? "-" : "",
+                                  (unsigned long long)(Seconds / 3600), (unsigned)(Seconds / 60 % 60), (unsigned)(Seconds % 60));
+            Length += (int)FormatFraction(Buffer + Length, (unsigned long)(Micros % 1000000), Column.Decimals);
+            return std::string_view(Buffer, (size_t)Length);
+        }
+    }
+    return Cell.Text();
+}
@@ -0,0 +1,323 @@
+//
+//  ResultStore.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DBCore
+{
+    class SpillFile;
+    class SpillMapping;
+
+    // How cell values are laid out in a column's arena. Text columns keep the
+    // wire bytes; the others hold one native 8-byte value per row.
+    enum class ColumnEncoding : uint8_t
+    {
+        Text,
+        Int64,
+        UInt64,
+        Double,
+        DateTime,   // packed, see PackDateTime()
+        Time,       // signed microseconds
+    };
+
+    constexpr uint32_t EncodingWidth(ColumnEncoding Encoding) { return Encoding == ColumnEncoding::Text ? 0 : 8; }
+
+    struct ColumnInfo
+    {
+        std::string     Name;
+        std::string     Database;           // where the column comes from, when it is a table column
+        std::string     Table;              // MYSQL_FIELD::org_table
+        std::string     OriginalName;       // MYSQL_FIELD::org_name
+        int             Type      = 0;      // enum_field_types
+        unsigned int    Charset   = 0;
+        unsigned int    Flags     = 0;
+        unsigned long   Length    = 0;
+        unsigned long   MaxLength = 0;
+        unsigned int    Decimals  = 0;
+        ColumnEncoding  Encoding  = ColumnEncoding::Text;
+    };
+
+    struct CellView
+    {
+        const char* Data   = nullptr;
+        uint32_t    Length = 0;
+        bool        Null   = true;
+
+        std::string_view Text() const { return std::string_view(Data ? Data : "", Length); }
+
+        template<typename T>
+        T As() const {
+            T Value{};
+            if (Data && Length == sizeof(T))
+                std::memcpy(&Value, Data, sizeof(T));
+            return Value;
+        }
+    };
+
+    // Values of one column for one row range: a single byte arena, a null
+    // bitmap and, for text columns, Rows + 1 offsets into the arena. Once
+    // sealed, readers go through the views, which point either at the owned
+    // vectors or into the block's spill mapping.
+    class ColumnBlock
+    {
+    public:
+        ColumnBlock() = default;
+        ColumnBlock(ColumnBlock&&) noexcept = default;
+        ColumnBlock& operator=(ColumnBlock&&) noexcept = default;
+        ColumnBlock(const ColumnBlock&) = delete;
+        ColumnBlock& operator=(const ColumnBlock&) = delete;
+
+        uint32_t        RowCount() const { return Rows; }
+        uint32_t        ValueWidth() const { return Width; }
+        bool            IsNull(uint32_t Row) const { return (NullView[Row >> 3] >> (Row & 7)) & 1; }
+        CellView        Cell(uint32_t Row) const {
+            if (IsNull(Row))
+                return CellView{};
+            if (Width)
+                return CellView{ ArenaView + (size_t)Row * Width, Width, false };
+            return CellView{ ArenaView + OffsetView[Row], OffsetView[Row + 1] - OffsetView[Row], false };
+        }
+
+        template<typename T>
+        const T*        Values() const { return reinterpret_cast<const T*>(ArenaView); }
+
+        const char*     ArenaData() const { return ArenaView; }
+        size_t          ArenaSize() const { return ArenaLength; }
+        const uint32_t* OffsetData() const { return OffsetView; }
+        const uint8_t*  NullData() const { return NullView; }
+        // Heap bytes only; spilled columns report 0 here.
+        size_t          ByteSize() const { return Arena.capacity() + Offsets.capacity() * sizeof(uint32_t) + NullBits.capacity(); }
+
+    private:
+        friend class ResultStoreBuilder;
+        friend class ResultCache;
+
+        void   BindOwned();
+        size_t SpillSize() const;
+
+        std::vector<char>     Arena;
+        std::vector<uint32_t> Offsets;
+        std::vector<uint8_t>  NullBits;
+        uint32_t              Rows  = 0;
+        uint32_t              Width = 0;
+
+        const char*           ArenaView   = nullptr;
+        const uint32_t*       OffsetView  = nullptr;
+        const uint8_t*        NullView    = nullptr;
+        size_t                ArenaLength = 0;
+    };
+
+    // A cell of which only the first bytes were kept; see ResultStoreBuilder::AppendPartialCell().
+    struct PartialCell
+    {
+        uint32_t Row;
+        uint32_t Column;
+        uint64_t FullLength;
+    };
+
+    // A sealed, immutable group of rows. Blocks are shared between stores,
+    // so publishing more rows never moves the ones already handed out.
+    struct ResultBlock
+    {
+        uint64_t                            FirstRow = 0;
+        uint32_t                            RowCount = 0;
+        std::vector<ColumnBlock>            Columns;
+        std::vector<PartialCell>            Partial;      // by row, then column
+        std::shared_ptr<const SpillMapping> Spill;        // set when the columns live on disk
+        size_t                              SpillBytes = 0;
+
+        size_t ByteSize() const;
+        bool   Spilled() const { return Spill != nullptr; }
+        // Length of the whole value when the cell holds a prefix, else 0.
+        uint64_t FullLength(uint32_t Row, size_t Column) const;
+    };
+
+    class ResultStore;
+
+    class RowView
+    {
+    public:
+        RowView() = default;
+        RowView(const ResultBlock* Block, uint32_t Row) : Block(Block), Row(Row) { }
+
+        size_t   size() const { return Block ? Block->Columns.size() : 0; }
+        CellView operator[](size_t Column) const { return Block->Columns[Column].Cell(Row); }
+
+    private:
+        const ResultBlock* Block = nullptr;
+        uint32_t           Row   = 0;
+    };
+
+    class ResultStore
+    {
+    public:
+        ResultStore() = default;
+        ResultStore(std::vector<ColumnInfo> Columns, std::vector<std::shared_ptr<const ResultBlock>> Blocks);
+
+        const std::vector<ColumnInfo>& Columns() const { return ColumnInfos; }
+        size_t   ColumnCount() const { return ColumnInfos.size(); }
+        uint64_t RowCount() const { return TotalRows; }
+        size_t   ByteSize() const { return TotalBytes + TotalSpilled; }
+        size_t   ResidentBytes() const { return TotalBytes; }
+        size_t   SpilledBytes() const { return TotalSpilled; }
+        // Cells that hold only a prefix of their value (large BLOB/TEXT).
+        uint64_t PartialCells() const { return TotalPartial; }
+        uint64_t FullLength(uint64_t Row, size_t Column) const;
+
+        const std::vector<std::shared_ptr<const ResultBlock>>& Blocks() const { return BlockList; }
+
+        RowView  Row(uint64_t Index) const;
+        CellView Cell(uint64_t Row, size_t Column) const { return this->Row(Row)[Column]; }
+
+        // Convenience for single message results (errors, status lines).
+        static std::shared_ptr<ResultStore> FromMessage(const std::string& Column, const std::string& Message);
+
+    private:
+        size_t FindBlock(uint64_t Row) const;
+
+        std::vector<ColumnInfo>                         ColumnInfos;
+        std::vector<std::shared_ptr<const ResultBlock>> BlockList;
+        uint64_t                                        TotalRows    = 0;
+        size_t                                          TotalBytes   = 0;
+        size_t                                          TotalSpilled = 0;
+        uint64_t                                        TotalPartial = 0;
+    };
+
+    // Packed DATE/DATETIME/TIMESTAMP, ordered like the values themselves and able
+    // to represent zero dates: ((year * 13 + month) << 5 | day) << 17 | hms, << 24 | usec.
+    inline int64_t PackDateTime(unsigned Year, unsigned Month, unsigned Day, unsigned Hour, unsigned Minute, unsigned Second, unsigned long Microsecond)
+    {
+        uint64_t YearMonthDay = (((uint64_t)Year * 13 + Month) << 5) | Day;
+        uint64_t HourMinSec   = ((uint64_t)Hour << 12) | (Minute << 6) | Second;
+        return (int64_t)((((YearMonthDay << 17) | HourMinSec) << 24) | (Microsecond & 0xFFFFFF));
+    }
+
+    inline void UnpackDateTime(int64_t Packed, unsigned& Year, unsigned& Month, unsigned& Day, unsigned& Hour, unsigned& Minute, unsigned& Second, unsigned long& Microsecond)
+    {
+        uint64_t Value = (uint64_t)Packed;
+        Microsecond = (unsigned long)(Value & 0xFFFFFF);
+        Value >>= 24;
+
+        uint64_t HourMinSec = Value & 0x1FFFF;
+        Second = (unsigned)(HourMinSec & 63);
+        Minute = (unsigned)((HourMinSec >> 6) & 63);
+        Hour   = (unsigned)(HourMinSec >> 12);
+
+        uint64_t YearMonthDay = Value >> 17;
+        Day = (unsigned)(YearMonthDay & 31);
+        uint64_t YearMonth = YearMonthDay >> 5;
+        Month = (unsigned)(YearMonth % 13);
+        Year  = (unsigned)(YearMonth / 13);
+    }
+
+    // Longest prefix of at most Limit bytes that does not end inside a UTF-8 sequence.
+    // Only the first Limit bytes are read.
+    inline size_t Utf8Prefix(const char* Data, size_t Length, size_t Limit)
+    {
+        if (Length <= Limit)
+            return Length;
+        size_t Lead = Limit;
+        while (Lead > 0 && (Data[Lead - 1] & 0xC0) == 0x80)
+            Lead--;
+        if (Lead == 0)
+            return Limit;
+        const uint8_t Byte = (uint8_t)Data[--Lead];
+        const size_t Sequence = Byte >= 0xF0 ? 4 : Byte >= 0xE0 ? 3 : Byte >= 0xC0 ? 2 : 1;
+        return Lead + Sequence <= Limit ? Limit : Lead;
+    }
+
+    // Display text of a cell. Text cells are returned as-is; typed cells are
+    // formatted into Buffer (64 bytes is always enough).
+    std::string_view FormatCell(const ColumnInfo& Column, const CellView& Cell, char* Buffer, size_t BufferSize);
+
+    // Appends rows cell by cell into the open block and seals it once it is
+    // full. Only the fetch thread touches a builder. With a memory budget set,
+    // blocks sealed while the resident total is over it go to a spill file;
+    // with a block sink set, sealed blocks are handed to it and not kept.
+    class ResultStoreBuilder
+    {
+    public:
+        using BlockSink = std::function<void(const std::vector<ColumnInfo>&, std::shared_ptr<const ResultBlock>)>;
+
+        static constexpr uint32_t DefaultBlockRows  = 16384;
+        static constexpr size_t   MaxBlockArenaSize = 64u << 20;
+
+        explicit ResultStoreBuilder(std::vector<ColumnInfo> Columns, uint32_t BlockRows = DefaultBlockRows);
+        ~ResultStoreBuilder();
+
+        ResultStoreBuilder(ResultStoreBuilder&&) noexcept;
+        ResultStoreBuilder& operator=(ResultStoreBuilder&&) noexcept;
+
+        // 0 keeps everything in memory. Directory defaults to /tmp.
+        void SetMemoryBudget(size_t Bytes, std::string SpillDirectory = std::string());
+        // For consumers that only pass rows through (exports); Sealed() then holds no rows.
+        void SetBlockSink(BlockSink Sink) { SealedSink = std::move(Sink); }
+
+        void AppendCell(const char* Data, size_t Length);
+        void AppendNull();
+        void EndRow();
+
+        // For fixed-width columns (ColumnInfo::Encoding other than Text).
+        template<typename T>
+        void AppendValue(T Value) { AppendCell(reinterpret_cast<const char*>(&Value), sizeof(T)); }
+
+        void AppendRow(const char* const* Cells, const unsigned long* Lengths);
+
+        // Stores the first Length bytes of a value of FullLength bytes; the rest
+        // can be fetched again from the server when it is needed.
+        void AppendPartialCell(const char* Data, size_t Length, uint64_t FullLength);
+
+        // Closes the open block, even when it is not full yet.
+        void Seal();
+
+        uint64_t RowCount() const { return SealedRows + OpenRows; }
+        uint64_t ByteCount() const { return TotalBytes; }
+        size_t   ResidentBytes() const { return Resident; }
+        size_t   SpilledBytes() const { return Spilled; }
+        // Last spill failure; the block that failed to spill stays in memory.
+        const std::string& SpillError() const { return LastSpillError; }
+        const std::vector<ColumnInfo>& Columns() const { return ColumnInfos; }
+
+        // Store over the blocks sealed so far; the builder keeps appending.
+        std::shared_ptr<ResultStore> Sealed() const;
+        std::shared_ptr<ResultStore> Finish();
+
+    private:
+        void OpenBlock();
+        void SetNull(ColumnBlock& Column, uint32_t Row, bool Null);
+        bool SpillOpen();
+
+        std::vector<ColumnInfo>                         ColumnInfos;
+        std::vector<std::shared_ptr<const ResultBlock>> SealedBlocks;
+        std::unique_ptr<ResultBlock>                    Open;
+
+        uint32_t BlockRows;
+        uint32_t OpenRows    = 0;
+        size_t   OpenColumn  = 0;
+        size_t   OpenBytes   = 0;
+        uint64_t SealedRows  = 0;
+        uint64_t TotalBytes  = 0;
+
+        std::unique_ptr<SpillFile> Spill;
+        std::string                SpillDirectory;
+        std::string                LastSpillError;
+        size_t                     MemoryBudget = 0;
+        size_t                     Resident     = 0;
+        size_t                     Spilled      = 0;
+
+        BlockSink                  SealedSink;
+    };
+}
@@ -0,0 +1,64 @@
+//
+//  ResultStream.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultStream.hpp"
+
+using namespace DBCore;
+
+ResultStream::ResultStream(ResultPublisher& Publisher, std::vector<ColumnInfo> Columns, StreamOptions Options)
+    : Publisher(Publisher), StoreBuilder(std::move(Columns)), Options(Options)
+{
+    Started   = std::chrono::steady_clock::now();
+    LastFlush = Started;
+    StoreBuilder.SetMemoryBudget(Options.MemoryBudget, Options.SpillDirectory);
+    if (Options.BlockSink)
+        StoreBuilder.SetBlockSink(Options.BlockSink);
+
+    // Publish the header right away so the grid shows columns before the first row.
+    Publisher.Publish(StoreBuilder.Sealed(), Stats(false));
+}
+
+StreamStats ResultStream::Stats(bool Complete) const
+{
+    StreamStats Stats;
+    Stats.Rows     = StoreBuilder.RowCount();
+    Stats.Bytes    = StoreBuilder.ByteCount();
+    Stats.Seconds  = std::chrono::duration<double>(std::chrono::steady_clock::now() - Started).count();
+    Stats.Complete = Complete;
+    Stats.Streamed = true;
+    return Stats;
+}
+
+void ResultStream::Flush()
+{
+    if (PendingRows == 0)
+        return;
+
+    StoreBuilder.Seal();
+    Publisher.Publish(StoreBuilder.Sealed(), Stats(false), true);
+    PendingRows = 0;
+
+    // A sink applies its own backpressure; nobody needs to look at these batches.
+    if (!Cancelled() && !Options.BlockSink)
+        Publisher.WaitForConsumer(Options.MaxPendingBatches, Options.MaxStall);
+    LastFlush = std::chrono::steady_clock::now();
+}
+
+std::shared_ptr<const ResultSnapshot> ResultStream::Finish()
+{
+    PendingRows = 0;
+    StreamStats Final = Stats(true);
+    return Publisher.Publish(StoreBuilder.Finish(), Final, true);
+}
+
+void ResultStream::Abandon()
+{
+    std::string Message = "Query cancelled after " + std::to_string(StoreBuilder.RowCount()) + " row(s)";
+    StoreBuilder = ResultStoreBuilder(StoreBuilder.Columns());
+    PendingRows = 0;
+    Publisher.Publish(ResultStore::FromMessage("Result", Message));
+}
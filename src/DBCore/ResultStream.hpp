@@ -0,0 +1,73 @@
+//
+//  ResultStream.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "ResultSnapshot.hpp"
+#include "CancelToken.hpp"
+
+#include <chrono>
+#include <string>
+
+namespace DBCore
+{
+    struct StreamOptions
+    {
+        uint32_t                  BatchRows         = 4096;
+        std::chrono::milliseconds BatchBudget       { 100 };
+        uint64_t                  MaxPendingBatches = 2;
+        std::chrono::milliseconds MaxStall          { 250 };
+        const CancelToken*        Cancel            = nullptr;
+        size_t                    MemoryBudget      = 0;    // bytes kept in memory before spilling, 0 = no limit
+        std::string               SpillDirectory;
+        // BLOB and TEXT values longer than this keep only their first bytes
+        // (see ResultStoreBuilder::AppendPartialCell()). 0 keeps them whole.
+        uint32_t                  CellPrefixBytes   = 0;
+        // When set, sealed blocks go here instead of into the published result,
+        // which then only carries the header and the row count.
+        ResultStoreBuilder::BlockSink BlockSink;
+    };
+
+    // Feeds a ResultStoreBuilder and publishes the rows received so far in
+    // batches capped by row count or time, so the grid fills while the fetch
+    // is still running. When the consumer lags behind by more than
+    // MaxPendingBatches, the fetch thread stalls for up to MaxStall per batch.
+    class ResultStream
+    {
+    public:
+        ResultStream(ResultPublisher& Publisher, std::vector<ColumnInfo> Columns, StreamOptions Options = StreamOptions());
+
+        ResultStoreBuilder& Builder() { return StoreBuilder; }
+
+        // Call after each Builder().EndRow().
+        void RowCommitted() {
+            if (++PendingRows >= Options.BatchRows || ((PendingRows < 64 || (PendingRows & 63) == 0) && BudgetExpired()))
+                Flush();
+        }
+
+        bool Cancelled() const { return IsCancelled(Options.Cancel); }
+
+        void Flush();
+        std::shared_ptr<const ResultSnapshot> Finish();
+
+        // Drops everything fetched so far and publishes a cancellation notice instead.
+        void Abandon();
+
+        StreamStats Stats(bool Complete) const;
+
+    private:
+        bool BudgetExpired() const { return std::chrono::steady_clock::now() - LastFlush >= Options.BatchBudget; }
+
+        ResultPublisher&    Publisher;
+        ResultStoreBuilder  StoreBuilder;
+        StreamOptions       Options;
+
+        uint32_t                              PendingRows = 0;
+        std::chrono::steady_clock::time_point Started;
+        std::chrono::steady_clock::time_point LastFlush;
+    };
+}
@@ -0,0 +1,139 @@
+//
+//  RowHeightIndex.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "RowHeightIndex.hpp"
+
+#include <algorithm>
+
+using namespace DBCore;
+
+void RowHeightIndex::Reset(uint64_t RowCount, float DefaultHeight)
+{
+    Tree.assign(1, 0.0);
+    Measured.clear();
+    Rows    = 0;
+    Default = DefaultHeight;
+    Resize(RowCount);
+}
+
+void RowHeightIndex::Resize(uint64_t RowCount)
+{
+    if (RowCount < Rows)
+    {
+        Reset(RowCount, Default);
+        return;
+    }
+
+    uint64_t Chunks = (RowCount + ChunkRows - 1) / ChunkRows;
+    while (Tree.size() - 1 < Chunks)
+    {
+        // Doubling a power-of-two Fenwick tree: the new top node covers the
+        // whole old range, everything else in the new half is still zero.
+        uint64_t Capacity = Tree.size() - 1;
+        double   Total    = ChunkDeltas(Capacity);
+        uint64_t Grown    = Capacity ? Capacity * 2 : 1;
+        Tree.resize(Grown + 1, 0.0);
+        Tree[Grown] = Total;
+    }
+    Rows = RowCount;
+}
+
+double RowHeightIndex::ChunkDeltas(uint64_t Chunks) const
+{
+    double Sum = 0.0;
+    for (uint64_t i = Chunks; i > 0; i &= i - 1)
+        Sum += Tree[i];
+    return Sum;
+}
+
+void RowHeightIndex::AddChunkDelta(uint64_t Chunk, double Delta)
+{
+    for (uint64_t i = Chunk + 1; i < Tree.size(); i += i & (~i + 1))
+        Tree[i] += Delta;
+}
+
+double RowHeightIndex::Offset(uint64_t Row) const
+{
+    Row = std::min(Row, Rows);
+
+    uint64_t Chunk  = Row / ChunkRows;
+    double   Result = Row * (double)Default + ChunkDeltas(Chunk);
+
+    auto It = Measured.find(Chunk);
+    if (It != Measured.end())
+    {
+        const float* Deltas = It->second.get();
+        for (uint64_t i = Chunk * ChunkRows; i < Row; i++)
+            Result += Deltas[i - Chunk * ChunkRows];
+    }
+    return Result;
+}
+
+float RowHeightIndex::Height(uint64_t Row) const
+{
+    auto It = Measured.find(Row / ChunkRows);
+    if (It == Measured.end())
+        return Default;
+    return Default + It->second[Row % ChunkRows];
+}
+
+void RowHeightIndex::SetHeight(uint64_t Row, float Height)
+{
+    if (Row >= Rows)
+        return;
+
+    uint64_t Chunk = Row / ChunkRows;
+    std::unique_ptr<float[]>& Deltas = Measured[Chunk];
+    if (!Deltas)
+        Deltas.reset(new float[ChunkRows]());
+
+    float& Slot  = Deltas[Row % ChunkRows];
+    float  Delta = Height - Default;
+    if (Slot == Delta)
+        return;
+
+    AddChunkDelta(Chunk, (double)Delta - Slot);
+    Slot = Delta;
+}
+
+uint64_t RowHeightIndex::RowAt(double Y) const
+{
+    if (Rows == 0 || Y <= 0.0)
+        return 0;
+
+    // Descend the tree for the number of whole chunks that end at or above Y.
+    const double ChunkHeight = (double)ChunkRows * Default;
+    uint64_t Chunk     = 0;
+    double   Remaining = Y;
+    for (uint64_t Step = (Tree.size() - 1); Step > 0; Step >>= 1)
+    {
+        uint64_t Next = Chunk + Step;
+        if (Next >= Tree.size())
+            continue;
+        double Span = Tree[Next] + Step * ChunkHeight;
+        if (Span <= Remaining)
+        {
+            Chunk      = Next;
+            Remaining -= Span;
+        }
+    }
+
+    uint64_t Row = Chunk * ChunkRows;
+    if (Row >= Rows)
+        return Rows - 1;
+
+    auto It = Measured.find(Chunk);
+    const float* Deltas = It != Measured.end() ? It->second.get() : nullptr;
+    for (uint64_t End = std::min<uint64_t>(Row + ChunkRows, Rows); Row < End; Row++)
+    {
+        double Height = Default + (Deltas ? Deltas[Row - Chunk * ChunkRows] : 0.0f);
+        if (Remaining < Height)
+            return Row;
+        Remaining -= Height;
+    }
+    return std::min(Row, Rows - 1);
+}
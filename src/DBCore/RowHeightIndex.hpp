@@ -0,0 +1,54 @@
+//
+//  RowHeightIndex.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace DBCore
+{
+    // Prefix sums of row heights for a virtualized grid. Every row starts at
+    // the default height; rows get their real height once they are drawn.
+    // Heights are kept per chunk of rows in a Fenwick tree, so finding the
+    // offset of a row or the row under a scroll position is O(log n) without
+    // measuring the rows above it, and memory is 8 bytes per chunk plus the
+    // chunks that were actually measured.
+    class RowHeightIndex
+    {
+    public:
+        static constexpr uint32_t ChunkRows = 256;
+
+        void     Reset(uint64_t Rows, float DefaultHeight);
+        // Rows added at the end start at the default height.
+        void     Resize(uint64_t Rows);
+
+        uint64_t RowCount() const { return Rows; }
+        float    DefaultHeight() const { return Default; }
+
+        double   Offset(uint64_t Row) const;
+        double   TotalHeight() const { return Offset(Rows); }
+        float    Height(uint64_t Row) const;
+        void     SetHeight(uint64_t Row, float Height);
+
+        // Row whose span contains Y, clamped to the last row.
+        uint64_t RowAt(double Y) const;
+
+    private:
+        double   ChunkDeltas(uint64_t Chunks) const;
+        void     AddChunkDelta(uint64_t Chunk, double Delta);
+
+        // 1-based Fenwick tree over per-chunk deviations from the default
+        // height; its size is always a power of two so it can grow by doubling.
+        std::vector<double>                                    Tree{ 0.0 };
+        std::unordered_map<uint64_t, std::unique_ptr<float[]>> Measured;
+        uint64_t                                               Rows    = 0;
+        float                                                  Default = 0.0f;
+    };
+}
@@ -0,0 +1,109 @@
+//
+//  SpillFile.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "SpillFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace DBCore;
+
+static bool SystemError(const char* What, std::string* Error)
+{
+    if (Error)
+        *Error = std::string(What) + ": " + strerror(errno);
+    return false;
+}
+
+SpillMapping::~SpillMapping()
+{
+    munmap(Base, Length);
+}
+
+std::unique_ptr<SpillFile> SpillFile::Create(const std::string& Directory, std::string* Error)
+{
+    std::string Path = Directory.empty() ? "/tmp" : Directory;
+    if (Path.back() != '/')
+        Path += '/';
+    Path += "DBGui-spill-XXXXXX";
+
+    int Descriptor = mkstemp(Path.data());
+    if (Descriptor < 0)
+    {
+        SystemError("Cannot create spill file", Error);
+        return nullptr;
+    }
+
+    // Nothing else needs the name; the space is released with the last mapping.
+    unlink(Path.c_str());
+    return std::unique_ptr<SpillFile>(new SpillFile(Descriptor));
+}
+
+SpillFile::~SpillFile()
+{
+    // Mappings stay valid after the descriptor is closed.
+    close(Descriptor);
+}
+
+bool SpillFile::MapWindow(size_t Length, std::string* Error)
+{
+    size_t PageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t Size = std::max(WindowSize, (Length + PageSize - 1) / PageSize * PageSize);
+
+    if (ftruncate(Descriptor, (off_t)(FileSize + Size)) != 0)
+        return SystemError("Cannot grow spill file", Error);
+
+    void* Base = mmap(nullptr, Size, PROT_READ, MAP_SHARED, Descriptor, (off_t)FileSize);
+    if (Base == MAP_FAILED)
+        return SystemError("Cannot map spill file", Error);
+
+    Window       = std::make_shared<SpillMapping>(Base, Size);
+    WindowOffset = FileSize;
+    WindowUsed   = 0;
+    FileSize    += Size;
+    return true;
+}
+
+bool SpillFile::Allocate(size_t Length, uint64_t& Offset, std::shared_ptr<const SpillMapping>& Mapping, const char*& Data, std::string* Error)
+{
+    Length = (Length + 7) & ~(size_t)7;
+    if (!Window || Window->Size() - WindowUsed < Length)
+    {
+        if (!MapWindow(Length, Error))
+            return false;
+    }
+
+    Offset  = WindowOffset + WindowUsed;
+    Mapping = Window;
+    Data    = Window->Data() + WindowUsed;
+    WindowUsed += Length;
+    Used       += Length;
+    return true;
+}
+
+bool SpillFile::Write(uint64_t Offset, const void* Data, size_t Length, std::string* Error)
+{
+    const char* Bytes = static_cast<const char*>(Data);
+    while (Length > 0)
+    {
+        ssize_t Written = pwrite(Descriptor, Bytes, Length, (off_t)Offset);
+        if (Written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return SystemError("Cannot write spill file", Error);
+        }
+        Bytes  += Written;
+        Offset += (uint64_t)Written;
+        Length -= (size_t)Written;
+    }
+    return true;
+}
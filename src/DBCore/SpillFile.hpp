@@ -0,0 +1,70 @@
+//
+//  SpillFile.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace DBCore
+{
+    // Read-only mapping of part of a spill file. Blocks that live in the
+    // mapping hold on to it; the pages are read back by the OS on demand.
+    class SpillMapping
+    {
+    public:
+        SpillMapping(void* Base, size_t Length) : Base(Base), Length(Length) { }
+        ~SpillMapping();
+
+        SpillMapping(const SpillMapping&) = delete;
+        SpillMapping& operator=(const SpillMapping&) = delete;
+
+        const char* Data() const { return static_cast<const char*>(Base); }
+        size_t      Size() const { return Length; }
+
+    private:
+        void*  Base;
+        size_t Length;
+    };
+
+    // Unlinked temporary file that result blocks are written to once a result
+    // goes over its memory budget. The file is mapped in large windows so a
+    // 40 GB result does not turn into tens of thousands of mappings; the disk
+    // space goes away with the last mapping.
+    class SpillFile
+    {
+    public:
+        static constexpr size_t WindowSize = 256u << 20;
+
+        static std::unique_ptr<SpillFile> Create(const std::string& Directory, std::string* Error);
+        ~SpillFile();
+
+        SpillFile(const SpillFile&) = delete;
+        SpillFile& operator=(const SpillFile&) = delete;
+
+        // Reserves Length bytes (8-byte aligned) and returns where they will be
+        // readable once written. Offset is the position in the file.
+        bool Allocate(size_t Length, uint64_t& Offset, std::shared_ptr<const SpillMapping>& Mapping, const char*& Data, std::string* Error);
+        bool Write(uint64_t Offset, const void* Data, size_t Length, std::string* Error);
+
+        uint64_t BytesUsed() const { return Used; }
+
+    private:
+        explicit SpillFile(int Descriptor) : Descriptor(Descriptor) { }
+
+        bool MapWindow(size_t Length, std::string* Error);
+
+        int                                 Descriptor;
+        std::shared_ptr<const SpillMapping> Window;
+        uint64_t                            WindowOffset = 0;
+        size_t                              WindowUsed   = 0;
+        uint64_t                            FileSize     = 0;
+        uint64_t                            Used         = 0;
+    };
+}
@@ -0,0 +1,172 @@
+//
+//  StatementCache.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "StatementCache.hpp"
+#include "ResultCache.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace DBCore;
+
+static std::string StatementError(MYSQL_STMT* Statement)
+{
+    const char* Message = mysql_stmt_error(Statement);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_stmt_errno(Statement)) + ")";
+}
+
+static CachedStatement::FieldShape ShapeOf(const MYSQL_FIELD& Field)
+{
+    CachedStatement::FieldShape Shape;
+    Shape.Length   = Field.length;
+    Shape.Flags    = Field.flags;
+    Shape.Charset  = Field.charsetnr;
+    Shape.Decimals = Field.decimals;
+    Shape.Type     = (int)Field.type;
+    return Shape;
+}
+
+StatementCache::StatementCache(size_t Capacity, StatementCounters* Counters)
+    : MaxEntries(std::max<size_t>(1, Capacity)), Stats(Counters)
+{
+}
+
+StatementCache::~StatementCache()
+{
+    Clear();
+}
+
+CachedStatement* StatementCache::Prepare(MYSQL* Connection, const std::string& Sql, std::string* Error)
+{
+    if (!Connection)
+    {
+        if (Error)
+            *Error = "Unknown error. (No connection to the server).";
+        return nullptr;
+    }
+
+    // mariadb_reconnect and mysql_reset_connection both leave the old
+    // statements unusable on the server. A statement also keeps resolving
+    // unqualified tables in the database it was prepared in, so a USE
+    // (reported through session tracking into mysql->db) starts over too.
+    const unsigned long Thread = mysql_thread_id(Connection);
+    const char* Schema = Connection->db ? Connection->db : "";
+    if (Connection != Owner || Thread != OwnerThread || OwnerSchema != Schema)
+    {
+        Clear();
+        Owner = Connection;
+        OwnerThread = Thread;
+        OwnerSchema = Schema;
+    }
+
+    std::string Key = NormalizeQuery(Sql);
+    auto Found = Index.find(Key);
+    if (Found != Index.end())
+    {
+        Entries.splice(Entries.begin(), Entries, Found->second);
+        if (Stats)
+            Stats->Hits.fetch_add(1, std::memory_order_relaxed);
+        return &Entries.front();
+    }
+
+    MYSQL_STMT* Handle = mysql_stmt_init(Connection);
+    if (!Handle)
+    {
+        if (Error)
+            *Error = "Out of memory";
+        return nullptr;
+    }
+    if (mysql_stmt_prepare(Handle, Sql.data(), (unsigned long)Sql.size()) != 0)
+    {
+        if (Error)
+            *Error = StatementError(Handle);
+        mysql_stmt_close(Handle);
+        return nullptr;
+    }
+    if (Stats)
+        Stats->Misses.fetch_add(1, std::memory_order_relaxed);
+
+    while (Entries.size() >= MaxEntries)
+    {
+        Close(std::prev(Entries.end()));
+        if (Stats)
+            Stats->Evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Entries.emplace_front();
+    CachedStatement& Entry = Entries.front();
+    Entry.Key        = std::move(Key);
+    Entry.Handle     = Handle;
+    Entry.ParamCount = mysql_stmt_param_count(Handle);
+    Index.emplace(Entry.Key, Entries.begin());
+    return &Entry;
+}
+
+bool StatementCache::BindResult(CachedStatement& Statement, uint32_t PrefixBytes, std::string* Error)
+{
+    // mariadb_stmt_fetch_fields hands out the statement's own metadata,
+    // unlike mysql_stmt_result_metadata which wraps it in a new result.
+    const MYSQL_FIELD* Fields = mariadb_stmt_fetch_fields(Statement.Handle);
+    const unsigned int Count = mysql_stmt_field_count(Statement.Handle);
+
+    // Compared field by field: a server that resends changed metadata can
+    // leave it at the same address.
+    bool Same = Count == Statement.Shape.size() && PrefixBytes == Statement.PrefixBytes && Count != 0;
+    for (unsigned int i = 0; Same && i < Count; i++)
+        Same = ShapeOf(Fields[i]) == Statement.Shape[i];
+
+    if (!Same)
+    {
+        StatementFetcher::BindResult(Fields, Count, Statement.Columns, Statement.Bound, Statement.Binds, PrefixBytes);
+        Statement.Shape.resize(Count);
+        for (unsigned int i = 0; i < Count; i++)
+            Statement.Shape[i] = ShapeOf(Fields[i]);
+        Statement.PrefixBytes = PrefixBytes;
+    }
+
+    // An execute that brought metadata along clears the client's bindings.
+    if (mysql_stmt_bind_result(Statement.Handle, Statement.Binds.data()) != 0)
+    {
+        if (Error)
+            *Error = StatementError(Statement.Handle);
+        return false;
+    }
+    return true;
+}
+
+void StatementCache::Invalidate(CachedStatement* Statement)
+{
+    auto Found = Index.find(Statement->Key);
+    if (Found == Index.end())
+        return;
+    Close(Found->second);
+    if (Stats)
+        Stats->Invalidations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatementCache::Clear()
+{
+    while (!Entries.empty())
+        Close(Entries.begin());
+}
+
+bool StatementCache::NeedsPrepare(MYSQL_STMT* Statement)
+{
+    // CR_NO_PREPARE_STMT, CR_STMT_CLOSED, ER_UNKNOWN_STMT_HANDLER and ER_NEED_REPREPARE.
+    const unsigned int Code = mysql_stmt_errno(Statement);
+    return Code == 2030 || Code == 2056 || Code == 1243 || Code == 1615;
+}
+
+void StatementCache::Close(EntryList::iterator Entry)
+{
+    // Sends COM_STMT_CLOSE, or only frees the handle when the session already dropped it.
+    mysql_stmt_close(Entry->Handle);
+    Index.erase(Entry->Key);
+    Entries.erase(Entry);
+}
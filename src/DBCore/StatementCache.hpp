@@ -0,0 +1,106 @@
+//
+//  StatementCache.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "StatementFetcher.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace DBCore
+{
+    struct StatementCounters
+    {
+        std::atomic<uint64_t> Hits{0};
+        std::atomic<uint64_t> Misses{0};          // prepared on the server
+        std::atomic<uint64_t> Evictions{0};       // closed to make room
+        std::atomic<uint64_t> Invalidations{0};   // dropped by the server (schema change, reset) and prepared again
+    };
+
+    // A prepared statement and the result bindings built from its metadata,
+    // reused by every execute until the metadata changes.
+    struct CachedStatement
+    {
+        // What the bindings of a column depend on.
+        struct FieldShape
+        {
+            uint64_t     Length   = 0;
+            unsigned int Flags    = 0;
+            unsigned int Charset  = 0;
+            unsigned int Decimals = 0;
+            int          Type     = 0;
+
+            bool operator==(const FieldShape& Other) const = default;
+        };
+
+        std::string              Key;          // NormalizeQuery() of the text it was prepared from
+        MYSQL_STMT*              Handle     = nullptr;
+        unsigned long            ParamCount = 0;
+
+        std::vector<ColumnInfo>  Columns;
+        std::vector<BoundColumn> Bound;
+        std::vector<MYSQL_BIND>  Binds;
+        std::vector<FieldShape>  Shape;        // of the fields the bindings were built for
+        uint32_t                 PrefixBytes = 0;
+    };
+
+    // Prepared statements of one connection, keyed by normalized SQL, so a
+    // refresh or the next page skips COM_STMT_PREPARE. The least recently used
+    // one is closed once Capacity are open. Statements belong to the session
+    // and default database they were prepared in, so a different handle,
+    // thread id (a reconnect) or current database empties the cache first. Used by one thread at a time, like the
+    // connection; the counters may be read from anywhere.
+    class StatementCache
+    {
+    public:
+        explicit StatementCache(size_t Capacity = 32, StatementCounters* Counters = nullptr);
+        ~StatementCache();
+
+        StatementCache(const StatementCache&) = delete;
+        StatementCache& operator=(const StatementCache&) = delete;
+
+        // The statement for Sql, prepared on a miss. Null, with Error set, when
+        // the server refuses to prepare it.
+        CachedStatement* Prepare(MYSQL* Connection, const std::string& Sql, std::string* Error);
+
+        // Binds the result columns of an executed statement, reusing the
+        // bindings of the previous execute unless the metadata changed.
+        bool BindResult(CachedStatement& Statement, uint32_t PrefixBytes, std::string* Error);
+
+        // Closes Statement after the server dropped it (NeedsPrepare()) or a
+        // fetch was abandoned; the next Prepare() starts over.
+        void Invalidate(CachedStatement* Statement);
+        void Clear();
+
+        // The last error on Statement means the server no longer knows it:
+        // reset or reconnected session, or a table it reads changed.
+        static bool NeedsPrepare(MYSQL_STMT* Statement);
+
+        size_t Size() const { return Entries.size(); }
+        size_t Capacity() const { return MaxEntries; }
+
+    private:
+        using EntryList = std::list<CachedStatement>;
+
+        void Close(EntryList::iterator Entry);
+
+        const size_t        MaxEntries;
+        StatementCounters*  Stats;
+        EntryList           Entries;       // most recently used first
+        std::unordered_map<std::string, EntryList::iterator> Index;
+        MYSQL*              Owner       = nullptr;
+        unsigned long       OwnerThread = 0;
+        std::string         OwnerSchema;   // mysql->db when the cache was last emptied
+    };
+}
@@ -0,0 +1,379 @@
+//
+//  StatementFetcher.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "StatementFetcher.hpp"
+#include "StatementCache.hpp"
+#include "QueryFetcher.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace DBCore;
+
+static constexpr unsigned long InitialStringBuffer = 256;
+
+bool StatementFetcher::IsSelect(const std::string& Sql)
+{
+    size_t i = 0;
+    const size_t Size = Sql.size();
+
+    while (i < Size)
+    {
+        char c = Sql[i];
+        if (isspace((unsigned char)c) || c == '(')
+        {
+            i++;
+        }
+        else if (c == '#' || (c == '-' && i + 1 < Size && Sql[i + 1] == '-'))
+        {
+            while (i < Size && Sql[i] != '\n')
+                i++;
+        }
+        else if (c == '/' && i + 1 < Size && Sql[i + 1] == '*')
+        {
+            size_t End = Sql.find("*/", i + 2);
+            i = End == std::string::npos ? Size : End + 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    auto Keyword = [&](const char* Word) {
+        size_t Length = strlen(Word);
+        if (i + Length > Size)
+            return false;
+        for (size_t k = 0; k < Length; k++)
+            if (toupper((unsigned char)Sql[i + k]) != Word[k])
+                return false;
+        return i + Length == Size || !isalnum((unsigned char)Sql[i + Length]);
+    };
+    return Keyword("SELECT") || Keyword("WITH");
+}
+
+void StatementFetcher::BindResult(const MYSQL_FIELD* Fields, unsigned int Count, std::vector<ColumnInfo>& Columns,
+                                  std::vector<BoundColumn>& Bound, std::vector<MYSQL_BIND>& Binds, uint32_t PrefixBytes)
+{
+    Columns.clear();
+    Bound.assign(Count, BoundColumn());
+    Binds.assign(Count, MYSQL_BIND());
+
+    for (unsigned int i = 0; i < Count; i++)
+    {
+        const MYSQL_FIELD& Field = Fields[i];
+        ColumnInfo Info = ColumnInfoFromField(Field);
+        BoundColumn& Column = Bound[i];
+        MYSQL_BIND& Bind = Binds[i];
+
+        Bind.is_null = &Column.IsNull;
+        Bind.length  = &Column.Length;
+        Bind.error   = &Column.Error;
+
+        switch (Field.type)
+        {
+            case MYSQL_TYPE_TINY:
+            case MYSQL_TYPE_SHORT:
+            case MYSQL_TYPE_INT24:
+            case MYSQL_TYPE_LONG:
+            case MYSQL_TYPE_LONGLONG:
+            case MYSQL_TYPE_YEAR:
+                Info.Encoding      = (Field.flags & UNSIGNED_FLAG) ? ColumnEncoding::UInt64 : ColumnEncoding::Int64;
+                Bind.buffer_type   = MYSQL_TYPE_LONGLONG;
+                Bind.buffer        = &Column.Integer;
+                Bind.buffer_length = sizeof(int64_t);
+                Bind.is_unsigned   = (Field.flags & UNSIGNED_FLAG) ? 1 : 0;
+                break;
+            case MYSQL_TYPE_FLOAT:
+            case MYSQL_TYPE_DOUBLE:
+                Info.Encoding      = ColumnEncoding::Double;
+                Bind.buffer_type   = MYSQL_TYPE_DOUBLE;
+                Bind.buffer        = &Column.Real;
+                Bind.buffer_length = sizeof(double);
+                break;
+            case MYSQL_TYPE_DATE:
+            case MYSQL_TYPE_DATETIME:
+            case MYSQL_TYPE_TIMESTAMP:
+                Info.Encoding      = ColumnEncoding::DateTime;
+                Bind.buffer_type   = MYSQL_TYPE_DATETIME;
+                Bind.buffer        = &Column.Temporal;
+                Bind.buffer_length = sizeof(MYSQL_TIME);
+                break;
+            case MYSQL_TYPE_TIME:
+                Info.Encoding      = ColumnEncoding::Time;
+                Bind.buffer_type   = MYSQL_TYPE_TIME;
+                Bind.buffer        = &Column.Temporal;
+                Bind.buffer_length = sizeof(MYSQL_TIME);
+                break;
+            default:
+            {
+                // BIT arrives as raw big-endian bytes and is decoded like the text path does.
+                Column.Bits = Field.type == MYSQL_TYPE_BIT;
+                if (Column.Bits)
+                    Info.Encoding = ColumnEncoding::UInt64;
+
+                if (IsLargeObjectField(Field))
+                    Column.Prefix = PrefixBytes;
+
+                unsigned long Initial = std::min<unsigned long>(Field.length, InitialStringBuffer);
+                if (Column.Prefix)
+                    Initial = std::min<unsigned long>(Initial, Column.Prefix);
+                Column.Buffer.resize(std::max<unsigned long>(1, Initial));
+                Bind.buffer_type   = MYSQL_TYPE_STRING;
+                Bind.buffer        = Column.Buffer.data();
+                Bind.buffer_length = Column.Buffer.size();
+                break;
+            }
+        }
+
+        Column.Encoding = Info.Encoding;
+        Columns.push_back(Info);
+    }
+}
+
+int StatementFetcher::FetchRow(MYSQL_STMT* Statement, std::vector<BoundColumn>& Bound, std::vector<MYSQL_BIND>& Binds)
+{
+    int Status = mysql_stmt_fetch(Statement);
+    if (Status != MYSQL_DATA_TRUNCATED)
+        return Status;
+
+    bool Rebind = false;
+    for (unsigned int i = 0; i < Bound.size(); i++)
+    {
+        BoundColumn& Column = Bound[i];
+        if (Column.Buffer.empty() || Column.IsNull || Column.Length <= Column.Buffer.size())
+            continue;
+        if (Column.Prefix && Column.Buffer.size() >= Column.Prefix)
+            continue;
+
+        // Keep the prefix we already have and pull the rest into the grown buffer.
+        size_t Fetched = Column.Buffer.size();
+        size_t Wanted  = Column.Prefix ? std::min<size_t>(Column.Length, Column.Prefix) : Column.Length;
+        Column.Buffer.resize(Column.Prefix ? std::min<size_t>(std::max<size_t>(Wanted, Fetched * 2), Column.Prefix)
+                                           : std::max<size_t>(Wanted, Fetched * 2));
+
+        MYSQL_BIND Rest{};
+        unsigned long RestLength = 0;
+        Rest.buffer_type   = MYSQL_TYPE_STRING;
+        Rest.buffer        = Column.Buffer.data() + Fetched;
+        Rest.buffer_length = Wanted - Fetched;
+        Rest.length        = &RestLength;
+        if (mysql_stmt_fetch_column(Statement, &Rest, i, (unsigned long)Fetched) != 0)
+            return 1;
+
+        Binds[i].buffer        = Column.Buffer.data();
+        Binds[i].buffer_length = Column.Buffer.size();
+        Rebind = true;
+    }
+
+    if (Rebind && mysql_stmt_bind_result(Statement, Binds.data()) != 0)
+        return 1;
+    return 0;
+}
+
+void StatementFetcher::AppendRow(const std::vector<ColumnInfo>& Columns, const std::vector<BoundColumn>& Bound, ResultStoreBuilder& Builder)
+{
+    for (size_t c = 0; c < Bound.size(); c++)
+    {
+        const BoundColumn& Column = Bound[c];
+        if (Column.IsNull)
+        {
+            Builder.AppendNull();
+            continue;
+        }
+
+        switch (Column.Encoding)
+        {
+            case ColumnEncoding::Int64:
+            case ColumnEncoding::UInt64:
+                if (Column.Bits)
+                {
+                    uint64_t Value = 0;
+                    for (unsigned long i = 0; i < Column.Length && i < 8; i++)
+                        Value = (Value << 8) | (uint8_t)Column.Buffer[i];
+                    Builder.AppendValue(Value);
+                }
+                else
+                {
+                    Builder.AppendValue(Column.Integer);
+                }
+                break;
+            case ColumnEncoding::Double:
+                Builder.AppendValue(Column.Real);
+                break;
+            case ColumnEncoding::DateTime:
+            {
+                const MYSQL_TIME& T = Column.Temporal;
+                Builder.AppendValue(PackDateTime(T.year, T.month, T.day, T.hour, T.minute, T.second, T.second_part));
+                break;
+            }
+            case ColumnEncoding::Time:
+            {
+                const MYSQL_TIME& T = Column.Temporal;
+                int64_t Micros = (((int64_t)T.hour * 60 + T.minute) * 60 + T.second) * 1000000 + (int64_t)T.second_part;
+                Builder.AppendValue<int64_t>(T.neg ? -Micros : Micros);
+                break;
+            }
+            case ColumnEncoding::Text:
+                if (Column.Prefix)
+                    AppendPrefix(Columns[c], Column.Buffer.data(), Column.Length, Column.Prefix, Builder);
+                else
+                    Builder.AppendCell(Column.Buffer.data(), Column.Length);
+                break;
+        }
+    }
+    Builder.EndRow();
+}
+
+static std::string StatementError(MYSQL_STMT* Statement)
+{
+    const char* Message = mysql_stmt_error(Statement);
+    if (Message && Message[0])
+        return Message;
+    return "Unknown error (" + std::to_string(mysql_stmt_errno(Statement)) + ")";
+}
+
+// Streams the rows of an executed statement whose result is bound to Bound.
+static bool StreamRows(MYSQL_STMT* Statement, const std::vector<ColumnInfo>& Columns, std::vector<BoundColumn>& Bound,
+                       std::vector<MYSQL_BIND>& Binds, ResultPublisher& Publisher, std::string* Error, const StreamOptions& Options)
+{
+    ResultStream Stream(Publisher, Columns, Options);
+    int Status = 0;
+    while (!Stream.Cancelled() && (Status = StatementFetcher::FetchRow(Statement, Bound, Binds)) == 0)
+    {
+        StatementFetcher::AppendRow(Columns, Bound, Stream.Builder());
+        Stream.RowCommitted();
+    }
+
+    if (Stream.Cancelled())
+    {
+        Stream.Abandon();
+        return true;
+    }
+
+    bool Succeeded = true;
+    if (Status != MYSQL_NO_DATA)
+    {
+        if (Error)
+            *Error = StatementError(Statement);
+        Succeeded = false;
+    }
+    Stream.Finish();
+    return Succeeded;
+}
+
+static void PublishAffectedRows(MYSQL_STMT* Statement, ResultPublisher& Publisher)
+{
+    std::string Message = std::to_string((unsigned long long)mysql_stmt_affected_rows(Statement)) + " row(s) affected";
+    Publisher.Publish(ResultStore::FromMessage("Result", Message));
+}
+
+bool StatementFetcher::Execute(MYSQL* Connection, const std::string& Sql, ResultPublisher& Publisher,
+                               std::string* Error, bool* Prepared, const StreamOptions& Options)
+{
+    if (Prepared)
+        *Prepared = false;
+
+    MYSQL_STMT* Statement = Connection ? mysql_stmt_init(Connection) : nullptr;
+    if (!Statement)
+    {
+        if (Error)
+            *Error = "Unknown error. (No connection to the server).";
+        return false;
+    }
+
+    if (mysql_stmt_prepare(Statement, Sql.data(), (unsigned long)Sql.size()) != 0 || mysql_stmt_param_count(Statement) != 0)
+    {
+        if (Error)
+            *Error = StatementError(Statement);
+        mysql_stmt_close(Statement);
+        return false;
+    }
+
+    if (Prepared)
+        *Prepared = true;
+
+    bool Succeeded = true;
+    MYSQL_RES* Metadata = mysql_stmt_result_metadata(Statement);
+
+    if (mysql_stmt_execute(Statement) != 0)
+    {
+        if (Error)
+            *Error = StatementError(Statement);
+        Succeeded = false;
+    }
+    else if (!Metadata)
+    {
+        PublishAffectedRows(Statement, Publisher);
+    }
+    else
+    {
+        std::vector<ColumnInfo>  Columns;
+        std::vector<BoundColumn> Bound;
+        std::vector<MYSQL_BIND>  Binds;
+        BindResult(mysql_fetch_fields(Metadata), mysql_num_fields(Metadata), Columns, Bound, Binds, Options.CellPrefixBytes);
+
+        if (mysql_stmt_bind_result(Statement, Binds.data()) != 0)
+        {
+            if (Error)
+                *Error = StatementError(Statement);
+            Succeeded = false;
+        }
+        else
+        {
+            Succeeded = StreamRows(Statement, Columns, Bound, Binds, Publisher, Error, Options);
+        }
+    }
+
+    if (Metadata)
+        mysql_free_result(Metadata);
+    mysql_stmt_close(Statement);
+    return Succeeded;
+}
+
+bool StatementFetcher::Execute(StatementCache& Statements, MYSQL* Connection, const std::string& Sql, ResultPublisher& Publisher,
+                               std::string* Error, bool* Prepared, const StreamOptions& Options)
+{
+    if (Prepared)
+        *Prepared = false;
+
+    CachedStatement* Statement = nullptr;
+    for (int Attempt = 0; ; Attempt++)
+    {
+        Statement = Statements.Prepare(Connection, Sql, Error);
+        // Placeholders have no values here; the caller runs such text as a query.
+        const bool Usable = Statement && Statement->ParamCount == 0;
+        if (Prepared)
+            *Prepared = Usable;
+        if (!Usable)
+            return false;
+        if (mysql_stmt_execute(Statement->Handle) == 0)
+            break;
+
+        if (Attempt == 0 && StatementCache::NeedsPrepare(Statement->Handle))
+        {
+            Statements.Invalidate(Statement);
+            continue;
+        }
+        if (Error)
+            *Error = StatementError(Statement->Handle);
+        return false;
+    }
+
+    MYSQL_STMT* Handle = Statement->Handle;
+    if (mysql_stmt_field_count(Handle) == 0)
+    {
+        PublishAffectedRows(Handle, Publisher);
+        return true;
+    }
+
+    bool Succeeded = Statements.BindResult(*Statement, Options.CellPrefixBytes, Error) &&
+                     StreamRows(Handle, Statement->Columns, Statement->Bound, Statement->Binds, Publisher, Error, Options);
+    // The statement stays prepared; what a cancel or an error left unread goes now.
+    mysql_stmt_free_result(Handle);
+    return Succeeded;
+}
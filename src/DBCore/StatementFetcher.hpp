@@ -0,0 +1,75 @@
+//
+//  StatementFetcher.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <MariaDBKit/mysql.h>
+
+#include "ResultStream.hpp"
+
+#include <string>
+#include <vector>
+
+namespace DBCore
+{
+    class StatementCache;
+
+    // Output buffers for one result column of a prepared statement. Numeric and
+    // temporal columns are bound to native buffers and land in fixed-width
+    // columns; everything else is bound as a string buffer that grows on demand.
+    struct BoundColumn
+    {
+        ColumnEncoding      Encoding = ColumnEncoding::Text;
+        bool                Bits     = false;
+        uint32_t            Prefix   = 0;   // longer values are fetched only this far
+
+        union {
+            int64_t         Integer;
+            double          Real;
+        };
+        MYSQL_TIME          Temporal{};
+        std::vector<char>   Buffer;
+
+        unsigned long       Length  = 0;
+        my_bool             IsNull  = 0;
+        my_bool             Error   = 0;
+
+        BoundColumn() : Integer(0) { }
+    };
+
+    class StatementFetcher
+    {
+    public:
+        // True for statements whose first keyword is SELECT or WITH, skipping
+        // leading comments, whitespace and parentheses.
+        static bool IsSelect(const std::string& Sql);
+
+        // Runs Sql through mysql_stmt_prepare/mysql_stmt_execute and streams the
+        // typed rows into Publisher. *Prepared is false when the server refused
+        // to prepare the statement, in which case nothing was published and the
+        // caller may fall back to the text protocol.
+        static bool Execute(MYSQL* Connection, const std::string& Sql, ResultPublisher& Publisher,
+                            std::string* Error, bool* Prepared, const StreamOptions& Options = StreamOptions());
+
+        // The same with the statement and its result bindings taken from
+        // Statements, prepared again once if the server dropped it.
+        static bool Execute(StatementCache& Statements, MYSQL* Connection, const std::string& Sql, ResultPublisher& Publisher,
+                            std::string* Error, bool* Prepared, const StreamOptions& Options = StreamOptions());
+
+        // Binds every column of Metadata to a BoundColumn and fills Columns.
+        // BLOB/TEXT columns are capped at PrefixBytes when it is not 0.
+        static void BindResult(const MYSQL_FIELD* Fields, unsigned int Count, std::vector<ColumnInfo>& Columns,
+                               std::vector<BoundColumn>& Bound, std::vector<MYSQL_BIND>& Binds, uint32_t PrefixBytes = 0);
+
+        // Fetches the next row into Bound, completing truncated string columns
+        // with mysql_stmt_fetch_column up to their prefix limit. Returns 0,
+        // MYSQL_NO_DATA or 1 on error.
+        static int FetchRow(MYSQL_STMT* Statement, std::vector<BoundColumn>& Bound, std::vector<MYSQL_BIND>& Binds);
+
+        static void AppendRow(const std::vector<ColumnInfo>& Columns, const std::vector<BoundColumn>& Bound, ResultStoreBuilder& Builder);
+    };
+}
@@ -0,0 +1,114 @@
+//
+//  SubstringSearch.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "SubstringSearch.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace DBCore;
+
+static inline unsigned char ToLower(unsigned char c) { return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c; }
+static inline unsigned char ToUpper(unsigned char c) { return (c >= 'a' && c <= 'z') ? (unsigned char)(c - 32) : c; }
+
+SubstringSearcher::SubstringSearcher(std::string_view Text, bool CaseSensitive)
+    : Needle(Text), CaseSensitive(CaseSensitive)
+{
+    if (!CaseSensitive)
+    {
+        for (char& c : Needle)
+            c = (char)ToLower((unsigned char)c);
+    }
+
+    unsigned char First = Needle.empty() ? 0 : (unsigned char)Needle.front();
+    unsigned char Last  = Needle.empty() ? 0 : (unsigned char)Needle.back();
+    FirstLower = First;
+    LastLower  = Last;
+    FirstUpper = CaseSensitive ? First : ToUpper(First);
+    LastUpper  = CaseSensitive ? Last : ToUpper(Last);
+}
+
+bool SubstringSearcher::Matches(const char* At) const
+{
+    if (CaseSensitive)
+        return memcmp(At, Needle.data(), Needle.size()) == 0;
+
+    for (size_t i = 0; i < Needle.size(); i++)
+    {
+        if (ToLower((unsigned char)At[i]) != (unsigned char)Needle[i])
+            return false;
+    }
+    return true;
+}
+
+size_t SubstringSearcher::FindScalar(const char* Data, size_t Length, size_t From) const
+{
+    const size_t n = Needle.size();
+    for (size_t i = From; i + n <= Length; i++)
+    {
+        unsigned char c = (unsigned char)Data[i];
+        if ((c == FirstLower || c == FirstUpper) && Matches(Data + i))
+            return i;
+    }
+    return NotFound;
+}
+
+size_t SubstringSearcher::Find(const char* Data, size_t Length, size_t From) const
+{
+    const size_t n = Needle.size();
+    if (n == 0)
+        return From <= Length ? From : NotFound;
+    if (Length < n || From > Length - n)
+        return NotFound;
+
+    size_t i = From;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    // Each step looks at 16 candidate starts; the last-byte load reaches n - 1 further.
+#if defined(__SSE2__)
+    const __m128i FirstL = _mm_set1_epi8((char)FirstLower), FirstU = _mm_set1_epi8((char)FirstUpper);
+    const __m128i LastL  = _mm_set1_epi8((char)LastLower),  LastU  = _mm_set1_epi8((char)LastUpper);
+#else
+    const uint8x16_t FirstL = vdupq_n_u8(FirstLower), FirstU = vdupq_n_u8(FirstUpper);
+    const uint8x16_t LastL  = vdupq_n_u8(LastLower),  LastU  = vdupq_n_u8(LastUpper);
+#endif
+    for (; i + n - 1 + 16 <= Length; i += 16)
+    {
+#if defined(__SSE2__)
+        const __m128i Head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + i));
+        const __m128i Tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + i + n - 1));
+        const __m128i Hit  = _mm_and_si128(_mm_or_si128(_mm_cmpeq_epi8(Head, FirstL), _mm_cmpeq_epi8(Head, FirstU)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(Tail, LastL), _mm_cmpeq_epi8(Tail, LastU)));
+        uint64_t Mask = (uint64_t)_mm_movemask_epi8(Hit);
+        const int LaneShift = 0;
+#else
+        const uint8x16_t Head = vld1q_u8(reinterpret_cast<const uint8_t*>(Data + i));
+        const uint8x16_t Tail = vld1q_u8(reinterpret_cast<const uint8_t*>(Data + i + n - 1));
+        const uint8x16_t Hit  = vandq_u8(vorrq_u8(vceqq_u8(Head, FirstL), vceqq_u8(Head, FirstU)),
+                                         vorrq_u8(vceqq_u8(Tail, LastL), vceqq_u8(Tail, LastU)));
+        // Narrow to a nibble per lane and keep one bit of each.
+        uint64_t Mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(Hit), 4)), 0) & 0x8888888888888888ull;
+        const int LaneShift = 2;
+#endif
+        while (Mask)
+        {
+            size_t Lane = (size_t)(__builtin_ctzll(Mask) >> LaneShift);
+            if (Matches(Data + i + Lane))
+                return i + Lane;
+            Mask &= Mask - 1;
+        }
+    }
+#endif
+
+    return FindScalar(Data, Length, i);
+}
@@ -0,0 +1,42 @@
+//
+//  SubstringSearch.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace DBCore
+{
+    // Substring search over raw column arenas. Candidates are found 16 bytes
+    // at a time by comparing the needle's first and last byte at once (SSE2
+    // or NEON, scalar elsewhere) and only those are verified in full.
+    // Case-insensitive matching folds ASCII letters only.
+    class SubstringSearcher
+    {
+    public:
+        static constexpr size_t NotFound = (size_t)-1;
+
+        SubstringSearcher(std::string_view Needle, bool CaseSensitive);
+
+        size_t Size() const { return Needle.size(); }
+
+        // Offset of the first match starting at or after From, or NotFound.
+        size_t Find(const char* Data, size_t Length, size_t From = 0) const;
+        bool   Contains(const char* Data, size_t Length) const { return Find(Data, Length) != NotFound; }
+
+    private:
+        bool Matches(const char* At) const;
+        size_t FindScalar(const char* Data, size_t Length, size_t From) const;
+
+        std::string   Needle;         // folded to lower case when !CaseSensitive
+        bool          CaseSensitive;
+        unsigned char FirstLower, FirstUpper;
+        unsigned char LastLower, LastUpper;
+    };
+}
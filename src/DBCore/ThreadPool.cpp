@@ -0,0 +1,115 @@
+//
+//  ThreadPool.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace DBCore;
+
+ThreadPool::ThreadPool(unsigned Threads)
+{
+    Threads = std::max(Threads, 1u);
+    for (unsigned i = 0; i < Threads; i++)
+        Workers.emplace_back(&ThreadPool::Run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+    Condition.notify_all();
+    for (std::thread& Worker : Workers)
+        Worker.join();
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+    static ThreadPool Instance;
+    return Instance;
+}
+
+void ThreadPool::Submit(std::function<void()> Task)
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Tasks.push_back(std::move(Task));
+    }
+    Condition.notify_one();
+}
+
+void ThreadPool::Run()
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true)
+    {
+        Condition.wait(Lock, [this] { return Stopping || !Tasks.empty(); });
+        if (Tasks.empty())
+            break;
+
+        std::function<void()> Task = std::move(Tasks.front());
+        Tasks.pop_front();
+
+        Lock.unlock();
+        Task();
+        Lock.lock();
+    }
+}
+
+void ThreadPool::ParallelFor(uint64_t Count, uint64_t Grain, const std::function<void(uint64_t, uint64_t)>& Body)
+{
+    if (Count == 0)
+        return;
+
+    Grain = std::max<uint64_t>(Grain, 1);
+    const uint64_t Chunks = (Count + Grain - 1) / Grain;
+    if (Chunks == 1)
+    {
+        Body(0, Count);
+        return;
+    }
+
+    // Helpers that start after every chunk is claimed find nothing to do;
+    // the shared state outlives this call for their sake.
+    struct State
+    {
+        std::atomic<uint64_t>   Next{0};
+        std::atomic<uint64_t>   Done{0};
+        std::mutex              Mutex;
+        std::condition_variable Finished;
+    };
+    auto Shared = std::make_shared<State>();
+
+    auto Drain = [Shared, Count, Grain, Chunks, &Body]() {
+        uint64_t Chunk;
+        while ((Chunk = Shared->Next.fetch_add(1)) < Chunks)
+        {
+            uint64_t Begin = Chunk * Grain;
+            Body(Begin, std::min(Begin + Grain, Count));
+            if (Shared->Done.fetch_add(1) + 1 == Chunks)
+            {
+                std::lock_guard<std::mutex> Lock(Shared->Mutex);
+                Shared->Finished.notify_all();
+            }
+        }
+    };
+
+    // Body is only touched while chunks remain, and this call does not
+    // return before every chunk is done, so capturing it by reference is safe.
+    const uint64_t Helpers = std::min<uint64_t>(ThreadCount(), Chunks - 1);
+    for (uint64_t i = 0; i < Helpers; i++)
+        Submit(Drain);
+
+    Drain();
+
+    std::unique_lock<std::mutex> Lock(Shared->Mutex);
+    Shared->Finished.wait(Lock, [&] { return Shared->Done.load() == Chunks; });
+}
@@ -0,0 +1,51 @@
+//
+//  ThreadPool.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DBCore
+{
+    // Fixed set of worker threads for CPU-bound work over fetched results
+    // (sort keys, filters, statistics). Query I/O stays on QueryWorker.
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(unsigned Threads = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        static ThreadPool& Shared();
+
+        unsigned ThreadCount() const { return (unsigned)Workers.size(); }
+
+        void Submit(std::function<void()> Task);
+
+        // Runs Body(Begin, End) over [0, Count) in chunks of Grain, on the pool
+        // and on the calling thread, and returns once every chunk is done.
+        // Safe to call from a pool thread: the caller drains chunks itself.
+        void ParallelFor(uint64_t Count, uint64_t Grain, const std::function<void(uint64_t, uint64_t)>& Body);
+
+    private:
+        void Run();
+
+        std::mutex                        Mutex;
+        std::condition_variable           Condition;
+        std::deque<std::function<void()>> Tasks;
+        std::vector<std::thread>          Workers;
+        bool                              Stopping = false;
+    };
+}
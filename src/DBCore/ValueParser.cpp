@@ -0,0 +1,337 @@
+//
+//  ValueParser.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ValueParser.hpp"
+#include "ResultStore.hpp"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <locale.h>
+#include <string>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+
+using namespace DBCore;
+
+// Powers of ten a double holds exactly.
+static constexpr double ExactPowers[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static constexpr int MaxDecimalDigits = 38;
+
+static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+
+// std::from_chars takes no '+'; the server never sends one, strtod did.
+static const char* SkipPlus(const char* s, const char* End)
+{
+    return s + 1 < End && *s == '+' && s[1] != '-' ? s + 1 : s;
+}
+
+bool DBCore::ParseInt64(std::string_view Text, int64_t& Value)
+{
+    const char* End = Text.data() + Text.size();
+    return std::from_chars(SkipPlus(Text.data(), End), End, Value).ec == std::errc();
+}
+
+bool DBCore::ParseUInt64(std::string_view Text, uint64_t& Value)
+{
+    const char* End = Text.data() + Text.size();
+    return std::from_chars(SkipPlus(Text.data(), End), End, Value).ec == std::errc();
+}
+
+#if !defined(__cpp_lib_to_chars)
+static locale_t CLocale()
+{
+    static const locale_t Locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+    return Locale;
+}
+#endif
+
+// Correctly rounded conversion of whatever the fast path turned down.
+static bool ParseDoubleSlow(const char* Begin, const char* End, double& Value)
+{
+#if defined(__cpp_lib_to_chars)
+    return std::from_chars(SkipPlus(Begin, End), End, Value).ec == std::errc();
+#else
+    char Buffer[128];
+    std::string Long;
+    const size_t Length = (size_t)(End - Begin);
+    const char* Terminated = Buffer;
+    if (Length < sizeof(Buffer))
+    {
+        memcpy(Buffer, Begin, Length);
+        Buffer[Length] = '\0';
+    }
+    else
+    {
+        Long.assign(Begin, Length);
+        Terminated = Long.c_str();
+    }
+    char* Stop = nullptr;
+    Value = strtod_l(Terminated, &Stop, CLocale());
+    return Stop != Terminated;
+#endif
+}
+
+bool DBCore::ParseDouble(std::string_view Text, double& Value)
+{
+    const char* Begin = Text.data();
+    const char* End = Begin + Text.size();
+    const char* s = Begin;
+    const bool Negative = s < End && *s == '-';
+    if (s < End && (*s == '-' || *s == '+'))
+        s++;
+
+    // Up to 19 significant digits, and the power of ten they are scaled by.
+    uint64_t Mantissa = 0;
+    int Significant = 0;
+    int Exponent = 0;
+    bool Truncated = false;
+    bool AnyDigit = false;
+    for (; s < End && IsDigit(*s); s++)
+    {
+        AnyDigit = true;
+        if (Significant == 19)
+        {
+            Exponent++;
+            Truncated = true;
+            continue;
+        }
+        Mantissa = Mantissa * 10 + (uint64_t)(*s - '0');
+        Significant += Mantissa != 0;
+    }
+    if (s < End && *s == '.')
+    {
+        for (s++; s < End && IsDigit(*s); s++)
+        {
+            AnyDigit = true;
+            if (Significant == 19)
+            {
+                Truncated = Truncated || *s != '0';
+                continue;
+            }
+            Mantissa = Mantissa * 10 + (uint64_t)(*s - '0');
+            Significant += Mantissa != 0;
+            Exponent--;
+        }
+    }
+    if (!AnyDigit)
+        return ParseDoubleSlow(Begin, End, Value);
+
+    if (s < End && (*s == 'e' || *s == 'E'))
+    {
+        const char* e = s + 1;
+        const bool NegativeExponent = e < End && *e == '-';
+        if (e < End && (*e == '-' || *e == '+'))
+            e++;
+        if (e < End && IsDigit(*e))
+        {
+            int Power = 0;
+            for (; e < End && IsDigit(*e); e++)
+                Power = Power < 100000 ? Power * 10 + (*e - '0') : Power;
+            Exponent += NegativeExponent ? -Power : Power;
+        }
+    }
+
+    if (Mantissa == 0 && !Truncated)
+    {
+        Value = Negative ? -0.0 : 0.0;
+        return true;
+    }
+    // Both operands exact, so the one rounding is the correct one.
+    if (!Truncated && Mantissa <= (1ull << 53) && Exponent >= -22 && Exponent <= 22)
+    {
+        double Result = (double)Mantissa;
+        Result = Exponent < 0 ? Result / ExactPowers[-Exponent] : Result * ExactPowers[Exponent];
+        Value = Negative ? -Result : Result;
+        return true;
+    }
+    return ParseDoubleSlow(Begin, End, Value);
+}
+
+bool DBCore::ParseDecimal(std::string_view Text, int Scale, __int128& Value)
+{
+    const char* s = Text.data();
+    const char* End = s + Text.size();
+    const bool Negative = s < End && *s == '-';
+    if (s < End && (*s == '-' || *s == '+'))
+        s++;
+
+    __int128 Digits = 0;
+    int Significant = 0;
+    int Fraction = -1;
+    bool AnyDigit = false;
+    for (; s < End; s++)
+    {
+        if (*s == '.' && Fraction < 0)
+        {
+            Fraction = 0;
+            continue;
+        }
+        if (!IsDigit(*s))
+            break;
+        AnyDigit = true;
+        if (Fraction >= 0)
+        {
+            if (Fraction == Scale)
+                continue;
+            Fraction++;
+        }
+        // Counted before scaling, so a 39th digit fails instead of overflowing.
+        if ((Digits != 0 || *s != '0') && ++Significant > MaxDecimalDigits)
+            return false;
+        Digits = Digits * 10 + (*s - '0');
+    }
+    if (!AnyDigit)
+        return false;
+
+    for (int f = Fraction > 0 ? Fraction : 0; f < Scale; f++)
+    {
+        if (Digits != 0 && ++Significant > MaxDecimalDigits)
+            return false;
+        Digits *= 10;
+    }
+    Value = Negative ? -Digits : Digits;
+    return true;
+}
+
+// Unpadded field of at most Max, as my_strtoui() in ma_stmt_codec.c.
+static bool ParseField(const char*& s, const char* End, unsigned Max, unsigned& Value)
+{
+    const char* Begin = s;
+    uint64_t Number = 0;
+    for (; s < End && IsDigit(*s); s++)
+    {
+        Number = Number * 10 + (uint64_t)(*s - '0');
+        if (Number > Max)
+            return false;
+    }
+    Value = (unsigned)Number;
+    return s != Begin;
+}
+
+// "hours:minutes:seconds[.fraction]"; the fraction is best effort, as in parse_time().
+static bool ParseClock(const char*& s, const char* End, TemporalValue& Value)
+{
+    if (!ParseField(s, End, 838, Value.Hour) || s == End || *s++ != ':' ||
+        !ParseField(s, End, 59, Value.Minute) || s == End || *s++ != ':' ||
+        !ParseField(s, End, 59, Value.Second))
+        return false;
+
+    Value.Microsecond = 0;
+    if (s < End && *s == '.')
+    {
+        int Digits = 0;
+        for (s++; s < End && IsDigit(*s); s++)
+        {
+            if (Digits < 6)
+            {
+                Value.Microsecond = Value.Microsecond * 10 + (unsigned long)(*s - '0');
+                Digits++;
+            }
+        }
+        for (; Digits < 6; Digits++)
+            Value.Microsecond *= 10;
+    }
+    return true;
+}
+
+// "year-month-day", as parse_date().
+static bool ParseCalendar(const char*& s, const char* End, TemporalValue& Value)
+{
+    const char* Begin = s;
+    if (!ParseField(s, End, 9999, Value.Year) || s == End || *s != '-')
+        return false;
+    if (s - Begin == 2)
+        Value.Year += Value.Year >= 70 ? 1900 : 2000;
+    s++;
+    return ParseField(s, End, 12, Value.Month) && s != End && *s++ == '-' &&
+           ParseField(s, End, 31, Value.Day);
+}
+
+bool DBCore::ParseTemporal(std::string_view Text, TemporalValue& Value)
+{
+    const char* s = Text.data();
+    const char* End = s + Text.size();
+    while (s < End && IsSpace(*s))
+        s++;
+    while (s < End && IsSpace(End[-1]))
+        End--;
+
+    Value = TemporalValue();
+    if (End - s < 5)
+        return false;
+
+    // Only TIME can be negative; otherwise the first separator tells them apart.
+    bool IsTime = false;
+    if (*s == '-')
+    {
+        Value.Negative = true;
+        IsTime = true;
+        s++;
+    }
+    else
+    {
+        for (const char* p = s + 1; p < End; p++)
+        {
+            if (*p == '-' || *p == ':')
+            {
+                IsTime = *p == ':';
+                break;
+            }
+        }
+    }
+
+    bool Parsed = false;
+    if (IsTime)
+    {
+        Value.Kind = TemporalKind::Time;
+        Parsed = ParseClock(s, End, Value);
+    }
+    else if (ParseCalendar(s, End, Value))
+    {
+        if (s == End || *s != ' ')
+        {
+            Value.Kind = TemporalKind::Date;
+            Parsed = true;
+        }
+        else
+        {
+            s++;
+            Value.Kind = TemporalKind::DateTime;
+            Parsed = ParseClock(s, End, Value) && Value.Hour <= 23;
+        }
+    }
+    if (!Parsed)
+        Value = TemporalValue();
+    return Parsed;
+}
+
+bool DBCore::ParseDateTime(std::string_view Text, int64_t& Packed)
+{
+    TemporalValue Value;
+    if (!ParseTemporal(Text, Value) || Value.Kind == TemporalKind::Time)
+        return false;
+    Packed = PackDateTime(Value.Year, Value.Month, Value.Day, Value.Hour, Value.Minute, Value.Second, Value.Microsecond);
+    return true;
+}
+
+bool DBCore::ParseTime(std::string_view Text, int64_t& Micros)
+{
+    TemporalValue Value;
+    if (!ParseTemporal(Text, Value) || Value.Kind != TemporalKind::Time)
+        return false;
+    int64_t Total = (((int64_t)Value.Hour * 60 + Value.Minute) * 60 + Value.Second) * 1000000 + (int64_t)Value.Microsecond;
+    Micros = Value.Negative ? -Total : Total;
+    return true;
+}
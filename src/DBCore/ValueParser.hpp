@@ -0,0 +1,55 @@
+//
+//  ValueParser.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace DBCore
+{
+    // Parsers for the text protocol's value formats. None of them look at the
+    // current locale or allocate. Like std::from_chars they read the longest
+    // valid prefix and return false only when there is none (or it overflows).
+    bool ParseInt64(std::string_view Text, int64_t& Value);
+    bool ParseUInt64(std::string_view Text, uint64_t& Value);
+
+    // Exact for up to 19 significant digits within 1e±22 (what DECIMAL and
+    // FLOAT/DOUBLE text nearly always is); anything else goes to strtod_l in
+    // the C locale, or std::from_chars where the library has it.
+    bool ParseDouble(std::string_view Text, double& Value);
+
+    // DECIMAL text as an integer scaled by 10^Scale; digits past Scale are
+    // truncated. False when the value does not fit in 38 digits.
+    bool ParseDecimal(std::string_view Text, int Scale, __int128& Value);
+
+    enum class TemporalKind : uint8_t { Date, DateTime, Time };
+
+    struct TemporalValue
+    {
+        TemporalKind  Kind        = TemporalKind::Date;
+        bool          Negative    = false;    // TIME only
+        unsigned      Year        = 0;
+        unsigned      Month       = 0;
+        unsigned      Day         = 0;
+        unsigned      Hour        = 0;
+        unsigned      Minute      = 0;
+        unsigned      Second      = 0;
+        unsigned long Microsecond = 0;
+    };
+
+    // "year-month-day[ hh:mm:ss[.frac]]" or "[-]hhh:mm:ss[.frac]", following
+    // str_to_TIME() in libmariadb: fields need not be zero padded, two-digit
+    // years map to 1970-2069, zero dates parse as zero fields, the fraction is
+    // truncated to microseconds and trailing junk is ignored.
+    bool ParseTemporal(std::string_view Text, TemporalValue& Value);
+
+    // DATE/DATETIME/TIMESTAMP text packed by PackDateTime().
+    bool ParseDateTime(std::string_view Text, int64_t& Packed);
+    // TIME text as signed microseconds.
+    bool ParseTime(std::string_view Text, int64_t& Micros);
+}
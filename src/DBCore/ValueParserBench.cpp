@@ -0,0 +1,247 @@
+//
+//  ValueParserBench.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+// Times the ValueParser kernels per cell on values shaped like what the text
+// protocol returns, with strtoll/strtod as the baseline. Not part of the app
+// target; build it on its own from this directory:
+//
+//   clang++ -std=c++20 -O2 ValueParserBench.cpp ValueParser.cpp -o ValueParserBench
+//   ./ValueParserBench [rounds]
+
+#include "ValueParser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DBCore;
+
+static constexpr size_t CellCount = 1 << 16;
+
+// Cells of one kind, stored back to back like a column arena and handed to
+// the parsers as views, so the timings leave out any allocation.
+struct Column
+{
+    std::string           Arena;
+    std::vector<uint32_t> Offsets{ 0 };
+
+    void Add(const std::string& Value)
+    {
+        Arena += Value;
+        Offsets.push_back((uint32_t)Arena.size());
+    }
+    std::string_view Cell(size_t i) const { return std::string_view(Arena.data() + Offsets[i], Offsets[i + 1] - Offsets[i]); }
+    size_t Size() const { return Offsets.size() - 1; }
+};
+
+static std::string Format(const char* Pattern, ...) __attribute__((format(printf, 1, 2)));
+static std::string Format(const char* Pattern, ...)
+{
+    char Buffer[96];
+    va_list Args;
+    va_start(Args, Pattern);
+    vsnprintf(Buffer, sizeof(Buffer), Pattern, Args);
+    va_end(Args);
+    return Buffer;
+}
+
+// Ids, counters and the odd extreme value, as INT/BIGINT columns hold.
+static Column SignedCells(std::mt19937_64& Random)
+{
+    Column Cells;
+    for (size_t i = 0; i < CellCount; i++)
+    {
+        switch (Random() % 8)
+        {
+            case 0:  Cells.Add(Format("%" PRId64, (int64_t)Random())); break;
+            case 1:  Cells.Add(Format("-%u", (unsigned)(Random() % 100000))); break;
+            case 2:  Cells.Add(Format("%u", (unsigned)(Random() % 100))); break;
+            default: Cells.Add(Format("%u", (unsigned)(Random() % 10000000))); break;
+        }
+    }
+    return Cells;
+}
+
+static Column UnsignedCells(std::mt19937_64& Random)
+{
+    Column Cells;
+    for (size_t i = 0; i < CellCount; i++)
+    {
+        if (Random() % 4 == 0)
+            Cells.Add(Format("%" PRIu64, (uint64_t)Random()));
+        else
+            Cells.Add(Format("%u", (unsigned)(Random() % 10000000)));
+    }
+    return Cells;
+}
+
+// DOUBLE text: short fractions, full 17-digit values and exponents.
+static Column DoubleCells(std::mt19937_64& Random)
+{
+    std::uniform_real_distribution<double> Values(-1e6, 1e6);
+    Column Cells;
+    for (size_t i = 0; i < CellCount; i++)
+    {
+        switch (Random() % 4)
+        {
+            case 0:  Cells.Add(Format("%.17g", Values(Random))); break;
+            case 1:  Cells.Add(Format("%.6e", Values(Random) * 1e20)); break;
+            default: Cells.Add(Format("%.2f", Values(Random))); break;
+        }
+    }
+    return Cells;
+}
+
+// DECIMAL(18,4) and DECIMAL(30,4) values, always printed with their scale.
+static Column DecimalCells(std::mt19937_64& Random)
+{
+    Column Cells;
+    for (size_t i = 0; i < CellCount; i++)
+    {
+        const char* Sign = Random() % 5 == 0 ? "-" : "";
+        unsigned Fraction = (unsigned)(Random() % 10000);
+        if (Random() % 4 == 0)
+            Cells.Add(Format("%s%" PRIu64 "%010u.%04u", Sign, (uint64_t)(Random() % 10000000000000000ull), (unsigned)(Random() % 1000000000), Fraction));
+        else
+            Cells.Add(Format("%s%u.%04u", Sign, (unsigned)(Random() % 100000000), Fraction));
+    }
+    return Cells;
+}
+
+// DATE, DATETIME and DATETIME(6) in the server's output format.
+static Column DateTimeCells(std::mt19937_64& Random)
+{
+    Column Cells;
+    for (size_t i = 0; i < CellCount; i++)
+    {
+        unsigned Year = 1970 + (unsigned)(Random() % 80), Month = 1 + (unsigned)(Random() % 12), Day = 1 + (unsigned)(Random() % 28);
+        unsigned Hour = (unsigned)(Random() % 24), Minute = (unsigned)(Random() % 60), Second = (unsigned)(Random() % 60);
+        switch (Random() % 3)
+        {
+            case 0:  Cells.Add(Format("%04u-%02u-%02u", Year, Month, Day)); break;
+            case 1:  Cells.Add(Format("%04u-%02u-%02u %02u:%02u:%02u", Year, Month, Day, Hour, Minute, Second)); break;
+            default: Cells.Add(Format("%04u-%02u-%02u %02u:%02u:%02u.%06u", Year, Month, Day, Hour, Minute, Second, (unsigned)(Random() % 1000000))); break;
+        }
+    }
+    return Cells;
+}
+
+static Column TimeCells(std::mt19937_64& Random)
+{
+    Column Cells;
+    for (size_t i = 0; i < CellCount; i++)
+    {
+        const char* Sign = Random() % 8 == 0 ? "-" : "";
+        Cells.Add(Format("%s%02u:%02u:%02u", Sign, (unsigned)(Random() % 839), (unsigned)(Random() % 60), (unsigned)(Random() % 60)));
+    }
+    return Cells;
+}
+
+// Parse returns something derived from the value, summed so the calls cannot
+// be dropped; Failed counts cells it rejected.
+template<typename ParseCell>
+static void Time(const char* Name, const Column& Cells, unsigned Rounds, ParseCell Parse)
+{
+    uint64_t Sum = 0;
+    uint64_t Failed = 0;
+    const auto Start = std::chrono::steady_clock::now();
+    for (unsigned Round = 0; Round < Rounds; Round++)
+    {
+        for (size_t i = 0; i < Cells.Size(); i++)
+        {
+            uint64_t Value = 0;
+            if (Parse(Cells.Cell(i), Value))
+                Sum += Value;
+            else
+                Failed++;
+        }
+    }
+    const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    const double Parsed = (double)Cells.Size() * Rounds;
+    printf("%-20s %8.2f ns/cell %9.1f MB/s  failed %-6" PRIu64 " (%016" PRIx64 ")\n", Name, Seconds * 1e9 / Parsed,
+           (double)Cells.Arena.size() * Rounds / Seconds / 1e6, Failed / Rounds, Sum);
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned Rounds = argc > 1 ? (unsigned)std::max(1, atoi(argv[1])) : 50;
+    std::mt19937_64 Random(20250101);
+
+    const Column Signed   = SignedCells(Random);
+    const Column Unsigned = UnsignedCells(Random);
+    const Column Doubles  = DoubleCells(Random);
+    const Column Decimals = DecimalCells(Random);
+    const Column Dates    = DateTimeCells(Random);
+    const Column Times    = TimeCells(Random);
+
+    // strtoll/strtod need terminated input, which the protocol's cells are not.
+    auto Terminated = [](std::string_view Text, char* Buffer) {
+        Text.copy(Buffer, 63);
+        Buffer[std::min<size_t>(Text.size(), 63)] = 0;
+        return Buffer;
+    };
+
+    printf("%zu cells per kind, %u rounds\n", CellCount, Rounds);
+    Time("ParseInt64", Signed, Rounds, [](std::string_view Text, uint64_t& Out) {
+        int64_t Value;
+        bool Parsed = ParseInt64(Text, Value);
+        Out = (uint64_t)Value;
+        return Parsed;
+    });
+    Time("  strtoll", Signed, Rounds, [&](std::string_view Text, uint64_t& Out) {
+        char Buffer[64];
+        Out = (uint64_t)strtoll(Terminated(Text, Buffer), nullptr, 10);
+        return true;
+    });
+    Time("ParseUInt64", Unsigned, Rounds, [](std::string_view Text, uint64_t& Out) {
+        return ParseUInt64(Text, Out);
+    });
+    Time("ParseDouble", Doubles, Rounds, [](std::string_view Text, uint64_t& Out) {
+        double Value;
+        bool Parsed = ParseDouble(Text, Value);
+        memcpy(&Out, &Value, sizeof(Out));
+        return Parsed;
+    });
+    Time("  strtod", Doubles, Rounds, [&](std::string_view Text, uint64_t& Out) {
+        char Buffer[64];
+        double Value = strtod(Terminated(Text, Buffer), nullptr);
+        memcpy(&Out, &Value, sizeof(Out));
+        return true;
+    });
+    Time("ParseDecimal", Decimals, Rounds, [](std::string_view Text, uint64_t& Out) {
+        __int128 Value;
+        bool Parsed = ParseDecimal(Text, 4, Value);
+        Out = (uint64_t)Value;
+        return Parsed;
+    });
+    Time("ParseDateTime", Dates, Rounds, [](std::string_view Text, uint64_t& Out) {
+        int64_t Packed;
+        bool Parsed = ParseDateTime(Text, Packed);
+        Out = (uint64_t)Packed;
+        return Parsed;
+    });
+    Time("ParseTime", Times, Rounds, [](std::string_view Text, uint64_t& Out) {
+        int64_t Micros;
+        bool Parsed = ParseTime(Text, Micros);
+        Out = (uint64_t)Micros;
+        return Parsed;
+    });
+    Time("ParseTemporal", Dates, Rounds, [](std::string_view Text, uint64_t& Out) {
+        TemporalValue Value;
+        bool Parsed = ParseTemporal(Text, Value);
+        Out = Value.Year + Value.Second + Value.Microsecond;
+        return Parsed;
+    });
+    return 0;
+}
@@ -0,0 +1,253 @@
+//
+//  BlobInspector.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "BlobInspector.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static std::string FormatSize(uint64_t Bytes)
+{
+    char Text[32];
+    if (Bytes >= (1ull << 20))
+        snprintf(Text, sizeof(Text), "%.1f MB", Bytes / (1024.0 * 1024.0));
+    else if (Bytes >= 1024)
+        snprintf(Text, sizeof(Text), "%.1f KB", Bytes / 1024.0);
+    else
+        snprintf(Text, sizeof(Text), "%llu bytes", (unsigned long long)Bytes);
+    return Text;
+}
+
+void BlobInspector::Open(std::shared_ptr<DBCore::BlobSource> NewSource, std::string NewTitle, bool IsBinary)
+{
+    // Pages still queued for the previous value are dropped; a running read finishes into the old state.
+    Loader.Cancel();
+    Source = std::move(NewSource);
+    Shared = std::make_shared<State>();
+    Title = std::move(NewTitle);
+    Length = Source ? Source->Length() : 0;
+    CurrentPage = 0;
+    Binary = IsBinary;
+    ShowHex = IsBinary;
+    Visible = true;
+}
+
+void BlobInspector::RequestPage(uint64_t Page)
+{
+    {
+        std::lock_guard<std::mutex> Lock(Shared->Mutex);
+        if (Shared->Pages.count(Page) || Shared->Failed.count(Page) || !Shared->Pending.insert(Page).second)
+            return;
+    }
+
+    std::shared_ptr<DBCore::BlobSource> Reader = Source;
+    std::shared_ptr<State> Target = Shared;
+    Loader.Submit([Reader, Target, Page](const DBCore::CancelToken &Token) {
+        std::string Data, ErrStr;
+        bool Succeeded = !Token.Cancelled() && Reader->Read(Page * PageSize, PageSize, Data, &ErrStr);
+
+        std::lock_guard<std::mutex> Lock(Target->Mutex);
+        Target->Pending.erase(Page);
+        if (!Succeeded)
+        {
+            if (!Token.Cancelled())
+            {
+                Target->Error = ErrStr;
+                Target->Failed.insert(Page);
+            }
+            return;
+        }
+        Target->Error.clear();
+        Target->Pages[Page] = std::move(Data);
+
+        // Keep the pages closest to the one just read.
+        while (Target->Pages.size() > MaxCachedPages)
+        {
+            auto First = Target->Pages.begin();
+            auto Last = std::prev(Target->Pages.end());
+            Target->Pages.erase(Page - First->first > Last->first - Page ? First : Last);
+        }
+    });
+}
+
+void BlobInspector::Save()
+{
+    std::string Path;
+    if (!ChooseSavePath || !ChooseSavePath(Path))
+        return;
+
+    std::shared_ptr<DBCore::BlobSource> Reader = Source;
+    std::shared_ptr<State> Target = Shared;
+    Target->Saved.store(0);
+    Target->Saving.store(true);
+    Loader.Submit([Reader, Target, Path](const DBCore::CancelToken &Token) {
+        std::string ErrStr;
+        bool Succeeded = Reader->WriteToFile(Path, &Target->Saved, &Token, &ErrStr);
+
+        std::lock_guard<std::mutex> Lock(Target->Mutex);
+        Target->SaveStatus = Succeeded ? "Saved " + FormatSize(Target->Saved.load()) + " to " + Path : "Save failed: " + ErrStr;
+        Target->Saving.store(false);
+    });
+}
+
+void BlobInspector::DrawHex(const std::string &Data, uint64_t Offset)
+{
+    static const char Digits[] = "0123456789ABCDEF";
+    const int Lines = (int)((Data.size() + 15) / 16);
+
+    ImGuiListClipper Clipper;
+    Clipper.Begin(Lines);
+    while (Clipper.Step())
+    {
+        for (int Line = Clipper.DisplayStart; Line < Clipper.DisplayEnd; Line++)
+        {
+            // "offset  xx xx .. xx  ascii"
+            char Text[96];
+            int Length = snprintf(Text, sizeof(Text), "%010llx  ", (unsigned long long)(Offset + (uint64_t)Line * 16));
+            const size_t Begin = (size_t)Line * 16;
+            for (size_t i = 0; i < 16; i++)
+            {
+                if (Begin + i < Data.size())
+                {
+                    uint8_t Byte = (uint8_t)Data[Begin + i];
+                    Text[Length++] = Digits[Byte >> 4];
+                    Text[Length++] = Digits[Byte & 15];
+                }
+                else
+                {
+                    Text[Length++] = ' ';
+                    Text[Length++] = ' ';
+                }
+                Text[Length++] = i == 7 ? '-' : ' ';
+            }
+            Text[Length++] = ' ';
+            for (size_t i = 0; i < 16 && Begin + i < Data.size(); i++)
+            {
+                char c = Data[Begin + i];
+                Text[Length++] = c >= 0x20 && c < 0x7F ? c : '.';
+            }
+            ImGui::TextUnformatted(Text, Text + Length);
+        }
+    }
+}
+
+void BlobInspector::Draw()
+{
+    if (!Visible || !Source)
+        return;
+
+    ImGui::SetNextWindowSize(ImVec2(720, 480), ImGuiCond_FirstUseEver);
+    std::string WindowTitle = Title + "###BlobInspector";
+    if (!ImGui::Begin(WindowTitle.c_str(), &Visible))
+    {
+        ImGui::End();
+        return;
+    }
+
+    const uint64_t Pages = std::max<uint64_t>(1, (Length + PageSize - 1) / PageSize);
+    CurrentPage = std::min(CurrentPage, Pages - 1);
+
+    ImGui::TextDisabled("%s", FormatSize(Length).c_str());
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Hex", ShowHex))
+        ShowHex = true;
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Text", !ShowHex))
+        ShowHex = false;
+
+    ImGui::SameLine();
+    ImGui::BeginDisabled(CurrentPage == 0);
+    if (ImGui::ArrowButton("##PreviousPage", ImGuiDir_Left))
+        CurrentPage--;
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::Text("Page %llu of %llu", (unsigned long long)(CurrentPage + 1), (unsigned long long)Pages);
+    ImGui::SameLine();
+    ImGui::BeginDisabled(CurrentPage + 1 >= Pages);
+    if (ImGui::ArrowButton("##NextPage", ImGuiDir_Right))
+        CurrentPage++;
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    const bool Saving = Shared->Saving.load();
+    if (Saving)
+    {
+        if (ImGui::Button("Cancel save"))
+            Loader.Cancel();
+        ImGui::SameLine();
+        ImGui::TextDisabled("Saving... %s of %s", FormatSize(Shared->Saved.load()).c_str(), FormatSize(Length).c_str());
+    }
+    else
+    {
+        if (ImGui::Button("Save..."))
+            Save();
+        std::lock_guard<std::mutex> Lock(Shared->Mutex);
+        if (!Shared->SaveStatus.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", Shared->SaveStatus.c_str());
+        }
+    }
+
+    ImGui::Separator();
+    ImGui::BeginChild("##BlobPage", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
+    {
+        std::string Data, ErrStr;
+        bool Loaded = false;
+        bool Failed = false;
+        {
+            std::lock_guard<std::mutex> Lock(Shared->Mutex);
+            auto It = Shared->Pages.find(CurrentPage);
+            if (It != Shared->Pages.end())
+            {
+                Data = It->second;
+                Loaded = true;
+            }
+            ErrStr = Shared->Error;
+            Failed = Shared->Failed.count(CurrentPage) != 0;
+        }
+
+        if (!Loaded)
+        {
+            // A failed page is not asked for again every frame; the error
+            // usually lasts (row deleted, no permission).
+            if (Failed && ImGui::Button("Retry"))
+            {
+                {
+                    std::lock_guard<std::mutex> Lock(Shared->Mutex);
+                    Shared->Failed.erase(CurrentPage);
+                }
+                Failed = false;
+            }
+            if (!Failed)
+                RequestPage(CurrentPage);
+            if (!ErrStr.empty())
+                ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "%s", ErrStr.c_str());
+            else
+                ImGui::TextDisabled(Saving ? "Waiting for the save to finish..." : "Loading...");
+        }
+        else if (ShowHex)
+        {
+            DrawHex(Data, CurrentPage * PageSize);
+        }
+        else
+        {
+            if (Binary)
+                std::replace_if(Data.begin(), Data.end(), [](char c) { return (c < 0x20 && c != '\n' && c != '\t') || c == 0x7F; }, '.');
+            ImGui::PushTextWrapPos(0.0f);
+            ImGui::TextUnformatted(Data.data(), Data.data() + Data.size());
+            ImGui::PopTextWrapPos();
+        }
+
+        // Read ahead so paging forward does not wait.
+        if (Loaded && CurrentPage + 1 < Pages && !Saving)
+            RequestPage(CurrentPage + 1);
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
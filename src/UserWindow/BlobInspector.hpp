@@ -0,0 +1,67 @@
+//
+//  BlobInspector.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "imgui.h"
+#include "BlobSource.hpp"
+#include "QueryWorker.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+// Window showing one cell value a page at a time, as a hex dump or as text.
+// Pages are read from the value's source on a background thread when they
+// are shown and only a few are kept, so a multi-gigabyte BLOB costs a few
+// pages of memory. Save streams the whole value to a file chunk by chunk;
+// pages wait while a save is running, as both share the source's connection.
+class BlobInspector {
+public:
+    static constexpr uint32_t PageSize = 64 * 1024;
+    static constexpr size_t MaxCachedPages = 8;
+
+    // Asks for a file to save to; returns false when the user cancelled.
+    std::function<bool(std::string &Path)> ChooseSavePath;
+
+    void Open(std::shared_ptr<DBCore::BlobSource> Source, std::string Title, bool Binary);
+    void Draw();
+
+private:
+    // Shared with the loader jobs, which may outlive a reopen.
+    struct State {
+        std::mutex Mutex;
+        std::map<uint64_t, std::string> Pages;
+        std::set<uint64_t> Pending;
+        std::set<uint64_t> Failed;      // retried only from the Retry button
+        std::string Error;
+        std::string SaveStatus;
+        std::atomic<uint64_t> Saved{0};
+        std::atomic_bool Saving{false};
+    };
+
+    void RequestPage(uint64_t Page);
+    void Save();
+    void DrawHex(const std::string &Data, uint64_t Offset);
+
+    std::shared_ptr<DBCore::BlobSource> Source;
+    std::shared_ptr<State> Shared;
+    std::string Title;
+    uint64_t Length = 0;
+    uint64_t CurrentPage = 0;
+    bool Binary = false;
+    bool ShowHex = false;
+    bool Visible = false;
+
+    // Last member, so its thread is joined before the rest goes away.
+    DBCore::QueryWorker Loader;
+};
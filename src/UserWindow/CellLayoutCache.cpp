@@ -0,0 +1,192 @@
+//
+//  CellLayoutCache.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "CellLayoutCache.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+void CellLayoutCache::Reset(size_t Columns)
+{
+    Cells.clear();
+    Cells.resize(Columns);
+    WrapWidths.assign(Columns, 0.0f);
+    CachedCells = 0;
+}
+
+void CellLayoutCache::Validate()
+{
+    if (Font == ImGui::GetFont() && FontSize == ImGui::GetFontSize())
+        return;
+    
+    Font = ImGui::GetFont();
+    FontSize = ImGui::GetFontSize();
+    Reset(Cells.size());
+}
+
+const CellLayout &CellLayoutCache::Get(const DBCore::ResultStore &Result, uint64_t Row, size_t Column, float WrapWidth)
+{
+    if (Cells.size() != Result.ColumnCount())
+        Reset(Result.ColumnCount());
+    
+    std::unordered_map<uint64_t, CellLayout> &ColumnCells = Cells[Column];
+    if (WrapWidths[Column] != WrapWidth)
+    {
+        CachedCells -= ColumnCells.size();
+        ColumnCells.clear();
+        WrapWidths[Column] = WrapWidth;
+    }
+    
+    auto It = ColumnCells.find(Row);
+    if (It != ColumnCells.end())
+        return It->second;
+    
+    // Only what is on screen matters; rather than tracking recency, start
+    // over once the cache holds far more cells than a screen can show.
+    if (CachedCells >= MaxCachedCells)
+    {
+        for (auto &Entries : Cells)
+            Entries.clear();
+        CachedCells = 0;
+    }
+    
+    CellLayout &Layout = ColumnCells[Row];
+    CachedCells++;
+    Build(Layout, Result.Columns()[Column], Result.Cell(Row, Column), Result.FullLength(Row, Column), WrapWidth);
+    return Layout;
+}
+
+void CellLayoutCache::Build(CellLayout &Layout, const DBCore::ColumnInfo &Column, const DBCore::CellView &Cell, uint64_t FullLength, float WrapWidth) const
+{
+    char Buffer[64];
+    std::string_view Value = DBCore::FormatCell(Column, Cell, Buffer, sizeof(Buffer));
+    Layout.Null = Cell.Null;
+    
+    // Partly fetched values show their size and how they start; binary ones in hex.
+    std::string Placeholder;
+    if (FullLength)
+    {
+        char Size[32];
+        if (FullLength >= (1ull << 20))
+            snprintf(Size, sizeof(Size), "[%.1f MB] ", FullLength / (1024.0 * 1024.0));
+        else
+            snprintf(Size, sizeof(Size), "[%.1f KB] ", FullLength / 1024.0);
+        Placeholder = Size;
+        if (Column.Charset == 63)
+        {
+            static const char Digits[] = "0123456789ABCDEF";
+            for (size_t i = 0; i < Value.size() && i < 32; i++)
+            {
+                Placeholder += Digits[(uint8_t)Value[i] >> 4];
+                Placeholder += Digits[(uint8_t)Value[i] & 15];
+            }
+            Placeholder += "...";
+        }
+        else
+        {
+            Placeholder.append(Value.data(), Value.size());
+        }
+        Value = Placeholder;
+    }
+    
+    bool Truncated = Value.size() > MaxDisplayBytes;
+    if (Truncated)
+    {
+        // Back off to a UTF-8 lead byte so no code point is cut in half.
+        size_t Cut = MaxDisplayBytes;
+        while (Cut > 0 && (Value[Cut] & 0xC0) == 0x80)
+            Cut--;
+        Value = Value.substr(0, Cut);
+    }
+    Layout.Text.assign(Value.data(), Value.size());
+    
+    ImFont *CurrentFont = ImGui::GetFont();
+    const float Size = ImGui::GetFontSize();
+    const float Scale = Size / CurrentFont->FontSize;
+    
+    const char *Begin = Layout.Text.data();
+    const char *End = Begin + Layout.Text.size();
+    std::vector<uint32_t> Lines;
+    float Width = 0.0f;
+    
+    for (const char *Paragraph = Begin; Paragraph <= End && (int)Lines.size() / 2 < MaxDisplayLines; )
+    {
+        const char *ParagraphEnd = std::find(Paragraph, End, '\n');
+        const char *s = Paragraph;
+        do
+        {
+            const char *LineEnd = WrapWidth > 0.0f ? CurrentFont->CalcWordWrapPositionA(Scale, s, ParagraphEnd, WrapWidth) : ParagraphEnd;
+            if (LineEnd == s && s < ParagraphEnd)
+                LineEnd = s + 1;
+            
+            const char *TrimmedEnd = LineEnd;
+            while (TrimmedEnd > s && (TrimmedEnd[-1] == ' ' || TrimmedEnd[-1] == '\t' || TrimmedEnd[-1] == '\r'))
+                TrimmedEnd--;
+            
+            Width = std::max(Width, CurrentFont->CalcTextSizeA(Size, FLT_MAX, 0.0f, s, TrimmedEnd).x);
+            Lines.push_back((uint32_t)(s - Begin));
+            Lines.push_back((uint32_t)(TrimmedEnd - Begin));
+            
+            s = LineEnd;
+            while (s < ParagraphEnd && (*s == ' ' || *s == '\t'))
+                s++;
+        } while (s < ParagraphEnd && (int)Lines.size() / 2 < MaxDisplayLines);
+        
+        if (s < ParagraphEnd)
+            Truncated = true;
+        Paragraph = ParagraphEnd + 1;
+    }
+    if ((int)Lines.size() / 2 >= MaxDisplayLines && Lines.back() < Layout.Text.size())
+        Truncated = true;
+    
+    if (Truncated)
+    {
+        // Mark the cut on the last line shown.
+        Layout.Text.resize(Lines.back());
+        Layout.Text += "...";
+        Lines.back() = (uint32_t)Layout.Text.size();
+        Width = std::max(Width, CurrentFont->CalcTextSizeA(Size, FLT_MAX, 0.0f, Layout.Text.data() + Lines[Lines.size() - 2], Layout.Text.data() + Lines.back()).x);
+    }
+    
+    Layout.Size = ImVec2(Width, Size * (float)(Lines.size() / 2));
+    if (Lines.size() > 2)
+        Layout.Lines = std::move(Lines);
+    else
+        Layout.Lines.clear();
+}
+
+void CellLayoutCache::Draw(const CellLayout &Layout)
+{
+    ImDrawList *DrawList = ImGui::GetWindowDrawList();
+    const ImVec2 Position = ImGui::GetCursorScreenPos();
+    const ImU32 Color = ImGui::GetColorU32(Layout.Null ? ImGuiCol_TextDisabled : ImGuiCol_Text);
+    const float LineHeight = ImGui::GetFontSize();
+    const char *Text = Layout.Text.data();
+    
+    if (Layout.Lines.empty())
+    {
+        DrawList->AddText(Position, Color, Text, Text + Layout.Text.size());
+    }
+    else
+    {
+        for (size_t i = 0; i < Layout.Lines.size(); i += 2)
+            DrawList->AddText(ImVec2(Position.x, Position.y + LineHeight * (float)(i / 2)), Color,
+                              Text + Layout.Lines[i], Text + Layout.Lines[i + 1]);
+    }
+    ImGui::Dummy(Layout.Size);
+}
+
+float CellLayoutCache::ColumnWidthHint(const DBCore::ColumnInfo &Column)
+{
+    const float CharWidth = ImGui::CalcTextSize("0").x;
+    unsigned long Chars = Column.MaxLength ? Column.MaxLength : Column.Length;
+    Chars = std::clamp<unsigned long>(Chars, 4, 40);
+    
+    float Width = CharWidth * (float)Chars;
+    Width = std::max(Width, ImGui::CalcTextSize(Column.Name.c_str()).x + CharWidth * 2.0f);
+    return std::clamp(Width, 48.0f, 360.0f);
+}
@@ -0,0 +1,59 @@
+//
+//  CellLayoutCache.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "imgui.h"
+#include "ResultStore.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Display form and wrapped layout of one cell, measured once.
+struct CellLayout {
+    std::string Text;               // formatted and, if needed, truncated
+    std::vector<uint32_t> Lines;    // begin/end pairs into Text; empty for a single line
+    ImVec2 Size;
+    bool Null = false;
+};
+
+// Per-result cache of cell layouts so that steady-state grid frames only
+// emit glyphs instead of formatting, measuring and wrapping every visible
+// cell. Entries stay valid for the life of a result (cells never change
+// once fetched); a column's entries are dropped when its wrap width
+// changes, and everything is dropped on a font change or a new result.
+class CellLayoutCache {
+public:
+    static constexpr size_t MaxDisplayBytes = 512;
+    static constexpr int MaxDisplayLines = 8;
+    static constexpr size_t MaxCachedCells = 1u << 16;
+    
+    void Reset(size_t Columns);
+    // Drops everything when the current font or font size differs from the cached one.
+    void Validate();
+    
+    const CellLayout &Get(const DBCore::ResultStore &Result, uint64_t Row, size_t Column, float WrapWidth);
+    
+    // Draws a cached layout at the cursor and submits it as one item.
+    static void Draw(const CellLayout &Layout);
+    
+    // Initial width for a column: the longest value the server reported
+    // (MYSQL_FIELD::max_length) or else the declared length, within limits.
+    static float ColumnWidthHint(const DBCore::ColumnInfo &Column);
+    
+private:
+    // FullLength is set for cells that hold only a prefix of their value.
+    void Build(CellLayout &Layout, const DBCore::ColumnInfo &Column, const DBCore::CellView &Cell, uint64_t FullLength, float WrapWidth) const;
+    
+    std::vector<std::unordered_map<uint64_t, CellLayout>> Cells;
+    std::vector<float> WrapWidths;
+    size_t CachedCells = 0;
+    ImFont *Font = nullptr;
+    float FontSize = 0.0f;
+};
@@ -0,0 +1,174 @@
+//
+//  ColumnStatsPanel.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ColumnStatsPanel.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static std::string RawCellText(const DBCore::ColumnInfo &Column, const std::string &Raw)
+{
+    char Buffer[64];
+    DBCore::CellView Cell{ Raw.data(), (uint32_t)Raw.size(), false };
+    std::string Text(DBCore::FormatCell(Column, Cell, Buffer, sizeof(Buffer)));
+    if (Text.size() > 64)
+        Text = Text.substr(0, 61) + "...";
+    std::replace(Text.begin(), Text.end(), '\n', ' ');
+    return Text;
+}
+
+void ColumnStatsPanel::Refresh(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot)
+{
+    // A new result drops the old numbers and starts the collector over.
+    bool NewResult = Snapshot->ResultId != ResultId;
+    if (NewResult)
+    {
+        Worker.Cancel();
+        ResultId = Snapshot->ResultId;
+        SubmittedGeneration = 0;
+        FocusColumn = -1;
+        Stats.reset();
+    }
+    
+    {
+        std::lock_guard<std::mutex> Lock(StatsMutex);
+        if (PublishedStats && PublishedResult == ResultId)
+            Stats = std::move(PublishedStats);
+        PublishedStats.reset();
+    }
+    
+    // One update at a time; rows that arrive meanwhile are picked up by the next one.
+    if (Snapshot->Generation == SubmittedGeneration || (!NewResult && Worker.Running(UpdateJob)))
+        return;
+    
+    SubmittedGeneration = Snapshot->Generation;
+    const uint64_t Result = ResultId;
+    UpdateJob = Worker.Submit([this, Snapshot, Result, NewResult](const DBCore::CancelToken &Token) {
+        if (NewResult)
+            Collector.Reset();
+        Collector.Update(*Snapshot->Store, Snapshot->Complete(), [this, Result](std::shared_ptr<const DBCore::ResultStats> Update) {
+            std::lock_guard<std::mutex> Lock(StatsMutex);
+            PublishedResult = Result;
+            PublishedStats = std::move(Update);
+        }, &Token);
+    });
+}
+
+void ColumnStatsPanel::Draw(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot)
+{
+    if (!Snapshot || !Snapshot->Store)
+        return;
+    
+    Refresh(Snapshot);
+    const DBCore::ResultStore &Result = *Snapshot->Store;
+    if (!Stats || Stats->Columns.size() != Result.ColumnCount())
+    {
+        ImGui::TextDisabled("Computing statistics...");
+        return;
+    }
+    
+    if (Stats->Complete)
+        ImGui::TextDisabled("Statistics over %llu rows", (unsigned long long)Stats->Rows);
+    else
+        ImGui::TextDisabled("Statistics over the first %llu rows...", (unsigned long long)Stats->Rows);
+    
+    ImGuiTableFlags Flags = ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings |
+                            ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg;
+    const float DetailsHeight = ImGui::GetTextLineHeightWithSpacing() * 6.0f;
+    if (ImGui::BeginTable("ColumnStatsTable", 8, Flags, ImVec2(0, -DetailsHeight)))
+    {
+        ImGui::TableSetupScrollFreeze(1, 1);
+        ImGui::TableSetupColumn("Column");
+        ImGui::TableSetupColumn("Non-null");
+        ImGui::TableSetupColumn("Null %");
+        ImGui::TableSetupColumn("Distinct ~");
+        ImGui::TableSetupColumn("Min");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableSetupColumn("Mean");
+        ImGui::TableSetupColumn("Std dev");
+        ImGui::TableHeadersRow();
+        
+        ImGuiListClipper Clipper;
+        Clipper.Begin((int)Result.ColumnCount());
+        while (Clipper.Step())
+        {
+            for (int c = Clipper.DisplayStart; c < Clipper.DisplayEnd; c++)
+            {
+                const DBCore::ColumnInfo &Column = Result.Columns()[c];
+                const DBCore::ColumnStats &Values = Stats->Columns[c];
+                
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::PushID(c);
+                if (ImGui::Selectable(Column.Name.c_str(), FocusColumn == c, ImGuiSelectableFlags_SpanAllColumns))
+                    FocusColumn = c;
+                ImGui::PopID();
+                
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", (unsigned long long)Values.Count);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.1f", Values.NullFraction() * 100.0);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%llu", (unsigned long long)Values.DistinctEstimate);
+                if (Values.HasRange)
+                {
+                    ImGui::TableSetColumnIndex(4);
+                    ImGui::TextUnformatted(RawCellText(Column, Values.Min).c_str());
+                    ImGui::TableSetColumnIndex(5);
+                    ImGui::TextUnformatted(RawCellText(Column, Values.Max).c_str());
+                }
+                if (Values.Numeric && Values.Count)
+                {
+                    ImGui::TableSetColumnIndex(6);
+                    ImGui::Text("%.6g", Values.Mean);
+                    ImGui::TableSetColumnIndex(7);
+                    ImGui::Text("%.6g", Values.StandardDeviation());
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+    
+    DrawDetails(Result, *Stats);
+}
+
+void ColumnStatsPanel::DrawDetails(const DBCore::ResultStore &Result, const DBCore::ResultStats &Stats)
+{
+    if (FocusColumn < 0 || FocusColumn >= (int)Result.ColumnCount())
+    {
+        ImGui::TextDisabled("Select a column to see its most frequent values and histogram");
+        return;
+    }
+    
+    const DBCore::ColumnInfo &Column = Result.Columns()[FocusColumn];
+    const DBCore::ColumnStats &Values = Stats.Columns[FocusColumn];
+    const float Height = ImGui::GetContentRegionAvail().y;
+    
+    ImGui::BeginChild("TopValues", ImVec2(ImGui::GetContentRegionAvail().x * 0.4f, Height));
+    ImGui::TextDisabled("Most frequent in %s%s", Column.Name.c_str(), Values.TopExact ? "" : " (at least)");
+    for (const auto &[Raw, Count] : Values.TopValues)
+        ImGui::Text("%8llu  %s", (unsigned long long)Count, RawCellText(Column, Raw).c_str());
+    if (Values.TopValues.empty())
+        ImGui::TextDisabled("No value repeats often enough to stand out");
+    ImGui::EndChild();
+    
+    ImGui::SameLine();
+    ImGui::BeginChild("Histogram", ImVec2(0, Height));
+    if (!Values.Histogram.empty())
+    {
+        std::vector<float> Bins(Values.Histogram.begin(), Values.Histogram.end());
+        char Label[96];
+        snprintf(Label, sizeof(Label), "%.6g .. %.6g", Values.HistogramLow, Values.HistogramHigh);
+        ImGui::PlotHistogram("##Histogram", Bins.data(), (int)Bins.size(), 0, Label, 0.0f, FLT_MAX, ImGui::GetContentRegionAvail());
+    }
+    else if (Values.Numeric)
+    {
+        ImGui::TextDisabled("The histogram is built once all rows are fetched");
+    }
+    ImGui::EndChild();
+}
@@ -0,0 +1,48 @@
+//
+//  ColumnStatsPanel.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "imgui.h"
+#include "ResultSnapshot.hpp"
+#include "ColumnStats.hpp"
+#include "QueryWorker.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Per-column statistics of the shown result, kept up to date on a
+// background thread while rows stream in: one row per column with counts,
+// range, mean and distinct estimate, and the most frequent values and the
+// histogram of the focused column below it.
+class ColumnStatsPanel {
+public:
+    void Draw(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot);
+    
+    // Column whose value counts and histogram are shown.
+    void Focus(int Column) { FocusColumn = Column; }
+    
+private:
+    void Refresh(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot);
+    void DrawDetails(const DBCore::ResultStore &Result, const DBCore::ResultStats &Stats);
+    
+    uint64_t ResultId = 0;
+    uint64_t SubmittedGeneration = 0;
+    uint64_t UpdateJob = 0;
+    int FocusColumn = -1;
+    std::shared_ptr<const DBCore::ResultStats> Stats;
+    
+    std::mutex StatsMutex;
+    uint64_t PublishedResult = 0;
+    std::shared_ptr<const DBCore::ResultStats> PublishedStats;
+    
+    // Only used by jobs on Worker, which run one at a time.
+    DBCore::ColumnStatsCollector Collector;
+    // Last member, so its thread is joined before the state it writes goes away.
+    DBCore::QueryWorker Worker;
+};
@@ -16,11 +16,24 @@
 #include "Fonts.h"
 #include "CTextEditor.h"
 #include "DBGUI.hpp"
+#include "QueryFetcher.hpp"
+#include "StatementFetcher.hpp"
+#include "QueryWorker.hpp"
+#include "ResultExport.hpp"
+#include "ArrowExport.hpp"
+#include "BulkLoader.hpp"
+#include "ResultCache.hpp"
+#include "BlobSource.hpp"
+#include "ConnectionPool.hpp"
+#include "ResultGrid.hpp"
 
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <string>
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -44,14 +57,93 @@ public:
 
     char ConnectionStatus[256];
     
-    std::mutex QueryMutex;
     std::atomic_bool QueryInProgress;
     std::atomic_bool QueryFinished;
-    std::vector<std::string> QueryColumns;
-    std::vector<std::vector<std::string>> QueryRows;
+    bool UseBinaryProtocol;
+    bool UseResultCache;
+    int  ResultMemoryBudgetMB;
+    // One entry per result of the last run; scripts can return several.
+    DBCore::ResultSetList QueryResults;
+    
+    int  ExportFormatIndex;
+    bool ExportGzip;
+    std::atomic_bool ExportInProgress;
+    DBCore::ExportProgress ExportCounters;
+    
+    // Bulk load target, "table" or "database.table".
+    char BulkTableBuffer[128];
+    int  BulkFormatIndex;       // CSV, TSV
+    int  BulkCommitEvery;       // batches per transaction
+    std::atomic_bool BulkInProgress;
+    DBCore::BulkProgress BulkCounters;
     
-    MariaDBClient *Client;
     std::atomic_bool IsConnected;
+    // Idle connections the pool keeps ready; applies on the next connect.
+    int  WarmConnections;
+    
+    // BLOB/TEXT cells are fetched up to this many bytes; the inspector reads the rest.
+    static constexpr uint32_t CellPrefixBytes = 4096;
+    
+    // Source for the inspector; values the result holds only part of are read
+    // back over pooled connections, so paging never waits on a running query.
+    std::shared_ptr<DBCore::BlobSource> OpenBlob(std::shared_ptr<const DBCore::ResultStore> Store, uint64_t Row, size_t Column, std::string *Error) {
+        return DBCore::OpenBlob(std::move(Store), Row, Column, [this](std::string *ConnectError) -> std::shared_ptr<DBCore::PooledConnection> {
+            std::shared_ptr<DBCore::ConnectionPool> Connections = CurrentPool();
+            if (!Connections) {
+                if (ConnectError)
+                    *ConnectError = "Not connected to database.";
+                return nullptr;
+            }
+            return Connections->Acquire(ConnectError);
+        }, Error);
+    }
+    
+    // "3 connections, 2 idle", or empty when not connected.
+    std::string PoolStatusText() {
+        std::shared_ptr<DBCore::ConnectionPool> Connections = CurrentPool();
+        if (!Connections || !IsConnected.load())
+            return std::string();
+        char Text[64];
+        snprintf(Text, sizeof(Text), "%zu connections, %zu idle", Connections->OpenCount(), Connections->IdleCount());
+        return Text;
+    }
+    
+    // "Statements: 12 hits, 3 prepared, 0 evicted", or empty before the first prepare.
+    std::string StatementCacheText() {
+        std::shared_ptr<DBCore::ConnectionPool> Connections = CurrentPool();
+        if (!Connections || !IsConnected.load())
+            return std::string();
+        const DBCore::StatementCounters &Counters = Connections->Counters().Statements;
+        unsigned long long Hits = Counters.Hits.load(), Misses = Counters.Misses.load();
+        if (Hits + Misses == 0)
+            return std::string();
+        char Text[128];
+        snprintf(Text, sizeof(Text), "Statements: %llu hits, %llu prepared, %llu evicted, %llu re-prepared", Hits, Misses,
+                 (unsigned long long)Counters.Evictions.load(), (unsigned long long)Counters.Invalidations.load());
+        return Text;
+    }
+    
+    DBCore::ResultCache Cache;
+    // Unix time the shown result was cached at, 0 when it came from the server.
+    std::atomic<int64_t> CachedResultCreated;
+    
+    // "Served from cache (5 min)", or empty for results fetched from the server.
+    std::string CacheStatusText() const {
+        int64_t Created = CachedResultCreated.load();
+        if (Created == 0)
+            return std::string();
+        int64_t Age = std::max<int64_t>(0, (int64_t)time(nullptr) - Created);
+        char Text[64];
+        if (Age < 60)
+            snprintf(Text, sizeof(Text), "Served from cache (%lld s)", (long long)Age);
+        else if (Age < 3600)
+            snprintf(Text, sizeof(Text), "Served from cache (%lld min)", (long long)(Age / 60));
+        else if (Age < 86400)
+            snprintf(Text, sizeof(Text), "Served from cache (%lld h)", (long long)(Age / 3600));
+        else
+            snprintf(Text, sizeof(Text), "Served from cache (%lld d)", (long long)(Age / 86400));
+        return Text;
+    }
     
     void ConnectToDatabase() {
         if (IsConnected.load()) {
@@ -75,41 +167,37 @@ public:
         OldDatabase = DatabaseBuffer;
         OldPort = PortBuffer;
         
+        DBCore::ConnectionEndpoint Endpoint;
+        Endpoint.Host     = OldHost;
+        Endpoint.User     = OldUsername;
+        Endpoint.Password = PasswordBuffer;
+        Endpoint.Database = OldDatabase;
+        Endpoint.Port     = (unsigned)atoi(OldPort.c_str());
+        DBCore::PoolOptions Options;
+        Options.WarmConnections = (size_t)std::max(WarmConnections, 0);
+        
+        // The pool starts warming right away; the editor's session is the first lease.
+        DropConnections();
+        {
+            std::lock_guard<std::mutex> Lock(ConnectionMutex);
+            Pool = DBCore::ConnectionPool::Create(Endpoint, Options);
+        }
+        
         snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Connecting to the database...");
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            @autoreleasepool {
-                NSError *Error = nil;
-                NSString *Host     = [NSString stringWithUTF8String: HostBuffer];
-                NSString *Username = [NSString stringWithUTF8String: UsernameBuffer];
-                NSString *Password = [NSString stringWithUTF8String: PasswordBuffer];
-                NSString *Database = [NSString stringWithUTF8String: DatabaseBuffer];
-                NSUInteger Port    = (NSUInteger)atoi(PortBuffer);
-                
-                if (!IsConnected.load()) {
-                    if (!Client) {
-                        Client = [[MariaDBClient alloc] init];
-                    }
-                    BOOL Connected = [Client connect:Host
-                                            username:Username
-                                            password:Password
-                                            database:Database
-                                                port:Port
-                                               error:&Error];
-                    IsConnected.store(Connected);
-                    if (Connected) {
-                        snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Connected successfully!");
-                    } else {
-                        snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Connect error: %s", Error ? [[Error localizedDescription] UTF8String] : "Unknown");
-                    }
-                }
+            std::string ErrStr;
+            bool Connected = SessionConnection(&ErrStr) != nullptr;
+            IsConnected.store(Connected);
+            if (Connected) {
+                snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Connected successfully!");
+            } else {
+                snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Connect error: %s", ErrStr.c_str());
             }
         });
     }
     
     void DisconnectFromDatabase() {
-        if (Client != nil) {
-            Client = nil;
-        }
+        DropConnections();
         IsConnected.store(false);
         snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Disconnected from database.");
     }
@@ -117,8 +205,161 @@ public:
     void ExecuteSqlQueryAsync(NSString *SqlQuery) {
         QueryInProgress.store(true);
         QueryFinished.store(false);
-        std::thread QueryThread(&DBManager::ExecuteQueryThread, this, SqlQuery);
-        QueryThread.detach();
+        CachedResultCreated.store(0);
+        bool BinaryProtocol = UseBinaryProtocol;
+        bool CacheResult = UseResultCache;
+        CurrentQueryJob.store(Worker.Submit([this, SqlQuery, BinaryProtocol, CacheResult](const DBCore::CancelToken &Token) {
+            ExecuteQueryThread(SqlQuery, BinaryProtocol, CacheResult, Token);
+        }));
+    }
+    
+    // Formats after the text ones in the export combo are Arrow IPC layouts.
+    static constexpr int ArrowFormatIndex = 3;
+    
+    bool ExportArrow() const { return ExportFormatIndex >= ArrowFormatIndex; }
+    
+    DBCore::ArrowOptions CurrentArrowOptions() const {
+        DBCore::ArrowOptions Options;
+        Options.Layout = ExportFormatIndex == ArrowFormatIndex ? DBCore::ArrowLayout::Stream : DBCore::ArrowLayout::File;
+        return Options;
+    }
+    
+    std::string CurrentExportExtension() const {
+        return ExportArrow() ? DBCore::ArrowExporter::FileExtension(CurrentArrowOptions())
+                             : DBCore::ResultExporter::FileExtension(CurrentExportOptions());
+    }
+    
+    DBCore::ExportOptions CurrentExportOptions() const {
+        DBCore::ExportOptions Options;
+        Options.Format      = (DBCore::ExportFormat)ExportFormatIndex;
+        Options.Compression = ExportGzip ? DBCore::ExportCompression::Gzip : DBCore::ExportCompression::None;
+        return Options;
+    }
+    
+    std::string ExportStatusText() {
+        std::lock_guard<std::mutex> Lock(ExportMutex);
+        return ExportStatus;
+    }
+    
+    double ExportSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - ExportStarted).count();
+    }
+    
+    // Writes a complete fetched result to Path off the UI thread.
+    void ExportResultAsync(std::shared_ptr<const DBCore::ResultStore> Store, std::string Path, DBCore::ExportOptions Options) {
+        BeginExport();
+        ExportWorker.Submit([this, Store, Path, Options](const DBCore::CancelToken &Token) {
+            std::string ErrStr;
+            bool Succeeded = DBCore::ResultExporter::ExportStore(*Store, Path, Options, &ExportCounters, &Token, &ErrStr);
+            EndExport(Path, Succeeded, ErrStr);
+        });
+    }
+    
+    void ExportArrowAsync(std::shared_ptr<const DBCore::ResultStore> Store, std::string Path, DBCore::ArrowOptions Options) {
+        BeginExport();
+        ExportWorker.Submit([this, Store, Path, Options](const DBCore::CancelToken &Token) {
+            std::string ErrStr;
+            bool Succeeded = DBCore::ArrowExporter::WriteIpc(*Store, Path, Options, &ExportCounters, &Token, &ErrStr);
+            EndExport(Path, Succeeded, ErrStr);
+        });
+    }
+    
+    // Runs the query on the query connection and streams its rows straight
+    // into the file, so results far larger than memory can be exported.
+    void ExportQueryAsync(NSString *SqlQuery, std::string Path, DBCore::ExportOptions Options) {
+        BeginExport();
+        QueryInProgress.store(true);
+        QueryFinished.store(false);
+        bool BinaryProtocol = UseBinaryProtocol;
+        CurrentQueryJob.store(Worker.Submit([this, SqlQuery, Path, Options, BinaryProtocol](const DBCore::CancelToken &Token) {
+            ExportQueryThread(SqlQuery, Path, Options, BinaryProtocol, Token);
+        }));
+    }
+    
+    std::string BulkStatusText() {
+        std::lock_guard<std::mutex> Lock(BulkMutex);
+        return BulkStatus;
+    }
+    
+    double BulkSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - BulkStarted).count();
+    }
+    
+    // Streams a CSV or TSV file into the table in BulkTableBuffer over a
+    // connection of its own, so the editor stays usable during the load.
+    void BulkLoadAsync(std::string Path) {
+        DBCore::BulkOptions Options;
+        std::string Target = BulkTableBuffer;
+        size_t Dot = Target.find('.');
+        if (Dot != std::string::npos) {
+            Options.Database = Target.substr(0, Dot);
+            Options.Table    = Target.substr(Dot + 1);
+        } else {
+            Options.Table = Target;
+        }
+        Options.CommitEvery = (unsigned)std::max(BulkCommitEvery, 0);
+        DBCore::ExportFormat Format = BulkFormatIndex == 1 ? DBCore::ExportFormat::Tsv : DBCore::ExportFormat::Csv;
+        
+        BeginBulk();
+        BulkWorker.Submit([this, Path, Options, Format](const DBCore::CancelToken &Token) mutable {
+            std::string ErrStr = "Not connected to database.";
+            bool Succeeded = false;
+            Options.Cancel = &Token;
+            
+            std::shared_ptr<DBCore::ConnectionPool> Connections = CurrentPool();
+            std::shared_ptr<DBCore::PooledConnection> Connection = Connections ? Connections->Acquire(&ErrStr, &Token) : nullptr;
+            std::unique_ptr<DBCore::DelimitedSource> Source = Connection ? DBCore::DelimitedSource::Open(Path, Format, &ErrStr) : nullptr;
+            if (Source) {
+                DBCore::BulkLoader Loader(Options, &BulkCounters);
+                Succeeded = Loader.Run(Connection->Handle(), *Source, &ErrStr);
+                if (!Succeeded && DBCore::IsConnectionLost(Connection->Handle())) {
+                    Connection->Discard();
+                }
+            }
+            EndBulk(BulkTarget(Options), Succeeded, ErrStr);
+        });
+    }
+    
+    void CancelBulkLoad() {
+        BulkWorker.Cancel();
+    }
+    
+    // Stops the fetch on the client side, asks the server to KILL QUERY over a
+    // side connection and, if the fetch still has not unwound after a grace
+    // period, shuts the socket down so the worker is free again.
+    void CancelQuery() {
+        if (!QueryInProgress.load())
+            return;
+        
+        uint64_t JobId = CurrentQueryJob.load();
+        std::shared_ptr<DBCore::PooledConnection> Target;
+        std::shared_ptr<DBCore::ConnectionPool> Connections;
+        {
+            std::lock_guard<std::mutex> Lock(ConnectionMutex);
+            Target = Session;
+            Connections = Pool;
+        }
+        unsigned long ThreadId = Target ? Target->ThreadId() : 0;
+        Worker.Cancel();
+        snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Cancelling query...");
+        
+        // The side connection comes warm from the pool, so the KILL goes out without a handshake.
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            std::string ErrStr = "no connection";
+            std::shared_ptr<DBCore::PooledConnection> Side = Connections && ThreadId ? Connections->Acquire(&ErrStr) : nullptr;
+            std::string Kill = "KILL QUERY " + std::to_string(ThreadId);
+            if (!Side || mysql_real_query(Side->Handle(), Kill.data(), (unsigned long)Kill.size()) != 0)
+                NSLog(@"KILL QUERY failed: %s", Side ? mysql_error(Side->Handle()) : ErrStr.c_str());
+        });
+        
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(CancelGracePeriod * NSEC_PER_SEC)),
+                       dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            if (Worker.Running(JobId) && Target) {
+                // The socket is unusable afterwards; the next run takes a warm one from the pool.
+                Target->Discard();
+                mariadb_cancel(Target->Handle());
+            }
+        });
     }
     
 private:
@@ -130,6 +371,78 @@ private:
     std::string OldDatabase;
     std::string OldPort;
     
+    std::mutex ConnectionMutex;
+    // Warm connections to the connected endpoint; replaced when it changes.
+    std::shared_ptr<DBCore::ConnectionPool> Pool;
+    // The editor's connection. Kept across runs rather than handed back and
+    // reset, so USE, SET and open transactions carry over as in a console.
+    std::shared_ptr<DBCore::PooledConnection> Session;
+    
+    std::shared_ptr<DBCore::ConnectionPool> CurrentPool() {
+        std::lock_guard<std::mutex> Lock(ConnectionMutex);
+        return Pool;
+    }
+    
+    // The editor's connection, borrowing a warm one from the pool when there
+    // is none yet or the last one was cut off.
+    std::shared_ptr<DBCore::PooledConnection> SessionConnection(std::string *Error) {
+        std::shared_ptr<DBCore::ConnectionPool> Connections;
+        {
+            std::lock_guard<std::mutex> Lock(ConnectionMutex);
+            if (Session && !Session->Discarded())
+                return Session;
+            Session.reset();
+            Connections = Pool;
+        }
+        if (!Connections) {
+            if (Error)
+                *Error = "Not connected to database.";
+            return nullptr;
+        }
+        
+        std::shared_ptr<DBCore::PooledConnection> Lease = Connections->Acquire(Error);
+        std::lock_guard<std::mutex> Lock(ConnectionMutex);
+        if (Lease && Connections == Pool && !Session)
+            Session = Lease;
+        return Lease;
+    }
+    
+    // Closing a pool joins its maintainer, which may be in the middle of a
+    // handshake, so the last references are dropped off the main thread.
+    void DropConnections() {
+        std::shared_ptr<DBCore::ConnectionPool> OldPool;
+        std::shared_ptr<DBCore::PooledConnection> OldSession;
+        {
+            std::lock_guard<std::mutex> Lock(ConnectionMutex);
+            OldPool.swap(Pool);
+            OldSession.swap(Session);
+        }
+        if (!OldPool && !OldSession)
+            return;
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+            // The block's copies are the last references; they go away with it.
+            (void)OldPool;
+            (void)OldSession;
+        });
+    }
+    
+    static constexpr double CancelGracePeriod = 3.0;
+    std::atomic<uint64_t> CurrentQueryJob;
+    DBCore::QueryWorker Worker;
+    
+    std::mutex ExportMutex;
+    std::string ExportStatus;
+    std::chrono::steady_clock::time_point ExportStarted;
+    // Declared after the export state, so its thread is joined before that goes away.
+    DBCore::QueryWorker ExportWorker;
+    
+    std::mutex BulkMutex;
+    std::string BulkStatus;
+    std::chrono::steady_clock::time_point BulkStarted;
+    DBCore::QueryWorker BulkWorker;
+    // Writes fetched results to the cache without holding up the next query.
+    DBCore::QueryWorker CacheWorker;
+    
     DBManager()
     {
         LoadOnce();
@@ -142,70 +455,256 @@ private:
         
         ConnectionStatus[0] = '\0';
         
-        Client = nil;
-        
         IsConnected.store(false);
+        WarmConnections = 2;
         QueryInProgress.store(false);
         QueryFinished.store(false);
+        UseBinaryProtocol = true;
+        UseResultCache = false;
+        ResultMemoryBudgetMB = 2048;
+        CurrentQueryJob.store(0);
+        
+        ExportFormatIndex = 0;
+        ExportGzip = false;
+        ExportInProgress.store(false);
+        
+        BulkTableBuffer[0] = '\0';
+        BulkFormatIndex = 0;
+        BulkCommitEvery = 4;
+        BulkInProgress.store(false);
+        
+        DBCore::CacheOptions CacheSettings;
+        NSString *Caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+        if (Caches)
+            CacheSettings.Directory = [[Caches stringByAppendingPathComponent:@"DBGui/Results"] fileSystemRepresentation];
+        Cache.SetOptions(CacheSettings);
+        CachedResultCreated.store(0);
+    }
+    
+    void BeginExport() {
+        ExportCounters.Rows.store(0);
+        ExportCounters.Bytes.store(0);
+        ExportStarted = std::chrono::steady_clock::now();
+        ExportInProgress.store(true);
+    }
+    
+    void EndExport(const std::string &Path, bool Succeeded, const std::string &ErrStr) {
+        char Status[512];
+        if (Succeeded)
+            snprintf(Status, sizeof(Status), "Exported %llu rows (%.1f MB) to %s in %.2f s",
+                     (unsigned long long)ExportCounters.Rows.load(), ExportCounters.Bytes.load() / (1024.0 * 1024.0),
+                     Path.c_str(), ExportSeconds());
+        else
+            snprintf(Status, sizeof(Status), "Export failed: %s", ErrStr.c_str());
+        {
+            std::lock_guard<std::mutex> Lock(ExportMutex);
+            ExportStatus = Status;
+        }
+        ExportInProgress.store(false);
+    }
+    
+    static std::string BulkTarget(const DBCore::BulkOptions &Options) {
+        return Options.Database.empty() ? Options.Table : Options.Database + "." + Options.Table;
+    }
+    
+    void BeginBulk() {
+        BulkCounters.Rows.store(0);
+        BulkCounters.Committed.store(0);
+        BulkCounters.Bytes.store(0);
+        BulkCounters.Batches.store(0);
+        BulkStarted = std::chrono::steady_clock::now();
+        BulkInProgress.store(true);
+    }
+    
+    void EndBulk(const std::string &Table, bool Succeeded, const std::string &ErrStr) {
+        char Status[512];
+        double Seconds = BulkSeconds();
+        unsigned long long Committed = BulkCounters.Committed.load();
+        if (Succeeded)
+            snprintf(Status, sizeof(Status), "Loaded %llu rows into %s in %.2f s (%.0f rows/s)",
+                     Committed, Table.c_str(), Seconds, Seconds > 0 ? Committed / Seconds : 0.0);
+        else
+            snprintf(Status, sizeof(Status), "Load failed after %llu committed rows: %s", Committed, ErrStr.c_str());
+        {
+            std::lock_guard<std::mutex> Lock(BulkMutex);
+            BulkStatus = Status;
+        }
+        BulkInProgress.store(false);
     }
     
-    void ExecuteQueryThread(NSString *SqlQuery) {
+    void ExportQueryThread(NSString *SqlQuery, std::string Path, DBCore::ExportOptions ExportOptions, bool BinaryProtocol, const DBCore::CancelToken &Token) {
         @autoreleasepool {
-            NSError *Error = nil;
-            NSString *Host     = [NSString stringWithUTF8String: HostBuffer];
-            NSString *Username = [NSString stringWithUTF8String: UsernameBuffer];
-            NSString *Password = [NSString stringWithUTF8String: PasswordBuffer];
-            NSString *Database = [NSString stringWithUTF8String: DatabaseBuffer];
-            NSUInteger Port    = (NSUInteger)atoi(PortBuffer);
+            std::string Sql = [SqlQuery UTF8String];
+            std::string ErrStr;
+            bool Succeeded = false;
+            bool Prepared = false;
             
-            if (!IsConnected.load()) {
-                if (!Client) {
-                    Client = [[MariaDBClient alloc] init];
+            // The editor's session, held for the whole fetch as in ExecuteQueryThread.
+            std::shared_ptr<DBCore::PooledConnection> Connection = SessionConnection(&ErrStr);
+            
+            DBCore::ResultExporter Exporter(ExportOptions, &ExportCounters);
+            if (Connection && Exporter.Open(Path, &ErrStr)) {
+                bool Begun = false;
+                bool WriteFailed = false;
+                
+                // Blocks go to the exporter instead of a result; the local
+                // publisher only ever holds the header and the row count.
+                DBCore::ResultPublisher ExportResults;
+                DBCore::StreamOptions Options;
+                Options.Cancel    = &Token;
+                Options.BlockSink = [&](const std::vector<DBCore::ColumnInfo> &Columns, std::shared_ptr<const DBCore::ResultBlock> Block) {
+                    if (!Begun) {
+                        Exporter.Begin(Columns);
+                        Begun = true;
+                    }
+                    if (!WriteFailed && !Exporter.Write(std::move(Block))) {
+                        WriteFailed = true;
+                        Worker.Cancel();
+                    }
+                };
+                
+                if (BinaryProtocol && DBCore::StatementFetcher::IsSelect(Sql)) {
+                    Succeeded = DBCore::StatementFetcher::Execute(Connection->Statements(), Connection->Handle(), Sql, ExportResults, &ErrStr, &Prepared, Options);
+                }
+                if (!Prepared) {
+                    Succeeded = DBCore::QueryFetcher::Execute(Connection->Handle(), Sql, ExportResults, &ErrStr, Options);
+                }
+                if (!Succeeded && DBCore::IsConnectionLost(Connection->Handle())) {
+                    Connection->Discard();
                 }
-                BOOL Connected = [Client connect:Host
-                                        username:Username
-                                        password:Password
-                                        database:Database
-                                            port:Port
-                                           error:&Error];
                 
-                IsConnected.store(Connected);
-                if (!Connected) {
-                    NSLog(@"Connection failed: %@", [Error localizedDescription]);
+                // No block arrived: either an empty result set, which still gets
+                // its header, or a statement that returned no rows at all.
+                std::shared_ptr<const DBCore::ResultSnapshot> Final = ExportResults.Acquire();
+                if (Succeeded && !Token.Cancelled() && !Begun && Final && Final->Store) {
+                    if (Final->Store->RowCount() == 0) {
+                        Exporter.Begin(Final->Store->Columns());
+                    } else {
+                        Succeeded = false;
+                        ErrStr = "The statement did not return a result set.";
+                    }
+                }
+                
+                if (WriteFailed) {
+                    Succeeded = Exporter.Finish(&ErrStr);
+                } else if (Succeeded && !Token.Cancelled()) {
+                    Succeeded = Exporter.Finish(&ErrStr);
+                } else {
+                    Exporter.Abort();
+                    if (Token.Cancelled()) {
+                        Succeeded = false;
+                        ErrStr = "Export cancelled.";
+                    }
                 }
             }
             
-            MariaDBResultSet *ResultSet = [Client executeQuery:SqlQuery error:&Error];
-            std::vector<std::vector<std::string>> Rows;
-            std::vector<std::string> Columns;
+            EndExport(Path, Succeeded, ErrStr);
+            QueryFinished.store(true);
+            QueryInProgress.store(false);
+        }
+    }
+    
+    void ExecuteQueryThread(NSString *SqlQuery, bool BinaryProtocol, bool CacheResult, const DBCore::CancelToken &Token) {
+        @autoreleasepool {
+            std::string Sql = [SqlQuery UTF8String];
+            std::string ErrStr;
+            bool Succeeded = false;
+            bool Prepared = false;
             
-            if (ResultSet != nil) {
-                NSArray *ColNames = ResultSet.columnNames;
-                for (NSString *Col in ColNames) {
-                    Columns.push_back(std::string([Col UTF8String]));
-                }
+            // Held for the whole fetch, so Disconnect cannot close it underneath.
+            std::shared_ptr<DBCore::PooledConnection> Connection = SessionConnection(&ErrStr);
+            
+            DBCore::StreamOptions Options;
+            Options.Cancel          = &Token;
+            Options.MemoryBudget    = (size_t)ResultMemoryBudgetMB << 20;
+            Options.SpillDirectory  = [NSTemporaryDirectory() fileSystemRepresentation];
+            Options.CellPrefixBytes = CellPrefixBytes;
+            
+            QueryResults.Clear();
+            bool Script = DBCore::QueryFetcher::CountStatements(Sql) > 1;
+            
+            // Only single SELECTs are cached; anything else always goes to the server.
+            // The key is taken before the fetch from the session itself: the
+            // form fields may have been edited since connecting, and USE moves
+            // the session to another schema than the one it logged in to.
+            DBCore::CacheKey Key;
+            CacheResult = CacheResult && Connection && !Script && DBCore::StatementFetcher::IsSelect(Sql);
+            if (CacheResult) {
+                const DBCore::ConnectionEndpoint &Endpoint = Connection->Endpoint();
+                const char *Schema = Connection->Handle()->db;
+                Key.Host        = Endpoint.Host + ":" + std::to_string(Endpoint.Port);
+                Key.Database    = Schema ? Schema : "";
+                Key.User        = Endpoint.User;
+                Key.Fingerprint = DBCore::NormalizeQuery(Sql);
                 
-                while ([ResultSet next:&Error]) {
-                    std::vector<std::string> Row;
-                    for (NSUInteger i = 0; i < ColNames.count; i++) {
-                        id Obj = [ResultSet objectForColumnIndex:i];
-                        NSString *Str = (Obj == [NSNull null]) ? @"NULL" : [Obj description];
-                        Row.push_back(std::string([Str UTF8String]));
-                    }
-                    Rows.push_back(Row);
+                std::chrono::system_clock::time_point Created;
+                if (auto Cached = Cache.Lookup(Key, &Created, &ErrStr)) {
+                    DBCore::StreamStats Stats;
+                    Stats.Rows     = Cached->RowCount();
+                    Stats.Bytes    = Cached->ByteSize();
+                    Stats.Streamed = true;
+                    QueryResults.Add()->Publish(Cached, Stats);
+                    DBCore::ResultSummary Summary;
+                    Summary.HasRows = true;
+                    QueryResults.Summarize(Summary);
+                    CachedResultCreated.store(std::chrono::duration_cast<std::chrono::seconds>(Created.time_since_epoch()).count());
+                    QueryFinished.store(true);
+                    QueryInProgress.store(false);
+                    return;
                 }
-            } else {
-                Columns.push_back("Error");
-                std::string ErrStr = Error ? std::string([[Error localizedDescription] UTF8String]) : "Unknown error";
-                Rows.push_back({ ErrStr });
+                if (!ErrStr.empty())
+                    NSLog(@"Result cache lookup failed: %s", ErrStr.c_str());
+                ErrStr.clear();
             }
             
-            {
-                std::lock_guard<std::mutex> Lock(QueryMutex);
-                QueryColumns = Columns;
-                QueryRows = Rows;
-                QueryFinished.store(true);
+            // Single SELECTs go through the binary protocol when possible; anything
+            // the server will not prepare, and every script, runs as text protocol
+            // with all of its results read in one round trip.
+            if (Connection && BinaryProtocol && !Script && DBCore::StatementFetcher::IsSelect(Sql)) {
+                auto Started = std::chrono::steady_clock::now();
+                Succeeded = DBCore::StatementFetcher::Execute(Connection->Statements(), Connection->Handle(), Sql, *QueryResults.Add(), &ErrStr, &Prepared, Options);
+                if (Prepared && Succeeded) {
+                    DBCore::ResultSummary Summary;
+                    Summary.HasRows = true;
+                    Summary.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Started).count();
+                    QueryResults.Summarize(Summary);
+                }
+                if (!Prepared || !Succeeded) {
+                    QueryResults.Clear();
+                }
+            }
+            if (Connection && !Prepared) {
+                Succeeded = DBCore::QueryFetcher::ExecuteScript(Connection->Handle(), Sql, QueryResults, &ErrStr, Options);
+            }
+            // A connection the server dropped is replaced by a warm one on the next run.
+            if (!Succeeded && Connection && DBCore::IsConnectionLost(Connection->Handle())) {
+                Connection->Discard();
+            }
+            if (!Succeeded) {
+                bool Cancelled = Token.Cancelled();
+                QueryResults.Add()->Publish(Cancelled ? DBCore::ResultStore::FromMessage("Result", "Query cancelled.")
+                                                      : DBCore::ResultStore::FromMessage("Error", ErrStr));
+                DBCore::ResultSummary Summary;
+                Summary.Failed = !Cancelled;
+                QueryResults.Summarize(Summary);
             }
+            if (Token.Cancelled()) {
+                snprintf(ConnectionStatus, sizeof(ConnectionStatus), "Query cancelled.");
+            }
+            
+            // The store is immutable, so the write can run while the grid reads it.
+            auto Final = QueryResults.Count() == 1 ? QueryResults.Publisher(0)->Acquire() : nullptr;
+            if (CacheResult && Succeeded && !Token.Cancelled() && Final && Final->Stats.Streamed && Final->Stats.Complete &&
+                Final->Store->PartialCells() == 0) {
+                std::shared_ptr<const DBCore::ResultStore> Store = Final->Store;
+                CacheWorker.Submit([this, Key, Store](const DBCore::CancelToken &) {
+                    std::string CacheError;
+                    if (!Cache.Insert(Key, *Store, &CacheError))
+                        NSLog(@"Result cache write failed: %s", CacheError.c_str());
+                });
+            }
+            
+            QueryFinished.store(true);
             QueryInProgress.store(false);
         }
     }
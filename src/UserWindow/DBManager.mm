@@ -7,8 +7,10 @@
 
 
 #include "DBManager.h"
+#include "BlobInspector.hpp"
 
 #import <Foundation/Foundation.h>
+#import <AppKit/AppKit.h>
 #import <Metal/Metal.h>
 #import <MetalKit/MetalKit.h>
 #import <CoreImage/CoreImage.h>
@@ -144,6 +146,30 @@ void DBManager::LoadOnce() {
     style.Colors[ImGuiCol_Separator] = style.Colors[ImGuiCol_Border];
 }
 
+static bool ChooseExportPath(const std::string &Extension, std::string &Path)
+{
+    NSSavePanel *Panel = [NSSavePanel savePanel];
+    std::string Name = "result" + Extension;
+    Panel.nameFieldStringValue = [NSString stringWithUTF8String: Name.c_str()];
+    Panel.canCreateDirectories = YES;
+    if ([Panel runModal] != NSModalResponseOK || !Panel.URL)
+        return false;
+    Path = Panel.URL.fileSystemRepresentation;
+    return true;
+}
+
+static bool ChooseImportPath(std::string &Path)
+{
+    NSOpenPanel *Panel = [NSOpenPanel openPanel];
+    Panel.canChooseFiles = YES;
+    Panel.canChooseDirectories = NO;
+    Panel.allowsMultipleSelection = NO;
+    if ([Panel runModal] != NSModalResponseOK || !Panel.URL)
+        return false;
+    Path = Panel.URL.fileSystemRepresentation;
+    return true;
+}
+
 ImTextureID menuLogo = 0;
 
 #define IMAGE_URL @"https://raw.githubusercontent.com/OPSphystech420/DBGui/refs/heads/main/DBGUI.png"
@@ -194,7 +220,28 @@ void DBManager::ShowSqlDatabaseEditor()
         DbManager.DisconnectFromDatabase();
     }
     ImGui::SameLine();
+    ImGui::SetNextItemWidth(90);
+    if (ImGui::InputInt("Warm", &DbManager.WarmConnections))
+        DbManager.WarmConnections = std::clamp(DbManager.WarmConnections, 0, 7);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Idle connections kept open and health-checked in the background; applies on the next connect");
+    ImGui::SameLine();
     ImGui::Text("%s", DbManager.ConnectionStatus);
+    std::string PoolStatus = DbManager.PoolStatusText();
+    if (!PoolStatus.empty()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", PoolStatus.c_str());
+    }
+    std::string StatementStatus = DbManager.StatementCacheText();
+    if (!StatementStatus.empty()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", StatementStatus.c_str());
+    }
+    std::string CacheStatus = DbManager.CacheStatusText();
+    if (!CacheStatus.empty()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", CacheStatus.c_str());
+    }
     
     ImGui::Separator();
     
@@ -212,65 +259,209 @@ void DBManager::ShowSqlDatabaseEditor()
     
     ImGuiStyle &style = ImGui::GetStyle();
     ImGui::BeginGroup(); {
-        static int currentPage = 0;
-        const int rowsPerPage = 30;
-        static int totalRows = 0;
-        const int totalPages = (totalRows + rowsPerPage - 1) / rowsPerPage;
+        // One snapshot and grid per result of a script, kept by position so
+        // sorting, filters and a pinned baseline survive the next run.
+        static std::vector<std::shared_ptr<const DBCore::ResultSnapshot>> Snapshots;
+        static std::vector<std::unique_ptr<ResultGrid>> Grids;
+        static size_t SelectedResult = 0;
+        static uint64_t SeenRun = 0;
+        static bool SelectFirst = false;
+        static BlobInspector Inspector;
         
-        if (totalPages > 1) {
-            if (DBGui::Button("Previous") && currentPage > 0)
-                currentPage--;
-            ImGui::SameLine();
-            if (DBGui::Button("Next") && currentPage < totalPages - 1)
-                currentPage++;
+        size_t ResultCount = DbManager.QueryResults.Count();
+        if (SeenRun != DbManager.QueryResults.Run()) {
+            SeenRun = DbManager.QueryResults.Run();
+            SelectedResult = 0;
+            SelectFirst = true;
+        }
+        if (Snapshots.size() < ResultCount)
+            Snapshots.resize(ResultCount);
+        while (Grids.size() < std::max<size_t>(ResultCount, 1))
+            Grids.push_back(std::make_unique<ResultGrid>());
+        for (size_t i = 0; i < Snapshots.size(); i++) {
+            if (auto Publisher = DbManager.QueryResults.Publisher(i))
+                Publisher->Refresh(Snapshots[i]);
+            else
+                Snapshots[i].reset();
+        }
+        if (SelectedResult >= ResultCount)
+            SelectedResult = 0;
+        
+        if (ResultCount > 1 && ImGui::BeginTabBar("Results", ImGuiTabBarFlags_FittingPolicyScroll)) {
+            for (size_t i = 0; i < ResultCount; i++) {
+                DBCore::ResultSummary Summary = DbManager.QueryResults.Summary(i);
+                char Label[64];
+                snprintf(Label, sizeof(Label), "%s %zu###Result%zu", Summary.Failed ? "Error" : "Result", i + 1, i);
+                ImGuiTabItemFlags Flags = SelectFirst && i == 0 ? ImGuiTabItemFlags_SetSelected : 0;
+                if (ImGui::BeginTabItem(Label, nullptr, Flags)) {
+                    SelectedResult = i;
+                    ImGui::EndTabItem();
+                }
+                if (ImGui::IsItemHovered()) {
+                    if (Summary.Failed)
+                        ImGui::SetTooltip("The script stopped at this statement");
+                    else if (Summary.HasRows)
+                        ImGui::SetTooltip("%llu rows in %.3f s, %u warnings",
+                                          (unsigned long long)(Snapshots[i] ? Snapshots[i]->RowCount() : 0), Summary.Seconds, Summary.Warnings);
+                    else
+                        ImGui::SetTooltip("%llu row(s) affected in %.3f s, %u warnings",
+                                          (unsigned long long)Summary.AffectedRows, Summary.Seconds, Summary.Warnings);
+                }
+            }
+            ImGui::EndTabBar();
+            SelectFirst = false;
+        }
+        
+        std::shared_ptr<const DBCore::ResultSnapshot> Snapshot = SelectedResult < ResultCount ? Snapshots[SelectedResult] : nullptr;
+        
+        if (Snapshot) {
+            const DBCore::StreamStats &Stats = Snapshot->Stats;
+            if (Stats.Complete)
+                ImGui::TextDisabled("%llu rows in %.2f s", (unsigned long long)Snapshot->RowCount(), Stats.Seconds);
+            else
+                ImGui::TextDisabled("%llu rows so far, %.0f rows/s, %.2f MB/s", (unsigned long long)Snapshot->RowCount(),
+                                    Stats.RowsPerSecond(), Stats.MegabytesPerSecond());
+            if (Snapshot->Store) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("| %.1f MB in memory, %.1f MB spilled to disk",
+                                    Snapshot->Store->ResidentBytes() / (1024.0 * 1024.0),
+                                    Snapshot->Store->SpilledBytes() / (1024.0 * 1024.0));
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Results above %d MB are written to a temporary file and paged back in as needed", DbManager.ResultMemoryBudgetMB);
+            }
+        }
+        
+        if (DBGui::Button(ICON_FA_FILE_EXPORT))
+            ImGui::OpenPopup("Export");
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Export to CSV, TSV, JSON Lines or Arrow");
+        if (ImGui::BeginPopup("Export")) {
+            static const char *FormatNames[] = { "CSV", "TSV", "JSON Lines", "Arrow IPC stream", "Arrow IPC file" };
+            ImGui::SetNextItemWidth(160);
+            ImGui::Combo("Format", &DbManager.ExportFormatIndex, FormatNames, IM_ARRAYSIZE(FormatNames));
+            bool Arrow = DbManager.ExportArrow();
+            if (Arrow)
+                ImGui::BeginDisabled();
+            DBGui::CheckBox("Gzip", &DbManager.ExportGzip);
+            if (Arrow)
+                ImGui::EndDisabled();
+            
+            bool ExportBusy = DbManager.ExportInProgress.load();
+            bool CanExportResult = !ExportBusy && Snapshot && Snapshot->Store && Snapshot->Complete();
+            if (!CanExportResult)
+                ImGui::BeginDisabled();
+            if (DBGui::Button("Export result...")) {
+                std::string Path;
+                if (ChooseExportPath(DbManager.CurrentExportExtension(), Path)) {
+                    if (Arrow)
+                        DbManager.ExportArrowAsync(Snapshot->Store, Path, DbManager.CurrentArrowOptions());
+                    else
+                        DbManager.ExportResultAsync(Snapshot->Store, Path, DbManager.CurrentExportOptions());
+                }
+                ImGui::CloseCurrentPopup();
+            }
+            if (!CanExportResult)
+                ImGui::EndDisabled();
+            if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+                ImGui::SetTooltip("Write the fetched rows in their original order; sorting and filtering are not applied");
+            
+            // Arrow needs every dictionary before the first batch, so it only takes complete results.
+            bool CanExportQuery = !ExportBusy && !Arrow && DbManager.IsConnected.load() && !DbManager.QueryInProgress.load();
+            if (!CanExportQuery)
+                ImGui::BeginDisabled();
+            if (DBGui::Button("Export query...")) {
+                std::string Path;
+                if (ChooseExportPath(DbManager.CurrentExportExtension(), Path)) {
+                    std::string QueryStr = Editor.GetText();
+                    DbManager.ExportQueryAsync([NSString stringWithUTF8String: QueryStr.c_str()], Path, DbManager.CurrentExportOptions());
+                }
+                ImGui::CloseCurrentPopup();
+            }
+            if (!CanExportQuery)
+                ImGui::EndDisabled();
+            if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+                ImGui::SetTooltip("Run the query in the editor and stream its rows straight to the file");
+            ImGui::EndPopup();
+        }
+        ImGui::SameLine();
+        if (DBGui::Button(ICON_FA_FILE_IMPORT))
+            ImGui::OpenPopup("Bulk load");
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Bulk load a CSV or TSV file into a table");
+        if (ImGui::BeginPopup("Bulk load")) {
+            static const char *FormatNames[] = { "CSV", "TSV" };
+            ImGui::SetNextItemWidth(160);
+            ImGui::InputText("Table", DbManager.BulkTableBuffer, sizeof(DbManager.BulkTableBuffer));
+            ImGui::SetNextItemWidth(160);
+            ImGui::Combo("Format", &DbManager.BulkFormatIndex, FormatNames, IM_ARRAYSIZE(FormatNames));
+            ImGui::SetNextItemWidth(160);
+            if (ImGui::InputInt("Commit every", &DbManager.BulkCommitEvery))
+                DbManager.BulkCommitEvery = std::clamp(DbManager.BulkCommitEvery, 0, 1000);
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Batches per transaction; 0 commits each batch on its own (autocommit)");
+            
+            bool BulkBusy = DbManager.BulkInProgress.load();
+            bool CanLoad = !BulkBusy && DbManager.IsConnected.load() && DbManager.BulkTableBuffer[0];
+            if (!CanLoad)
+                ImGui::BeginDisabled();
+            if (DBGui::Button("Load file...")) {
+                std::string Path;
+                if (ChooseImportPath(Path))
+                    DbManager.BulkLoadAsync(Path);
+                ImGui::CloseCurrentPopup();
+            }
+            if (!CanLoad)
+                ImGui::EndDisabled();
+            if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+                ImGui::SetTooltip("The header row names the columns; batches are sized to the server's max_allowed_packet");
+            if (BulkBusy) {
+                ImGui::SameLine();
+                if (DBGui::Button("Stop"))
+                    DbManager.CancelBulkLoad();
+            }
+            ImGui::EndPopup();
+        }
+        ImGui::SameLine();
+        if (DbManager.ExportInProgress.load())
+            ImGui::TextDisabled("Exporting... %llu rows, %.1f MB written, %.1f s", (unsigned long long)DbManager.ExportCounters.Rows.load(),
+                                DbManager.ExportCounters.Bytes.load() / (1024.0 * 1024.0), DbManager.ExportSeconds());
+        else
+            ImGui::TextDisabled("%s", DbManager.ExportStatusText().c_str());
+        if (DbManager.BulkInProgress.load()) {
+            double Seconds = DbManager.BulkSeconds();
+            unsigned long long Rows = DbManager.BulkCounters.Rows.load();
             ImGui::SameLine();
-            ImGui::Text("Page %d/%d", currentPage + 1, totalPages);
+            ImGui::TextDisabled("Loading... %llu rows (%llu committed), %.0f rows/s, %.1f MB/s, %.1f s", Rows,
+                                (unsigned long long)DbManager.BulkCounters.Committed.load(), Seconds > 0 ? Rows / Seconds : 0.0,
+                                Seconds > 0 ? DbManager.BulkCounters.Bytes.load() / (1024.0 * 1024.0) / Seconds : 0.0, Seconds);
+        } else {
+            std::string BulkStatus = DbManager.BulkStatusText();
+            if (!BulkStatus.empty()) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s", BulkStatus.c_str());
+            }
         }
     
         ImGui::BeginChild("Result", ImVec2((ImGui::GetWindowWidth() - style.ItemSpacing.x - style.WindowPadding.x * 2) / 3, 0), ImGuiChildFlags_Border | ImGuiChildFlags_ResizeX); // ImGuiWindowFlags_MenuBar
         {
-            if (DbManager.QueryFinished.load())
-            {
-                totalRows = 0;
-                
-                std::vector<std::string> Columns;
-                std::vector<std::vector<std::string>> Rows;
-                {
-                    std::lock_guard<std::mutex> Lock(DbManager.QueryMutex);
-                    Columns = DbManager.QueryColumns;
-                    Rows = DbManager.QueryRows;
-                }
-                
-                totalRows = static_cast<int>(Rows.size());
-
-                if (currentPage >= totalPages)
-                    currentPage = totalPages > 0 ? totalPages - 1 : 0;
-                
-                if (ImGui::BeginTable("ResultsTable", (int)Columns.size() + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
-                {
-                    ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed);
-                    for (size_t i = 0; i < Columns.size(); i++)
-                        ImGui::TableSetupColumn(Columns[i].c_str());
-                    ImGui::TableHeadersRow();
-
-                    const int startRow = currentPage * rowsPerPage;
-                    const int endRow = std::min(startRow + rowsPerPage, totalRows);
-                    for (int r = startRow; r < endRow; r++)
-                    {
-                        ImGui::TableNextRow();
-                        ImGui::TableSetColumnIndex(0);
-                        ImGui::Text("%d", r + 1);
-                        for (size_t c = 0; c < Columns.size(); c++)
-                        {
-                            ImGui::TableSetColumnIndex((int)c + 1);
-                            ImGui::TextWrapped("%s", Rows[r][c].c_str());
-                        }
-                    }
-                    ImGui::EndTable();
-                }
-            }
+            Grids[SelectedResult]->Draw(Snapshot);
         }
         ImGui::EndChild();
+        
+        uint64_t InspectRow = 0;
+        size_t InspectColumn = 0;
+        if (Grids[SelectedResult]->TakeInspectRequest(InspectRow, InspectColumn) && Snapshot && Snapshot->Store) {
+            std::string ErrStr;
+            if (auto Source = DbManager.OpenBlob(Snapshot->Store, InspectRow, InspectColumn, &ErrStr)) {
+                const DBCore::ColumnInfo &Info = Snapshot->Store->Columns()[InspectColumn];
+                if (!Inspector.ChooseSavePath)
+                    Inspector.ChooseSavePath = [](std::string &Path) { return ChooseExportPath(".bin", Path); };
+                Inspector.Open(Source, Info.Name, Info.Charset == 63);
+            } else {
+                snprintf(DbManager.ConnectionStatus, sizeof(DbManager.ConnectionStatus), "%s", ErrStr.c_str());
+            }
+        }
+        Inspector.Draw();
     }
     ImGui::EndGroup();
     
@@ -282,6 +473,13 @@ void DBManager::ShowSqlDatabaseEditor()
         if (DbManager.QueryInProgress.load())
         {
             DBGui::Spinner("##spinoff", 7, 3, ImColor(255, 255, 0));
+            ImGui::SameLine();
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 0.2f, 0.2f, 1.0f));
+            if (DBGui::Button(ICON_FA_STOP))
+                DbManager.CancelQuery();
+            ImGui::PopStyleColor();
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Cancel query");
         } else {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.1f, 0.8f, 0.1f, 1.0f));
             if (DBGui::Button(ICON_FA_PLAY))
@@ -300,6 +498,16 @@ void DBManager::ShowSqlDatabaseEditor()
             } ImGui::PopStyleColor();
         } ImGui::SameLine();
         
+        DBGui::CheckBox("Binary", &DbManager.UseBinaryProtocol);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Run SELECTs as prepared statements (binary protocol)");
+        ImGui::SameLine();
+        
+        DBGui::CheckBox("Cache", &DbManager.UseResultCache);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Serve repeated SELECTs from the on-disk result cache");
+        ImGui::SameLine();
+        
         bool undoDisabled = !Editor.CanUndo();
         if (undoDisabled)
             ImGui::BeginDisabled();
@@ -0,0 +1,242 @@
+//
+//  ResultDiffView.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultDiffView.hpp"
+#include "imgui_internal.h"
+
+#include <algorithm>
+
+// Text of a cell on one line, short enough for a fixed-height row.
+static std::string CellText(const DBCore::ResultStore &Result, uint64_t Row, size_t Column)
+{
+    char Buffer[64];
+    DBCore::CellView Cell = Result.Cell(Row, Column);
+    if (Cell.Null)
+        return "NULL";
+    std::string Text(DBCore::FormatCell(Result.Columns()[Column], Cell, Buffer, sizeof(Buffer)));
+    if (Text.size() > 128)
+        Text = Text.substr(0, 125) + "...";
+    std::replace(Text.begin(), Text.end(), '\n', ' ');
+    return Text;
+}
+
+void ResultDiffView::Draw(const std::shared_ptr<const DBCore::ResultSnapshot> &Baseline, const std::shared_ptr<const DBCore::ResultSnapshot> &Current)
+{
+    if (!Baseline || !Baseline->Store || !Current || !Current->Store)
+        return;
+    
+    DrawOptions(*Current->Store);
+    
+    {
+        std::lock_guard<std::mutex> Lock(DiffMutex);
+        if (PendingDone)
+        {
+            PendingDone = false;
+            Diffing = false;
+            Message = std::move(PendingError);
+            PendingError.clear();
+            Diff = std::move(PendingDiff);
+            Filter();
+        }
+    }
+    
+    // Only complete results are diffed; a result still streaming in is picked up when it finishes.
+    if ((Baseline->ResultId != BaselineId || Current->ResultId != CurrentId || OptionsChanged) && Current->Complete())
+        RequestDiff(Baseline, Current);
+    
+    if (!Current->Complete())
+    {
+        ImGui::TextDisabled("Waiting for the result to finish...");
+        return;
+    }
+    if (Diffing)
+    {
+        ImGui::TextDisabled("Comparing...");
+        return;
+    }
+    if (!Message.empty())
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", Message.c_str());
+        return;
+    }
+    if (!Diff)
+        return;
+    
+    bool Toggled = ImGui::Checkbox("##ShowChanged", &ShowChanged);
+    ImGui::SameLine();
+    ImGui::Text("%llu changed", (unsigned long long)Diff->Changed);
+    ImGui::SameLine();
+    Toggled |= ImGui::Checkbox("##ShowAdded", &ShowAdded);
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.4f, 0.9f, 0.4f, 1.0f), "%llu added", (unsigned long long)Diff->Added);
+    ImGui::SameLine();
+    Toggled |= ImGui::Checkbox("##ShowRemoved", &ShowRemoved);
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1.0f, 0.45f, 0.45f, 1.0f), "%llu removed", (unsigned long long)Diff->Removed);
+    ImGui::SameLine();
+    ImGui::TextDisabled("| %llu unchanged", (unsigned long long)Diff->Unchanged);
+    if (Toggled)
+        Filter();
+    
+    if (!Diff->AddedColumns.empty() || !Diff->RemovedColumns.empty())
+    {
+        std::string Columns;
+        for (const std::string &Name : Diff->AddedColumns)
+            Columns += " +" + Name;
+        for (const std::string &Name : Diff->RemovedColumns)
+            Columns += " -" + Name;
+        ImGui::TextDisabled("Columns in only one result:%s", Columns.c_str());
+    }
+    
+    DrawEntries(*Baseline->Store, *Current->Store);
+}
+
+void ResultDiffView::DrawOptions(const DBCore::ResultStore &Current)
+{
+    static const char *KeyNames[] = { "Primary key", "Chosen columns", "Whole row" };
+    
+    int Key = (int)Options.Key;
+    ImGui::SetNextItemWidth(140.0f);
+    if (ImGui::Combo("Match rows by", &Key, KeyNames, IM_ARRAYSIZE(KeyNames)))
+    {
+        Options.Key = (DBCore::DiffKey)Key;
+        OptionsChanged = true;
+    }
+    
+    if (Options.Key != DBCore::DiffKey::Columns)
+        return;
+    
+    ImGui::SameLine();
+    if (ImGui::Button("Key columns..."))
+        ImGui::OpenPopup("DiffKeyColumns");
+    if (ImGui::BeginPopup("DiffKeyColumns"))
+    {
+        for (const DBCore::ColumnInfo &Column : Current.Columns())
+        {
+            auto Found = std::find(Options.KeyColumns.begin(), Options.KeyColumns.end(), Column.Name);
+            bool Checked = Found != Options.KeyColumns.end();
+            if (ImGui::Checkbox(Column.Name.c_str(), &Checked))
+            {
+                if (Checked)
+                    Options.KeyColumns.push_back(Column.Name);
+                else
+                    Options.KeyColumns.erase(Found);
+                OptionsChanged = true;
+            }
+        }
+        ImGui::EndPopup();
+    }
+}
+
+void ResultDiffView::RequestDiff(const std::shared_ptr<const DBCore::ResultSnapshot> &Baseline, const std::shared_ptr<const DBCore::ResultSnapshot> &Current)
+{
+    BaselineId = Baseline->ResultId;
+    CurrentId = Current->ResultId;
+    OptionsChanged = false;
+    Diffing = true;
+    Message.clear();
+    
+    uint64_t Request;
+    {
+        std::lock_guard<std::mutex> Lock(DiffMutex);
+        Request = ++DiffRequest;
+        PendingDone = false;
+    }
+    Worker.Cancel();
+    
+    const std::shared_ptr<const DBCore::ResultStore> Old = Baseline->Store;
+    const std::shared_ptr<const DBCore::ResultStore> New = Current->Store;
+    const DBCore::DiffOptions Key = Options;
+    Worker.Submit([this, Old, New, Key, Request](const DBCore::CancelToken &Token) {
+        auto Result = std::make_shared<DBCore::ResultDiff>();
+        std::string Error;
+        bool Finished = DBCore::ResultDiffer::Diff(*Old, *New, Key, *Result, &Token, &Error);
+        if (!Finished && Token.Cancelled())
+            return;
+        
+        std::lock_guard<std::mutex> Lock(DiffMutex);
+        if (Request != DiffRequest)
+            return;
+        PendingDone = true;
+        PendingError = std::move(Error);
+        if (Finished)
+            PendingDiff = std::move(Result);
+    });
+}
+
+void ResultDiffView::Filter()
+{
+    Shown.clear();
+    if (!Diff)
+        return;
+    for (uint32_t i = 0; i < (uint32_t)Diff->Entries.size(); i++)
+    {
+        DBCore::RowChange Change = Diff->Entries[i].Change;
+        if ((Change == DBCore::RowChange::Changed && ShowChanged) || (Change == DBCore::RowChange::Added && ShowAdded) ||
+            (Change == DBCore::RowChange::Removed && ShowRemoved))
+            Shown.push_back(i);
+    }
+}
+
+void ResultDiffView::DrawEntries(const DBCore::ResultStore &Old, const DBCore::ResultStore &New)
+{
+    // Wider diffs show their leading columns; a status column comes first.
+    const int Columns = (int)std::min<size_t>(Diff->Columns.size(), IMGUI_TABLE_MAX_COLUMNS - 1);
+    ImGuiTableFlags Flags = ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings |
+                            ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY;
+    if (!ImGui::BeginTable("DiffTable", Columns + 1, Flags))
+        return;
+    
+    ImGui::TableSetupScrollFreeze(1, 1);
+    ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoHide);
+    for (int c = 0; c < Columns; c++)
+        ImGui::TableSetupColumn(New.Columns()[Diff->Columns[c].second].Name.c_str(), ImGuiTableColumnFlags_WidthFixed, 120.0f);
+    ImGui::TableHeadersRow();
+    
+    const ImU32 AddedColor = IM_COL32(60, 140, 60, 70);
+    const ImU32 RemovedColor = IM_COL32(160, 60, 60, 70);
+    const ImU32 ChangedColor = IM_COL32(200, 160, 40, 90);
+    
+    ImGuiListClipper Clipper;
+    Clipper.Begin((int)Shown.size());
+    while (Clipper.Step())
+    {
+        for (int i = Clipper.DisplayStart; i < Clipper.DisplayEnd; i++)
+        {
+            const DBCore::DiffEntry &Entry = Diff->Entries[Shown[i]];
+            const bool Removed = Entry.Change == DBCore::RowChange::Removed;
+            const DBCore::ResultStore &Side = Removed ? Old : New;
+            const uint64_t Row = Removed ? Entry.OldRow : Entry.NewRow;
+            const uint32_t *Changed = Diff->ChangedColumns.data() + Entry.FirstChanged;
+            
+            ImGui::TableNextRow();
+            if (Entry.Change == DBCore::RowChange::Added)
+                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, AddedColor);
+            else if (Removed)
+                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, RemovedColor);
+            
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(Entry.Change == DBCore::RowChange::Changed ? "~" : Removed ? "-" : "+");
+            
+            for (int c = 0; c < Columns; c++)
+            {
+                if (!ImGui::TableSetColumnIndex(c + 1))
+                    continue;
+                const size_t Column = Removed ? Diff->Columns[c].first : Diff->Columns[c].second;
+                ImGui::TextUnformatted(CellText(Side, Row, Column).c_str());
+                
+                if (std::find(Changed, Changed + Entry.ChangedCount, (uint32_t)c) != Changed + Entry.ChangedCount)
+                {
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, ChangedColor);
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("Was: %s", CellText(Old, Entry.OldRow, Diff->Columns[c].first).c_str());
+                }
+            }
+        }
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,56 @@
+//
+//  ResultDiffView.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "imgui.h"
+#include "ResultSnapshot.hpp"
+#include "ResultDiff.hpp"
+#include "QueryWorker.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Rows that differ between a pinned baseline result and the current one:
+// changed rows with the differing cells highlighted (hover for the old
+// value), then added and removed rows. The diff runs on a background thread
+// whenever either side or the key choice changes.
+class ResultDiffView {
+public:
+    void Draw(const std::shared_ptr<const DBCore::ResultSnapshot> &Baseline, const std::shared_ptr<const DBCore::ResultSnapshot> &Current);
+    
+private:
+    void DrawOptions(const DBCore::ResultStore &Current);
+    void DrawEntries(const DBCore::ResultStore &Old, const DBCore::ResultStore &New);
+    void RequestDiff(const std::shared_ptr<const DBCore::ResultSnapshot> &Baseline, const std::shared_ptr<const DBCore::ResultSnapshot> &Current);
+    void Filter();
+    
+    uint64_t BaselineId = 0;
+    uint64_t CurrentId = 0;
+    bool OptionsChanged = true;
+    bool Diffing = false;
+    DBCore::DiffOptions Options;
+    std::string Message;
+    
+    std::shared_ptr<const DBCore::ResultDiff> Diff;
+    bool ShowChanged = true;
+    bool ShowAdded = true;
+    bool ShowRemoved = true;
+    // Entries that pass the show toggles, as indices into Diff->Entries.
+    std::vector<uint32_t> Shown;
+    
+    std::mutex DiffMutex;
+    uint64_t DiffRequest = 0;
+    std::shared_ptr<const DBCore::ResultDiff> PendingDiff;
+    std::string PendingError;
+    bool PendingDone = false;
+    // Last member, so its thread is joined before the state it writes goes away.
+    DBCore::QueryWorker Worker;
+};
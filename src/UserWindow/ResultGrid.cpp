@@ -0,0 +1,683 @@
+//
+//  ResultGrid.cpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#include "ResultGrid.hpp"
+#include "imgui_internal.h"
+#include "IconsFontAwesome6.h"
+#include "ResultSorter.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+void ResultGrid::Sync(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot)
+{
+    uint64_t Rows = Snapshot && Snapshot->Store ? Snapshot->Store->RowCount() : 0;
+    float DefaultHeight = ImGui::GetTextLineHeight() + ImGui::GetStyle().CellPadding.y * 2.0f;
+    
+    // A new result or a font change invalidates every measured height; a
+    // streamed result that grew only needs the new rows appended.
+    if (!Snapshot || Snapshot->ResultId != ResultId || DefaultHeight != RowHeight)
+    {
+        if (!Snapshot || Snapshot->ResultId != ResultId)
+        {
+            ColumnWidths.clear();
+            if (Snapshot && Snapshot->Store)
+            {
+                for (const DBCore::ColumnInfo &Column : Snapshot->Store->Columns())
+                    ColumnWidths.push_back(CellLayoutCache::ColumnWidthHint(Column));
+            }
+            Layouts.Reset(ColumnWidths.size());
+            OffsetsDirty = true;
+            ClearSort();
+            ClearFilter();
+            ClearSelection();
+        }
+        ResultId = Snapshot ? Snapshot->ResultId : 0;
+        RowHeight = DefaultHeight;
+        Heights.Reset(DisplayRows(Rows), DefaultHeight);
+    }
+}
+
+void ResultGrid::Draw(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot)
+{
+    Layouts.Validate();
+    Sync(Snapshot);
+    if (!Snapshot || !Snapshot->Store)
+        return;
+    
+    const DBCore::ResultStore &Result = *Snapshot->Store;
+    const uint64_t Rows = Result.RowCount();
+    
+    // Rows that arrived while a sort ran are appended unsorted; re-sort once the result is complete.
+    bool ViewChanged = TakeSortResult();
+    ViewChanged |= TakeFilterResult();
+    if (ViewChanged)
+        UpdateView(Rows);
+    if (SortColumn >= 0 && !Sorting && Snapshot->Complete() && (!Order || Order->size() != Rows))
+        RequestSort(Snapshot->Store);
+    
+    // Likewise a filter applied while rows stream in is run again on the complete result.
+    if (FilterText[0] && !Filtering && FilterMessage.empty() && (!Matches || (Snapshot->Complete() && Matches->TotalRows != Rows)))
+        RequestFilter(Snapshot->Store);
+    
+    const uint64_t Shown = DisplayRows(Rows);
+    if (Heights.RowCount() != Shown)
+        Heights.Resize(Shown);
+    
+    ImGui::SetNextItemWidth(120.0f);
+    ImGui::InputScalar("Go to row", ImGuiDataType_U64, &GoToRowInput, nullptr, nullptr, "%llu");
+    if (ImGui::IsItemDeactivatedAfterEdit() && Shown > 0)
+    {
+        ScrollToRow(std::clamp<uint64_t>(GoToRowInput, 1, Shown) - 1);
+    }
+    
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80.0f);
+    if (ImGui::InputInt("Pinned columns", &PinnedColumns))
+        PinnedColumns = std::clamp(PinnedColumns, 0, MaxPinnedColumns);
+    
+    ImGui::SameLine();
+    ImGui::Checkbox("Statistics", &ShowStats);
+    
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!Snapshot->Complete());
+    if (ImGui::Button(ICON_FA_THUMBTACK " Baseline"))
+        DiffBaseline = Snapshot;
+    ImGui::EndDisabled();
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+        ImGui::SetTooltip("Keep this result to compare the next run of the query against");
+    if (DiffBaseline)
+    {
+        ImGui::SameLine();
+        ImGui::Checkbox(ICON_FA_CODE_COMPARE " Diff", &ShowDiff);
+    }
+    
+    if (Sorting)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Sorting...");
+    }
+    
+    if (ShowDiff && DiffBaseline)
+    {
+        Diff.Draw(DiffBaseline, Snapshot);
+        return;
+    }
+    
+    DrawFilterBar(Snapshot->Store);
+    DrawSelectionSummary();
+    
+    if (Result.ColumnCount() == 0)
+        return;
+    
+    const int Pinned = std::min(PinnedColumns, (int)Result.ColumnCount());
+    const int Scrolling = (int)Result.ColumnCount() - Pinned;
+    const bool Windowed = Scrolling > WindowSlots;
+    const int TableColumns = 1 + Pinned + (Windowed ? WindowSlots + 2 : Scrolling);
+    
+    ImGuiTableFlags Flags = ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings |
+                            ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY;
+    if (!ImGui::BeginTable("ResultsTable", TableColumns, Flags, ImVec2(0.0f, ShowStats ? -StatsPanelHeight : 0.0f)))
+        return;
+    
+    LayoutColumns(Result);
+    DrawHeaders(Snapshot->Store);
+    
+    if (PendingScrollRow != NoRow)
+    {
+        ImGui::SetScrollY((float)Heights.Offset(std::min(PendingScrollRow, Shown)));
+        PendingScrollRow = NoRow;
+    }
+    
+    DrawRows(Snapshot->Store);
+    ImGui::EndTable();
+    
+    if (ShowStats)
+    {
+        ImGui::BeginChild("ColumnStats", ImVec2(0.0f, 0.0f), ImGuiChildFlags_Border);
+        Stats.Draw(Snapshot);
+        ImGui::EndChild();
+    }
+}
+
+void ResultGrid::LayoutColumns(const DBCore::ResultStore &Result)
+{
+    ImGuiTable *Table = ImGui::GetCurrentTable();
+    const int Pinned = std::min(PinnedColumns, (int)Result.ColumnCount());
+    const int Scrolling = (int)Result.ColumnCount() - Pinned;
+    const bool Windowed = Scrolling > WindowSlots;
+    
+    // Pick the window of scrolling columns from last frame's offsets; the
+    // window is wider than any screen, so a frame of lag never shows a gap.
+    int First = 0;
+    if (Windowed && !ScrollOffsets.empty())
+    {
+        double ScrollX = ImGui::GetScrollX();
+        First = (int)(std::upper_bound(ScrollOffsets.begin(), ScrollOffsets.end(), ScrollX) - ScrollOffsets.begin()) - 1;
+        First = std::clamp(First, 0, Scrolling - WindowSlots);
+    }
+    
+    std::vector<int> Layout;
+    Layout.reserve(Table->ColumnsCount);
+    Layout.push_back(RowNumberSlot);
+    for (int c = 0; c < Pinned; c++)
+        Layout.push_back(c);
+    if (Windowed)
+    {
+        Layout.push_back(LeadingSpacerSlot);
+        for (int i = 0; i < WindowSlots; i++)
+            Layout.push_back(Pinned + First + i);
+        Layout.push_back(TrailingSpacerSlot);
+    }
+    else
+    {
+        for (int c = Pinned; c < (int)Result.ColumnCount(); c++)
+            Layout.push_back(c);
+    }
+    
+    ImGui::TableSetupScrollFreeze(1 + Pinned, 1);
+    for (int Slot : Layout)
+    {
+        if (Slot == RowNumberSlot)
+            ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoHide);
+        else if (Slot < 0)
+            ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 1.0f);
+        else
+            ImGui::TableSetupColumn(Result.Columns()[Slot].Name.c_str(), ImGuiTableColumnFlags_WidthFixed, ColumnWidths[Slot]);
+    }
+    
+    // A width that differs from what was requested last frame for the same
+    // column came from the user dragging or auto-fitting a border.
+    if (Slots.size() == Layout.size())
+    {
+        for (size_t t = 0; t < Layout.size(); t++)
+        {
+            float Requested = Table->Columns[t].WidthRequest;
+            if (Layout[t] >= 0 && Slots[t] == Layout[t] && Requested > 0.0f && Requested != SlotWidths[t])
+            {
+                ColumnWidths[Layout[t]] = Requested;
+                OffsetsDirty = true;
+            }
+        }
+    }
+    
+    const double CellExtra = Table->CellPaddingX * 2.0f + Table->CellSpacingX1 + Table->CellSpacingX2;
+    if (OffsetsDirty || ScrollOffsets.size() != (size_t)Scrolling + 1)
+    {
+        ScrollOffsets.resize((size_t)Scrolling + 1);
+        ScrollOffsets[0] = 0.0;
+        for (int c = 0; c < Scrolling; c++)
+            ScrollOffsets[c + 1] = ScrollOffsets[c] + ColumnWidths[Pinned + c] + CellExtra;
+        OffsetsDirty = false;
+    }
+    
+    // Spacers always keep the minimum width on top of what they stand in for,
+    // so columns do not shift when the window moves off the first column.
+    SlotWidths.resize(Layout.size());
+    for (size_t t = 0; t < Layout.size(); t++)
+    {
+        float Width;
+        if (Layout[t] == RowNumberSlot)
+            Width = Table->Columns[t].WidthRequest;
+        else if (Layout[t] == LeadingSpacerSlot)
+            Width = Table->MinColumnWidth + (float)ScrollOffsets[First];
+        else if (Layout[t] == TrailingSpacerSlot)
+            Width = Table->MinColumnWidth + (float)(ScrollOffsets[Scrolling] - ScrollOffsets[First + WindowSlots]);
+        else
+            Width = ColumnWidths[Layout[t]];
+        
+        if (Layout[t] != RowNumberSlot)
+            Table->Columns[t].WidthRequest = Width;
+        SlotWidths[t] = Width;
+    }
+    Slots = std::move(Layout);
+}
+
+void ResultGrid::DrawHeaders(const std::shared_ptr<const DBCore::ResultStore> &Result)
+{
+    ImGui::TableNextRow(ImGuiTableRowFlags_Headers);
+    for (size_t t = 0; t < Slots.size(); t++)
+    {
+        if (!ImGui::TableSetColumnIndex((int)t))
+            continue;
+        
+        const int c = Slots[t];
+        ImGui::PushID((int)t);
+        if (c < 0) {
+            ImGui::TableHeader(c == RowNumberSlot ? "#" : "");
+        } else {
+            // Name, sort arrow, then a stable id that does not change with the label.
+            std::string Label = Result->Columns()[c].Name;
+            if (c == SortColumn)
+                Label += SortDescending ? " " ICON_FA_SORT_DOWN : " " ICON_FA_SORT_UP;
+            Label += "##Header";
+            ImGui::TableHeader(Label.c_str());
+            
+            // Ascending, descending, then back to fetch order.
+            if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+            {
+                if (SortColumn != c) {
+                    SortColumn = c;
+                    SortDescending = false;
+                } else if (!SortDescending) {
+                    SortDescending = true;
+                } else {
+                    SortColumn = -1;
+                }
+                
+                if (SortColumn < 0) {
+                    ClearSort();
+                    UpdateView(Result->RowCount());
+                } else {
+                    RequestSort(Result);
+                }
+            }
+        }
+        ImGui::PopID();
+    }
+}
+
+void ResultGrid::RequestSort(const std::shared_ptr<const DBCore::ResultStore> &Result)
+{
+    uint64_t Request;
+    {
+        std::lock_guard<std::mutex> Lock(SortMutex);
+        Request = ++SortRequest;
+        SortedOrder.reset();
+    }
+    SortWorker.Cancel();
+    Sorting = true;
+    
+    const size_t Column = (size_t)SortColumn;
+    const bool Descending = SortDescending;
+    SortWorker.Submit([this, Result, Column, Descending, Request](const DBCore::CancelToken &Token) {
+        auto Permutation = std::make_shared<std::vector<uint64_t>>();
+        if (!DBCore::ResultSorter::Sort(*Result, Column, Descending, *Permutation, &Token))
+            return;
+        
+        std::lock_guard<std::mutex> Lock(SortMutex);
+        if (Request == SortRequest)
+            SortedOrder = std::move(Permutation);
+    });
+}
+
+void ResultGrid::ClearSort()
+{
+    {
+        std::lock_guard<std::mutex> Lock(SortMutex);
+        ++SortRequest;
+        SortedOrder.reset();
+    }
+    SortWorker.Cancel();
+    SortColumn = -1;
+    Sorting = false;
+    Order.reset();
+}
+
+bool ResultGrid::TakeSortResult()
+{
+    if (!Sorting)
+        return false;
+    
+    std::lock_guard<std::mutex> Lock(SortMutex);
+    if (!SortedOrder)
+        return false;
+    
+    Order = std::move(SortedOrder);
+    Sorting = false;
+    return true;
+}
+
+void ResultGrid::DrawFilterBar(const std::shared_ptr<const DBCore::ResultStore> &Result)
+{
+    ImGui::SetNextItemWidth(240.0f);
+    bool Changed = ImGui::InputTextWithHint("##Filter", ICON_FA_MAGNIFYING_GLASS " Filter rows...", FilterText, sizeof(FilterText));
+    ImGui::SameLine();
+    Changed |= ImGui::Checkbox("Regex", &FilterRegex);
+    ImGui::SameLine();
+    Changed |= ImGui::Checkbox("Match case", &FilterCaseSensitive);
+    
+    if (Changed)
+    {
+        if (FilterText[0]) {
+            RequestFilter(Result);
+        } else {
+            ClearFilter();
+            UpdateView(Result->RowCount());
+        }
+    }
+    
+    if (!FilterMessage.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", FilterMessage.c_str());
+    }
+    else if (View)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%llu of %llu rows%s", (unsigned long long)View->size(),
+                            (unsigned long long)Result->RowCount(), Filtering ? ", filtering..." : "");
+    }
+    else if (Filtering)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Filtering...");
+    }
+}
+
+void ResultGrid::DrawSelectionSummary()
+{
+    if (SelectionAnchor.Row == NoRow)
+        return;
+    
+    if (Summing)
+    {
+        std::lock_guard<std::mutex> Lock(SelectionMutex);
+        if (PendingTotals)
+        {
+            Totals = *PendingTotals;
+            PendingTotals.reset();
+            Summing = false;
+        }
+    }
+    
+    ImGui::SameLine();
+    if (Summing)
+        ImGui::TextDisabled("| %llu cells, count ..., sum ..., avg ...", (unsigned long long)SelectedCells);
+    else if (Totals.Numbers)
+        ImGui::TextDisabled("| %llu cells, count %llu, sum %.10g, avg %.10g", (unsigned long long)SelectedCells,
+                            (unsigned long long)Totals.Values, Totals.Sum, Totals.Sum / (double)Totals.Numbers);
+    else
+        ImGui::TextDisabled("| %llu cells, count %llu", (unsigned long long)SelectedCells, (unsigned long long)Totals.Values);
+}
+
+void ResultGrid::Select(const std::shared_ptr<const DBCore::ResultStore> &Result, uint64_t Row, int Column, bool Extend)
+{
+    if (!Extend || SelectionAnchor.Row == NoRow)
+    {
+        SelectionAnchor = CellRef{ Row, Column };
+        Stats.Focus(Column);
+    }
+    SelectionEnd = CellRef{ Row, Column };
+    
+    const uint64_t FirstRow = std::min(SelectionAnchor.Row, SelectionEnd.Row);
+    const uint64_t LastRow = std::max(SelectionAnchor.Row, SelectionEnd.Row);
+    const size_t FirstColumn = (size_t)std::min(SelectionAnchor.Column, SelectionEnd.Column);
+    const size_t LastColumn = (size_t)std::max(SelectionAnchor.Column, SelectionEnd.Column);
+    SelectedCells = (LastRow - FirstRow + 1) * (uint64_t)(LastColumn - FirstColumn + 1);
+    
+    // Whole-column selections of large results take a while to sum, so the
+    // totals come from the pool and the toolbar shows them once published.
+    uint64_t Request;
+    {
+        std::lock_guard<std::mutex> Lock(SelectionMutex);
+        Request = ++SelectionRequest;
+        PendingTotals.reset();
+    }
+    SelectionWorker.Cancel();
+    Totals = SelectionTotals();
+    Summing = true;
+    
+    SelectionWorker.Submit([this, Result, View = View, Order = Order, FirstRow, LastRow, FirstColumn, LastColumn, Request](const DBCore::CancelToken &Token) {
+        const std::vector<DBCore::ColumnInfo> &Columns = Result->Columns();
+        auto Sum = std::make_shared<SelectionTotals>();
+        std::mutex SumMutex;
+        auto Add = [&Columns](SelectionTotals &Into, size_t Column, const DBCore::CellView &Cell) {
+            double Value;
+            if (Cell.Null)
+                return;
+            Into.Values++;
+            if (DBCore::NumericValue(Columns[Column], Cell, Value))
+            {
+                Into.Numbers++;
+                Into.Sum += Value;
+            }
+        };
+        auto Merge = [&](const SelectionTotals &Part) {
+            std::lock_guard<std::mutex> Lock(SumMutex);
+            Sum->Values += Part.Values;
+            Sum->Numbers += Part.Numbers;
+            Sum->Sum += Part.Sum;
+        };
+        
+        if (!View && !Order)
+        {
+            // Display rows are result rows: read each block column by column.
+            const auto &Blocks = Result->Blocks();
+            auto First = std::upper_bound(Blocks.begin(), Blocks.end(), FirstRow, [](uint64_t Row, const auto &Block) {
+                return Row < Block->FirstRow;
+            }) - 1;
+            auto Last = std::upper_bound(Blocks.begin(), Blocks.end(), LastRow, [](uint64_t Row, const auto &Block) {
+                return Row < Block->FirstRow;
+            });
+            DBCore::ThreadPool::Shared().ParallelFor((uint64_t)(Last - First), 1, [&](uint64_t Begin, uint64_t End) {
+                SelectionTotals Part;
+                for (uint64_t b = Begin; b < End && !Token.Cancelled(); b++)
+                {
+                    const DBCore::ResultBlock &Block = *First[(ptrdiff_t)b];
+                    const uint32_t Top = (uint32_t)(std::max(FirstRow, Block.FirstRow) - Block.FirstRow);
+                    const uint32_t Bottom = (uint32_t)(std::min(LastRow + 1, Block.FirstRow + Block.RowCount) - Block.FirstRow);
+                    for (size_t c = FirstColumn; c <= LastColumn; c++)
+                    {
+                        const DBCore::ColumnBlock &Values = Block.Columns[c];
+                        for (uint32_t r = Top; r < Bottom; r++)
+                            Add(Part, c, Values.Cell(r));
+                    }
+                }
+                Merge(Part);
+            });
+        }
+        else
+        {
+            // Sorted or filtered rows are scattered over the blocks; read them a row at a time.
+            DBCore::ThreadPool::Shared().ParallelFor(LastRow - FirstRow + 1, 16384, [&](uint64_t Begin, uint64_t End) {
+                SelectionTotals Part;
+                for (uint64_t r = FirstRow + Begin; r < FirstRow + End && !Token.Cancelled(); r++)
+                {
+                    const uint64_t Source = View ? (*View)[r] : r < Order->size() ? (*Order)[r] : r;
+                    DBCore::RowView Cells = Result->Row(Source);
+                    for (size_t c = FirstColumn; c <= LastColumn; c++)
+                        Add(Part, c, Cells[c]);
+                }
+                Merge(Part);
+            });
+        }
+        if (Token.Cancelled())
+            return;
+        
+        std::lock_guard<std::mutex> Lock(SelectionMutex);
+        if (Request == SelectionRequest)
+            PendingTotals = std::move(Sum);
+    });
+}
+
+bool ResultGrid::Selected(uint64_t Row, int Column) const
+{
+    if (SelectionAnchor.Row == NoRow)
+        return false;
+    return Row >= std::min(SelectionAnchor.Row, SelectionEnd.Row) && Row <= std::max(SelectionAnchor.Row, SelectionEnd.Row) &&
+           Column >= std::min(SelectionAnchor.Column, SelectionEnd.Column) && Column <= std::max(SelectionAnchor.Column, SelectionEnd.Column);
+}
+
+void ResultGrid::RequestFilter(const std::shared_ptr<const DBCore::ResultStore> &Result)
+{
+    DBCore::FilterQuery Query{ FilterText, FilterRegex, FilterCaseSensitive };
+    
+    // A query that can only match a subset of the last complete matches rescans just those.
+    std::shared_ptr<const DBCore::FilterMatches> Previous;
+    if (CompleteMatches && CompleteMatches->TotalRows == Result->RowCount() && DBCore::ResultFilter::Refines(CompleteMatches->Query, Query))
+        Previous = CompleteMatches;
+    
+    uint64_t Request;
+    {
+        std::lock_guard<std::mutex> Lock(FilterMutex);
+        Request = ++FilterRequest;
+        PendingMatches.reset();
+        PendingError.clear();
+    }
+    FilterWorker.Cancel();
+    FilterApplied = Query;
+    FilterMessage.clear();
+    Filtering = true;
+    
+    FilterWorker.Submit([this, Result, Query, Previous, Request](const DBCore::CancelToken &Token) {
+        auto Publish = [this, Request](std::shared_ptr<const DBCore::FilterMatches> Found) {
+            std::lock_guard<std::mutex> Lock(FilterMutex);
+            if (Request == FilterRequest)
+                PendingMatches = std::move(Found);
+        };
+        
+        std::string Error;
+        if (DBCore::ResultFilter::Run(*Result, Query, Previous ? &Previous->Rows : nullptr, Publish, &Token, &Error) || Token.Cancelled())
+            return;
+        
+        std::lock_guard<std::mutex> Lock(FilterMutex);
+        if (Request == FilterRequest)
+            PendingError = Error.empty() ? "Filter failed" : Error;
+    });
+}
+
+void ResultGrid::ClearFilter()
+{
+    {
+        std::lock_guard<std::mutex> Lock(FilterMutex);
+        ++FilterRequest;
+        PendingMatches.reset();
+        PendingError.clear();
+    }
+    FilterWorker.Cancel();
+    FilterApplied = DBCore::FilterQuery();
+    FilterMessage.clear();
+    Filtering = false;
+    Matches.reset();
+    CompleteMatches.reset();
+    View.reset();
+}
+
+bool ResultGrid::TakeFilterResult()
+{
+    if (!Filtering)
+        return false;
+    
+    std::lock_guard<std::mutex> Lock(FilterMutex);
+    if (!PendingError.empty())
+    {
+        FilterMessage = std::move(PendingError);
+        PendingError.clear();
+        Filtering = false;
+        return false;
+    }
+    if (!PendingMatches)
+        return false;
+    
+    Matches = std::move(PendingMatches);
+    if (Matches->Complete)
+    {
+        CompleteMatches = Matches;
+        Filtering = false;
+    }
+    return true;
+}
+
+void ResultGrid::UpdateView(uint64_t Rows)
+{
+    if (!Matches) {
+        View.reset();
+    } else if (!Order) {
+        View = std::shared_ptr<const std::vector<uint64_t>>(Matches, &Matches->Rows);
+    } else {
+        // Walk the sort order and keep the matching rows; matches past the
+        // order (fetched while it was computed) follow in fetch order.
+        std::vector<bool> Hit(Rows, false);
+        for (uint64_t Row : Matches->Rows)
+            if (Row < Rows)
+                Hit[Row] = true;
+        
+        auto Composed = std::make_shared<std::vector<uint64_t>>();
+        Composed->reserve(Matches->Rows.size());
+        for (uint64_t Row : *Order)
+            if (Row < Rows && Hit[Row])
+                Composed->push_back(Row);
+        for (uint64_t Row : Matches->Rows)
+            if (Row >= Order->size() && Row < Rows)
+                Composed->push_back(Row);
+        View = std::move(Composed);
+    }
+    Heights.Reset(DisplayRows(Rows), RowHeight);
+    ClearSelection();
+}
+
+void ResultGrid::DrawRows(const std::shared_ptr<const DBCore::ResultStore> &Store)
+{
+    const DBCore::ResultStore &Result = *Store;
+    const uint64_t Rows = DisplayRows(Result.RowCount());
+    if (Rows == 0)
+        return;
+    
+    const float CellPaddingY = ImGui::GetStyle().CellPadding.y;
+    const double ViewTop = ImGui::GetScrollY();
+    const double ViewBottom = ViewTop + ImGui::GetWindowHeight();
+    const ImU32 RowColors[2] = { ImGui::GetColorU32(ImGuiCol_TableRowBg), ImGui::GetColorU32(ImGuiCol_TableRowBgAlt) };
+    const ImU32 SelectionColor = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+    const bool Clicked = ImGui::IsMouseClicked(ImGuiMouseButton_Left) && ImGui::IsWindowHovered();
+    const bool DoubleClicked = Clicked && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left);
+    const float MouseY = ImGui::GetIO().MousePos.y;
+    
+    uint64_t Row = Heights.RowAt(ViewTop);
+    double Top = Heights.Offset(Row);
+    if (Top > 0.0)
+        ImGui::TableNextRow(ImGuiTableRowFlags_None, (float)Top);
+    
+    // Row backgrounds are set by row index so the stripes do not flicker as
+    // the first drawn row changes while scrolling.
+    for (; Row < Rows && Top < ViewBottom; Row++)
+    {
+        const uint64_t Source = SourceRow(Row);
+        ImGui::TableNextRow();
+        ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, RowColors[Row & 1]);
+        
+        ImGui::TableSetColumnIndex(0);
+        const float CellTop = ImGui::GetCursorScreenPos().y;
+        float CellBottom = CellTop + ImGui::GetTextLineHeight();
+        ImGui::Text("%llu", (unsigned long long)(Row + 1));
+        
+        for (size_t t = 1; t < Slots.size(); t++)
+        {
+            const int c = Slots[t];
+            if (c < 0 || !ImGui::TableSetColumnIndex((int)t))
+                continue;
+            
+            if (Selected(Row, c))
+                ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, SelectionColor);
+            const CellLayout &Layout = Layouts.Get(Result, Source, (size_t)c, ImGui::GetContentRegionAvail().x);
+            CellLayoutCache::Draw(Layout);
+            CellBottom = std::max(CellBottom, ImGui::GetItemRectMax().y);
+        }
+        
+        float Height = CellBottom - CellTop + CellPaddingY * 2.0f;
+        Heights.SetHeight(Row, Height);
+        
+        // Cells are plain text, so clicks are hit-tested against the row's span and the hovered column.
+        if (Clicked && MouseY >= CellTop - CellPaddingY && MouseY < CellTop - CellPaddingY + Height)
+        {
+            const int Hovered = ImGui::TableGetHoveredColumn();
+            if (Hovered > 0 && Hovered < (int)Slots.size() && Slots[Hovered] >= 0)
+            {
+                Select(Store, Row, Slots[Hovered], ImGui::GetIO().KeyShift);
+                if (DoubleClicked)
+                {
+                    InspectRow = Source;
+                    InspectColumn = Slots[Hovered];
+                }
+            }
+        }
+        Top += Height;
+    }
+    
+    if (Row < Rows)
+        ImGui::TableNextRow(ImGuiTableRowFlags_None, (float)(Heights.TotalHeight() - Top));
+}
@@ -0,0 +1,184 @@
+//
+//  ResultGrid.hpp
+//  DBGui
+//
+// Made by OPSphystech420 2025 (c)
+//
+
+#pragma once
+
+#include "imgui.h"
+#include "ResultSnapshot.hpp"
+#include "RowHeightIndex.hpp"
+#include "CellLayoutCache.hpp"
+#include "QueryWorker.hpp"
+#include "ResultFilter.hpp"
+#include "ColumnStatsPanel.hpp"
+#include "ResultDiffView.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Virtualized table over a result snapshot. Only the rows in view are
+// submitted to ImGui; the rows above and below are stood in for by two
+// spacer rows sized from the row-height index, so scrolling and jumping
+// cost the same for ten rows or ten million.
+//
+// Wide results are virtualized the same way horizontally: past WindowSlots
+// scrolling columns the table only holds the pinned columns, a window of
+// WindowSlots columns around the scroll position and two spacer columns, so
+// it never gets near IMGUI_TABLE_MAX_COLUMNS and only sets up what is shown.
+//
+// Clicking a header sorts the fetched rows on a background thread; rows are
+// then shown through the sort permutation, the result itself is untouched.
+//
+// The filter bar narrows the rows to those containing the typed text (or
+// regex) in any column. Matches stream in while the scan runs, and a query
+// that extends the previous one only rescans the previous matches.
+//
+// Clicking a cell selects it and shift-clicking extends the selection to a
+// rectangle; its count, sum and average are summed on the thread pool and
+// shown in the toolbar once done. The statistics panel below the table
+// profiles every column of the result.
+// Double-clicking a cell asks the owner to open it in the value inspector.
+//
+// A complete result can be pinned as the baseline; the diff toggle then
+// replaces the table with the rows that differ from it.
+class ResultGrid {
+public:
+    static constexpr int WindowSlots = 128;
+    static constexpr int MaxPinnedColumns = 8;
+    static constexpr float StatsPanelHeight = 300.0f;
+    
+    void Draw(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot);
+    
+    // Applied on the next Draw().
+    void ScrollToRow(uint64_t Row) { PendingScrollRow = Row; }
+    
+    // Result row and column of the last double-clicked cell, once.
+    bool TakeInspectRequest(uint64_t &Row, size_t &Column) {
+        if (InspectRow == NoRow)
+            return false;
+        Row = InspectRow;
+        Column = (size_t)InspectColumn;
+        InspectRow = NoRow;
+        return true;
+    }
+    
+private:
+    static constexpr uint64_t NoRow = UINT64_MAX;
+    
+    // What a table column shows; result columns are >= 0.
+    enum SlotKind : int { RowNumberSlot = -1, LeadingSpacerSlot = -2, TrailingSpacerSlot = -3 };
+    
+    void Sync(const std::shared_ptr<const DBCore::ResultSnapshot> &Snapshot);
+    void LayoutColumns(const DBCore::ResultStore &Result);
+    void DrawHeaders(const std::shared_ptr<const DBCore::ResultStore> &Result);
+    void DrawRows(const std::shared_ptr<const DBCore::ResultStore> &Store);
+    
+    void DrawFilterBar(const std::shared_ptr<const DBCore::ResultStore> &Result);
+    void DrawSelectionSummary();
+    
+    void Select(const std::shared_ptr<const DBCore::ResultStore> &Result, uint64_t Row, int Column, bool Extend);
+    void ClearSelection() { SelectionAnchor = SelectionEnd = CellRef(); }
+    bool Selected(uint64_t Row, int Column) const;
+    
+    void RequestSort(const std::shared_ptr<const DBCore::ResultStore> &Result);
+    void ClearSort();
+    bool TakeSortResult();
+    
+    void RequestFilter(const std::shared_ptr<const DBCore::ResultStore> &Result);
+    void ClearFilter();
+    bool TakeFilterResult();
+    
+    // Composes the filter matches with the sort order and resets the heights.
+    void UpdateView(uint64_t Rows);
+    uint64_t DisplayRows(uint64_t Rows) const { return View ? View->size() : Rows; }
+    uint64_t SourceRow(uint64_t DisplayRow) const {
+        if (View)
+            return (*View)[DisplayRow];
+        return Order && DisplayRow < Order->size() ? (*Order)[DisplayRow] : DisplayRow;
+    }
+    
+    DBCore::RowHeightIndex Heights;
+    CellLayoutCache Layouts;
+    uint64_t ResultId = 0;
+    float RowHeight = 0.0f;
+    uint64_t GoToRowInput = 1;
+    uint64_t PendingScrollRow = NoRow;
+    uint64_t InspectRow = NoRow;
+    int InspectColumn = -1;
+    
+    int PinnedColumns = 0;
+    // Widths of result columns, kept across frames and window moves.
+    std::vector<float> ColumnWidths;
+    // Left edges of the scrolling (unpinned) columns, ColumnWidths plus cell padding.
+    std::vector<double> ScrollOffsets;
+    bool OffsetsDirty = true;
+    // Table column -> SlotKind or result column, and the width last requested for it.
+    std::vector<int> Slots;
+    std::vector<float> SlotWidths;
+    
+    // Display row -> result row; rows past its end (still streaming in) show in fetch order.
+    std::shared_ptr<const std::vector<uint64_t>> Order;
+    int SortColumn = -1;
+    bool SortDescending = false;
+    bool Sorting = false;
+    
+    // Selected rectangle, in display rows and result columns.
+    struct CellRef {
+        uint64_t Row = NoRow;
+        int Column = -1;
+    };
+    CellRef SelectionAnchor;
+    CellRef SelectionEnd;
+    uint64_t SelectedCells = 0;
+    // Non-null cells, numeric ones and their sum; summed on SelectionWorker.
+    struct SelectionTotals {
+        uint64_t Values = 0;
+        uint64_t Numbers = 0;
+        double Sum = 0.0;
+    };
+    SelectionTotals Totals;
+    bool Summing = false;
+    
+    bool ShowStats = false;
+    ColumnStatsPanel Stats;
+    
+    std::shared_ptr<const DBCore::ResultSnapshot> DiffBaseline;
+    bool ShowDiff = false;
+    ResultDiffView Diff;
+    
+    // Display row -> result row while a filter is applied, already in sort order.
+    std::shared_ptr<const std::vector<uint64_t>> View;
+    char FilterText[256] = {};
+    bool FilterRegex = false;
+    bool FilterCaseSensitive = false;
+    bool Filtering = false;
+    DBCore::FilterQuery FilterApplied;
+    std::string FilterMessage;
+    // Latest (possibly partial) matches, and the last complete set, which a
+    // narrower query can rescan instead of the whole result.
+    std::shared_ptr<const DBCore::FilterMatches> Matches;
+    std::shared_ptr<const DBCore::FilterMatches> CompleteMatches;
+    
+    std::mutex SortMutex;
+    uint64_t SortRequest = 0;
+    std::shared_ptr<const std::vector<uint64_t>> SortedOrder;
+    
+    std::mutex SelectionMutex;
+    uint64_t SelectionRequest = 0;
+    std::shared_ptr<const SelectionTotals> PendingTotals;
+    
+    std::mutex FilterMutex;
+    uint64_t FilterRequest = 0;
+    std::shared_ptr<const DBCore::FilterMatches> PendingMatches;
+    std::string PendingError;
+    
+    // Last members, so their threads are joined before the state they write goes away.
+    DBCore::QueryWorker SortWorker;
+    DBCore::QueryWorker FilterWorker;
+    DBCore::QueryWorker SelectionWorker;
+};